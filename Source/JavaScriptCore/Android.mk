@@ -48,10 +48,12 @@ LOCAL_SRC_FILES := \
 	debugger/DebuggerActivation.cpp \
 	debugger/DebuggerCallFrame.cpp \
 	\
+	heap/AllocationSampler.cpp \
 	heap/ConservativeRoots.cpp \
 	heap/HandleHeap.cpp \
 	heap/HandleStack.cpp \
 	heap/Heap.cpp \
+	heap/HeapSnapshot.cpp \
 	heap/MachineStackMarker.cpp \
 	heap/MarkStack.cpp \
 	heap/MarkStackPosix.cpp \
@@ -72,8 +74,10 @@ LOCAL_SRC_FILES := \
 	jit/JITOpcodes.cpp \
 	jit/JITPropertyAccess.cpp \
 	jit/JITStubs.cpp \
+	jit/MegamorphicCache.cpp \
 	jit/ThunkGenerators.cpp \
 	\
+	parser/BackgroundParser.cpp \
 	parser/JSParser.cpp \
 	parser/Lexer.cpp \
 	parser/Nodes.cpp \
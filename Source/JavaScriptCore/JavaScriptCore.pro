@@ -72,10 +72,12 @@ SOURCES += \
     bytecode/StructureStubInfo.cpp \
     bytecompiler/BytecodeGenerator.cpp \
     bytecompiler/NodesCodegen.cpp \
+    heap/AllocationSampler.cpp \
     heap/ConservativeRoots.cpp \
     heap/HandleHeap.cpp \
     heap/HandleStack.cpp \
     heap/Heap.cpp \
+    heap/HeapSnapshot.cpp \
     heap/MachineStackMarker.cpp \
     heap/MarkStack.cpp \
     heap/MarkStackPosix.cpp \
@@ -108,7 +110,9 @@ SOURCES += \
     jit/JITPropertyAccess.cpp \
     jit/JITPropertyAccess32_64.cpp \
     jit/JITStubs.cpp \
+    jit/MegamorphicCache.cpp \
     jit/ThunkGenerators.cpp \
+    parser/BackgroundParser.cpp \
     parser/JSParser.cpp \
     parser/Lexer.cpp \
     parser/Nodes.cpp \
@@ -30,6 +30,7 @@
 #include "config.h"
 #include "CodeBlock.h"
 
+#include "AllocationSampler.h"
 #include "BytecodeGenerator.h"
 #include "Debugger.h"
 #include "Interpreter.h"
@@ -38,6 +39,7 @@
 #include "JSFunction.h"
 #include "JSStaticScopeObject.h"
 #include "JSValue.h"
+#include "MegamorphicCache.h"
 #include "UStringConcatenate.h"
 #include <stdio.h>
 #include <wtf/StringExtras.h>
@@ -246,6 +248,9 @@ static void printStructureStubInfo(const StructureStubInfo& stubInfo, unsigned i
     case access_get_by_id_proto_list:
         printf("  [%4d] %s: %s (%d)\n", instructionOffset, "op_get_by_id_proto_list", pointerToSourceString(stubInfo.u.getByIdProtoList.structureList).utf8().data(), stubInfo.u.getByIdProtoList.listSize);
         return;
+    case access_get_by_id_megamorphic:
+        printf("  [%4d] %s\n", instructionOffset, "op_get_by_id_megamorphic");
+        return;
     case access_put_by_id_transition:
         printf("  [%4d] %s: %s, %s, %s\n", instructionOffset, "put_by_id_transition", pointerToSourceString(stubInfo.u.putByIdTransition.previousStructure).utf8().data(), pointerToSourceString(stubInfo.u.putByIdTransition.structure).utf8().data(), pointerToSourceString(stubInfo.u.putByIdTransition.chain).utf8().data());
         return;
@@ -1379,6 +1384,10 @@ CodeBlock::CodeBlock(ScriptExecutable* ownerExecutable, CodeType codeType, JSGlo
     , m_codeType(codeType)
     , m_source(sourceProvider)
     , m_sourceOffset(sourceOffset)
+#if ENABLE(JIT)
+    , m_megamorphicCacheHits(0)
+    , m_megamorphicCacheMisses(0)
+#endif
     , m_symbolTable(symTab)
 {
     ASSERT(m_source);
@@ -1393,6 +1402,13 @@ CodeBlock::~CodeBlock()
 #if ENABLE(JIT)
     for (size_t size = m_structureStubInfos.size(), i = 0; i < size; ++i)
         m_structureStubInfos[i].deref();
+
+    if (m_globalData) {
+        if (AllocationSampler* allocationSampler = m_globalData->heap.allocationSampler())
+            allocationSampler->codeBlockDestroyed(this);
+        if (m_megamorphicCacheMisses)
+            m_globalData->jitStubs->megamorphicCache().codeBlockDestroyed(this);
+    }
 #endif // ENABLE(JIT)
 
 #if DUMP_CODE_BLOCK_STATISTICS
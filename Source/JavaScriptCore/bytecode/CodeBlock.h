@@ -269,6 +269,14 @@ namespace JSC {
                 return 1;
             return binarySearch<CallReturnOffsetToBytecodeOffset, unsigned, getCallReturnOffset>(callIndices.begin(), callIndices.size(), getJITCode().offsetOf(returnAddress.value()))->bytecodeOffset;
         }
+
+        // The accesses of the megamorphic get_by_id in this code block, by
+        // whether the megamorphic cache had the property. Hits are counted
+        // by the JIT code.
+        unsigned megamorphicCacheHits() const { return m_megamorphicCacheHits; }
+        unsigned megamorphicCacheMisses() const { return m_megamorphicCacheMisses; }
+        unsigned* addressOfMegamorphicCacheHits() { return &m_megamorphicCacheHits; }
+        void didMissMegamorphicCache() { ++m_megamorphicCacheMisses; }
 #endif
 #if ENABLE(INTERPRETER)
         unsigned bytecodeOffset(Instruction* returnAddress)
@@ -520,6 +528,8 @@ namespace JSC {
         Vector<GlobalResolveInfo> m_globalResolveInfos;
         Vector<CallLinkInfo> m_callLinkInfos;
         Vector<MethodCallLinkInfo> m_methodCallLinkInfos;
+        unsigned m_megamorphicCacheHits;
+        unsigned m_megamorphicCacheMisses;
 #endif
 
         Vector<unsigned> m_jumpTargets;
@@ -48,6 +48,7 @@ void StructureStubInfo::deref()
     case access_get_by_id_self:
     case access_get_by_id_proto:
     case access_get_by_id_chain:
+    case access_get_by_id_megamorphic:
     case access_put_by_id_transition:
     case access_put_by_id_replace:
     case access_get_by_id:
@@ -95,6 +96,7 @@ void StructureStubInfo::markAggregate(MarkStack& markStack)
     case access_put_by_id_replace:
         markStack.append(&u.putByIdReplace.baseObjectStructure);
         return;
+    case access_get_by_id_megamorphic:
     case access_get_by_id:
     case access_put_by_id:
     case access_get_by_id_generic:
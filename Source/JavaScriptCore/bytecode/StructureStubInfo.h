@@ -41,6 +41,7 @@ namespace JSC {
         access_get_by_id_chain,
         access_get_by_id_self_list,
         access_get_by_id_proto_list,
+        access_get_by_id_megamorphic,
         access_put_by_id_transition,
         access_put_by_id_replace,
         access_get_by_id,
@@ -97,6 +98,14 @@ namespace JSC {
             u.getByIdProtoList.listSize = listSize;
         }
 
+        // Drops the self list, whose stubs the megamorphic stub replaces
+        void initGetByIdMegamorphic()
+        {
+            ASSERT(accessType == access_get_by_id_self_list);
+            deref();
+            accessType = access_get_by_id_megamorphic;
+        }
+
         // PutById*
 
         void initPutByIdTransition(JSGlobalData& globalData, JSCell* owner, Structure* previousStructure, Structure* structure, StructureChain* chain)
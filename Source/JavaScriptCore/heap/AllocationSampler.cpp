@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "AllocationSampler.h"
+
+#include "CallFrame.h"
+#include "CodeBlock.h"
+#include "Executable.h"
+#include <algorithm>
+#include <stdio.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+// The sites printed by dump()
+static const size_t maxDumpedSites = 50;
+
+AllocationSampler::AllocationSampler()
+    : m_sampleInterval(0)
+    , m_bytesUntilSample(0)
+    , m_allocatedBytes(0)
+    , m_unattributedSamples(0)
+#if ENABLE(JIT)
+    , m_stubCallFrame(0)
+    , m_stubCodeBlock(0)
+    , m_stubBytecodeOffset(noBytecodeOffset)
+#endif
+{
+}
+
+void AllocationSampler::setSampleInterval(size_t sampleInterval)
+{
+    m_sampleInterval = sampleInterval;
+    m_bytesUntilSample = sampleInterval;
+#if ENABLE(JIT)
+    // Code blocks were not reported destroyed while not sampling
+    m_stubCallFrame = 0;
+    m_stubCodeBlock = 0;
+#endif
+}
+
+CodeBlock* AllocationSampler::allocatingCodeBlock(CallFrame* callFrame, unsigned& bytecodeOffset)
+{
+    bytecodeOffset = noBytecodeOffset;
+
+    if (!callFrame) {
+#if ENABLE(JIT)
+        bytecodeOffset = m_stubBytecodeOffset;
+        return m_stubCodeBlock;
+#else
+        return 0;
+#endif
+    }
+
+    if (CodeBlock* codeBlock = callFrame->codeBlock()) {
+#if ENABLE(JIT)
+        if (callFrame == m_stubCallFrame && codeBlock == m_stubCodeBlock && m_stubBytecodeOffset != noBytecodeOffset)
+            bytecodeOffset = m_stubBytecodeOffset;
+#endif
+        return codeBlock;
+    }
+
+    // A host function, or code run from the global ExecState
+    CallFrame* callerFrame = callFrame->callerFrame();
+    if (!callerFrame || callerFrame->hasHostCallFrameFlag())
+        return 0;
+    CodeBlock* callerCodeBlock = callerFrame->codeBlock();
+    if (!callerCodeBlock)
+        return 0;
+#if ENABLE(JIT)
+    JITCode& jitCode = callerCodeBlock->getJITCode();
+    char* returnPC = static_cast<char*>(callFrame->returnPC().value());
+    char* codeStart = static_cast<char*>(jitCode.start());
+    if (!!jitCode && returnPC > codeStart && returnPC <= codeStart + jitCode.size())
+        bytecodeOffset = callerCodeBlock->bytecodeOffset(callFrame->returnPC());
+#endif
+    return callerCodeBlock;
+}
+
+void AllocationSampler::sample(CallFrame* callFrame)
+{
+    unsigned bytecodeOffset;
+    CodeBlock* codeBlock = allocatingCodeBlock(callFrame, bytecodeOffset);
+    if (!codeBlock) {
+        ++m_unattributedSamples;
+        return;
+    }
+
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    const SourceCode& source = executable->source();
+    SiteKey key(source.provider(), (static_cast<uint64_t>(source.startOffset()) << 32) | bytecodeOffset);
+    std::pair<HashMap<SiteKey, AllocationSite>::iterator, bool> result = m_sites.add(key, AllocationSite());
+    AllocationSite& site = result.first->second;
+    if (result.second) {
+        site.provider = source.provider();
+        if (codeBlock->codeType() == GlobalCode)
+            site.functionName = "<global>";
+        else if (codeBlock->codeType() == EvalCode)
+            site.functionName = "<eval>";
+        else if (static_cast<FunctionExecutable*>(executable)->name().isEmpty())
+            site.functionName = "<anonymous>";
+        else
+            site.functionName = static_cast<FunctionExecutable*>(executable)->name().ustring();
+        site.line = bytecodeOffset == noBytecodeOffset ? executable->lineNo() : codeBlock->lineNumberForBytecodeOffset(bytecodeOffset);
+        site.bytecodeOffset = bytecodeOffset;
+    }
+    ++site.samples;
+}
+
+static bool moreSamples(const std::pair<size_t, const void*>& a, const std::pair<size_t, const void*>& b)
+{
+    return a.first > b.first;
+}
+
+void AllocationSampler::dump() const
+{
+    size_t samples = m_unattributedSamples;
+    Vector<std::pair<size_t, const void*> > sites;
+    HashMap<SiteKey, AllocationSite>::const_iterator end = m_sites.end();
+    for (HashMap<SiteKey, AllocationSite>::const_iterator it = m_sites.begin(); it != end; ++it) {
+        sites.append(std::make_pair(it->second.samples, &it->second));
+        samples += it->second.samples;
+    }
+    std::sort(sites.begin(), sites.end(), moreSamples);
+
+    printf("\nAllocation sites: %lu bytes allocated, %lu samples of %lu bytes\n",
+        static_cast<unsigned long>(m_allocatedBytes), static_cast<unsigned long>(samples), static_cast<unsigned long>(m_sampleInterval));
+    if (!samples)
+        return;
+
+    printf("%8s %7s  %s\n", "samples", "%", "site");
+    for (size_t i = 0; i < sites.size() && i < maxDumpedSites; ++i) {
+        const AllocationSite& site = *static_cast<const AllocationSite*>(sites[i].second);
+        printf("%8lu %6.2f%%  %s %s:%d", static_cast<unsigned long>(site.samples), 100.0 * site.samples / samples,
+            site.functionName.utf8().data(),
+            site.provider->url().utf8().data(), site.line);
+        if (site.bytecodeOffset != noBytecodeOffset)
+            printf(" [bc#%u]", site.bytecodeOffset);
+        printf("\n");
+    }
+    if (sites.size() > maxDumpedSites)
+        printf("  ... %lu more sites\n", static_cast<unsigned long>(sites.size() - maxDumpedSites));
+    if (m_unattributedSamples)
+        printf("%8lu %6.2f%%  <native code>\n", static_cast<unsigned long>(m_unattributedSamples), 100.0 * m_unattributedSamples / samples);
+}
+
+} // namespace JSC
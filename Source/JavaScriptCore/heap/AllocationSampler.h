@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef AllocationSampler_h
+#define AllocationSampler_h
+
+#include "SourceProvider.h"
+#include "UString.h"
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+
+namespace JSC {
+
+    class CodeBlock;
+    class ExecState;
+    typedef ExecState CallFrame;
+
+    // Samples the allocated cells, one for every sampleInterval bytes, and
+    // counts the samples by the bytecode that allocated them. Each sample
+    // stands for sampleInterval bytes.
+    //
+    // JIT stubs learn their bytecode offset from what the code compiled while
+    // sampling stores before calling them; host functions are attributed to
+    // the call in their caller. Cells allocated with only a JSGlobalData go
+    // to the last JIT stub called, from which most of them come.
+    class AllocationSampler {
+        WTF_MAKE_NONCOPYABLE(AllocationSampler);
+    public:
+        AllocationSampler();
+
+        // The call frame is 0 for cells allocated with only a JSGlobalData
+        void didAllocate(CallFrame* callFrame, size_t bytes)
+        {
+            m_allocatedBytes += bytes;
+            if (bytes < m_bytesUntilSample) {
+                m_bytesUntilSample -= bytes;
+                return;
+            }
+            m_bytesUntilSample = m_sampleInterval;
+            sample(callFrame);
+        }
+
+        size_t sampleInterval() const { return m_sampleInterval; }
+        void setSampleInterval(size_t sampleInterval);
+
+        // Prints the allocation sites, the most sampled first
+        void dump() const;
+
+#if ENABLE(JIT)
+        void codeBlockDestroyed(CodeBlock* codeBlock)
+        {
+            if (codeBlock == m_stubCodeBlock)
+                m_stubCodeBlock = 0;
+        }
+
+        void* addressOfStubCallFrame() { return &m_stubCallFrame; }
+        void* addressOfStubCodeBlock() { return &m_stubCodeBlock; }
+        void* addressOfStubBytecodeOffset() { return &m_stubBytecodeOffset; }
+#endif
+
+    private:
+        static const unsigned noBytecodeOffset = 0xffffffff;
+
+        struct AllocationSite {
+            AllocationSite()
+                : line(0)
+                , bytecodeOffset(noBytecodeOffset)
+                , samples(0)
+            {
+            }
+
+            RefPtr<SourceProvider> provider; // Keeps the key alive
+            UString functionName;
+            int line;
+            unsigned bytecodeOffset;
+            size_t samples;
+        };
+
+        // The source and the bytecode offset in the function starting at
+        // the given offset in the source
+        typedef std::pair<SourceProvider*, uint64_t> SiteKey;
+
+        void sample(CallFrame*);
+        CodeBlock* allocatingCodeBlock(CallFrame*, unsigned& bytecodeOffset);
+
+        size_t m_sampleInterval;
+        size_t m_bytesUntilSample;
+        size_t m_allocatedBytes;
+        size_t m_unattributedSamples;
+        HashMap<SiteKey, AllocationSite> m_sites;
+
+#if ENABLE(JIT)
+        CallFrame* m_stubCallFrame;
+        CodeBlock* m_stubCodeBlock;
+        unsigned m_stubBytecodeOffset;
+#endif
+    };
+
+} // namespace JSC
+
+#endif // AllocationSampler_h
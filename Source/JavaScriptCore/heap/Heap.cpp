@@ -21,6 +21,7 @@
 #include "config.h"
 #include "Heap.h"
 
+#include "AllocationSampler.h"
 #include "CodeBlock.h"
 #include "ConservativeRoots.h"
 #include "GCActivityCallback.h"
@@ -31,6 +32,7 @@
 #include "JSONObject.h"
 #include "Tracing.h"
 #include <algorithm>
+#include <wtf/CurrentTime.h>
 
 #define COLLECT_ON_EVERY_SLOW_ALLOCATION 0
 
@@ -45,12 +47,23 @@ Heap::Heap(JSGlobalData* globalData)
     , m_markedSpace(globalData)
     , m_markListSet(0)
     , m_activityCallback(DefaultGCActivityCallback::create(this))
+    , m_isSamplingAllocations(false)
     , m_globalData(globalData)
     , m_machineThreads(this)
-    , m_markStack(globalData->jsArrayVPtr)
+    , m_markStackSharedData(globalData->jsArrayVPtr)
+    , m_markStack(globalData->jsArrayVPtr, &m_markStackSharedData)
     , m_handleHeap(globalData)
     , m_extraCost(0)
+    , m_totalPauseTime(0)
+    , m_maxPauseTime(0)
+#if ENABLE(GGC)
+    , m_isGenerational(false)
+    , m_shouldDoFullCollection(false)
+    , m_sizeAfterLastFullCollection(0)
+    , m_minorCollectionCount(0)
+#endif
 {
+    memset(m_pauseHistogram, 0, sizeof(m_pauseHistogram));
     m_markedSpace.setHighWaterMark(minBytesPerCycle);
     (*m_activityCallback)();
 }
@@ -119,7 +132,7 @@ void* Heap::allocateSlowCase(size_t bytes)
     ASSERT(m_operationInProgress == NoOperation);
 #endif
 
-    reset(DoNotSweep);
+    collect(DoNotSweep);
 
     m_operationInProgress = Allocation;
     void* result = m_markedSpace.allocate(bytes);
@@ -190,7 +203,7 @@ inline RegisterFile& Heap::registerFile()
     return m_globalData->interpreter->registerFile();
 }
 
-void Heap::markRoots()
+void Heap::markRoots(CollectionType collectionType)
 {
 #ifndef NDEBUG
     if (m_globalData->isSharedInstance()) {
@@ -219,40 +232,68 @@ void Heap::markRoots()
     ConservativeRoots registerFileRoots(this);
     registerFile().gatherConservativeRoots(registerFileRoots);
 
-    m_markedSpace.clearMarks();
+    if (collectionType == FullCollection) {
+        m_markedSpace.clearMarks();
+        markStack.clearOpaqueRoots();
+    }
+#if ENABLE(GGC)
+    else {
+        // The old cells keep their marks, and the ones written to since the
+        // last collection may be the only references to young cells.
+        m_markedSpace.clearNewlyAllocatedMarks();
+        m_markedSpace.visitRememberedCells(markStack);
+
+        // Global code stores to the registers of the global object without
+        // write barriers.
+        JSGlobalObject* globalObject = registerFile().globalObject();
+        if (globalObject && isMarked(globalObject))
+            markStack.appendChildren(globalObject);
+    }
+#else
+    ASSERT_UNUSED(collectionType, collectionType == FullCollection);
+#endif
 
+    markStack.setRootName("machine stacks");
     markStack.append(machineThreadRoots);
     markStack.drain();
 
+    markStack.setRootName("register file");
     markStack.append(registerFileRoots);
     markStack.drain();
 
+    markStack.setRootName("protected values");
     markProtectedObjects(heapRootMarker);
     markStack.drain();
     
+    markStack.setRootName("sort vectors");
     markTempSortVectors(heapRootMarker);
     markStack.drain();
 
+    markStack.setRootName("argument buffers");
     if (m_markListSet && m_markListSet->size())
         MarkedArgumentBuffer::markLists(heapRootMarker, *m_markListSet);
     if (m_globalData->exception)
         heapRootMarker.mark(&m_globalData->exception);
     markStack.drain();
 
+    markStack.setRootName("strong handles");
     m_handleHeap.markStrongHandles(heapRootMarker);
     markStack.drain();
 
+    markStack.setRootName("handle stack");
     m_handleStack.mark(heapRootMarker);
     markStack.drain();
 
     // Mark the small strings cache as late as possible, since it will clear
     // itself if nothing else has marked it.
     // FIXME: Change the small strings cache to use Weak<T>.
+    markStack.setRootName("small strings");
     m_globalData->smallStrings.markChildren(heapRootMarker);
     markStack.drain();
     
     // Weak handles must be marked last, because their owners use the set of
     // opaque roots to determine reachability.
+    markStack.setRootName("weak handles");
     int lastOpaqueRootCount;
     do {
         lastOpaqueRootCount = markStack.opaqueRootCount();
@@ -262,6 +303,7 @@ void Heap::markRoots()
     } while (lastOpaqueRootCount != markStack.opaqueRootCount());
 
     markStack.reset();
+    m_markStackSharedData.reset();
 
     m_operationInProgress = NoOperation;
 }
@@ -311,7 +353,6 @@ public:
     PassOwnPtr<TypeCountSet> take();
     
 private:
-    const char* typeName(JSCell*);
     OwnPtr<TypeCountSet> m_typeCountSet;
 };
 
@@ -320,7 +361,7 @@ inline TypeCounter::TypeCounter()
 {
 }
 
-inline const char* TypeCounter::typeName(JSCell* cell)
+const char* Heap::typeName(JSCell* cell)
 {
     if (cell->isString())
         return "string";
@@ -339,7 +380,7 @@ inline const char* TypeCounter::typeName(JSCell* cell)
 
 inline void TypeCounter::operator()(JSCell* cell)
 {
-    m_typeCountSet->add(typeName(cell));
+    m_typeCountSet->add(Heap::typeName(cell));
 }
 
 inline PassOwnPtr<TypeCountSet> TypeCounter::take()
@@ -383,16 +424,34 @@ bool Heap::isBusy()
 
 void Heap::collectAllGarbage()
 {
-    reset(DoSweep);
+    collect(DoSweep);
 }
 
-void Heap::reset(SweepToggle sweepToggle)
+void Heap::collectAllGarbageRecordingRetainers(RetainerMap& retainers)
+{
+    m_markStack.setRetainerMap(&retainers);
+    collect(DoSweep);
+    m_markStack.setRetainerMap(0);
+}
+
+void Heap::collect(SweepToggle sweepToggle)
 {
     ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
     JAVASCRIPTCORE_GC_BEGIN();
 
-    markRoots();
+    double pauseStart = currentTime();
+
+    CollectionType collectionType = FullCollection;
+#if ENABLE(GGC) && !ENABLE(JSC_ZOMBIES)
+    if (m_isGenerational && sweepToggle == DoNotSweep && !m_shouldDoFullCollection)
+        collectionType = MinorCollection;
+#endif
+
+    markRoots(collectionType);
     m_handleHeap.finalizeWeakHandles();
+#if ENABLE(JIT)
+    m_globalData->jitStubs->megamorphicCache().clear();
+#endif
 
     JAVASCRIPTCORE_GC_MARKED();
 
@@ -415,11 +474,88 @@ void Heap::reset(SweepToggle sweepToggle)
     size_t proportionalBytes = 2 * m_markedSpace.size();
     m_markedSpace.setHighWaterMark(max(proportionalBytes, minBytesPerCycle));
 
+#if ENABLE(GGC)
+    if (collectionType == FullCollection)
+        m_sizeAfterLastFullCollection = m_markedSpace.size();
+    else
+        ++m_minorCollectionCount;
+    // Minor collections never free old cells, dead or not
+    m_shouldDoFullCollection = m_markedSpace.size() > 2 * max(m_sizeAfterLastFullCollection, minBytesPerCycle);
+#endif
+
+    recordPause(currentTime() - pauseStart);
+
     JAVASCRIPTCORE_GC_END();
 
     (*m_activityCallback)();
 }
 
+bool Heap::sweepIncrementally(double timeSlice)
+{
+    ASSERT(globalData()->identifierTable == wtfThreadData().currentIdentifierTable());
+    ASSERT(m_operationInProgress == NoOperation);
+
+    double deadline = currentTime() + timeSlice;
+    while (m_markedSpace.sweepNextBlock()) {
+        if (currentTime() >= deadline)
+            return true;
+    }
+    return false;
+}
+
+void Heap::recordPause(double seconds)
+{
+    size_t bucket = 0;
+    for (double limit = 0.001; seconds >= limit && bucket < pauseHistogramSize - 1; limit *= 2)
+        ++bucket;
+    ++m_pauseHistogram[bucket];
+
+    m_totalPauseTime += seconds;
+    m_maxPauseTime = max(m_maxPauseTime, seconds);
+}
+
+void Heap::dumpPauseHistogram() const
+{
+    unsigned count = 0;
+    for (size_t i = 0; i < pauseHistogramSize; ++i)
+        count += m_pauseHistogram[i];
+
+    printf("\nGC pauses: %u, total %.2fms, max %.2fms\n", count, m_totalPauseTime * 1000, m_maxPauseTime * 1000);
+#if ENABLE(GGC)
+    if (m_isGenerational)
+        printf("  %u minor collections\n", m_minorCollectionCount);
+#endif
+    if (!count)
+        return;
+
+    for (size_t i = 0; i < pauseHistogramSize; ++i) {
+        if (!m_pauseHistogram[i])
+            continue;
+        if (!i)
+            printf("  < 1ms");
+        else if (i == pauseHistogramSize - 1)
+            printf("  >= %ums", 1u << (i - 1));
+        else
+            printf("  %u-%ums", 1u << (i - 1), 1u << i);
+        printf("\t%u (%.1f%%)\n", m_pauseHistogram[i], 100.0 * m_pauseHistogram[i] / count);
+    }
+}
+
+void Heap::setAllocationSamplingInterval(size_t sampleInterval)
+{
+    // The JIT code compiled while sampling stores to the sampler, so it is
+    // kept until the heap is destroyed.
+    if (!m_allocationSampler)
+        m_allocationSampler = adoptPtr(new AllocationSampler);
+    m_allocationSampler->setSampleInterval(sampleInterval);
+    m_isSamplingAllocations = sampleInterval > 0;
+}
+
+void Heap::sampleAllocation(ExecState* exec, size_t bytes)
+{
+    m_allocationSampler->didAllocate(exec, bytes);
+}
+
 void Heap::setActivityCallback(PassOwnPtr<GCActivityCallback> activityCallback)
 {
     m_activityCallback = activityCallback;
@@ -32,6 +32,8 @@
 
 namespace JSC {
 
+    class AllocationSampler;
+    class ExecState;
     class GCActivityCallback;
     class GlobalCodeBlock;
     class HeapRootMarker;
@@ -76,8 +78,36 @@ namespace JSC {
         void* allocate(size_t);
         void collectAllGarbage();
 
+        // Also records which cell, or which kind of root, retains each live cell
+        void collectAllGarbageRecordingRetainers(RetainerMap&);
+
+        // DoNotSweep leaves the dead cells to allocation and to sweepIncrementally().
+        enum SweepToggle { DoNotSweep, DoSweep };
+        void collect(SweepToggle);
+
+        // Sweeps blocks left by the last collection for about timeSlice
+        // seconds. Returns true if some are left for a later call.
+        bool sweepIncrementally(double timeSlice);
+        bool isSweeping() const { return m_markedSpace.isSweeping(); }
+
+        // Prints how long the collections paused the mutator
+        void dumpPauseHistogram() const;
+
+#if ENABLE(GGC)
+        // In generational mode, collections triggered by allocation only
+        // collect the cells allocated since the last collection, until the
+        // old generation doubles since the last full collection.
+        bool isGenerational() const { return m_isGenerational; }
+        void setGenerational(bool isGenerational) { m_isGenerational = isGenerational; }
+#endif
+
         void reportExtraMemoryCost(size_t cost);
 
+        // The number of threads marking the heap in a collection, 1 when
+        // parallel marking is not available
+        unsigned markerCount() const { return m_markStackSharedData.markerCount(); }
+        void setMarkerCount(unsigned markerCount) { m_markStackSharedData.setMarkerCount(markerCount); }
+
         void protect(JSValue);
         bool unprotect(JSValue); // True when the protect count drops to 0.
 
@@ -91,6 +121,14 @@ namespace JSC {
         size_t protectedGlobalObjectCount();
         PassOwnPtr<TypeCountSet> protectedObjectTypeCounts();
         PassOwnPtr<TypeCountSet> objectTypeCounts();
+        static const char* typeName(JSCell*); // As counted by objectTypeCounts()
+
+        // Samples the allocated cells every sampleInterval bytes; 0 stops
+        // sampling. Only code compiled while sampling gives the bytecode
+        // offsets of the allocations in JIT stubs.
+        void setAllocationSamplingInterval(size_t sampleInterval);
+        AllocationSampler* allocationSampler() const { return m_isSamplingAllocations ? m_allocationSampler.get() : 0; }
+        void sampleAllocation(ExecState*, size_t);
 
         void pushTempSortVector(Vector<ValueStringPair>*);
         void popTempSortVector(Vector<ValueStringPair>*);
@@ -113,12 +151,12 @@ namespace JSC {
         void* allocateSlowCase(size_t);
         void reportExtraMemoryCostSlowCase(size_t);
 
-        void markRoots();
+        enum CollectionType { FullCollection, MinorCollection };
+        void markRoots(CollectionType);
         void markProtectedObjects(HeapRootMarker&);
         void markTempSortVectors(HeapRootMarker&);
 
-        enum SweepToggle { DoNotSweep, DoSweep };
-        void reset(SweepToggle);
+        void recordPause(double seconds);
 
         RegisterFile& registerFile();
 
@@ -131,15 +169,31 @@ namespace JSC {
         HashSet<MarkedArgumentBuffer*>* m_markListSet;
 
         OwnPtr<GCActivityCallback> m_activityCallback;
+        OwnPtr<AllocationSampler> m_allocationSampler;
+        bool m_isSamplingAllocations;
 
         JSGlobalData* m_globalData;
         
         MachineThreads m_machineThreads;
+        MarkStackThreadSharedData m_markStackSharedData;
         MarkStack m_markStack;
         HandleHeap m_handleHeap;
         HandleStack m_handleStack;
 
         size_t m_extraCost;
+
+        // Pauses of 2^(i - 1) to 2^i milliseconds land in bucket i
+        static const size_t pauseHistogramSize = 12;
+        unsigned m_pauseHistogram[pauseHistogramSize];
+        double m_totalPauseTime;
+        double m_maxPauseTime;
+
+#if ENABLE(GGC)
+        bool m_isGenerational;
+        bool m_shouldDoFullCollection;
+        size_t m_sizeAfterLastFullCollection;
+        unsigned m_minorCollectionCount;
+#endif
     };
 
     inline bool Heap::isMarked(const JSCell* cell)
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "HeapSnapshot.h"
+
+#include "Heap.h"
+#include "JSCell.h"
+#include "JSGlobalObject.h"
+#include "MarkedBlock.h"
+#include <algorithm>
+#include <stdio.h>
+
+namespace JSC {
+
+// Longer retaining paths are cut
+static const size_t maxRetainingPathLength = 32;
+
+// The retainers printed for each type
+static const size_t maxDumpedRetainers = 3;
+
+static const char unknownRetainer[] = "unknown";
+
+HeapSnapshot::HeapSnapshot(Heap& heap)
+    : m_cellCount(0)
+    , m_bytes(0)
+{
+    heap.collectAllGarbageRecordingRetainers(m_retainers);
+    heap.forEach(*this);
+}
+
+void HeapSnapshot::operator()(JSCell* cell)
+{
+    TypeStatistics& statistics = m_types.add(Heap::typeName(cell), TypeStatistics()).first->second;
+    size_t cellSize = MarkedBlock::blockFor(cell)->cellSize();
+    ++statistics.cellCount;
+    statistics.bytes += cellSize;
+    statistics.structures.add(cell->structure());
+    ++m_cellCount;
+    m_bytes += cellSize;
+
+    RetainerMap::iterator retainer = m_retainers.find(cell);
+    if (retainer == m_retainers.end())
+        statistics.retainingRoots.add(unknownRetainer);
+    else if (retainer->second.cell)
+        statistics.retainingTypes.add(Heap::typeName(const_cast<JSCell*>(retainer->second.cell)));
+    else
+        statistics.retainingRoots.add(retainer->second.rootName);
+
+    if (statistics.retainingPath.isEmpty())
+        findRetainingPath(cell, statistics.retainingPath);
+}
+
+void HeapSnapshot::findRetainingPath(const JSCell* cell, Vector<const char*>& path) const
+{
+    while (path.size() < maxRetainingPathLength) {
+        path.append(Heap::typeName(const_cast<JSCell*>(cell)));
+        RetainerMap::const_iterator retainer = m_retainers.find(cell);
+        if (retainer == m_retainers.end()) {
+            path.append(unknownRetainer);
+            return;
+        }
+        if (!retainer->second.cell) {
+            path.append(retainer->second.rootName);
+            return;
+        }
+        cell = retainer->second.cell;
+    }
+    path.append("...");
+}
+
+typedef std::pair<size_t, const char*> CountedName;
+
+static bool moreCounted(const CountedName& a, const CountedName& b)
+{
+    return a.first > b.first;
+}
+
+// Type names are printed as they are, root names in brackets
+static void appendRetainers(const HashCountedSet<const char*>& counts, bool areRoots, Vector<std::pair<CountedName, bool> >& retainers)
+{
+    HashCountedSet<const char*>::const_iterator end = counts.end();
+    for (HashCountedSet<const char*>::const_iterator it = counts.begin(); it != end; ++it)
+        retainers.append(std::make_pair(CountedName(it->second, it->first), areRoots));
+}
+
+static bool moreRetained(const std::pair<CountedName, bool>& a, const std::pair<CountedName, bool>& b)
+{
+    return moreCounted(a.first, b.first);
+}
+
+void HeapSnapshot::dump() const
+{
+    printf("\nHeap snapshot: %lu cells, %lu bytes\n", static_cast<unsigned long>(m_cellCount), static_cast<unsigned long>(m_bytes));
+
+    Vector<CountedName> types;
+    HashMap<const char*, TypeStatistics>::const_iterator end = m_types.end();
+    for (HashMap<const char*, TypeStatistics>::const_iterator it = m_types.begin(); it != end; ++it)
+        types.append(CountedName(it->second.bytes, it->first));
+    std::sort(types.begin(), types.end(), moreCounted);
+
+    printf("%8s %10s %10s  %s\n", "cells", "bytes", "structures", "type");
+    for (size_t i = 0; i < types.size(); ++i) {
+        const TypeStatistics& statistics = m_types.find(types[i].second)->second;
+        printf("%8lu %10lu %10lu  %s\n", static_cast<unsigned long>(statistics.cellCount), static_cast<unsigned long>(statistics.bytes),
+            static_cast<unsigned long>(statistics.structures.size()), types[i].second);
+    }
+
+    printf("\nRetainers:\n");
+    for (size_t i = 0; i < types.size(); ++i) {
+        const TypeStatistics& statistics = m_types.find(types[i].second)->second;
+
+        Vector<std::pair<CountedName, bool> > retainers;
+        appendRetainers(statistics.retainingTypes, false, retainers);
+        appendRetainers(statistics.retainingRoots, true, retainers);
+        std::sort(retainers.begin(), retainers.end(), moreRetained);
+
+        printf("  %s: retained by", types[i].second);
+        for (size_t j = 0; j < retainers.size() && j < maxDumpedRetainers; ++j) {
+            const CountedName& retainer = retainers[j].first;
+            printf(retainers[j].second ? "%s [%s] %lu" : "%s %s %lu", j ? "," : "", retainer.second, static_cast<unsigned long>(retainer.first));
+        }
+        if (retainers.size() > maxDumpedRetainers)
+            printf(", ...");
+
+        printf("\n    path:");
+        const Vector<const char*>& path = statistics.retainingPath;
+        for (size_t j = path.size(); j; --j)
+            printf(j == path.size() ? " [%s]" : " > %s", path[j - 1]);
+        printf("\n");
+    }
+}
+
+} // namespace JSC
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HeapSnapshot_h
+#define HeapSnapshot_h
+
+#include "MarkStack.h"
+#include <wtf/HashCountedSet.h>
+#include <wtf/HashMap.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+    class Heap;
+    class JSCell;
+
+    // The live cells of a heap, counted by type. Taking a snapshot collects
+    // all garbage, recording what retains each cell, so that the snapshot
+    // tells for each type which types and roots retain its cells, and the
+    // path from a root to one of them.
+    class HeapSnapshot {
+        WTF_MAKE_NONCOPYABLE(HeapSnapshot);
+    public:
+        HeapSnapshot(Heap&);
+
+        size_t cellCount() const { return m_cellCount; }
+        size_t bytes() const { return m_bytes; }
+
+        // Prints the types, the largest first
+        void dump() const;
+
+        // Used with Heap::forEach
+        void operator()(JSCell*);
+
+    private:
+        struct TypeStatistics {
+            TypeStatistics()
+                : cellCount(0)
+                , bytes(0)
+            {
+            }
+
+            size_t cellCount;
+            size_t bytes;
+            HashSet<void*> structures;
+            HashCountedSet<const char*> retainingTypes;
+            HashCountedSet<const char*> retainingRoots;
+            Vector<const char*> retainingPath; // From the cell to its root
+        };
+
+        void findRetainingPath(const JSCell*, Vector<const char*>&) const;
+
+        RetainerMap m_retainers;
+        HashMap<const char*, TypeStatistics> m_types;
+        size_t m_cellCount;
+        size_t m_bytes;
+    };
+
+} // namespace JSC
+
+#endif // HeapSnapshot_h
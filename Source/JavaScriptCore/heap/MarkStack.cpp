@@ -36,14 +36,110 @@
 
 namespace JSC {
 
+// Cells a marker visits before looking whether it should donate some
+static const unsigned visitsBetweenDonations = 100;
+
 size_t MarkStack::s_pageSize = 0;
 
+MarkStackThreadSharedData::MarkStackThreadSharedData(void* jsArrayVPtr)
+    : m_jsArrayVPtr(jsArrayVPtr)
+    , m_markerCount(defaultMarkerCount())
+#if ENABLE(PARALLEL_GC)
+    , m_numberOfActiveMarkers(0)
+    , m_markersShouldExit(false)
+#endif
+{
+}
+
+MarkStackThreadSharedData::~MarkStackThreadSharedData()
+{
+#if ENABLE(PARALLEL_GC)
+    stopMarkingThreads();
+#endif
+}
+
+void MarkStackThreadSharedData::setMarkerCount(unsigned markerCount)
+{
+#if ENABLE(PARALLEL_GC)
+    stopMarkingThreads();
+    m_markerCount = std::min(std::max(markerCount, 1u), maximumMarkerCount);
+#else
+    UNUSED_PARAM(markerCount);
+#endif
+}
+
+#if ENABLE(PARALLEL_GC)
+void MarkStackThreadSharedData::startMarkingThreads()
+{
+    ASSERT(m_markingThreads.isEmpty());
+    for (unsigned i = 1; i < m_markerCount; ++i) {
+        MarkStack* markStack = new MarkStack(m_jsArrayVPtr, this);
+        ThreadIdentifier thread = createThread(markingThreadStartFunc, markStack, "JavaScriptCore::Marking");
+        if (!thread) {
+            delete markStack;
+            break;
+        }
+        m_markingThreadStacks.append(markStack);
+        m_markingThreads.append(thread);
+    }
+    // Mark alone if no thread could be started
+    if (m_markingThreads.isEmpty())
+        m_markerCount = 1;
+}
+
+void MarkStackThreadSharedData::stopMarkingThreads()
+{
+    {
+        MutexLocker locker(m_markingLock);
+        m_markersShouldExit = true;
+        m_markingCondition.broadcast();
+    }
+    for (size_t i = 0; i < m_markingThreads.size(); ++i)
+        waitForThreadCompletion(m_markingThreads[i], 0);
+    m_markingThreads.clear();
+    deleteAllValues(m_markingThreadStacks);
+    m_markingThreadStacks.clear();
+    m_markersShouldExit = false;
+}
+
+void* MarkStackThreadSharedData::markingThreadStartFunc(void* markStack)
+{
+    static_cast<MarkStack*>(markStack)->drainFromShared(MarkStack::SlaveDrain);
+    return 0;
+}
+
+void MarkStackThreadSharedData::mergeOpaqueRoots(MarkStack& markStack)
+{
+    MutexLocker locker(m_markingLock);
+    for (size_t i = 0; i < m_markingThreadStacks.size(); ++i) {
+        HashSet<void*>& opaqueRoots = m_markingThreadStacks[i]->m_opaqueRoots;
+        HashSet<void*>::iterator end = opaqueRoots.end();
+        for (HashSet<void*>::iterator it = opaqueRoots.begin(); it != end; ++it)
+            markStack.m_opaqueRoots.add(*it);
+        opaqueRoots.clear();
+    }
+}
+
+void MarkStackThreadSharedData::reset()
+{
+    // The marking threads are idle, waiting for the next collection
+    MutexLocker locker(m_markingLock);
+    ASSERT(m_sharedValues.isEmpty());
+    m_sharedValues.shrinkAllocation(MarkStack::pageSize());
+    for (size_t i = 0; i < m_markingThreadStacks.size(); ++i)
+        m_markingThreadStacks[i]->reset();
+}
+#else
+void MarkStackThreadSharedData::reset()
+{
+}
+#endif
+
 void MarkStack::reset()
 {
     ASSERT(s_pageSize);
     m_values.shrinkAllocation(s_pageSize);
     m_markSets.shrinkAllocation(s_pageSize);
-    m_opaqueRoots.clear();
 }
 
 void MarkStack::append(ConservativeRoots& conservativeRoots)
@@ -83,6 +179,25 @@ inline void MarkStack::markChildren(JSCell* cell)
 }
 
 void MarkStack::drain()
+{
+    if (m_retainers) {
+        drainRecordingRetainers();
+        return;
+    }
+#if ENABLE(PARALLEL_GC)
+    if (m_shared && m_shared->m_markerCount > 1) {
+        if (m_shared->m_markingThreads.isEmpty())
+            m_shared->startMarkingThreads();
+        drainLocal();
+        drainFromShared(MasterDrain);
+        m_shared->mergeOpaqueRoots(*this);
+        return;
+    }
+#endif
+    drainLocal();
+}
+
+void MarkStack::drainLocal()
 {
 #if !ASSERT_DISABLED
     ASSERT(!m_isDraining);
@@ -124,12 +239,106 @@ void MarkStack::drain()
 
             markChildren(cell);
         }
-        while (!m_values.isEmpty())
+        while (!m_values.isEmpty()) {
             markChildren(m_values.removeLast());
+#if ENABLE(PARALLEL_GC)
+            if (m_shared && ++m_visitsSinceDonation == visitsBetweenDonations) {
+                m_visitsSinceDonation = 0;
+                donateKnownParallel();
+            }
+#endif
+        }
     }
 #if !ASSERT_DISABLED
     m_isDraining = false;
 #endif
 }
 
+// Visits the values of the mark sets right after the cell that appended
+// them, so that the cell being visited is their retainer.
+void MarkStack::drainRecordingRetainers()
+{
+    m_currentRetainer = 0;
+    while (!m_markSets.isEmpty() || !m_values.isEmpty()) {
+        while (!m_markSets.isEmpty()) {
+            MarkSet current = m_markSets.removeLast();
+            for (JSValue* value = current.m_values; value != current.m_end; ++value) {
+                if (*value)
+                    internalAppend(*value);
+            }
+        }
+        if (m_values.isEmpty())
+            break;
+        m_currentRetainer = m_values.removeLast();
+        markChildren(m_currentRetainer);
+    }
+    m_currentRetainer = 0;
+}
+
+void MarkStack::recordRetainer(JSCell* cell)
+{
+    m_retainers->add(cell, Retainer(m_currentRetainer, m_currentRetainer ? 0 : m_rootName));
+}
+
+#if ENABLE(PARALLEL_GC)
+void MarkStack::donateKnownParallel()
+{
+    // Do not bother the other markers from the dead ends of the object graph
+    if (m_values.size() < 2 || m_shared->m_markerCount < 2)
+        return;
+
+    // If the lock is taken, another marker is already donating or stealing
+    if (!m_shared->m_markingLock.tryLock())
+        return;
+
+    // Donate only when the other markers ran out of work to steal
+    if (m_shared->m_sharedValues.isEmpty()) {
+        m_values.donateSomeTo(m_shared->m_sharedValues);
+        if (m_shared->m_numberOfActiveMarkers < m_shared->m_markerCount)
+            m_shared->m_markingCondition.broadcast();
+    }
+    m_shared->m_markingLock.unlock();
+}
+
+void MarkStack::drainFromShared(SharedDrainMode sharedDrainMode)
+{
+    MarkStackThreadSharedData& shared = *m_shared;
+    {
+        MutexLocker locker(shared.m_markingLock);
+        shared.m_numberOfActiveMarkers++;
+    }
+    while (true) {
+        {
+            MutexLocker locker(shared.m_markingLock);
+            shared.m_numberOfActiveMarkers--;
+
+            if (sharedDrainMode == MasterDrain) {
+                // Wait for termination, or for some work to do
+                while (true) {
+                    if (!shared.m_numberOfActiveMarkers && shared.m_sharedValues.isEmpty())
+                        return;
+                    if (!shared.m_sharedValues.isEmpty())
+                        break;
+                    shared.m_markingCondition.wait(shared.m_markingLock);
+                }
+            } else {
+                ASSERT(sharedDrainMode == SlaveDrain);
+                // Let the collecting thread know if marking is done
+                if (!shared.m_numberOfActiveMarkers && shared.m_sharedValues.isEmpty())
+                    shared.m_markingCondition.broadcast();
+                while (shared.m_sharedValues.isEmpty() && !shared.m_markersShouldExit)
+                    shared.m_markingCondition.wait(shared.m_markingLock);
+                if (shared.m_markersShouldExit)
+                    return;
+            }
+
+            size_t idleMarkerCount = shared.m_markerCount - shared.m_numberOfActiveMarkers;
+            m_values.stealSomeFrom(shared.m_sharedValues, idleMarkerCount);
+            shared.m_numberOfActiveMarkers++;
+        }
+        drainLocal();
+    }
+}
+#endif
+
 } // namespace JSC
@@ -29,24 +29,51 @@
 #include "JSValue.h"
 #include "Register.h"
 #include "WriteBarrier.h"
+#include <wtf/HashMap.h>
 #include <wtf/HashSet.h>
 #include <wtf/Vector.h>
 #include <wtf/Noncopyable.h>
 #include <wtf/OSAllocator.h>
+#include <wtf/Threading.h>
 
 namespace JSC {
 
     class ConservativeRoots;
     class JSGlobalData;
+    class MarkStackThreadSharedData;
     class Register;
     
     enum MarkSetProperties { MayContainNullValues, NoNullValues };
+
+    // What marking first reached a cell from: another cell, or a kind of root
+    struct Retainer {
+        Retainer()
+            : cell(0)
+            , rootName(0)
+        {
+        }
+
+        Retainer(const JSCell* cell, const char* rootName)
+            : cell(cell)
+            , rootName(rootName)
+        {
+        }
+
+        const JSCell* cell; // 0 for roots
+        const char* rootName;
+    };
+    typedef HashMap<const JSCell*, Retainer> RetainerMap;
     
     class MarkStack {
         WTF_MAKE_NONCOPYABLE(MarkStack);
     public:
-        MarkStack(void* jsArrayVPtr)
+        MarkStack(void* jsArrayVPtr, MarkStackThreadSharedData* shared = 0)
             : m_jsArrayVPtr(jsArrayVPtr)
+            , m_shared(shared)
+            , m_visitsSinceDonation(0)
+            , m_retainers(0)
+            , m_currentRetainer(0)
+            , m_rootName(0)
 #if !ASSERT_DISABLED
             , m_isCheckingForDefaultMarkViolation(false)
             , m_isDraining(false)
@@ -71,16 +98,42 @@ namespace JSC {
         }
         
         void append(ConservativeRoots&);
+#if ENABLE(GGC)
+        // Visits again the children of a marked cell that was written to
+        void appendChildren(JSCell*);
+#endif
 
+        // The opaque roots are kept until cleared, as minor collections
+        // do not visit the old cells that added them.
         bool addOpaqueRoot(void* root) { return m_opaqueRoots.add(root).second; }
         bool containsOpaqueRoot(void* root) { return m_opaqueRoots.contains(root); }
         int opaqueRootCount() { return m_opaqueRoots.size(); }
+        void clearOpaqueRoots() { m_opaqueRoots.clear(); }
 
+        // With a MarkStackThreadSharedData of several markers, the
+        // marking threads help draining this stack.
         void drain();
         void reset();
 
+        // While a RetainerMap is set, marking records the retainer of each
+        // cell it marks, on this thread only. The root name is the kind of
+        // the roots appended next.
+        void setRetainerMap(RetainerMap* retainers) { m_retainers = retainers; }
+        void setRootName(const char* rootName) { m_rootName = rootName; }
+
     private:
         friend class HeapRootMarker; // Allowed to mark a JSValue* or JSCell** directly.
+        friend class MarkStackThreadSharedData;
+
+        enum SharedDrainMode { MasterDrain, SlaveDrain };
+
+        void drainLocal();
+        void drainRecordingRetainers();
+        void recordRetainer(JSCell*);
+#if ENABLE(PARALLEL_GC)
+        void donateKnownParallel();
+        void drainFromShared(SharedDrainMode);
+#endif
         void append(JSValue*);
         void append(JSValue*, size_t count);
         void append(JSCell**);
@@ -145,6 +198,22 @@ namespace JSC {
                 m_data[m_top++] = v;
             }
 
+            // Moves half of the entries to another array
+            void donateSomeTo(MarkStackArray& other)
+            {
+                for (size_t count = m_top / 2; count; --count)
+                    other.append(removeLast());
+            }
+
+            // Takes a share of another array's entries, to split between sharerCount arrays
+            void stealSomeFrom(MarkStackArray& other, size_t sharerCount)
+            {
+                ASSERT(sharerCount);
+                size_t count = std::max<size_t>(other.size() / sharerCount, 1);
+                for (count = std::min(count, other.size()); count; --count)
+                    append(other.removeLast());
+            }
+
             inline T removeLast()
             {
                 ASSERT(m_top);
@@ -190,10 +259,15 @@ namespace JSC {
         };
 
         void* m_jsArrayVPtr;
+        MarkStackThreadSharedData* m_shared;
+        unsigned m_visitsSinceDonation;
         MarkStackArray<MarkSet> m_markSets;
         MarkStackArray<JSCell*> m_values;
         static size_t s_pageSize;
         HashSet<void*> m_opaqueRoots; // Handle-owning data structures not visible to the garbage collector.
+        RetainerMap* m_retainers;
+        JSCell* m_currentRetainer;
+        const char* m_rootName;
 
 #if !ASSERT_DISABLED
     public:
@@ -202,6 +276,53 @@ namespace JSC {
 #endif
     };
 
+    // The threads helping the collecting thread to mark, and the cells they
+    // share. Each marker drains its own MarkStack, donating half of its cells
+    // to the shared pool when the others might run out of work, and stealing
+    // from the pool when it has none left. The collecting thread merges the
+    // opaque roots of the other markers into its own once they all are idle.
+    class MarkStackThreadSharedData {
+        WTF_MAKE_NONCOPYABLE(MarkStackThreadSharedData);
+    public:
+        static const unsigned maximumMarkerCount = 8;
+
+        MarkStackThreadSharedData(void* jsArrayVPtr);
+        ~MarkStackThreadSharedData();
+
+        // The number of threads marking, including the collecting thread.
+        // The marking threads are started by the first collection.
+        unsigned markerCount() const { return m_markerCount; }
+        void setMarkerCount(unsigned);
+
+        // Shrinks the marking threads' stacks, after a collection
+        void reset();
+
+    private:
+        friend class MarkStack;
+
+        static unsigned defaultMarkerCount();
+
+#if ENABLE(PARALLEL_GC)
+        void startMarkingThreads();
+        void stopMarkingThreads();
+        static void* markingThreadStartFunc(void* markStack);
+        void mergeOpaqueRoots(MarkStack&);
+#endif
+
+        void* m_jsArrayVPtr;
+        unsigned m_markerCount;
+#if ENABLE(PARALLEL_GC)
+        Vector<ThreadIdentifier> m_markingThreads;
+        Vector<MarkStack*> m_markingThreadStacks;
+        Mutex m_markingLock;
+        ThreadCondition m_markingCondition;
+        // Guarded by m_markingLock
+        MarkStack::MarkStackArray<JSCell*> m_sharedValues;
+        unsigned m_numberOfActiveMarkers;
+        bool m_markersShouldExit;
+#endif
+    };
+
     inline void MarkStack::append(JSValue* slot, size_t count)
     {
         if (!count)
@@ -28,6 +28,7 @@
 
 #if OS(UNIX) && !OS(SYMBIAN)
 
+#include <algorithm>
 #include <unistd.h>
 #include <sys/mman.h>
 
@@ -38,6 +39,16 @@ void MarkStack::initializePagesize()
     MarkStack::s_pageSize = getpagesize();
 }
 
+unsigned MarkStackThreadSharedData::defaultMarkerCount()
+{
+#if ENABLE(PARALLEL_GC)
+    long processorCount = sysconf(_SC_NPROCESSORS_ONLN);
+    if (processorCount > 1)
+        return std::min(static_cast<unsigned>(processorCount), 4u);
+#endif
+    return 1;
+}
+
 }
 
 #endif
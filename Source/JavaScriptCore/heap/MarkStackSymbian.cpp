@@ -33,6 +33,11 @@ void MarkStack::initializePagesize()
     MarkStack::s_pageSize = page_size;
 }
 
+unsigned MarkStackThreadSharedData::defaultMarkerCount()
+{
+    return 1;
+}
+
 }
 
 #endif
@@ -39,6 +39,11 @@ void MarkStack::initializePagesize()
     MarkStack::s_pageSize = system_info.dwPageSize;
 }
 
+unsigned MarkStackThreadSharedData::defaultMarkerCount()
+{
+    return 1;
+}
+
 }
 
 #endif
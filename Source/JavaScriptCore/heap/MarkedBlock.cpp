@@ -57,6 +57,9 @@ MarkedBlock::MarkedBlock(const PageAllocationAligned& allocation, JSGlobalData*
 {
     m_atomsPerCell = (cellSize + atomSize - 1) / atomSize;
     m_endAtom = atomsPerBlock - m_atomsPerCell + 1;
+#if ENABLE(GGC)
+    clearCards();
+#endif
 
     Structure* dummyMarkableCellStructure = globalData->dummyMarkableCellStructure.get();
     for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell)
@@ -67,7 +70,9 @@ void MarkedBlock::sweep()
 {
     Structure* dummyMarkableCellStructure = m_heap->globalData()->dummyMarkableCellStructure.get();
 
-    for (size_t i = firstAtom(); i < m_endAtom; i += m_atomsPerCell) {
+    // Allocation marks every cell it passes, so the cells before m_nextAtom
+    // are all live.
+    for (size_t i = m_nextAtom; i < m_endAtom; i += m_atomsPerCell) {
         if (m_marks.get(i))
             continue;
 
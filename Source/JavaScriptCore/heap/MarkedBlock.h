@@ -22,6 +22,7 @@
 #ifndef MarkedBlock_h
 #define MarkedBlock_h
 
+#include <algorithm>
 #include <wtf/Bitmap.h>
 #include <wtf/PageAllocationAligned.h>
 #include <wtf/StdLibExtras.h>
@@ -40,6 +41,9 @@ namespace JSC {
     public:
         static const size_t atomSize = sizeof(double); // Ensures natural alignment for all built-in types.
 
+        static const size_t blockSize = 16 * KB;
+        static const size_t blockMask = ~(blockSize - 1); // blockSize must be a power of two.
+
         static MarkedBlock* create(JSGlobalData*, size_t cellSize);
         static void destroy(MarkedBlock*);
 
@@ -76,10 +80,28 @@ namespace JSC {
         
         template <typename Functor> void forEach(Functor&);
 
-    private:
-        static const size_t blockSize = 16 * KB;
-        static const size_t blockMask = ~(blockSize - 1); // blockSize must be a power of two.
+#if ENABLE(GGC)
+        // Each block keeps the cards of its remembered set. A card is dirty once
+        // a reference was stored into a cell starting in it, which then may
+        // point to a newly allocated cell.
+        static const size_t cardShift = 7;
+        static const size_t cardsPerBlock = blockSize >> cardShift;
+
+        static ptrdiff_t offsetOfCards() { return OBJECT_OFFSETOF(MarkedBlock, m_cards); }
+        int32_t* addressOfCardFor(const void* cell) { return &m_cards[cardNumber(cell)]; }
+        void rememberCell(const void* cell) { m_cards[cardNumber(cell)] = 1; }
+        void clearCards() { memset(m_cards, 0, sizeof(m_cards)); }
+
+        // Visits the marked cells of the dirty cards, and cleans them.
+        template <typename Functor> void forEachRememberedCell(Functor&);
 
+        // Cells allocated since the last collection are its young generation.
+        // Clearing their marks lets a minor collection find the live ones.
+        void clearNewlyAllocatedMarks() { m_marks.exclude(m_newlyAllocated); }
+        void clearNewlyAllocated() { m_newlyAllocated.clearAll(); }
+#endif
+
+    private:
         static const size_t atomMask = ~(atomSize - 1); // atomSize must be a power of two.
         
         static const size_t atomsPerBlock = blockSize / atomSize;
@@ -88,11 +110,18 @@ namespace JSC {
 
         MarkedBlock(const PageAllocationAligned&, JSGlobalData*, size_t cellSize);
         Atom* atoms();
+#if ENABLE(GGC)
+        size_t cardNumber(const void*);
+#endif
 
         size_t m_nextAtom;
         size_t m_endAtom; // This is a fuzzy end. Always test for < m_endAtom.
         size_t m_atomsPerCell;
         WTF::Bitmap<blockSize / atomSize> m_marks;
+#if ENABLE(GGC)
+        WTF::Bitmap<blockSize / atomSize> m_newlyAllocated;
+        int32_t m_cards[cardsPerBlock];
+#endif
         PageAllocationAligned m_allocation;
         Heap* m_heap;
         MarkedBlock* m_prev;
@@ -202,7 +231,12 @@ namespace JSC {
 
     inline bool MarkedBlock::testAndSetMarked(const void* p)
     {
+#if ENABLE(PARALLEL_GC)
+        // Other marking threads may be setting bits of the same word
+        return m_marks.concurrentTestAndSet(atomNumber(p));
+#else
         return m_marks.testAndSet(atomNumber(p));
+#endif
     }
 
     inline void MarkedBlock::setMarked(const void* p)
@@ -219,6 +253,35 @@ namespace JSC {
         }
     }
 
+#if ENABLE(GGC)
+    inline size_t MarkedBlock::cardNumber(const void* p)
+    {
+        return (reinterpret_cast<uintptr_t>(p) - reinterpret_cast<uintptr_t>(this)) >> cardShift;
+    }
+
+    template <typename Functor> inline void MarkedBlock::forEachRememberedCell(Functor& functor)
+    {
+        static const size_t atomsPerCard = (1 << cardShift) / atomSize;
+
+        for (size_t card = 0; card < cardsPerBlock; ++card) {
+            if (!m_cards[card])
+                continue;
+            m_cards[card] = 0;
+
+            // The cells starting in the card
+            size_t begin = std::max(card * atomsPerCard, firstAtom());
+            if (size_t offset = (begin - firstAtom()) % m_atomsPerCell)
+                begin += m_atomsPerCell - offset;
+            size_t end = std::min((card + 1) * atomsPerCard, m_endAtom);
+            for (size_t i = begin; i < end; i += m_atomsPerCell) {
+                if (!m_marks.get(i))
+                    continue;
+                functor(reinterpret_cast<JSCell*>(&atoms()[i]));
+            }
+        }
+    }
+#endif
+
 } // namespace JSC
 
 #endif // MarkedSpace_h
@@ -25,6 +25,7 @@
 #include "JSGlobalData.h"
 #include "JSLock.h"
 #include "JSObject.h"
+#include "MarkStack.h"
 #include "ScopeChain.h"
 
 namespace JSC {
@@ -45,6 +46,7 @@ MarkedSpace::MarkedSpace(JSGlobalData* globalData)
 
 void MarkedSpace::destroy()
 {
+    m_blocksToSweep.clear();
     clearMarks();
     shrink();
     ASSERT(!size());
@@ -89,6 +91,8 @@ void* MarkedSpace::allocateFromSizeClass(SizeClass& sizeClass)
 
 void MarkedSpace::shrink()
 {
+    ASSERT(m_blocksToSweep.isEmpty());
+
     // We record a temporary list of empties to avoid modifying m_blocks while iterating it.
     DoublyLinkedList<MarkedBlock> empties;
 
@@ -110,15 +114,99 @@ void MarkedSpace::shrink()
 void MarkedSpace::clearMarks()
 {
     BlockIterator end = m_blocks.end();
-    for (BlockIterator it = m_blocks.begin(); it != end; ++it)
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it) {
         (*it)->clearMarks();
+#if ENABLE(GGC)
+        (*it)->clearCards();
+#endif
+    }
 }
 
-void MarkedSpace::sweep()
+#if ENABLE(GGC)
+template<typename Functor> inline void MarkedSpace::forEachNurseryBlock(SizeClass& sizeClass, Functor& functor)
+{
+    // Allocation goes through the blocks of a size class in order, so it
+    // used the blocks up to the one it allocates from.
+    for (MarkedBlock* block = sizeClass.blockList.head(); block; block = block->next()) {
+        functor(block);
+        if (block == sizeClass.nextBlock)
+            break;
+    }
+}
+
+template<typename Functor> inline void MarkedSpace::forEachNurseryBlock(Functor& functor)
+{
+    for (size_t cellSize = preciseStep; cellSize < preciseCutoff; cellSize += preciseStep)
+        forEachNurseryBlock(sizeClassFor(cellSize), functor);
+
+    for (size_t cellSize = impreciseStep; cellSize < impreciseCutoff; cellSize += impreciseStep)
+        forEachNurseryBlock(sizeClassFor(cellSize), functor);
+}
+
+struct ClearNewlyAllocatedMarks {
+    void operator()(MarkedBlock* block) { block->clearNewlyAllocatedMarks(); }
+};
+
+struct ClearNewlyAllocated {
+    void operator()(MarkedBlock* block) { block->clearNewlyAllocated(); }
+};
+
+void MarkedSpace::clearNewlyAllocatedMarks()
+{
+    ClearNewlyAllocatedMarks functor;
+    forEachNurseryBlock(functor);
+}
+
+struct VisitRememberedCell {
+    VisitRememberedCell(MarkStack& markStack)
+        : markStack(markStack)
+    {
+    }
+
+    void operator()(JSCell* cell) { markStack.appendChildren(cell); }
+
+    MarkStack& markStack;
+};
+
+void MarkedSpace::visitRememberedCells(MarkStack& markStack)
 {
+    // Only old cells are still marked
+    VisitRememberedCell functor(markStack);
     BlockIterator end = m_blocks.end();
     for (BlockIterator it = m_blocks.begin(); it != end; ++it)
-        (*it)->sweep();
+        (*it)->forEachRememberedCell(functor);
+}
+#endif
+
+void MarkedSpace::sweep()
+{
+    for (size_t i = 0; i < m_blocksToSweep.size(); ++i)
+        m_blocksToSweep[i]->sweep();
+    m_blocksToSweep.clear();
+}
+
+bool MarkedSpace::sweepNextBlock()
+{
+    if (m_blocksToSweep.isEmpty())
+        return false;
+
+    MarkedBlock* block = m_blocksToSweep.last();
+    m_blocksToSweep.removeLast();
+
+    if (!block->isEmpty())
+        block->sweep();
+    else {
+        // Nothing survived the collection or was allocated since, so give
+        // the block back. Destroying it finalizes its dead cells.
+        SizeClass& sizeClass = sizeClassFor(block->cellSize());
+        if (sizeClass.nextBlock == block)
+            sizeClass.nextBlock = block->next();
+        sizeClass.blockList.remove(block);
+        m_blocks.remove(block);
+        MarkedBlock::destroy(block);
+    }
+
+    return !m_blocksToSweep.isEmpty();
 }
 
 size_t MarkedSpace::objectCount() const
@@ -150,6 +238,12 @@ size_t MarkedSpace::capacity() const
 
 void MarkedSpace::reset()
 {
+#if ENABLE(GGC)
+    // The cells that survived the collection are old now
+    ClearNewlyAllocated clearNewlyAllocated;
+    forEachNurseryBlock(clearNewlyAllocated);
+#endif
+
     m_waterMark = 0;
 
     for (size_t cellSize = preciseStep; cellSize < preciseCutoff; cellSize += preciseStep)
@@ -158,9 +252,14 @@ void MarkedSpace::reset()
     for (size_t cellSize = impreciseStep; cellSize < impreciseCutoff; cellSize += impreciseStep)
         sizeClassFor(cellSize).reset();
 
+    m_blocksToSweep.clear();
+    m_blocksToSweep.reserveCapacity(m_blocks.size());
+
     BlockIterator end = m_blocks.end();
-    for (BlockIterator it = m_blocks.begin(); it != end; ++it)
+    for (BlockIterator it = m_blocks.begin(); it != end; ++it) {
         (*it)->reset();
+        m_blocksToSweep.append(*it);
+    }
 }
 
 } // namespace JSC
@@ -71,6 +71,20 @@ namespace JSC {
         void sweep();
         void shrink();
 
+        // After reset(), the blocks are swept lazily: allocation finalizes dead
+        // cells as it reuses them, and sweepNextBlock() sweeps one more block,
+        // freeing it if empty. Returns false once no block is left to sweep.
+        bool sweepNextBlock();
+        bool isSweeping() const { return !m_blocksToSweep.isEmpty(); }
+
+#if ENABLE(GGC)
+        // A minor collection only clears the marks of the cells allocated
+        // since the last collection, and marks from the roots and from the
+        // old cells written to since.
+        void clearNewlyAllocatedMarks();
+        void visitRememberedCells(MarkStack&);
+#endif
+
         size_t size() const;
         size_t capacity() const;
         size_t objectCount() const;
@@ -109,9 +123,16 @@ namespace JSC {
 
         void clearMarks(MarkedBlock*);
 
+#if ENABLE(GGC)
+        // The blocks allocated from since the last collection
+        template<typename Functor> void forEachNurseryBlock(Functor&);
+        template<typename Functor> void forEachNurseryBlock(SizeClass&, Functor&);
+#endif
+
         SizeClass m_preciseSizeClasses[preciseCount];
         SizeClass m_impreciseSizeClasses[impreciseCount];
         HashSet<MarkedBlock*> m_blocks;
+        Vector<MarkedBlock*> m_blocksToSweep;
         size_t m_waterMark;
         size_t m_highWaterMark;
         JSGlobalData* m_globalData;
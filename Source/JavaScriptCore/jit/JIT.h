@@ -38,6 +38,7 @@
 
 #define ASSERT_JIT_OFFSET(actual, expected) ASSERT_WITH_MESSAGE(actual == expected, "JIT Offset \"%s\" should be %d, not %d.\n", #expected, static_cast<int>(expected), static_cast<int>(actual));
 
+#include "AllocationSampler.h"
 #include "CodeBlock.h"
 #include "Interpreter.h"
 #include "JSInterfaceJIT.h"
@@ -194,6 +195,11 @@ namespace JSC {
             JIT jit(globalData, codeBlock);
             jit.privateCompileGetByIdSelfList(stubInfo, polymorphicStructures, currentIndex, structure, ident, slot, cachedOffset);
         }
+        static void compileGetByIdMegamorphic(JSGlobalData* globalData, CodeBlock* codeBlock, StructureStubInfo* stubInfo, const Identifier& ident, ReturnAddressPtr returnAddress)
+        {
+            JIT jit(globalData, codeBlock);
+            jit.privateCompileGetByIdMegamorphic(stubInfo, ident, returnAddress);
+        }
         static void compileGetByIdProtoList(JSGlobalData* globalData, CallFrame* callFrame, CodeBlock* codeBlock, StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructureList, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset)
         {
             JIT jit(globalData, codeBlock);
@@ -266,6 +272,7 @@ namespace JSC {
         JITCode privateCompile(CodePtr* functionEntryArityCheck);
         void privateCompileGetByIdProto(StructureStubInfo*, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
         void privateCompileGetByIdSelfList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, const Identifier&, const PropertySlot&, size_t cachedOffset);
+        void privateCompileGetByIdMegamorphic(StructureStubInfo*, const Identifier&, ReturnAddressPtr returnAddress);
         void privateCompileGetByIdProtoList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, Structure* prototypeStructure, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChainList(StructureStubInfo*, PolymorphicAccessStructureList*, int, Structure*, StructureChain* chain, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, CallFrame* callFrame);
         void privateCompileGetByIdChain(StructureStubInfo*, Structure*, StructureChain*, size_t count, const Identifier&, const PropertySlot&, size_t cachedOffset, ReturnAddressPtr returnAddress, CallFrame* callFrame);
@@ -919,6 +926,8 @@ namespace JSC {
         void linkSlowCaseIfNotJSCell(Vector<SlowCaseEntry>::iterator&, int vReg);
 
         Jump checkStructure(RegisterID reg, Structure* structure);
+        // Leaves in entry the address of the megamorphic cache entry for the Structure in structure and the property
+        void emitMegamorphicCacheEntry(RegisterID structure, RegisterID entry, const Identifier&);
 
         void restoreArgumentReference();
         void restoreArgumentReferenceForTrampoline();
@@ -933,6 +942,9 @@ namespace JSC {
         void emitLoadCharacterString(RegisterID src, RegisterID dst, JumpList& failures);
         
         void emitTimeoutCheck();
+
+        // Tells the allocation sampler, if any, which bytecode calls the next JIT stub
+        void emitAllocationSite(RegisterID scratch = regT0);
 #ifndef NDEBUG
         void printBytecodeOperandTypes(unsigned src1, unsigned src2);
 #endif
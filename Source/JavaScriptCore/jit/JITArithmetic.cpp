@@ -305,6 +305,7 @@ void JIT::emitSlow_op_jnless(Instruction* currentInstruction, Vector<SlowCaseEnt
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
         JITStubCall stubCall(this, cti_op_jless);
         stubCall.addArgument(op1, regT0);
         stubCall.addArgument(op2, regT1);
@@ -458,6 +459,7 @@ void JIT::emitSlow_op_jless(Instruction* currentInstruction, Vector<SlowCaseEntr
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
         JITStubCall stubCall(this, cti_op_jless);
         stubCall.addArgument(op1, regT0);
         stubCall.addArgument(op2, regT1);
@@ -612,6 +614,7 @@ void JIT::emitSlow_op_jlesseq(Instruction* currentInstruction, Vector<SlowCaseEn
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
         JITStubCall stubCall(this, cti_op_jlesseq);
         stubCall.addArgument(op1, regT0);
         stubCall.addArgument(op2, regT1);
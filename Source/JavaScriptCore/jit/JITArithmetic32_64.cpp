@@ -151,6 +151,7 @@ void JIT::emitSlow_op_jnless(Instruction* currentInstruction, Vector<SlowCaseEnt
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
     } else {
         if (!supportsFloatingPoint()) {
             if (!isOperandConstantImmediateInt(op1) && !isOperandConstantImmediateInt(op2))
@@ -239,6 +240,7 @@ void JIT::emitSlow_op_jless(Instruction* currentInstruction, Vector<SlowCaseEntr
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
     } else {
         if (!supportsFloatingPoint()) {
             if (!isOperandConstantImmediateInt(op1) && !isOperandConstantImmediateInt(op2))
@@ -326,6 +328,7 @@ void JIT::emitSlow_op_jlesseq(Instruction* currentInstruction, Vector<SlowCaseEn
         linkSlowCase(iter);
         linkSlowCase(iter);
         linkSlowCase(iter);
+        linkSlowCase(iter);
     } else {
         if (!supportsFloatingPoint()) {
             if (!isOperandConstantImmediateInt(op1) && !isOperandConstantImmediateInt(op2))
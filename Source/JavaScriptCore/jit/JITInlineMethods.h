@@ -88,7 +88,7 @@ ALWAYS_INLINE void JIT::emitLoadCharacterString(RegisterID src, RegisterID dst,
     failures.append(branchTest32(NonZero, Address(src, OBJECT_OFFSETOF(JSString, m_fiberCount))));
     failures.append(branch32(NotEqual, MacroAssembler::Address(src, ThunkHelpers::jsStringLengthOffset()), TrustedImm32(1)));
     loadPtr(MacroAssembler::Address(src, ThunkHelpers::jsStringValueOffset()), dst);
-    loadPtr(MacroAssembler::Address(dst, ThunkHelpers::stringImplDataOffset()), dst);
+    failures.append(emitLoadStringImplCharacters16(dst, dst));
     load16(MacroAssembler::Address(dst, 0), dst);
 }
 
@@ -256,11 +256,33 @@ ALWAYS_INLINE void JIT::restoreArgumentReferenceForTrampoline()
     // In the trampoline on x86-64, the first argument register is not overwritten.
 }
 
+ALWAYS_INLINE void JIT::emitAllocationSite(RegisterID scratch)
+{
+    AllocationSampler* allocationSampler = m_globalData->heap.allocationSampler();
+    if (!allocationSampler)
+        return;
+    storePtr(callFrameRegister, allocationSampler->addressOfStubCallFrame());
+    move(TrustedImmPtr(m_codeBlock), scratch);
+    storePtr(scratch, allocationSampler->addressOfStubCodeBlock());
+    store32(TrustedImm32(m_bytecodeOffset), allocationSampler->addressOfStubBytecodeOffset());
+}
+
 ALWAYS_INLINE JIT::Jump JIT::checkStructure(RegisterID reg, Structure* structure)
 {
     return branchPtr(NotEqual, Address(reg, JSCell::structureOffset()), TrustedImmPtr(structure));
 }
 
+ALWAYS_INLINE void JIT::emitMegamorphicCacheEntry(RegisterID structure, RegisterID entry, const Identifier& ident)
+{
+    // As MegamorphicCache::index(); on 64-bit, the 32-bit operations clear the upper half of entry
+    move(structure, entry);
+    urshift32(TrustedImm32(MegamorphicCache::structureShift), entry);
+    xor32(TrustedImm32(static_cast<int32_t>(ident.impl()->existingHash())), entry);
+    and32(TrustedImm32(MegamorphicCache::entryCount - 1), entry);
+    lshift32(TrustedImm32(MegamorphicCache::log2EntrySize), entry);
+    addPtr(TrustedImmPtr(m_globalData->jitStubs->megamorphicCache().entries()), entry);
+}
+
 ALWAYS_INLINE void JIT::linkSlowCaseIfNotJSCell(Vector<SlowCaseEntry>::iterator& iter, int vReg)
 {
     if (!m_codeBlock->isKnownNotImmediate(vReg))
@@ -665,6 +665,7 @@ void JIT::emit_op_put_global_var(Instruction* currentInstruction)
 
     emitLoad(value, regT1, regT0);
 
+    emitWriteBarrier(globalObject);
     loadPtr(&globalObject->m_registers, regT2);
     emitStore(index, regT1, regT0, regT2);
     map(m_bytecodeOffset + OPCODE_LENGTH(op_put_global_var), value, regT1, regT0);
@@ -703,8 +704,6 @@ void JIT::emit_op_put_scoped_var(Instruction* currentInstruction)
     int skip = currentInstruction[2].u.operand;
     int value = currentInstruction[3].u.operand;
 
-    emitLoad(value, regT1, regT0);
-
     emitGetFromCallFrameHeaderPtr(RegisterFile::ScopeChain, regT2);
     bool checkTopLevel = m_codeBlock->codeType() == FunctionCode && m_codeBlock->needsFullScopeChain();
     ASSERT(skip || !checkTopLevel);
@@ -719,8 +718,11 @@ void JIT::emit_op_put_scoped_var(Instruction* currentInstruction)
         loadPtr(Address(regT2, OBJECT_OFFSETOF(ScopeChainNode, next)), regT2);
 
     loadPtr(Address(regT2, OBJECT_OFFSETOF(ScopeChainNode, object)), regT2);
+    emitWriteBarrier(regT2, regT0, regT1);
+    unmap();
     loadPtr(Address(regT2, OBJECT_OFFSETOF(JSVariableObject, m_registers)), regT2);
 
+    emitLoad(value, regT1, regT0);
     emitStore(index, regT1, regT0, regT2);
     map(m_bytecodeOffset + OPCODE_LENGTH(op_put_scoped_var), value, regT1, regT0);
 }
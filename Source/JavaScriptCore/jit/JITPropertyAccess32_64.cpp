@@ -277,7 +277,7 @@ JIT::CodePtr JIT::stringGetByValStubGenerator(JSGlobalData* globalData, Executab
     // Load string length to regT1, and start the process of loading the data pointer into regT0
     jit.load32(Address(regT0, ThunkHelpers::jsStringLengthOffset()), regT1);
     jit.loadPtr(Address(regT0, ThunkHelpers::jsStringValueOffset()), regT0);
-    jit.loadPtr(Address(regT0, ThunkHelpers::stringImplDataOffset()), regT0);
+    failures.append(jit.emitLoadStringImplCharacters16(regT0, regT0));
     
     // Do an unsigned compare to simultaneously filter negative indices as well as indices that are too large
     failures.append(jit.branch32(AboveOrEqual, regT2, regT1));
@@ -364,6 +364,7 @@ void JIT::emit_op_put_by_val(Instruction* currentInstruction)
     addSlowCase(branchPtr(NotEqual, Address(regT0), TrustedImmPtr(m_globalData->jsArrayVPtr)));
     addSlowCase(branch32(AboveOrEqual, regT2, Address(regT0, JSArray::vectorLengthOffset())));
     
+    emitWriteBarrier(regT0, regT1, regT3);
     loadPtr(Address(regT0, JSArray::storageOffset()), regT3);
     
     Jump empty = branch32(Equal, BaseIndex(regT3, regT2, TimesEight, OBJECT_OFFSETOF(ArrayStorage, m_vector[0]) + OBJECT_OFFSETOF(JSValue, u.asBits.tag)), TrustedImm32(JSValue::EmptyValueTag));
@@ -465,12 +466,16 @@ void JIT::compileGetByIdSlowCase(int dst, int base, Identifier* ident, Vector<Sl
     linkSlowCaseIfNotJSCell(iter, base);
     linkSlowCase(iter);
     
+    // Outside of the sequence, as the distance to the call is fixed
+    emitAllocationSite(regT2);
+
     BEGIN_UNINTERRUPTED_SEQUENCE(sequenceGetByIdSlowCase);
     
 #ifndef NDEBUG
     Label coldPathBegin(this);
 #endif
     JITStubCall stubCall(this, isMethodCheck ? cti_op_get_by_id_method_check : cti_op_get_by_id);
+    stubCall.skipAllocationSite();
     stubCall.addArgument(regT1, regT0);
     stubCall.addArgument(TrustedImmPtr(ident));
     Call call = stubCall.call(dst);
@@ -493,10 +498,15 @@ void JIT::emit_op_put_by_id(Instruction* currentInstruction)
     int base = currentInstruction[1].u.operand;
     int value = currentInstruction[3].u.operand;
     
-    emitLoad2(base, regT1, regT0, value, regT3, regT2);
+    emitLoad(base, regT1, regT0);
     
     emitJumpSlowCaseIfNotJSCell(base, regT1);
     
+    // Outside the patched sequence; the slow case stores with a barrier of its own.
+    emitWriteBarrier(regT0, regT2, regT3);
+    unmap();
+    emitLoad(value, regT3, regT2);
+    
     BEGIN_UNINTERRUPTED_SEQUENCE(sequencePutById);
     
     Label hotPathBegin(this);
@@ -522,11 +532,15 @@ void JIT::emitSlow_op_put_by_id(Instruction* currentInstruction, Vector<SlowCase
 {
     int base = currentInstruction[1].u.operand;
     int ident = currentInstruction[2].u.operand;
+    int value = currentInstruction[3].u.operand;
     int direct = currentInstruction[8].u.operand;
 
     linkSlowCaseIfNotJSCell(iter, base);
     linkSlowCase(iter);
     
+    // The value is not loaded yet when the base is not a cell.
+    emitLoad(value, regT3, regT2);
+
     JITStubCall stubCall(this, direct ? cti_op_put_by_id_direct : cti_op_put_by_id);
     stubCall.addArgument(regT1, regT0);
     stubCall.addArgument(TrustedImmPtr(&(m_codeBlock->identifier(ident))));
@@ -620,7 +634,7 @@ void JIT::privateCompilePutByIdTransition(StructureStubInfo* stubInfo, Structure
         restoreReturnAddressBeforeReturn(regT3);
     }
 
-    storePtrWithWriteBarrier(TrustedImmPtr(newStructure), regT0, Address(regT0, JSCell::structureOffset()));
+    storePtrWithWriteBarrier(TrustedImmPtr(newStructure), regT0, Address(regT0, JSCell::structureOffset()), regT1, regT2);
     
 #if CPU(MIPS) || CPU(SH4)
     // For MIPS, we don't add sizeof(void*) to the stack offset.
@@ -871,6 +885,40 @@ void JIT::privateCompileGetByIdSelfList(StructureStubInfo* stubInfo, Polymorphic
     repatchBuffer.relink(jumpLocation, entryLabel);
 }
 
+void JIT::privateCompileGetByIdMegamorphic(StructureStubInfo* stubInfo, const Identifier& ident, ReturnAddressPtr returnAddress)
+{
+    // regT0 holds a JSCell*, and regT1 its tag, which the slow case expects unchanged
+    loadPtr(Address(regT0, JSCell::structureOffset()), regT3);
+    emitMegamorphicCacheEntry(regT3, regT2, ident);
+    Jump structureMiss = branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, structure)), regT3);
+    Jump propertyNameMiss = branchPtr(NotEqual, Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, propertyName)), TrustedImmPtr(ident.impl()));
+    add32(TrustedImm32(1), AbsoluteAddress(m_codeBlock->addressOfMegamorphicCacheHits()));
+    loadPtr(Address(regT2, OBJECT_OFFSETOF(MegamorphicCache::Entry, offset)), regT3);
+    move(regT0, regT2);
+    compileGetDirectOffset(regT2, regT1, regT0, regT3);
+    Jump success = jump();
+
+    LinkBuffer patchBuffer(this, m_codeBlock->executablePool(), 0);
+
+    // Misses go to the slow case, which fills the entry.
+    CodeLocationLabel slowCaseBegin = stubInfo->callReturnLocation.labelAtOffset(-patchOffsetGetByIdSlowCaseCall);
+    patchBuffer.link(structureMiss, slowCaseBegin);
+    patchBuffer.link(propertyNameMiss, slowCaseBegin);
+
+    // On success return back to the hot patch code, at a point it will perform the store to dest for us.
+    patchBuffer.link(success, stubInfo->hotPathBegin.labelAtOffset(patchOffsetGetByIdPutResult));
+
+    CodeLocationLabel entryLabel = patchBuffer.finalizeCodeAddendum();
+    stubInfo->initGetByIdMegamorphic();
+
+    // Finally patch the jump to slow case back in the hot path to jump here instead.
+    CodeLocationJump jumpLocation = stubInfo->hotPathBegin.jumpAtOffset(patchOffsetGetByIdBranchToSlowCase);
+    RepatchBuffer repatchBuffer(m_codeBlock);
+    repatchBuffer.relink(jumpLocation, entryLabel);
+
+    repatchBuffer.relinkCallerToFunction(returnAddress, FunctionPtr(cti_op_get_by_id_megamorphic));
+}
+
 void JIT::privateCompileGetByIdProtoList(StructureStubInfo* stubInfo, PolymorphicAccessStructureList* prototypeStructures, int currentIndex, Structure* structure, Structure* prototypeStructure, const Identifier& ident, const PropertySlot& slot, size_t cachedOffset, CallFrame* callFrame)
 {
     // regT0 holds a JSCell*
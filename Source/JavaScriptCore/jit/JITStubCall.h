@@ -39,6 +39,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Cell)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -47,6 +48,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Cell)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -55,6 +57,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(VoidPtr)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -63,6 +66,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Int)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -71,6 +75,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Int)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -79,6 +84,7 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Void)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 
@@ -88,10 +94,15 @@ namespace JSC {
             , m_stub(stub)
             , m_returnType(Value)
             , m_stackIndex(JITSTACKFRAME_ARGS_INDEX)
+            , m_emitsAllocationSite(true)
         {
         }
 #endif
 
+        // For calls at a fixed distance from the code before them, which
+        // then has to emit the allocation site itself.
+        void skipAllocationSite() { m_emitsAllocationSite = false; }
+
         // Arguments are added first to last.
 
         void skipArgument()
@@ -171,6 +182,9 @@ namespace JSC {
                 m_jit->sampleInstruction(m_jit->m_codeBlock->instructions().begin() + m_jit->m_bytecodeOffset, true);
 #endif
 
+            if (m_emitsAllocationSite)
+                m_jit->emitAllocationSite();
+
             m_jit->restoreArgumentReference();
             JIT::Call call = m_jit->call();
             m_jit->m_calls.append(CallRecord(call, m_jit->m_bytecodeOffset, m_stub.value()));
@@ -229,6 +243,7 @@ namespace JSC {
         FunctionPtr m_stub;
         enum { Void, VoidPtr, Int, Value, Cell } m_returnType;
         size_t m_stackIndex;
+        bool m_emitsAllocationSite;
     };
 }
 
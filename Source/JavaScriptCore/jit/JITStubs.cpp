@@ -1639,15 +1639,44 @@ DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_self_fail)
         if (listIndex < POLYMORPHIC_LIST_CACHE_SIZE) {
             stubInfo->u.getByIdSelfList.listSize++;
             JIT::compileGetByIdSelfList(callFrame->scopeChain()->globalData, codeBlock, stubInfo, polymorphicStructureList, listIndex, baseValue.asCell()->structure(), ident, slot, slot.cachedOffset());
-
-            if (listIndex == (POLYMORPHIC_LIST_CACHE_SIZE - 1))
-                ctiPatchCallByReturnAddress(codeBlock, STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
+        } else {
+            // The list is full, so from now on look the property up in the megamorphic cache.
+            JIT::compileGetByIdMegamorphic(callFrame->scopeChain()->globalData, codeBlock, stubInfo, ident, STUB_RETURN_ADDRESS);
+            MegamorphicCache& megamorphicCache = callFrame->globalData().jitStubs->megamorphicCache();
+            megamorphicCache.didGoMegamorphic(codeBlock);
+            codeBlock->didMissMegamorphicCache();
+            if (slot.isCacheableValue() && !baseValue.asCell()->structure()->isDictionary())
+                megamorphicCache.add(baseValue.asCell()->structure(), ident.impl(), slot.cachedOffset());
         }
     } else
         ctiPatchCallByReturnAddress(callFrame->codeBlock(), STUB_RETURN_ADDRESS, FunctionPtr(cti_op_get_by_id_generic));
     return JSValue::encode(result);
 }
 
+DEFINE_STUB_FUNCTION(EncodedJSValue, op_get_by_id_megamorphic)
+{
+    STUB_INIT_STACK_FRAME(stackFrame);
+
+    CallFrame* callFrame = stackFrame.callFrame;
+    Identifier& ident = stackFrame.args[1].identifier();
+
+    JSValue baseValue = stackFrame.args[0].jsValue();
+    PropertySlot slot(baseValue);
+    JSValue result = baseValue.get(callFrame, ident, slot);
+
+    CHECK_FOR_EXCEPTION();
+
+    // The JIT code found no entry in the megamorphic cache; fill it if the property is an own value.
+    callFrame->codeBlock()->didMissMegamorphicCache();
+    if (baseValue.isCell()
+        && slot.isCacheable()
+        && slot.isCacheableValue()
+        && !baseValue.asCell()->structure()->isDictionary()
+        && slot.slotBase() == baseValue)
+        callFrame->globalData().jitStubs->megamorphicCache().add(baseValue.asCell()->structure(), ident.impl(), slot.cachedOffset());
+    return JSValue::encode(result);
+}
+
 static PolymorphicAccessStructureList* getPolymorphicAccessStructureListSlot(JSGlobalData& globalData, ScriptExecutable* owner, StructureStubInfo* stubInfo, int& listIndex)
 {
     PolymorphicAccessStructureList* prototypeStructureList = 0;
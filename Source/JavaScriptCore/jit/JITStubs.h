@@ -32,6 +32,7 @@
 
 #include "CallData.h"
 #include "MacroAssemblerCodeRef.h"
+#include "MegamorphicCache.h"
 #include "Register.h"
 #include "ThunkGenerators.h"
 #include <wtf/HashMap.h>
@@ -301,6 +302,8 @@ namespace JSC {
 
         void clearHostFunctionStubs();
 
+        MegamorphicCache& megamorphicCache() { return m_megamorphicCache; }
+
     private:
         typedef HashMap<ThunkGenerator, MacroAssemblerCodePtr> CTIStubMap;
         CTIStubMap m_ctiStubMap;
@@ -309,6 +312,8 @@ namespace JSC {
         RefPtr<ExecutablePool> m_executablePool;
 
         TrampolineStructure m_trampolineStructure;
+
+        MegamorphicCache m_megamorphicCache;
     };
 
 extern "C" {
@@ -333,6 +338,7 @@ extern "C" {
     EncodedJSValue JIT_STUB cti_op_get_by_id_custom_stub(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_generic(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_getter_stub(STUB_ARGS_DECLARATION);
+    EncodedJSValue JIT_STUB cti_op_get_by_id_megamorphic(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_method_check(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_proto_fail(STUB_ARGS_DECLARATION);
     EncodedJSValue JIT_STUB cti_op_get_by_id_proto_list(STUB_ARGS_DECLARATION);
@@ -30,6 +30,7 @@
 #include "JITStubs.h"
 #include "JSValue.h"
 #include "MacroAssembler.h"
+#include "MarkedBlock.h"
 #include "RegisterFile.h"
 #include <wtf/AlwaysInline.h>
 #include <wtf/Vector.h>
@@ -193,8 +194,16 @@ namespace JSC {
         inline Jump emitLoadInt32(unsigned virtualRegisterIndex, RegisterID dst);
         inline Jump emitLoadDouble(unsigned virtualRegisterIndex, FPRegisterID dst, RegisterID scratch);
 
-        inline void storePtrWithWriteBarrier(TrustedImmPtr ptr, RegisterID /* owner */, Address dest)
+        // Loads the UChars of the StringImpl in string to dst, which may be the same register.
+        // An 8 bit string only has them once characters() has been called on it.
+        inline Jump emitLoadStringImplCharacters16(RegisterID string, RegisterID dst);
+
+        inline void emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2);
+        inline void emitWriteBarrier(JSCell* owner);
+
+        inline void storePtrWithWriteBarrier(TrustedImmPtr ptr, RegisterID owner, Address dest, RegisterID scratch1, RegisterID scratch2)
         {
+            emitWriteBarrier(owner, scratch1, scratch2);
             storePtr(ptr, dest);
         }
 
@@ -217,10 +226,24 @@ namespace JSC {
 
     struct ThunkHelpers {
         static unsigned stringImplDataOffset() { return StringImpl::dataOffset(); }
+        static unsigned stringImplCopyData16Offset() { return StringImpl::copyData16Offset(); }
+        static unsigned stringImplFlagsOffset() { return StringImpl::flagsOffset(); }
+        static unsigned stringImplIs8BitFlag() { return StringImpl::flagIs8Bit(); }
         static unsigned jsStringLengthOffset() { return OBJECT_OFFSETOF(JSString, m_length); }
         static unsigned jsStringValueOffset() { return OBJECT_OFFSETOF(JSString, m_value); }
     };
 
+    inline JSInterfaceJIT::Jump JSInterfaceJIT::emitLoadStringImplCharacters16(RegisterID string, RegisterID dst)
+    {
+        Jump is16Bit = branchTest32(Zero, Address(string, ThunkHelpers::stringImplFlagsOffset()), TrustedImm32(ThunkHelpers::stringImplIs8BitFlag()));
+        loadPtr(Address(string, ThunkHelpers::stringImplCopyData16Offset()), dst);
+        Jump loaded = jump();
+        is16Bit.link(this);
+        loadPtr(Address(string, ThunkHelpers::stringImplDataOffset()), dst);
+        loaded.link(this);
+        return branchTestPtr(Zero, dst);
+    }
+
 #if USE(JSVALUE32_64)
     inline JSInterfaceJIT::Jump JSInterfaceJIT::emitLoadJSCell(unsigned virtualRegisterIndex, RegisterID payload)
     {
@@ -347,6 +370,36 @@ namespace JSC {
         return Address(base, (static_cast<unsigned>(virtualRegisterIndex) * sizeof(Register)));
     }
 
+#if ENABLE(GGC)
+    // Dirties the card of a cell that is about to have a reference stored
+    // into it, like MarkedBlock::rememberCell. Clobbers both scratch registers.
+    inline void JSInterfaceJIT::emitWriteBarrier(RegisterID owner, RegisterID scratch1, RegisterID scratch2)
+    {
+        static const int32_t cardOffsetMask = (MarkedBlock::blockSize - 1) & ~((1 << MarkedBlock::cardShift) - 1);
+
+        move(owner, scratch1);
+        andPtr(TrustedImm32(static_cast<int32_t>(MarkedBlock::blockMask)), scratch1);
+        move(owner, scratch2);
+        andPtr(TrustedImm32(cardOffsetMask), scratch2);
+        urshift32(TrustedImm32(MarkedBlock::cardShift - 2), scratch2); // Cards are int32_t.
+        addPtr(scratch2, scratch1);
+        store32(TrustedImm32(1), Address(scratch1, MarkedBlock::offsetOfCards()));
+    }
+
+    inline void JSInterfaceJIT::emitWriteBarrier(JSCell* owner)
+    {
+        store32(TrustedImm32(1), MarkedBlock::blockFor(owner)->addressOfCardFor(owner));
+    }
+#else
+    inline void JSInterfaceJIT::emitWriteBarrier(RegisterID, RegisterID, RegisterID)
+    {
+    }
+
+    inline void JSInterfaceJIT::emitWriteBarrier(JSCell*)
+    {
+    }
+#endif
+
 }
 
 #endif // JSInterfaceJIT_h
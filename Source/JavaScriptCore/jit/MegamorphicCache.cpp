@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "MegamorphicCache.h"
+
+#if ENABLE(JIT)
+
+#include "CodeBlock.h"
+#include "Executable.h"
+#include <algorithm>
+#include <stdio.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/Vector.h>
+
+namespace JSC {
+
+COMPILE_ASSERT(sizeof(MegamorphicCache::Entry) == 1 << MegamorphicCache::log2EntrySize, MegamorphicCache_entry_size_is_a_power_of_two);
+
+// The code blocks printed by dump()
+static const size_t maxDumpedCodeBlocks = 50;
+
+MegamorphicCache::MegamorphicCache()
+    : m_entries(0)
+    , m_clearCount(0)
+{
+}
+
+MegamorphicCache::~MegamorphicCache()
+{
+    fastFree(m_entries);
+}
+
+MegamorphicCache::Entry* MegamorphicCache::entries()
+{
+    if (!m_entries)
+        m_entries = static_cast<Entry*>(fastZeroedMalloc(entryCount * sizeof(Entry)));
+    return m_entries;
+}
+
+void MegamorphicCache::clear()
+{
+    if (!m_entries)
+        return;
+    memset(m_entries, 0, entryCount * sizeof(Entry));
+    ++m_clearCount;
+}
+
+void MegamorphicCache::didGoMegamorphic(CodeBlock* codeBlock)
+{
+    m_codeBlocks.add(codeBlock);
+}
+
+void MegamorphicCache::codeBlockDestroyed(CodeBlock* codeBlock)
+{
+    HashSet<CodeBlock*>::iterator it = m_codeBlocks.find(codeBlock);
+    if (it == m_codeBlocks.end())
+        return;
+    addStatistics(codeBlock, m_destroyedCodeBlockStatistics);
+    m_codeBlocks.remove(it);
+}
+
+void MegamorphicCache::addStatistics(CodeBlock* codeBlock, StatisticsMap& statisticsMap) const
+{
+    ScriptExecutable* executable = codeBlock->ownerExecutable();
+    const SourceCode& source = executable->source();
+    std::pair<StatisticsMap::iterator, bool> result = statisticsMap.add(FunctionKey(source.provider(), source.startOffset()), Statistics());
+    Statistics& statistics = result.first->second;
+    if (result.second) {
+        statistics.provider = source.provider();
+        if (codeBlock->codeType() == GlobalCode)
+            statistics.functionName = "<global>";
+        else if (codeBlock->codeType() == EvalCode)
+            statistics.functionName = "<eval>";
+        else if (static_cast<FunctionExecutable*>(executable)->name().isEmpty())
+            statistics.functionName = "<anonymous>";
+        else
+            statistics.functionName = static_cast<FunctionExecutable*>(executable)->name().ustring();
+        statistics.line = executable->lineNo();
+    }
+    statistics.hits += codeBlock->megamorphicCacheHits();
+    statistics.misses += codeBlock->megamorphicCacheMisses();
+}
+
+static bool moreAccesses(const std::pair<size_t, const void*>& a, const std::pair<size_t, const void*>& b)
+{
+    return a.first > b.first;
+}
+
+void MegamorphicCache::dump() const
+{
+    StatisticsMap statisticsMap = m_destroyedCodeBlockStatistics;
+    HashSet<CodeBlock*>::const_iterator codeBlocksEnd = m_codeBlocks.end();
+    for (HashSet<CodeBlock*>::const_iterator it = m_codeBlocks.begin(); it != codeBlocksEnd; ++it)
+        addStatistics(*it, statisticsMap);
+
+    size_t hits = 0;
+    size_t misses = 0;
+    Vector<std::pair<size_t, const void*> > functions;
+    StatisticsMap::const_iterator end = statisticsMap.end();
+    for (StatisticsMap::const_iterator it = statisticsMap.begin(); it != end; ++it) {
+        functions.append(std::make_pair(it->second.hits + it->second.misses, &it->second));
+        hits += it->second.hits;
+        misses += it->second.misses;
+    }
+    std::sort(functions.begin(), functions.end(), moreAccesses);
+
+    printf("\nMegamorphic get_by_id: %lu hits, %lu misses, cache cleared %lu times\n",
+        static_cast<unsigned long>(hits), static_cast<unsigned long>(misses), static_cast<unsigned long>(m_clearCount));
+    if (!hits && !misses)
+        return;
+
+    printf("%10s %10s %7s  %s\n", "hits", "misses", "hit %", "function");
+    for (size_t i = 0; i < functions.size() && i < maxDumpedCodeBlocks; ++i) {
+        const Statistics& statistics = *static_cast<const Statistics*>(functions[i].second);
+        printf("%10lu %10lu %6.2f%%  %s %s:%d\n", static_cast<unsigned long>(statistics.hits), static_cast<unsigned long>(statistics.misses),
+            100.0 * statistics.hits / (statistics.hits + statistics.misses),
+            statistics.functionName.utf8().data(), statistics.provider->url().utf8().data(), statistics.line);
+    }
+    if (functions.size() > maxDumpedCodeBlocks)
+        printf("  ... %lu more functions\n", static_cast<unsigned long>(functions.size() - maxDumpedCodeBlocks));
+}
+
+} // namespace JSC
+
+#endif // ENABLE(JIT)
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MegamorphicCache_h
+#define MegamorphicCache_h
+
+#if ENABLE(JIT)
+
+#include "SourceProvider.h"
+#include "UString.h"
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/RefPtr.h>
+#include <wtf/text/StringImpl.h>
+
+namespace JSC {
+
+    class CodeBlock;
+    class Structure;
+
+    // Maps a Structure and a property name to the offset of the property in
+    // objects of that Structure, for the get_by_id that have seen more
+    // Structures than fit in their polymorphic list. The code the JIT compiles
+    // for those looks the property up here before calling the slow case,
+    // which fills the entry.
+    //
+    // Only own properties of non-dictionary Structures are entered; their
+    // offsets never change. Identifiers are compared by their StringImpl,
+    // which the Structure keeps alive. The cache is cleared by every
+    // collection, as a dead Structure's cell may be reused for another.
+    class MegamorphicCache {
+        WTF_MAKE_NONCOPYABLE(MegamorphicCache);
+    public:
+        struct Entry {
+            Structure* structure;
+            StringImpl* propertyName;
+            size_t offset;
+            size_t unused; // Pads the entry to a power of two
+        };
+
+        static const unsigned entryCount = 2048;
+        static const unsigned log2EntrySize = sizeof(void*) == 8 ? 5 : 4;
+        static const unsigned structureShift = 4; // Structure cells are larger than that
+
+        MegamorphicCache();
+        ~MegamorphicCache();
+
+        static unsigned index(Structure* structure, StringImpl* propertyName)
+        {
+            return ((static_cast<unsigned>(reinterpret_cast<uintptr_t>(structure)) >> structureShift) ^ propertyName->existingHash()) & (entryCount - 1);
+        }
+
+        // Allocated on first use, and never moved after, as JIT code holds its address
+        Entry* entries();
+
+        bool get(Structure* structure, StringImpl* propertyName, size_t& offset)
+        {
+            if (!m_entries)
+                return false;
+            Entry& entry = m_entries[index(structure, propertyName)];
+            if (entry.structure != structure || entry.propertyName != propertyName)
+                return false;
+            offset = entry.offset;
+            return true;
+        }
+
+        void add(Structure* structure, StringImpl* propertyName, size_t offset)
+        {
+            Entry& entry = entries()[index(structure, propertyName)];
+            entry.structure = structure;
+            entry.propertyName = propertyName;
+            entry.offset = offset;
+        }
+
+        void clear();
+
+        // Statistics, per code block with a megamorphic get_by_id
+        void didGoMegamorphic(CodeBlock*);
+        void codeBlockDestroyed(CodeBlock*);
+
+        // Prints the hit rates of the code blocks, the most accessed first
+        void dump() const;
+
+    private:
+        struct Statistics {
+            Statistics()
+                : line(0)
+                , hits(0)
+                , misses(0)
+            {
+            }
+
+            RefPtr<SourceProvider> provider; // Keeps the key alive
+            UString functionName;
+            int line;
+            size_t hits;
+            size_t misses;
+        };
+
+        // The source and the offset in it of the code block's function,
+        // which its later recompilations share
+        typedef std::pair<SourceProvider*, unsigned> FunctionKey;
+        typedef HashMap<FunctionKey, Statistics> StatisticsMap;
+
+        void addStatistics(CodeBlock*, StatisticsMap&) const;
+
+        Entry* m_entries;
+        size_t m_clearCount;
+        HashSet<CodeBlock*> m_codeBlocks;
+        StatisticsMap m_destroyedCodeBlockStatistics;
+    };
+
+} // namespace JSC
+
+#endif // ENABLE(JIT)
+
+#endif // MegamorphicCache_h
@@ -22,15 +22,20 @@
 
 #include "config.h"
 
+#include "AllocationSampler.h"
+#include "BackgroundParser.h"
 #include "BytecodeGenerator.h"
 #include "Completion.h"
 #include "CurrentTime.h"
 #include "ExceptionHelpers.h"
+#include "HeapSnapshot.h"
 #include "InitializeThreading.h"
 #include "JSArray.h"
 #include "JSFunction.h"
 #include "JSLock.h"
 #include "JSString.h"
+#include "Parser.h"
+#include "RegExpCache.h"
 #include "SamplingTool.h"
 #include <math.h>
 #include <stdio.h>
@@ -70,6 +75,8 @@ using namespace WTF;
 
 static void cleanupGlobalData(JSGlobalData*);
 static bool fillBufferWithContentsOfFile(const UString& fileName, Vector<char>& buffer);
+static bool readFunctionCache(const UString& fileName, Vector<char>& buffer);
+static void writeFunctionCache(const UString& fileName, const Vector<char>& buffer);
 
 static EncodedJSValue JSC_HOST_CALL functionPrint(ExecState*);
 static EncodedJSValue JSC_HOST_CALL functionDebug(ExecState*);
@@ -101,11 +108,23 @@ struct Options {
     Options()
         : interactive(false)
         , dump(false)
+        , dumpGCPauses(false)
+        , dumpHeapSnapshot(false)
+        , dumpMegamorphicCacheStatistics(false)
+        , dumpParserStatistics(false)
+        , dumpRegExpStatistics(false)
+        , parseInBackground(false)
     {
     }
 
     bool interactive;
     bool dump;
+    bool dumpGCPauses;
+    bool dumpHeapSnapshot;
+    bool dumpMegamorphicCacheStatistics;
+    bool dumpParserStatistics;
+    bool dumpRegExpStatistics;
+    bool parseInBackground;
     Vector<Script> scripts;
     Vector<UString> arguments;
 };
@@ -244,14 +263,28 @@ EncodedJSValue JSC_HOST_CALL functionCheckSyntax(ExecState* exec)
         return JSValue::encode(throwError(exec, createError(exec, "Could not open file.")));
 
     JSGlobalObject* globalObject = exec->lexicalGlobalObject();
+    SourceCode source = makeSource(script.data(), fileName);
+
+    // The optional second argument names a file that keeps the functions the
+    // parser cached between runs, like a browser's disk cache would.
+    UString functionCacheName = exec->argumentCount() > 1 ? exec->argument(1).toString(exec) : UString();
+    bool usedFunctionCache = false;
 
     StopWatch stopWatch;
     stopWatch.start();
-    Completion result = checkSyntax(globalObject->globalExec(), makeSource(script.data(), fileName));
+    Vector<char> functionCache;
+    if (!functionCacheName.isNull() && readFunctionCache(functionCacheName, functionCache))
+        usedFunctionCache = source.provider()->cache()->deserialize(&exec->globalData(), source.provider(), functionCache.data(), functionCache.size());
+    Completion result = checkSyntax(globalObject->globalExec(), source);
     stopWatch.stop();
 
     if (result.complType() == Throw)
         throwError(exec, result.value());
+    else if (!functionCacheName.isNull() && !usedFunctionCache) {
+        functionCache.clear();
+        source.provider()->cache()->serialize(source.provider(), functionCache);
+        writeFunctionCache(functionCacheName, functionCache);
+    }
     return JSValue::encode(jsNumber(stopWatch.getElapsedMS()));
 }
 
@@ -371,17 +404,34 @@ static void cleanupGlobalData(JSGlobalData* globalData)
     globalData->deref();
 }
 
-static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scripts, bool dump)
+static bool runWithScripts(GlobalObject* globalObject, const Options& options)
 {
+    const Vector<Script>& scripts = options.scripts;
     UString script;
     UString fileName;
     Vector<char> scriptBuffer;
 
-    if (dump)
+    if (options.dump)
         BytecodeGenerator::setDumpsGeneratedCode(true);
 
     JSGlobalData& globalData = globalObject->globalData();
 
+    // Every file goes to the background parser up front, so that it parses
+    // the later files while the earlier ones run
+    OwnPtr<BackgroundParser> backgroundParser;
+    Vector<RefPtr<BackgroundParseRequest> > backgroundParses;
+    if (options.parseInBackground) {
+        backgroundParser = adoptPtr(new BackgroundParser);
+        backgroundParses.resize(scripts.size());
+        for (size_t i = 0; i < scripts.size(); i++) {
+            if (!scripts[i].isFile || !fillBufferWithContentsOfFile(scripts[i].argument, scriptBuffer))
+                continue;
+            script = scriptBuffer.data();
+            backgroundParses[i] = backgroundParser->parse(script.characters(), script.length());
+        }
+    }
+    double backgroundParseWaitTime = 0;
+
 #if ENABLE(SAMPLING_FLAGS)
     SamplingFlags::start();
 #endif
@@ -398,11 +448,19 @@ static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scr
             fileName = "[Command Line]";
         }
 
+        SourceCode source = makeSource(script, fileName);
+        if (i < backgroundParses.size() && backgroundParses[i]) {
+            double startTime = currentTime();
+            backgroundParses[i]->waitUntilFinished();
+            backgroundParseWaitTime += currentTime() - startTime;
+            backgroundParses[i]->restore(&globalData, source.provider());
+        }
+
         globalData.startSampling();
 
-        Completion completion = evaluate(globalObject->globalExec(), globalObject->globalScopeChain(), makeSource(script, fileName));
+        Completion completion = evaluate(globalObject->globalExec(), globalObject->globalScopeChain(), source);
         success = success && completion.complType() != Throw;
-        if (dump) {
+        if (options.dump) {
             if (completion.complType() == Throw)
                 printf("Exception: %s\n", completion.value().toString(globalObject->globalExec()).utf8().data());
             else
@@ -413,6 +471,9 @@ static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scr
         globalObject->globalExec()->clearException();
     }
 
+    if (options.parseInBackground && options.dumpParserStatistics)
+        printf("\nWaited %.2fms for the background parser\n", backgroundParseWaitTime * 1000);
+
 #if ENABLE(SAMPLING_FLAGS)
     SamplingFlags::stop();
 #endif
@@ -431,6 +492,9 @@ static bool runWithScripts(GlobalObject* globalObject, const Vector<Script>& scr
 static void runInteractive(GlobalObject* globalObject)
 {
     while (true) {
+        // Waiting for input is idle time, finish sweeping
+        while (globalObject->globalData().heap.sweepIncrementally(0.01)) { }
+
 #if HAVE(READLINE) && !RUNNING_FROM_XCODE
         char* line = readline(interactivePrompt);
         if (!line)
@@ -470,8 +534,21 @@ static NO_RETURN void printUsageStatement(JSGlobalData* globalData, bool help =
     fprintf(stderr, "  -d         Dumps bytecode (debug builds only)\n");
     fprintf(stderr, "  -e         Evaluate argument as script code\n");
     fprintf(stderr, "  -f         Specifies a source file (deprecated)\n");
+    fprintf(stderr, "  -a         Samples the allocations every given number of bytes, and prints their sites on exit\n");
+    fprintf(stderr, "  -b         Parses the files on a background thread, ahead of running them\n");
+    fprintf(stderr, "  -c         Prints how much of the source was compiled, and how much only syntax checked, on exit\n");
+    fprintf(stderr, "  -g         Prints a histogram of the garbage collection pauses on exit\n");
     fprintf(stderr, "  -h|--help  Prints this help message\n");
     fprintf(stderr, "  -i         Enables interactive mode (default if no files are specified)\n");
+#if ENABLE(JIT)
+    fprintf(stderr, "  -j         Prints the hit rates of the megamorphic property access cache on exit\n");
+#endif
+    fprintf(stderr, "  -m         Marks the heap with the given number of threads (ENABLE(PARALLEL_GC) builds)\n");
+#if ENABLE(GGC)
+    fprintf(stderr, "  -n         Collects the heap generationally\n");
+#endif
+    fprintf(stderr, "  -p         Prints a snapshot of the live cells and their retainers on exit\n");
+    fprintf(stderr, "  -r         Prints the calls to each regular expression, and whether it was compiled, on exit\n");
 #if HAVE(SIGNAL_H)
     fprintf(stderr, "  -s         Installs signal handlers that exit on a crash (Unix platforms only)\n");
 #endif
@@ -497,6 +574,24 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
             options.scripts.append(Script(false, argv[i]));
             continue;
         }
+        if (!strcmp(arg, "-a")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->heap.setAllocationSamplingInterval(atoi(argv[i]));
+            continue;
+        }
+        if (!strcmp(arg, "-b")) {
+            options.parseInBackground = true;
+            continue;
+        }
+        if (!strcmp(arg, "-c")) {
+            options.dumpParserStatistics = true;
+            continue;
+        }
+        if (!strcmp(arg, "-g")) {
+            options.dumpGCPauses = true;
+            continue;
+        }
         if (!strcmp(arg, "-i")) {
             options.interactive = true;
             continue;
@@ -505,6 +600,33 @@ static void parseArguments(int argc, char** argv, Options& options, JSGlobalData
             options.dump = true;
             continue;
         }
+#if ENABLE(JIT)
+        if (!strcmp(arg, "-j")) {
+            options.dumpMegamorphicCacheStatistics = true;
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "-m")) {
+            if (++i == argc)
+                printUsageStatement(globalData);
+            globalData->heap.setMarkerCount(atoi(argv[i]));
+            continue;
+        }
+#if ENABLE(GGC)
+        if (!strcmp(arg, "-n")) {
+            globalData->heap.setGenerational(true);
+            continue;
+        }
+#endif
+        if (!strcmp(arg, "-p")) {
+            options.dumpHeapSnapshot = true;
+            continue;
+        }
+        if (!strcmp(arg, "-r")) {
+            options.dumpRegExpStatistics = true;
+            globalData->regExpCache()->setCollectsStatistics();
+            continue;
+        }
         if (!strcmp(arg, "-s")) {
 #if HAVE(SIGNAL_H)
             signal(SIGILL, _exit);
@@ -538,10 +660,25 @@ int jscmain(int argc, char** argv, JSGlobalData* globalData)
     parseArguments(argc, argv, options, globalData);
 
     GlobalObject* globalObject = new (globalData) GlobalObject(*globalData, options.arguments);
-    bool success = runWithScripts(globalObject, options.scripts, options.dump);
+    bool success = runWithScripts(globalObject, options);
     if (options.interactive && success)
         runInteractive(globalObject);
 
+    if (options.dumpParserStatistics)
+        globalData->parser->dumpStatistics();
+    if (options.dumpGCPauses)
+        globalData->heap.dumpPauseHistogram();
+    if (AllocationSampler* allocationSampler = globalData->heap.allocationSampler())
+        allocationSampler->dump();
+    if (options.dumpHeapSnapshot)
+        HeapSnapshot(globalData->heap).dump();
+    if (options.dumpRegExpStatistics)
+        globalData->regExpCache()->dumpStatistics();
+#if ENABLE(JIT)
+    if (options.dumpMegamorphicCacheStatistics)
+        globalData->jitStubs->megamorphicCache().dump();
+#endif
+
     return success ? 0 : 3;
 }
 
@@ -573,3 +710,28 @@ static bool fillBufferWithContentsOfFile(const UString& fileName, Vector<char>&
 
     return true;
 }
+
+static bool readFunctionCache(const UString& fileName, Vector<char>& buffer)
+{
+    FILE* f = fopen(fileName.utf8().data(), "rb");
+    if (!f)
+        return false;
+
+    char chunk[4096];
+    while (size_t size = fread(chunk, 1, sizeof(chunk), f))
+        buffer.append(chunk, size);
+    bool success = !ferror(f);
+    fclose(f);
+    return success;
+}
+
+static void writeFunctionCache(const UString& fileName, const Vector<char>& buffer)
+{
+    FILE* f = fopen(fileName.utf8().data(), "wb");
+    if (!f) {
+        fprintf(stderr, "Could not open file: %s\n", fileName.utf8().data());
+        return;
+    }
+    fwrite(buffer.data(), 1, buffer.size(), f);
+    fclose(f);
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "BackgroundParser.h"
+
+#include "Completion.h"
+#include "JSGlobalData.h"
+#include "JSGlobalObject.h"
+#include "JSLock.h"
+#include "SourceCode.h"
+#include "Strong.h"
+#include <wtf/CurrentTime.h>
+
+namespace JSC {
+
+BackgroundParseRequest::BackgroundParseRequest(const UChar* characters, unsigned length)
+    : m_succeeded(false)
+    , m_parseTime(0)
+    , m_isFinished(false)
+{
+    m_source.append(characters, length);
+}
+
+bool BackgroundParseRequest::isFinished() const
+{
+    MutexLocker locker(m_lock);
+    return m_isFinished;
+}
+
+void BackgroundParseRequest::waitUntilFinished()
+{
+    MutexLocker locker(m_lock);
+    while (!m_isFinished)
+        m_finishedCondition.wait(m_lock);
+}
+
+bool BackgroundParseRequest::restore(JSGlobalData* globalData, SourceProvider* provider)
+{
+    if (!isFinished() || !m_succeeded)
+        return false;
+    return provider->cache()->deserialize(globalData, provider, m_functionCache.data(), m_functionCache.size());
+}
+
+void BackgroundParseRequest::finish(bool succeeded, double parseTime)
+{
+    MutexLocker locker(m_lock);
+    m_succeeded = succeeded;
+    m_parseTime = parseTime;
+    m_isFinished = true;
+    m_finishedCondition.broadcast();
+}
+
+BackgroundParser::BackgroundParser()
+    : m_parsingThread(0)
+    , m_shouldExit(false)
+{
+}
+
+BackgroundParser::~BackgroundParser()
+{
+    if (!m_parsingThread)
+        return;
+    {
+        MutexLocker locker(m_lock);
+        m_shouldExit = true;
+        m_requestCondition.signal();
+    }
+    waitForThreadCompletion(m_parsingThread, 0);
+}
+
+PassRefPtr<BackgroundParseRequest> BackgroundParser::parse(const UChar* characters, unsigned length)
+{
+    RefPtr<BackgroundParseRequest> request = adoptRef(new BackgroundParseRequest(characters, length));
+
+    MutexLocker locker(m_lock);
+    if (!m_parsingThread) {
+        m_parsingThread = createThread(parsingThreadStartFunc, this, "JavaScriptCore::BackgroundParser");
+        // Without the thread, the request is never finished and the source
+        // is parsed when it runs
+        if (!m_parsingThread)
+            return request.release();
+    }
+    m_requests.append(request);
+    m_requestCondition.signal();
+    return request.release();
+}
+
+void* BackgroundParser::parsingThreadStartFunc(void* parser)
+{
+    static_cast<BackgroundParser*>(parser)->parseRequests();
+    return 0;
+}
+
+void BackgroundParser::parseRequests()
+{
+    RefPtr<JSGlobalData> globalData = JSGlobalData::create(ThreadStackTypeSmall);
+    {
+        JSLock lock(SilenceAssertionsOnly);
+        Strong<JSGlobalObject> globalObject(*globalData, new (globalData.get()) JSGlobalObject(*globalData));
+
+        while (true) {
+            RefPtr<BackgroundParseRequest> request;
+            {
+                MutexLocker locker(m_lock);
+                while (m_requests.isEmpty() && !m_shouldExit)
+                    m_requestCondition.wait(m_lock);
+                if (m_shouldExit)
+                    break;
+                request = m_requests.takeFirst();
+            }
+
+            // Only this thread uses the copy of the source, which keeps it
+            // from the thread that made the request
+            double startTime = currentTime();
+            SourceCode source = makeSource(UString(request->m_source.data(), request->m_source.size()));
+            Completion completion = checkSyntax(globalObject->globalExec(), source);
+            bool succeeded = completion.complType() != Throw;
+            if (succeeded)
+                source.provider()->cache()->serialize(source.provider(), request->m_functionCache);
+            globalObject->globalExec()->clearException();
+            request->finish(succeeded, currentTime() - startTime);
+        }
+
+        globalObject.clear();
+        globalData->clearBuiltinStructures();
+        globalData->heap.destroy();
+    }
+}
+
+} // namespace JSC
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BackgroundParser_h
+#define BackgroundParser_h
+
+#include <wtf/Deque.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/PassRefPtr.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/unicode/Unicode.h>
+
+namespace JSC {
+
+    class JSGlobalData;
+    class SourceProvider;
+
+    // A source waiting for, or done with, the background parser. Only the
+    // thread that made the request may restore it.
+    class BackgroundParseRequest : public ThreadSafeRefCounted<BackgroundParseRequest> {
+    public:
+        bool isFinished() const;
+        void waitUntilFinished();
+
+        // Reads the functions the background parser cached into the cache of
+        // a provider of the same source. Returns false if the source did not
+        // parse, or the request is not finished.
+        bool restore(JSGlobalData*, SourceProvider*);
+
+        // The seconds the source took to parse on the background thread
+        double parseTime() const { return m_parseTime; }
+
+    private:
+        friend class BackgroundParser;
+
+        BackgroundParseRequest(const UChar* characters, unsigned length);
+
+        void finish(bool succeeded, double parseTime);
+
+        Vector<UChar> m_source;
+        Vector<char> m_functionCache;
+        bool m_succeeded;
+        double m_parseTime;
+
+        mutable Mutex m_lock;
+        ThreadCondition m_finishedCondition;
+        bool m_isFinished;
+    };
+
+    // Syntax checks sources on a thread of its own, with a JSGlobalData of its
+    // own. The functions that its parser caches are handed back serialized,
+    // for the thread that runs the source to read into its SourceProviderCache,
+    // so that parsing the source there skips their bodies.
+    class BackgroundParser {
+        WTF_MAKE_NONCOPYABLE(BackgroundParser); WTF_MAKE_FAST_ALLOCATED;
+    public:
+        BackgroundParser();
+        ~BackgroundParser(); // Waits for the source being parsed, if any
+
+        // The source is copied
+        PassRefPtr<BackgroundParseRequest> parse(const UChar* characters, unsigned length);
+
+    private:
+        static void* parsingThreadStartFunc(void*);
+        void parseRequests();
+
+        ThreadIdentifier m_parsingThread;
+        Mutex m_lock;
+        ThreadCondition m_requestCondition;
+        Deque<RefPtr<BackgroundParseRequest> > m_requests;
+        bool m_shouldExit;
+    };
+
+} // namespace JSC
+
+#endif // BackgroundParser_h
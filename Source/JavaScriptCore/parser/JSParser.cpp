@@ -1323,6 +1323,8 @@ template <JSParser::FunctionRequirements requirements, bool nameIsInContainingSc
         m_lexer->setOffset(m_token.m_info.endOffset);
         m_lexer->setLineNumber(m_token.m_info.line);
 
+        if (TreeBuilder::CreatesAST)
+            m_globalData->parser->statistics().skippedBytes += closeBracePos + 1 - openBracePos;
         next();
         return true;
     }
@@ -1350,6 +1352,10 @@ template <JSParser::FunctionRequirements requirements, bool nameIsInContainingSc
     failIfFalse(popScope(functionScope, TreeBuilder::NeedsFreeVariableInfo));
     matchOrFail(CLOSEBRACE);
 
+    // The bodies of nested functions were syntax checked with their parent
+    if (TreeBuilder::CreatesAST)
+        m_globalData->parser->statistics().syntaxCheckedBytes += closeBracePos + 1 - openBracePos;
+
     if (newInfo) {
         unsigned approximateByteSize = newInfo->approximateByteSize();
         m_functionCache->add(openBracePos, newInfo.release(), approximateByteSize);
@@ -26,6 +26,8 @@
 #include "Debugger.h"
 #include "JSParser.h"
 #include "Lexer.h"
+#include <stdio.h>
+#include <wtf/CurrentTime.h>
 
 #ifdef ANDROID_INSTRUMENT
 #include "TimeCounter.h"
@@ -54,8 +56,11 @@ void Parser::parse(JSGlobalData* globalData, FunctionParameters* parameters, JSP
 
     Lexer& lexer = *globalData->lexer;
     lexer.setCode(*m_source, m_arena);
+    m_statistics.parsedBytes += m_source->length();
 
+    double startTime = currentTime();
     const char* parseError = jsParse(globalData, parameters, strictness, mode, m_source);
+    m_statistics.parseTime += currentTime() - startTime;
     int lineNumber = lexer.lineNumber();
     bool lexError = lexer.sawError();
     lexer.clear();
@@ -82,4 +87,17 @@ void Parser::didFinishParsing(SourceElements* sourceElements, ParserArenaData<De
     m_numConstants = numConstants;
 }
 
+static double percentOf(size_t bytes, size_t total)
+{
+    return total ? 100.0 * bytes / total : 0;
+}
+
+void Parser::dumpStatistics() const
+{
+    printf("\nParsed %lu bytes of source in %.2fms\n", static_cast<unsigned long>(m_statistics.parsedBytes), m_statistics.parseTime * 1000);
+    printf("%10lu bytes compiled (%.1f%%)\n", static_cast<unsigned long>(m_statistics.compiledBytes()), percentOf(m_statistics.compiledBytes(), m_statistics.parsedBytes));
+    printf("%10lu bytes of function bodies only syntax checked (%.1f%%)\n", static_cast<unsigned long>(m_statistics.syntaxCheckedBytes), percentOf(m_statistics.syntaxCheckedBytes, m_statistics.parsedBytes));
+    printf("%10lu bytes of function bodies skipped with the function cache (%.1f%%)\n", static_cast<unsigned long>(m_statistics.skippedBytes), percentOf(m_statistics.skippedBytes, m_statistics.parsedBytes));
+}
+
 } // namespace JSC
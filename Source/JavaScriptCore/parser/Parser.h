@@ -45,6 +45,27 @@ namespace JSC {
 
     template <typename T> struct ParserArenaData : ParserArenaDeletable { T data; };
 
+    // The bytes of source handed to the parser, and how many of them were
+    // in function bodies that it only syntax checked, to be parsed again when
+    // the function is first called, or skipped with the SourceProviderCache.
+    // The rest was parsed into syntax trees and compiled.
+    struct ParserStatistics {
+        ParserStatistics()
+            : parsedBytes(0)
+            , syntaxCheckedBytes(0)
+            , skippedBytes(0)
+            , parseTime(0)
+        {
+        }
+
+        size_t compiledBytes() const { return parsedBytes - syntaxCheckedBytes - skippedBytes; }
+
+        size_t parsedBytes;
+        size_t syntaxCheckedBytes;
+        size_t skippedBytes;
+        double parseTime; // In seconds
+    };
+
     class Parser {
         WTF_MAKE_NONCOPYABLE(Parser); WTF_MAKE_FAST_ALLOCATED;
     public:
@@ -58,6 +79,9 @@ namespace JSC {
 
         ParserArena& arena() { return m_arena; }
 
+        ParserStatistics& statistics() { return m_statistics; }
+        void dumpStatistics() const;
+
     private:
         void parse(JSGlobalData*, FunctionParameters*, JSParserStrictness strictness, JSParserMode mode, int* errLine, UString* errMsg);
 
@@ -74,6 +98,7 @@ namespace JSC {
         CodeFeatures m_features;
         int m_lastLine;
         int m_numConstants;
+        ParserStatistics m_statistics;
     };
 
     template <class ParsedNode>
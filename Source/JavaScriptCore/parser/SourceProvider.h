@@ -93,10 +93,21 @@ namespace JSC {
     private:
         UStringSourceProvider(const UString& source, const UString& url)
             : SourceProvider(url)
-            , m_source(source)
+            , m_source(source.is8Bit() ? copyTo16Bit(source) : source)
         {
         }
 
+        // The lexer reads UChars, so take a 16 bit copy of an 8 bit source up front
+        // rather than asking the caller's string for characters(), which would keep
+        // both buffers alive for as long as that string is.
+        static UString copyTo16Bit(const UString& source)
+        {
+            UChar* data;
+            RefPtr<StringImpl> impl = StringImpl::createUninitialized(source.length(), data);
+            StringImpl::copyChars(data, source.characters8(), source.length());
+            return impl.release();
+        }
+
         UString m_source;
     };
     
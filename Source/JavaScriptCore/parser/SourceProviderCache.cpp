@@ -26,10 +26,79 @@
 #include "config.h"
 #include "SourceProviderCache.h"
 
+#include "Identifier.h"
+#include "SourceProvider.h"
 #include "SourceProviderCacheItem.h"
+#include <wtf/StringHasher.h>
 
 namespace JSC {
 
+// Changes whenever the serialized format does
+static const uint32_t serializedFormatVersion = 1;
+
+static uint32_t sourceHash(SourceProvider* provider)
+{
+    return StringHasher::computeHash<UChar>(provider->data(), provider->length());
+}
+
+template <typename T> static void append(Vector<char>& data, T value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendIdentifiers(Vector<char>& data, const Vector<RefPtr<StringImpl> >& identifiers)
+{
+    append<uint32_t>(data, identifiers.size());
+    for (size_t i = 0; i < identifiers.size(); ++i) {
+        append<uint32_t>(data, identifiers[i]->length());
+        data.append(reinterpret_cast<const char*>(identifiers[i]->characters()), identifiers[i]->length() * sizeof(UChar));
+    }
+}
+
+// Reads serialized data, failing past its end
+class SerializedDataReader {
+public:
+    SerializedDataReader(const char* data, size_t size)
+        : m_position(data)
+        , m_end(data + size)
+    {
+    }
+
+    bool atEnd() const { return m_position == m_end; }
+
+    template <typename T> bool read(T& value)
+    {
+        if (static_cast<size_t>(m_end - m_position) < sizeof(value))
+            return false;
+        memcpy(&value, m_position, sizeof(value));
+        m_position += sizeof(value);
+        return true;
+    }
+
+    bool readIdentifiers(JSGlobalData* globalData, Vector<RefPtr<StringImpl> >& identifiers)
+    {
+        uint32_t count;
+        if (!read(count))
+            return false;
+        Vector<UChar, 32> characters;
+        for (uint32_t i = 0; i < count; ++i) {
+            uint32_t length;
+            if (!read(length) || !length || static_cast<size_t>(m_end - m_position) / sizeof(UChar) < length)
+                return false;
+            characters.resize(length);
+            memcpy(characters.data(), m_position, length * sizeof(UChar));
+            m_position += length * sizeof(UChar);
+            identifiers.append(Identifier(globalData, characters.data(), length).impl());
+        }
+        identifiers.shrinkToFit();
+        return true;
+    }
+
+private:
+    const char* m_position;
+    const char* m_end;
+};
+
 SourceProviderCache::~SourceProviderCache()
 {
     clear();
@@ -53,4 +122,84 @@ void SourceProviderCache::add(int sourcePosition, PassOwnPtr<SourceProviderCache
     m_contentByteSize += size;
 }
 
+void SourceProviderCache::serialize(SourceProvider* provider, Vector<char>& data) const
+{
+    append<uint32_t>(data, serializedFormatVersion);
+    append<uint32_t>(data, provider->length());
+    append<uint32_t>(data, sourceHash(provider));
+    append<uint32_t>(data, m_map.size());
+
+    HashMap<int, SourceProviderCacheItem*>::const_iterator end = m_map.end();
+    for (HashMap<int, SourceProviderCacheItem*>::const_iterator it = m_map.begin(); it != end; ++it) {
+        const SourceProviderCacheItem* item = it->second;
+        append<int32_t>(data, it->first);
+        append<int32_t>(data, item->closeBraceLine);
+        append<int32_t>(data, item->closeBracePos);
+        append<uint8_t>(data, item->usesEval);
+        appendIdentifiers(data, item->usedVariables);
+        appendIdentifiers(data, item->writtenVariables);
+    }
+}
+
+typedef Vector<std::pair<int, SourceProviderCacheItem*> > DeserializedItems;
+
+static bool deserializeItems(JSGlobalData* globalData, SourceProvider* provider, SerializedDataReader& reader, DeserializedItems& items)
+{
+    uint32_t version;
+    uint32_t length;
+    uint32_t hash;
+    uint32_t count;
+    if (!reader.read(version) || version != serializedFormatVersion)
+        return false;
+    if (!reader.read(length) || length != static_cast<uint32_t>(provider->length()))
+        return false;
+    if (!reader.read(hash) || hash != sourceHash(provider))
+        return false;
+    if (!reader.read(count))
+        return false;
+
+    const UChar* source = provider->data();
+    for (uint32_t i = 0; i < count; ++i) {
+        int32_t openBracePos;
+        int32_t closeBraceLine;
+        int32_t closeBracePos;
+        uint8_t usesEval;
+        if (!reader.read(openBracePos) || !reader.read(closeBraceLine) || !reader.read(closeBracePos) || !reader.read(usesEval))
+            return false;
+        if (openBracePos < 0 || closeBracePos <= openBracePos || static_cast<uint32_t>(closeBracePos) >= length)
+            return false;
+        if (source[openBracePos] != '{' || source[closeBracePos] != '}')
+            return false;
+
+        SourceProviderCacheItem* item = new SourceProviderCacheItem(closeBraceLine, closeBracePos);
+        items.append(std::make_pair(openBracePos, item));
+        item->usesEval = usesEval;
+        if (!reader.readIdentifiers(globalData, item->usedVariables) || !reader.readIdentifiers(globalData, item->writtenVariables))
+            return false;
+    }
+    return reader.atEnd();
+}
+
+bool SourceProviderCache::deserialize(JSGlobalData* globalData, SourceProvider* provider, const char* data, size_t size)
+{
+    // Nothing is added unless all of the data is sound, since the parser
+    // trusts the cached functions to be where they say.
+    SerializedDataReader reader(data, size);
+    DeserializedItems items;
+    if (!deserializeItems(globalData, provider, reader, items)) {
+        for (size_t i = 0; i < items.size(); ++i)
+            delete items[i].second;
+        return false;
+    }
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (m_map.contains(items[i].first)) {
+            delete items[i].second;
+            continue;
+        }
+        add(items[i].first, adoptPtr(items[i].second), items[i].second->approximateByteSize());
+    }
+    return true;
+}
+
 }
@@ -23,11 +23,17 @@
  * THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#ifndef SourceProviderCache_h
+#define SourceProviderCache_h
+
 #include <wtf/HashMap.h>
 #include <wtf/PassOwnPtr.h>
+#include <wtf/Vector.h>
 
 namespace JSC {
 
+class JSGlobalData;
+class SourceProvider;
 class SourceProviderCacheItem;
 
 class SourceProviderCache {
@@ -39,6 +45,13 @@ public:
     unsigned byteSize() const;
     void add(int sourcePosition, PassOwnPtr<SourceProviderCacheItem>, unsigned size);
     const SourceProviderCacheItem* get(int sourcePosition) const { return m_map.get(sourcePosition); }
+    bool isEmpty() const { return m_map.isEmpty(); }
+
+    // Serialized, the cache outlives its source provider, e.g. in a disk cache,
+    // so that parsing the same source again skips the cached functions from
+    // the start. The data is only read back for a source with the same content.
+    void serialize(SourceProvider*, Vector<char>&) const;
+    bool deserialize(JSGlobalData*, SourceProvider*, const char* data, size_t);
 
 private:
     HashMap<int, SourceProviderCacheItem*> m_map;
@@ -46,3 +59,5 @@ private:
 };
 
 }
+
+#endif // SourceProviderCache_h
@@ -46,23 +46,36 @@ namespace JSC {
 
 struct DefaultGCActivityCallbackPlatformData {
     static void trigger(CFRunLoopTimerRef, void *info);
+    static void sweep(CFRunLoopTimerRef, void *info);
 
     RetainPtr<CFRunLoopTimerRef> timer;
+    RetainPtr<CFRunLoopTimerRef> sweepTimer;
     RetainPtr<CFRunLoopRef> runLoop;
     CFRunLoopTimerContext context;
 };
 
 const CFTimeInterval decade = 60 * 60 * 24 * 365 * 10;
 const CFTimeInterval triggerInterval = 2; // seconds
+const CFTimeInterval sweepInterval = 0.1; // seconds
+const double sweepTimeSlice = 0.01; // seconds
 
 void DefaultGCActivityCallbackPlatformData::trigger(CFRunLoopTimerRef timer, void *info)
 {
     Heap* heap = static_cast<Heap*>(info);
     APIEntryShim shim(heap->globalData());
-    heap->collectAllGarbage();
+    // The sweep timer picks up the sweeping
+    heap->collect(Heap::DoNotSweep);
     CFRunLoopTimerSetNextFireDate(timer, CFAbsoluteTimeGetCurrent() + decade);
 }
 
+void DefaultGCActivityCallbackPlatformData::sweep(CFRunLoopTimerRef timer, void *info)
+{
+    Heap* heap = static_cast<Heap*>(info);
+    APIEntryShim shim(heap->globalData());
+    bool isDone = !heap->sweepIncrementally(sweepTimeSlice);
+    CFRunLoopTimerSetNextFireDate(timer, CFAbsoluteTimeGetCurrent() + (isDone ? decade : sweepInterval));
+}
+
 DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap)
 {
     commonConstructor(heap, CFRunLoopGetCurrent());
@@ -76,10 +89,13 @@ DefaultGCActivityCallback::DefaultGCActivityCallback(Heap* heap, CFRunLoopRef ru
 DefaultGCActivityCallback::~DefaultGCActivityCallback()
 {
     CFRunLoopRemoveTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopRemoveTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
     CFRunLoopTimerInvalidate(d->timer.get());
+    CFRunLoopTimerInvalidate(d->sweepTimer.get());
     d->context.info = 0;
     d->runLoop = 0;
     d->timer = 0;
+    d->sweepTimer = 0;
 }
 
 void DefaultGCActivityCallback::commonConstructor(Heap* heap, CFRunLoopRef runLoop)
@@ -91,11 +107,17 @@ void DefaultGCActivityCallback::commonConstructor(Heap* heap, CFRunLoopRef runLo
     d->runLoop = runLoop;
     d->timer.adoptCF(CFRunLoopTimerCreate(0, decade, decade, 0, 0, DefaultGCActivityCallbackPlatformData::trigger, &d->context));
     CFRunLoopAddTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    d->sweepTimer.adoptCF(CFRunLoopTimerCreate(0, decade, decade, 0, 0, DefaultGCActivityCallbackPlatformData::sweep, &d->context));
+    CFRunLoopAddTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
 }
 
 void DefaultGCActivityCallback::operator()()
 {
     CFRunLoopTimerSetNextFireDate(d->timer.get(), CFAbsoluteTimeGetCurrent() + triggerInterval);
+
+    Heap* heap = static_cast<Heap*>(d->context.info);
+    if (heap->isSweeping())
+        CFRunLoopTimerSetNextFireDate(d->sweepTimer.get(), CFAbsoluteTimeGetCurrent() + sweepInterval);
 }
 
 void DefaultGCActivityCallback::synchronize()
@@ -103,8 +125,10 @@ void DefaultGCActivityCallback::synchronize()
     if (CFRunLoopGetCurrent() == d->runLoop.get())
         return;
     CFRunLoopRemoveTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopRemoveTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
     d->runLoop = CFRunLoopGetCurrent();
     CFRunLoopAddTimer(d->runLoop.get(), d->timer.get(), kCFRunLoopCommonModes);
+    CFRunLoopAddTimer(d->runLoop.get(), d->sweepTimer.get(), kCFRunLoopCommonModes);
 }
 
 }
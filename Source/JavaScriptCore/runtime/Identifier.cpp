@@ -70,6 +70,14 @@ void deleteIdentifierTable(IdentifierTable* table)
 bool Identifier::equal(const StringImpl* r, const char* s)
 {
     int length = r->length();
+    if (r->is8Bit()) {
+        const LChar* d = r->characters8();
+        for (int i = 0; i != length; ++i)
+            if (d[i] != (unsigned char)s[i])
+                return false;
+        return s[length] == 0;
+    }
+
     const UChar* d = r->characters();
     for (int i = 0; i != length; ++i)
         if (d[i] != (unsigned char)s[i])
@@ -81,6 +89,14 @@ bool Identifier::equal(const StringImpl* r, const UChar* s, unsigned length)
 {
     if (r->length() != length)
         return false;
+    if (r->is8Bit()) {
+        const LChar* d = r->characters8();
+        for (unsigned i = 0; i != length; ++i)
+            if (d[i] != s[i])
+                return false;
+        return true;
+    }
+
     const UChar* d = r->characters();
     for (unsigned i = 0; i != length; ++i)
         if (d[i] != s[i])
@@ -102,10 +118,9 @@ struct IdentifierCStringTranslator {
     static void translate(StringImpl*& location, const char* c, unsigned hash)
     {
         size_t length = strlen(c);
-        UChar* d;
+        LChar* d;
         StringImpl* r = StringImpl::createUninitialized(length, d).leakRef();
-        for (size_t i = 0; i != length; i++)
-            d[i] = static_cast<unsigned char>(c[i]); // use unsigned char to zero-extend instead of sign-extend
+        memcpy(d, c, length);
         r->setHash(hash);
         location = r;
     }
@@ -161,22 +176,17 @@ struct IdentifierUCharBufferTranslator {
 
     static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
     {
-        UChar* d;
-        StringImpl* r = StringImpl::createUninitialized(buf.length, d).leakRef();
-        for (unsigned i = 0; i != buf.length; i++)
-            d[i] = buf.s[i];
+        StringImpl* r = StringImpl::create8BitIfPossible(buf.s, buf.length).leakRef();
         r->setHash(hash);
         location = r; 
     }
 };
 
-uint32_t Identifier::toUInt32(const UString& string, bool& ok)
+template <typename CharType>
+static inline uint32_t charactersToUInt32(const CharType* characters, unsigned length, bool& ok)
 {
     ok = false;
 
-    unsigned length = string.length();
-    const UChar* characters = string.characters();
-
     // An empty string is not a number.
     if (!length)
         return 0;
@@ -213,6 +223,13 @@ uint32_t Identifier::toUInt32(const UString& string, bool& ok)
     return value;
 }
 
+uint32_t Identifier::toUInt32(const UString& string, bool& ok)
+{
+    if (string.is8Bit())
+        return charactersToUInt32(string.characters8(), string.length(), ok);
+    return charactersToUInt32(string.characters(), string.length(), ok);
+}
+
 PassRefPtr<StringImpl> Identifier::add(JSGlobalData* globalData, const UChar* s, int length)
 {
     if (length == 1) {
@@ -243,13 +260,21 @@ PassRefPtr<StringImpl> Identifier::addSlowCase(JSGlobalData* globalData, StringI
     ASSERT(r->length());
 
     if (r->length() == 1) {
-        UChar c = r->characters()[0];
+        UChar c = (*r)[0];
         if (c <= maxSingleCharacterString)
             r = globalData->smallStrings.singleCharacterStringRep(c);
             if (r->isIdentifier())
                 return r;
     }
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Atoms can be used on other threads, but identifiers belong to this thread's table.
+    if (r->isAtomic()) {
+        RefPtr<StringImpl> copy = r->is8Bit() ? StringImpl::create(r->characters8(), r->length()) : StringImpl::create(r->characters(), r->length());
+        return *globalData->identifierTable->add(copy.get()).first;
+    }
+#endif
+
     return *globalData->identifierTable->add(r).first;
 }
 
@@ -355,6 +355,9 @@ namespace JSC {
     {
         while (m_nextAtom < m_endAtom) {
             if (!m_marks.testAndSet(m_nextAtom)) {
+#if ENABLE(GGC)
+                m_newlyAllocated.set(m_nextAtom);
+#endif
                 JSCell* cell = reinterpret_cast<JSCell*>(&atoms()[m_nextAtom]);
                 m_nextAtom += m_atomsPerCell;
                 cell->~JSCell();
@@ -399,12 +402,17 @@ namespace JSC {
 
     inline void* JSCell::operator new(size_t size, JSGlobalData* globalData)
     {
+        if (UNLIKELY(globalData->heap.allocationSampler() != 0))
+            globalData->heap.sampleAllocation(0, size);
         return globalData->heap.allocate(size);
     }
 
     inline void* JSCell::operator new(size_t size, ExecState* exec)
     {
-        return exec->heap()->allocate(size);
+        Heap* heap = exec->heap();
+        if (UNLIKELY(heap->allocationSampler() != 0))
+            heap->sampleAllocation(exec, size);
+        return heap->allocate(size);
     }
 
 } // namespace JSC
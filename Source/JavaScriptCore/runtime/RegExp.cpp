@@ -30,6 +30,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <wtf/Assertions.h>
+#include <wtf/CurrentTime.h>
 #include <wtf/OwnArrayPtr.h>
 
 namespace JSC {
@@ -78,6 +79,9 @@ inline RegExp::RegExp(JSGlobalData* globalData, const UString& patternString, Re
     , m_flags(flags)
     , m_constructionError(0)
     , m_numSubpatterns(0)
+    , m_collectsStatistics(false)
+    , m_matchCount(0)
+    , m_matchTime(0)
 #if ENABLE(REGEXP_TRACING)
     , m_rtMatchCallCount(0)
     , m_rtMatchFoundCount(0)
@@ -111,7 +115,7 @@ RegExp::RegExpState RegExp::compile(JSGlobalData* globalData)
     RegExpState res = ByteCode;
 
 #if ENABLE(YARR_JIT)
-    if (!pattern.m_containsBackreferences && globalData->canUseJIT()) {
+    if (globalData->canUseJIT()) {
         Yarr::jitCompile(pattern, globalData, m_representation->m_regExpJITCode);
 #if ENABLE(YARR_JIT_DEBUG)
         if (!m_representation->m_regExpJITCode.isFallBack())
@@ -161,6 +165,8 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
         for (unsigned j = 0, i = 0; i < m_numSubpatterns + 1; j += 2, i++)            
             offsetVector[j] = -1;
 
+        double startTime = m_collectsStatistics ? currentTime() : 0;
+
         int result;
 #if ENABLE(YARR_JIT)
         if (m_state == JITCode) {
@@ -173,6 +179,11 @@ int RegExp::match(const UString& s, int startOffset, Vector<int, 32>* ovector)
             result = Yarr::interpret(m_representation->m_regExpBytecode.get(), s.characters(), startOffset, s.length(), offsetVector);
         ASSERT(result >= -1);
 
+        if (m_collectsStatistics) {
+            ++m_matchCount;
+            m_matchTime += currentTime() - startTime;
+        }
+
 #if ENABLE(REGEXP_TRACING)
         if (result != -1)
             m_rtMatchFoundCount++;
@@ -51,6 +51,14 @@ namespace JSC {
 
         int match(const UString&, int startOffset, Vector<int, 32>* ovector = 0);
         unsigned numSubpatterns() const { return m_numSubpatterns; }
+
+        // False if the pattern could not be compiled by the JIT, and is matched by the interpreter
+        bool hasJITCode() const { return m_state == JITCode; }
+
+        // Counts the calls to match() and the time spent in them, from then on
+        void setCollectsStatistics() { m_collectsStatistics = true; }
+        unsigned matchCount() const { return m_matchCount; }
+        double matchTime() const { return m_matchTime; }
         
 #if ENABLE(REGEXP_TRACING)
         void printTraceData();
@@ -75,6 +83,9 @@ namespace JSC {
         RegExpFlags m_flags;
         const char* m_constructionError;
         unsigned m_numSubpatterns;
+        bool m_collectsStatistics;
+        unsigned m_matchCount;
+        double m_matchTime;
 #if ENABLE(REGEXP_TRACING)
         unsigned m_rtMatchCallCount;
         unsigned m_rtMatchFoundCount;
@@ -29,8 +29,15 @@
 
 #include "RegExpCache.h"
 
+#include <algorithm>
+#include <stdio.h>
+#include <wtf/text/CString.h>
+
 namespace JSC {
 
+// The patterns printed by dumpStatistics()
+static const size_t maxDumpedPatterns = 50;
+
 PassRefPtr<RegExp> RegExpCache::lookupOrCreate(const UString& patternString, RegExpFlags flags)
 {
     if (patternString.length() < maxCacheablePatternLength) {
@@ -46,6 +53,10 @@ PassRefPtr<RegExp> RegExpCache::lookupOrCreate(const UString& patternString, Reg
 PassRefPtr<RegExp> RegExpCache::create(const UString& patternString, RegExpFlags flags, RegExpCacheMap::iterator iterator) 
 {
     RefPtr<RegExp> regExp = RegExp::create(m_globalData, patternString, flags);
+    if (m_collectsStatistics) {
+        regExp->setCollectsStatistics();
+        m_regExpsWithStatistics.append(regExp);
+    }
 
     if (patternString.length() >= maxCacheablePatternLength)
         return regExp;
@@ -71,7 +82,89 @@ RegExpCache::RegExpCache(JSGlobalData* globalData)
     : m_globalData(globalData)
     , m_nextKeyToEvict(-1)
     , m_isFull(false)
+    , m_collectsStatistics(false)
+{
+}
+
+void RegExpCache::setCollectsStatistics()
+{
+    m_collectsStatistics = true;
+}
+
+struct PatternStatistics {
+    PatternStatistics()
+        : regExp(0)
+        , matchCount(0)
+        , matchTime(0)
+    {
+    }
+
+    const RegExp* regExp; // The first created with the pattern and flags
+    unsigned matchCount;
+    double matchTime;
+};
+
+static bool moreMatchTime(const PatternStatistics& a, const PatternStatistics& b)
 {
+    return a.matchTime > b.matchTime;
+}
+
+static RegExpFlags flagsOf(const RegExp* regExp)
+{
+    int flags = NoFlags;
+    if (regExp->global())
+        flags |= FlagGlobal;
+    if (regExp->ignoreCase())
+        flags |= FlagIgnoreCase;
+    if (regExp->multiline())
+        flags |= FlagMultiline;
+    return static_cast<RegExpFlags>(flags);
+}
+
+void RegExpCache::dumpStatistics() const
+{
+    // A pattern created again after its eviction from the cache is counted once
+    HashMap<RegExpKey, size_t> indices;
+    Vector<PatternStatistics> patterns;
+    for (size_t i = 0; i < m_regExpsWithStatistics.size(); ++i) {
+        const RegExp* regExp = m_regExpsWithStatistics[i].get();
+        pair<HashMap<RegExpKey, size_t>::iterator, bool> result = indices.add(RegExpKey(flagsOf(regExp), regExp->pattern()), patterns.size());
+        if (result.second) {
+            patterns.append(PatternStatistics());
+            patterns.last().regExp = regExp;
+        }
+        PatternStatistics& statistics = patterns[result.first->second];
+        statistics.matchCount += regExp->matchCount();
+        statistics.matchTime += regExp->matchTime();
+    }
+    std::sort(patterns.begin(), patterns.end(), moreMatchTime);
+
+    size_t interpretedPatterns = 0;
+    double matchTime = 0;
+    double interpretedMatchTime = 0;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        matchTime += patterns[i].matchTime;
+        if (!patterns[i].regExp->hasJITCode()) {
+            ++interpretedPatterns;
+            interpretedMatchTime += patterns[i].matchTime;
+        }
+    }
+
+    printf("\nRegExp: %lu patterns, %lu interpreted; %.2fms matching, %.2fms of it in the interpreter\n",
+        static_cast<unsigned long>(patterns.size()), static_cast<unsigned long>(interpretedPatterns), matchTime * 1000, interpretedMatchTime * 1000);
+    if (patterns.isEmpty())
+        return;
+
+    printf("%10s %10s  %-11s  %s\n", "calls", "ms", "code", "pattern");
+    for (size_t i = 0; i < patterns.size() && i < maxDumpedPatterns; ++i) {
+        const PatternStatistics& statistics = patterns[i];
+        const RegExp* regExp = statistics.regExp;
+        const char* code = !regExp->isValid() ? "invalid" : regExp->hasJITCode() ? "JIT" : "interpreter";
+        printf("%10u %10.2f  %-11s  /%.80s/%s%s%s\n", statistics.matchCount, statistics.matchTime * 1000, code, regExp->pattern().utf8().data(),
+            regExp->global() ? "g" : "", regExp->ignoreCase() ? "i" : "", regExp->multiline() ? "m" : "");
+    }
+    if (patterns.size() > maxDumpedPatterns)
+        printf("  ... %lu more patterns\n", static_cast<unsigned long>(patterns.size() - maxDumpedPatterns));
 }
 
 }
@@ -30,6 +30,7 @@
 #include "UString.h"
 #include <wtf/FixedArray.h>
 #include <wtf/HashMap.h>
+#include <wtf/Vector.h>
 
 #ifndef RegExpCache_h
 #define RegExpCache_h
@@ -45,6 +46,13 @@ public:
     PassRefPtr<RegExp> create(const UString& patternString, RegExpFlags, RegExpCacheMap::iterator);
     RegExpCache(JSGlobalData* globalData);
 
+    // Keeps the RegExps created from then on alive, counting their calls to match()
+    void setCollectsStatistics();
+
+    // Prints whether each pattern is compiled or interpreted, and its matches,
+    // the most time consuming first
+    void dumpStatistics() const;
+
 private:
     static const unsigned maxCacheablePatternLength = 256;
 
@@ -61,6 +69,8 @@ private:
     JSGlobalData* m_globalData;
     int m_nextKeyToEvict;
     bool m_isFull;
+    bool m_collectsStatistics;
+    Vector<RefPtr<RegExp> > m_regExpsWithStatistics;
 };
 
 } // namespace JSC
@@ -291,10 +291,21 @@ namespace JSC {
         ASSERT(cell);
         if (Heap::testAndSetMarked(cell))
             return;
+        if (m_retainers)
+            recordRetainer(cell);
         if (cell->structure()->typeInfo().type() >= CompoundType)
             m_values.append(cell);
     }
 
+#if ENABLE(GGC)
+    ALWAYS_INLINE void MarkStack::appendChildren(JSCell* cell)
+    {
+        ASSERT(Heap::isMarked(cell));
+        if (cell->structure()->typeInfo().type() >= CompoundType)
+            m_values.append(cell);
+    }
+#endif
+
     inline StructureTransitionTable::Hash::Key StructureTransitionTable::keyForWeakGCMapFinalizer(void*, Structure* structure)
     {
         return Hash::Key(structure->m_nameInPrevious.get(), structure->m_attributesInPrevious);
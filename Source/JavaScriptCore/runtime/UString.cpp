@@ -216,13 +216,10 @@ UString UString::substringSharingImpl(unsigned offset, unsigned length) const
     return UString(StringImpl::create(m_impl, offset, length));
 }
 
-bool operator==(const UString& s1, const char *s2)
+template <typename CharType>
+static inline bool equalToLatin1(const CharType* u, unsigned length, const char* s2)
 {
-    if (s2 == 0)
-        return s1.isEmpty();
-
-    const UChar* u = s1.characters();
-    const UChar* uend = u + s1.length();
+    const CharType* uend = u + length;
     while (u != uend && *s2) {
         if (u[0] != (unsigned char)*s2)
             return false;
@@ -233,6 +230,16 @@ bool operator==(const UString& s1, const char *s2)
     return u == uend && *s2 == 0;
 }
 
+bool operator==(const UString& s1, const char *s2)
+{
+    if (s2 == 0)
+        return s1.isEmpty();
+
+    if (s1.is8Bit())
+        return equalToLatin1(s1.characters8(), s1.length(), s2);
+    return equalToLatin1(s1.characters(), s1.length(), s2);
+}
+
 bool operator<(const UString& s1, const UString& s2)
 {
     const unsigned l1 = s1.length();
@@ -277,13 +284,12 @@ CString UString::ascii() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
     for (unsigned i = 0; i < length; ++i) {
-        UChar ch = characters[i];
+        UChar ch = (*m_impl)[i];
         characterBuffer[i] = ch && (ch < 0x20 || ch >= 0x7f) ? '?' : ch;
     }
 
@@ -296,11 +302,16 @@ CString UString::latin1() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
+    if (is8Bit()) {
+        memcpy(characterBuffer, characters8(), length);
+        return result;
+    }
+
+    const UChar* characters = this->characters();
     for (unsigned i = 0; i < length; ++i) {
         UChar ch = characters[i];
         characterBuffer[i] = ch > 0xff ? '?' : ch;
@@ -321,6 +332,26 @@ static inline void putUTF8Triple(char*& buffer, UChar ch)
 CString UString::utf8(bool strict) const
 {
     unsigned length = this->length();
+
+    if (is8Bit()) {
+        // Latin-1 characters take one or two bytes in UTF-8.
+        if (length > numeric_limits<unsigned>::max() / 2)
+            return CString();
+        Vector<char, 1024> bufferVector(length * 2);
+        char* buffer = bufferVector.data();
+        const LChar* characters = characters8();
+        for (unsigned i = 0; i < length; ++i) {
+            LChar ch = characters[i];
+            if (ch < 0x80)
+                *buffer++ = ch;
+            else {
+                *buffer++ = static_cast<char>((ch >> 6) | 0xC0);
+                *buffer++ = static_cast<char>((ch & 0x3F) | 0x80);
+            }
+        }
+        return CString(bufferVector.data(), buffer - bufferVector.data());
+    }
+
     const UChar* characters = this->characters();
 
     // Allocate a buffer big enough to hold all the characters
@@ -76,6 +76,14 @@ public:
         return m_impl->characters();
     }
 
+    bool is8Bit() const { return m_impl && m_impl->is8Bit(); }
+    const LChar* characters8() const
+    {
+        if (!m_impl)
+            return 0;
+        return m_impl->characters8();
+    }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -84,7 +92,7 @@ public:
     {
         if (!m_impl || index >= m_impl->length())
             return 0;
-        return m_impl->characters()[index];
+        return (*m_impl)[index];
     }
 
     static UString number(int);
@@ -138,6 +146,9 @@ ALWAYS_INLINE bool operator==(const UString& s1, const UString& s2)
     // At this point we know 
     //   (a) that the strings are the same length and
     //   (b) that they are greater than zero length.
+    if (rep1->is8Bit() || rep2->is8Bit())
+        return WTF::equalWith8Bit(rep1, rep2);
+
     const UChar* d1 = rep1->characters();
     const UChar* d2 = rep2->characters();
     
@@ -200,6 +211,9 @@ struct UStringHash {
         if (aLength != bLength)
             return false;
 
+        if (a->is8Bit() || b->is8Bit())
+            return WTF::equalWith8Bit(a, b);
+
         // FIXME: perhaps we should have a more abstract macro that indicates when
         // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS)
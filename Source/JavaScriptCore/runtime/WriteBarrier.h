@@ -27,11 +27,29 @@
 #define WriteBarrier_h
 
 #include "JSValue.h"
+#include "MarkedBlock.h"
 
 namespace JSC {
 class JSCell;
 class JSGlobalData;
 
+#if ENABLE(GGC)
+// Remembers the owner, so that minor collections scan it for references to
+// young cells.
+inline void writeBarrier(JSGlobalData&, const JSCell* owner, JSValue value)
+{
+    ASSERT(owner);
+    if (value.isCell())
+        MarkedBlock::blockFor(owner)->rememberCell(owner);
+}
+
+inline void writeBarrier(JSGlobalData&, const JSCell* owner, JSCell* value)
+{
+    ASSERT(owner);
+    if (value)
+        MarkedBlock::blockFor(owner)->rememberCell(owner);
+}
+#else
 inline void writeBarrier(JSGlobalData&, const JSCell*, JSValue)
 {
 }
@@ -39,6 +57,7 @@ inline void writeBarrier(JSGlobalData&, const JSCell*, JSValue)
 inline void writeBarrier(JSGlobalData&, const JSCell*, JSCell*)
 {
 }
+#endif
 
 typedef enum { } Unknown;
 typedef JSValue* HandleSlot;
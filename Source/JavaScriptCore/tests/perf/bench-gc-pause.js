@@ -0,0 +1,27 @@
+// Measures full collection pauses over a large live heap; compare
+// "jsc -m 1 bench-gc-pause.js" against "jsc -m 4 bench-gc-pause.js".
+(function () {
+    function tree(depth) {
+        if (!depth)
+            return { value: depth };
+        return { left: tree(depth - 1), right: tree(depth - 1), items: [depth, depth + 1] };
+    }
+
+    var live = new Array(40);
+    for (var i = 0; i < live.length; ++i)
+        live[i] = tree(14);
+
+    var total = 0;
+    var max = 0;
+    var min = Infinity;
+    var runs = 20;
+    for (var i = 0; i < runs; ++i) {
+        var start = Date.now();
+        gc();
+        var pause = Date.now() - start;
+        total += pause;
+        max = Math.max(max, pause);
+        min = Math.min(min, pause);
+    }
+    print("gc pause ms: min " + min + " avg " + (total / runs) + " max " + max);
+})();
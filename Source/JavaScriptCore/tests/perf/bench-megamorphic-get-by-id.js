@@ -0,0 +1,29 @@
+// Measures property reads at sites that see more object shapes than their
+// polymorphic inline caches hold; "jsc -j bench-megamorphic-get-by-id.js"
+// also prints the hit rates of the megamorphic cache.
+(function () {
+    var shapes = 32;
+    var objects = [];
+    for (var i = 0; i < 1024; ++i) {
+        var object = {};
+        // Different sets of properties before x and y give each shape its own Structure
+        for (var j = 0; j < i % shapes; ++j)
+            object["p" + j] = j;
+        object.x = i;
+        object.y = 1;
+        objects.push(object);
+    }
+
+    function sum(objects) {
+        var total = 0;
+        for (var i = 0; i < objects.length; ++i)
+            total += objects[i].x + objects[i].y;
+        return total;
+    }
+
+    var start = Date.now();
+    var total = 0;
+    for (var i = 0; i < 2000; ++i)
+        total += sum(objects);
+    print("megamorphic get_by_id ms: " + (Date.now() - start) + " (" + total + ")");
+})();
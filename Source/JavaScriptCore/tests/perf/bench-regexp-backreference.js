@@ -0,0 +1,24 @@
+// Measures matching of patterns with backreferences and fixed count groups;
+// "jsc -r bench-regexp-backreference.js" also prints whether each pattern
+// was compiled or interpreted.
+(function () {
+    var text = [];
+    for (var i = 0; i < 200; ++i)
+        text.push("<b>bold " + i + "</b> said 'hello " + i + "' from 10.0." + (i % 256) + "." + (i % 7) + " to to the list");
+    text = text.join(" ");
+
+    var patterns = [
+        /<(\w+)>[^<]*<\/\1>/g,
+        /(['"])[^'"]*\1/g,
+        /\b(\w+) \1\b/g,
+        /(?:\d{1,3}\.){3}\d{1,3}/g
+    ];
+
+    var start = Date.now();
+    var matches = 0;
+    for (var i = 0; i < 200; ++i) {
+        for (var j = 0; j < patterns.length; ++j)
+            matches += text.match(patterns[j]).length;
+    }
+    print("regexp backreference ms: " + (Date.now() - start) + " (" + matches + ")");
+})();
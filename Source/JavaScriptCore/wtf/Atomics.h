@@ -107,6 +107,14 @@ inline int atomicDecrement(int volatile* addend) { return __gnu_cxx::__exchange_
 
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+// May fail spuriously, callers retry in a loop.
+inline bool weakCompareAndSwap(volatile unsigned* location, unsigned expected, unsigned newValue)
+{
+    return __sync_bool_compare_and_swap(location, expected, newValue);
+}
+#endif
+
 } // namespace WTF
 
 #if USE(LOCKFREE_THREADSAFEREFCOUNTED)
@@ -114,4 +122,8 @@ using WTF::atomicDecrement;
 using WTF::atomicIncrement;
 #endif
 
+#if ENABLE(COMPARE_AND_SWAP)
+using WTF::weakCompareAndSwap;
+#endif
+
 #endif // Atomics_h
@@ -164,6 +164,9 @@ private:
             ASSERT(allocationEnd > current); // check for overflow
             if (allocationEnd <= static_cast<void*>(pool))
                 return pool;
+
+            previousPool = pool;
+            pool = pool->m_next;
         }
     }
 
@@ -380,6 +380,38 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+bool fastMallocUsesSystemMalloc()
+{
+    return true;
+}
+
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t)
+{
+    return 0;
+}
+
+FastMallocPageHeapStatistics fastMallocPageHeapStatistics()
+{
+    FastMallocPageHeapStatistics statistics = { 0, 0, 0, 0, 0 };
+    return statistics;
+}
+
+void setFastMallocScavengeAggressiveness(float) { }
+
+void setFastMallocSampleInterval(size_t) { }
+
+size_t fastMallocSampleInterval()
+{
+    return 0;
+}
+
+size_t fastMallocAllocationSites(FastMallocAllocationSite*, size_t)
+{
+    return 0;
+}
+
+void clearFastMallocAllocationSites() { }
+
 size_t fastMallocSize(const void* p)
 {
 #if OS(DARWIN)
@@ -437,6 +469,10 @@ extern "C" const int jscore_fastmalloc_introspection = 0;
 
 #ifdef WTF_CHANGES
 
+#if COMPILER(GCC)
+#include <unwind.h>
+#endif
+
 #if OS(DARWIN)
 #include "MallocZoneSupport.h"
 #include <wtf/HashSet.h>
@@ -677,6 +713,17 @@ static size_t sample_period = 262147;
 // Protects sample_period above
 static SpinLock sample_period_lock = SPINLOCK_INITIALIZER;
 
+// Smallest prime in primes_list >= flag_value, or the largest one
+static size_t SamplePeriodForFlag(int64_t flag_value) {
+  int i;
+  for (i = 0; i < (static_cast<int>(sizeof(primes_list)/sizeof(primes_list[0])) - 1); i++) {
+    if (primes_list[i] >= flag_value) {
+      break;
+    }
+  }
+  return primes_list[i];
+}
+
 // Parameters for controlling how fast memory is returned to the OS.
 
 DEFINE_double(tcmalloc_release_rate, 1,
@@ -1300,6 +1347,23 @@ static const size_t kMinimumFreeCommittedPageCount = kMinSpanListsWithSpans * ((
 
 #endif
 
+// Set by setFastMallocScavengeAggressiveness().  Read without a lock: a
+// scavenge that sees the old value releases pages at the old pace once more.
+static float scavenge_aggressiveness = 1;
+
+#if USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY
+// Free committed pages the scavenger leaves alone.  Never less than
+// kMinimumFreeCommittedPageCount, without which scavenge() may not finish.
+static inline size_t minimumFreeCommittedPageCount()
+{
+  if (scavenge_aggressiveness <= 0)
+    return std::numeric_limits<size_t>::max();
+  if (scavenge_aggressiveness >= 1)
+    return kMinimumFreeCommittedPageCount;
+  return static_cast<size_t>(kMinimumFreeCommittedPageCount / scavenge_aggressiveness);
+}
+#endif
+
 class TCMalloc_PageHeap {
  public:
   void init();
@@ -1341,6 +1405,9 @@ class TCMalloc_PageHeap {
   }
     
   size_t ReturnedBytes() const;
+
+  // REQUIRES: pageheap_lock is held
+  void collectStatistics(FastMallocPageHeapStatistics*) const;
 #endif
 
   // Dump state to stderr
@@ -1634,8 +1701,8 @@ ALWAYS_INLINE void TCMalloc_PageHeap::signalScavenger()
 
 void TCMalloc_PageHeap::scavenge()
 {
-    size_t pagesToRelease = min_free_committed_pages_since_last_scavenge_ * kScavengePercentage;
-    size_t targetPageCount = std::max<size_t>(kMinimumFreeCommittedPageCount, free_committed_pages_ - pagesToRelease);
+    size_t pagesToRelease = min_free_committed_pages_since_last_scavenge_ * std::min(1.0f, kScavengePercentage * scavenge_aggressiveness);
+    size_t targetPageCount = std::max<size_t>(minimumFreeCommittedPageCount(), free_committed_pages_ - pagesToRelease);
 
     while (free_committed_pages_ > targetPageCount) {
         for (int i = kMaxPages; i > 0 && free_committed_pages_ >= targetPageCount; i--) {
@@ -1665,7 +1732,7 @@ void TCMalloc_PageHeap::scavenge()
 
 ALWAYS_INLINE bool TCMalloc_PageHeap::shouldScavenge() const 
 {
-    return free_committed_pages_ > kMinimumFreeCommittedPageCount; 
+    return free_committed_pages_ > minimumFreeCommittedPageCount();
 }
 
 #endif  // USE_BACKGROUND_THREAD_TO_SCAVENGE_MEMORY
@@ -1931,6 +1998,9 @@ void TCMalloc_PageHeap::IncrementalScavenge(Length n) {
   // Fast path; not yet time to release memory
   scavenge_counter_ -= n;
   if (scavenge_counter_ >= 0) return;  // Not yet time to scavenge
+#ifdef WTF_CHANGES
+  if (scavenge_aggressiveness <= 0) return;
+#endif
 
   // If there is nothing to release, wait for so many pages before
   // scavenging again.  With 4K pages, this comes to 16MB of memory.
@@ -1951,6 +2021,9 @@ void TCMalloc_PageHeap::IncrementalScavenge(Length n) {
       DLL_Prepend(&slist->returned, s);
 
       scavenge_counter_ = std::max<size_t>(64UL, std::min<size_t>(kDefaultReleaseDelay, kDefaultReleaseDelay - (free_pages_ / kDefaultReleaseDelay)));
+#ifdef WTF_CHANGES
+      scavenge_counter_ = static_cast<int64_t>(scavenge_counter_ / scavenge_aggressiveness);
+#endif
 
       if (index == kMaxPages && !DLL_IsEmpty(&slist->normal))
         scavenge_index_ = index - 1;
@@ -1991,6 +2064,32 @@ size_t TCMalloc_PageHeap::ReturnedBytes() const {
         result += s->length << kPageShift;
     return result;
 }
+
+static void addFreeSpans(const Span* list, FastMallocPageHeapStatistics* statistics, size_t* bytes)
+{
+    for (Span* s = list->next; s != list; s = s->next) {
+        size_t spanBytes = s->length << kPageShift;
+        *bytes += spanBytes;
+        statistics->freeSpanCount++;
+        statistics->largestFreeSpanBytes = std::max(statistics->largestFreeSpanBytes, spanBytes);
+    }
+}
+
+void TCMalloc_PageHeap::collectStatistics(FastMallocPageHeapStatistics* statistics) const
+{
+    statistics->systemBytes = static_cast<size_t>(system_bytes_);
+    statistics->freeCommittedBytes = 0;
+    statistics->returnedBytes = 0;
+    statistics->freeSpanCount = 0;
+    statistics->largestFreeSpanBytes = 0;
+
+    for (unsigned s = 0; s < kMaxPages; s++) {
+        addFreeSpans(&free_[s].normal, statistics, &statistics->freeCommittedBytes);
+        addFreeSpans(&free_[s].returned, statistics, &statistics->returnedBytes);
+    }
+    addFreeSpans(&large_.normal, statistics, &statistics->freeCommittedBytes);
+    addFreeSpans(&large_.returned, statistics, &statistics->returnedBytes);
+}
 #endif
 
 #ifndef WTF_CHANGES
@@ -2330,6 +2429,12 @@ class TCMalloc_Central_FreeList {
   }
 
 #ifdef WTF_CHANGES
+  // Returns the number of spans carved into objects of this size class.
+  size_t span_count() {
+    SpinLockHolder h(&lock_);
+    return DLL_Length(&empty_) + DLL_Length(&nonempty_);
+  }
+
   template <class Finder, class Reader>
   void enumerateFreeObjects(Finder& finder, const Reader& reader, TCMalloc_Central_FreeList* remoteCentralFreeList)
   {
@@ -2978,13 +3083,7 @@ void TCMalloc_ThreadCache::PickNextSample(size_t k) {
 
   if (flag_value != last_flag_value) {
     SpinLockHolder h(&sample_period_lock);
-    int i;
-    for (i = 0; i < (static_cast<int>(sizeof(primes_list)/sizeof(primes_list[0])) - 1); i++) {
-      if (primes_list[i] >= flag_value) {
-        break;
-      }
-    }
-    sample_period = primes_list[i];
+    sample_period = SamplePeriodForFlag(flag_value);
     last_flag_value = flag_value;
   }
 
@@ -3546,7 +3645,93 @@ static TCMallocGuard module_enter_exit_hook;
 // Helpers for the exported routines below
 //-------------------------------------------------------------------
 
-#ifndef WTF_CHANGES
+#ifdef WTF_CHANGES
+
+// Allocation sites counted by the sampler, in an open addressed table that is
+// allocated when sampling is first turned on, and never freed.  Sites that do
+// not fit are only counted by size class.
+static const size_t kNumSampledSites = 1024;
+struct SampledSite {
+  uint32_t hash;
+  unsigned depth;
+  void* stack[FastMallocAllocationSite::maxStackDepth];
+  size_t samples;
+};
+
+// Protects the following state
+static SpinLock sample_sites_lock = SPINLOCK_INITIALIZER;
+static SampledSite* sampled_sites = NULL;
+static size_t sampled_class_count[kNumClasses];
+
+#if COMPILER(GCC)
+struct StackWalk {
+  void** stack;
+  int depth;
+  int max_depth;
+  int skip;
+};
+
+static _Unwind_Reason_Code StackWalkCallback(struct _Unwind_Context* context, void* argument) {
+  StackWalk* walk = static_cast<StackWalk*>(argument);
+  if (walk->skip > 0) {
+    walk->skip--;
+    return _URC_NO_REASON;
+  }
+  void* pc = reinterpret_cast<void*>(_Unwind_GetIP(context));
+  if (pc == NULL)
+    return _URC_END_OF_STACK;
+  walk->stack[walk->depth++] = pc;
+  return walk->depth == walk->max_depth ? _URC_END_OF_STACK : _URC_NO_REASON;
+}
+#endif
+
+// Stores the return addresses on the stack, innermost first, after skipping
+// the first "skip" callers of this function.  The unwinder does not allocate.
+static NEVER_INLINE int GetStackTrace(void** stack, int max_depth, int skip) {
+#if COMPILER(GCC)
+  StackWalk walk = { stack, 0, max_depth, skip + 1 };
+  _Unwind_Backtrace(StackWalkCallback, &walk);
+  return walk.depth;
+#else
+  UNUSED_PARAM(stack);
+  UNUSED_PARAM(max_depth);
+  UNUSED_PARAM(skip);
+  return 0;
+#endif
+}
+
+static NEVER_INLINE void RecordSampledAllocation(size_t size) {
+  // Skip this function and the fastMalloc that do_malloc is inlined in
+  void* stack[FastMallocAllocationSite::maxStackDepth];
+  const int depth = GetStackTrace(stack, FastMallocAllocationSite::maxStackDepth, 2);
+  uint32_t hash = depth;
+  for (int i = 0; i < depth; i++)
+    hash = hash * 31 + static_cast<uint32_t>(reinterpret_cast<uintptr_t>(stack[i]) >> 2);
+
+  SpinLockHolder h(&sample_sites_lock);
+  if (size <= kMaxSize)
+    sampled_class_count[SizeClass(size)]++;
+  if (sampled_sites == NULL)
+    return;
+
+  for (size_t i = 0; i < kNumSampledSites; i++) {
+    SampledSite* site = &sampled_sites[(hash + i) & (kNumSampledSites - 1)];
+    if (site->samples == 0) {
+      site->hash = hash;
+      site->depth = depth;
+      memcpy(site->stack, stack, depth * sizeof(void*));
+      site->samples = 1;
+      return;
+    }
+    if (site->hash == hash && site->depth == static_cast<unsigned>(depth)
+        && !memcmp(site->stack, stack, depth * sizeof(void*))) {
+      site->samples++;
+      return;
+    }
+  }
+}
+
+#else
 
 static Span* DoSampledAllocation(size_t size) {
 
@@ -3610,7 +3795,10 @@ static ALWAYS_INLINE void* do_malloc(size_t size) {
 
   // The following call forces module initialization
   TCMalloc_ThreadCache* heap = TCMalloc_ThreadCache::GetCache();
-#ifndef WTF_CHANGES
+#ifdef WTF_CHANGES
+  if (UNLIKELY(FLAGS_tcmalloc_sample_parameter > 0) && heap->SampleAllocation(size))
+    RecordSampledAllocation(size);
+#else
   if ((FLAGS_tcmalloc_sample_parameter > 0) && heap->SampleAllocation(size)) {
     Span* span = DoSampledAllocation(size);
     if (span != NULL) {
@@ -4276,6 +4464,118 @@ FastMallocStatistics fastMallocStatistics()
     return statistics;
 }
 
+bool fastMallocUsesSystemMalloc()
+{
+    return false;
+}
+
+size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics* statistics, size_t maxCount)
+{
+    if (!phinited)
+        return 0;
+
+    // Size class 0 is not used.
+    size_t count = std::min(maxCount, kNumClasses - 1);
+    for (size_t i = 0; i < count; ++i) {
+        size_t cl = i + 1;
+        size_t objectSize = ByteSizeForClass(cl);
+        size_t bytesPerSpan = class_to_pages[cl] << kPageShift;
+
+        statistics[i].objectSize = objectSize;
+        statistics[i].spanCount = central_cache[cl].span_count();
+        statistics[i].spanBytes = statistics[i].spanCount * bytesPerSpan;
+        statistics[i].freeBytes = objectSize * (central_cache[cl].length() + central_cache[cl].tc_length());
+        statistics[i].unusableBytes = statistics[i].spanCount * (bytesPerSpan % objectSize);
+    }
+
+    {
+        SpinLockHolder lockHolder(&pageheap_lock);
+        for (TCMalloc_ThreadCache* threadCache = thread_heaps; threadCache; threadCache = threadCache->next_) {
+            for (size_t i = 0; i < count; ++i)
+                statistics[i].freeBytes += statistics[i].objectSize * threadCache->freelist_length(i + 1);
+        }
+    }
+
+    size_t sampleInterval = fastMallocSampleInterval();
+    SpinLockHolder lockHolder(&sample_sites_lock);
+    for (size_t i = 0; i < count; ++i)
+        statistics[i].sampledBytes = sampled_class_count[i + 1] * sampleInterval;
+
+    return count;
+}
+
+FastMallocPageHeapStatistics fastMallocPageHeapStatistics()
+{
+    FastMallocPageHeapStatistics statistics = { 0, 0, 0, 0, 0 };
+    if (!phinited)
+        return statistics;
+
+    SpinLockHolder lockHolder(&pageheap_lock);
+    pageheap->collectStatistics(&statistics);
+    return statistics;
+}
+
+void setFastMallocScavengeAggressiveness(float aggressiveness)
+{
+    scavenge_aggressiveness = std::max(0.0f, aggressiveness);
+}
+
+void setFastMallocSampleInterval(size_t interval)
+{
+    if (interval) {
+        TCMalloc_ThreadCache::InitModule();
+
+        SpinLockHolder lockHolder(&pageheap_lock);
+        if (!sampled_sites) {
+            // Metadata is allocated with pageheap_lock held.
+            SampledSite* sites = static_cast<SampledSite*>(MetaDataAlloc(kNumSampledSites * sizeof(SampledSite)));
+            if (!sites)
+                return;
+            memset(sites, 0, kNumSampledSites * sizeof(SampledSite));
+
+            SpinLockHolder sitesLockHolder(&sample_sites_lock);
+            sampled_sites = sites;
+        }
+    }
+
+    // The sampler's parameter is twice the average interval.
+    FLAGS_tcmalloc_sample_parameter = static_cast<int64_t>(std::min<size_t>(interval, std::numeric_limits<int32_t>::max() / 2)) * 2;
+}
+
+size_t fastMallocSampleInterval()
+{
+    if (FLAGS_tcmalloc_sample_parameter <= 0)
+        return 0;
+    return SamplePeriodForFlag(FLAGS_tcmalloc_sample_parameter) / 2;
+}
+
+size_t fastMallocAllocationSites(FastMallocAllocationSite* sites, size_t maxCount)
+{
+    SpinLockHolder lockHolder(&sample_sites_lock);
+    if (!sampled_sites)
+        return 0;
+
+    size_t count = 0;
+    for (size_t i = 0; i < kNumSampledSites && count < maxCount; ++i) {
+        const SampledSite& site = sampled_sites[i];
+        if (!site.samples)
+            continue;
+        memcpy(sites[count].stack, site.stack, site.depth * sizeof(void*));
+        sites[count].stackDepth = site.depth;
+        sites[count].samples = site.samples;
+        ++count;
+    }
+    return count;
+}
+
+void clearFastMallocAllocationSites()
+{
+    SpinLockHolder lockHolder(&sample_sites_lock);
+    if (sampled_sites)
+        memset(sampled_sites, 0, kNumSampledSites * sizeof(SampledSite));
+    memset(sampled_class_count, 0, sizeof(sampled_class_count));
+}
+
 size_t fastMallocSize(const void* ptr)
 {
     const PageID p = reinterpret_cast<uintptr_t>(ptr) >> kPageShift;
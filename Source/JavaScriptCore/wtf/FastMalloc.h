@@ -89,6 +89,56 @@ namespace WTF {
     };
     FastMallocStatistics fastMallocStatistics();
 
+    // True when FastMalloc forwards to the system malloc (USE_SYSTEM_MALLOC, or a
+    // debug build). None of the TCMalloc statistics below are kept then.
+    bool fastMallocUsesSystemMalloc();
+
+    // Occupancy of one TCMalloc size class. Bytes in its spans are either in use,
+    // free in a cache, or unusable because they do not fit a whole object.
+    struct FastMallocSizeClassStatistics {
+        size_t objectSize;
+        size_t spanCount;
+        size_t spanBytes;
+        size_t freeBytes;       // In the central cache and the thread caches
+        size_t unusableBytes;   // At the end of each span
+        size_t sampledBytes;    // Estimated from the samples, see setFastMallocSampleInterval()
+    };
+    // Fills in at most maxCount size classes, smallest first, and returns how
+    // many were filled in. Returns 0 when FastMalloc uses the system malloc.
+    size_t fastMallocSizeClassStatistics(FastMallocSizeClassStatistics*, size_t maxCount);
+
+    // Free pages of the TCMalloc page heap. Free bytes spread over many small
+    // spans, compared with the largest one, are what fragmentation costs.
+    struct FastMallocPageHeapStatistics {
+        size_t systemBytes;
+        size_t freeCommittedBytes;
+        size_t returnedBytes;   // Free, and given back to the system
+        size_t freeSpanCount;
+        size_t largestFreeSpanBytes;
+    };
+    FastMallocPageHeapStatistics fastMallocPageHeapStatistics();
+
+    // How eagerly free pages are given back to the system: 1 is the default,
+    // 0 keeps them all, and larger values release more of them at a time.
+    void setFastMallocScavengeAggressiveness(float);
+
+    // Samples about one fastMalloc for every interval bytes allocated, and counts
+    // the samples by the stack that made them. 0, the default, turns sampling off.
+    // The interval is rounded up to what the sampler supports.
+    void setFastMallocSampleInterval(size_t);
+    size_t fastMallocSampleInterval();
+
+    struct FastMallocAllocationSite {
+        static const unsigned maxStackDepth = 16;
+        void* stack[maxStackDepth];  // Return addresses, innermost first
+        unsigned stackDepth;
+        size_t samples;
+    };
+    // Fills in at most maxCount sites and returns how many were filled in. Each
+    // sample stands for fastMallocSampleInterval() bytes.
+    size_t fastMallocAllocationSites(FastMallocAllocationSite*, size_t maxCount);
+    void clearFastMallocAllocationSites();
+
     // This defines a type which holds an unsigned integer and is the same
     // size as the minimally aligned memory allocation.
     typedef unsigned long long AllocAlignmentInteger;
@@ -226,6 +226,12 @@
 #define WTF_CPU_X86_64 1
 #endif
 
+/* CPU(X86_SSE2) - SSE2 instructions can be used without a runtime check */
+#if CPU(X86_64) \
+    || (CPU(X86) && (defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)))
+#define WTF_CPU_X86_SSE2 1
+#endif
+
 /* CPU(ARM) - ARM, any version*/
 #if   defined(arm) \
     || defined(__arm__) \
@@ -1275,6 +1281,42 @@
 
 #define ENABLE_JSC_ZOMBIES 0
 
+#if COMPILER(GCC) && (CPU(X86) || CPU(X86_64) || CPU(ARM)) && !OS(SYMBIAN)
+#define ENABLE_COMPARE_AND_SWAP 1
+#endif
+
+/* Parallel marking, off unless asked for: it has not been validated on multicore
+   devices, and the WebCore visitChildren() and addOpaqueRoot() callers have not
+   been audited for running on several threads at once. */
+#if !defined(ENABLE_PARALLEL_GC)
+#define ENABLE_PARALLEL_GC 0
+#endif
+
+#if ENABLE(PARALLEL_GC) && (!ENABLE(COMPARE_AND_SWAP) || ENABLE(SINGLE_THREADED) || !(OS(DARWIN) || OS(LINUX)))
+#error "ENABLE(PARALLEL_GC) requires ENABLE(COMPARE_AND_SWAP) and threads on Darwin or Linux"
+#endif
+
+/* One AtomicString table for the whole process instead of one per thread, so that
+   atoms made on one thread can be used on another. Atoms are then ref counted with
+   compare-and-swap, which is why it is off unless asked for. */
+#if !defined(ENABLE_SHARED_ATOMIC_STRING_TABLE)
+#define ENABLE_SHARED_ATOMIC_STRING_TABLE 0
+#endif
+
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE) && !ENABLE(COMPARE_AND_SWAP)
+#error "ENABLE(SHARED_ATOMIC_STRING_TABLE) requires ENABLE(COMPARE_AND_SWAP)"
+#endif
+
+/* Generational collection, off unless the heap is switched to it. Needs write
+   barriers in all generated code, which the DFG JIT does not emit yet. */
+#if !defined(ENABLE_GGC)
+#define ENABLE_GGC 0
+#endif
+
+#if ENABLE(GGC) && ENABLE(DFG_JIT)
+#error "The DFG JIT does not support ENABLE(GGC)"
+#endif
+
 /* FIXME: Eventually we should enable this for all platforms and get rid of the define. */
 #if PLATFORM(MAC) || PLATFORM(WIN) || PLATFORM(QT)
 #define WTF_USE_PLATFORM_STRATEGIES 1
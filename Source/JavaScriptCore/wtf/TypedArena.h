@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TypedArena_h
+#define TypedArena_h
+
+#include <algorithm>
+#include <wtf/BumpPointerAllocator.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/Noncopyable.h>
+#include <wtf/StdLibExtras.h>
+
+namespace WTF {
+
+// A TypedArena hands out slots for objects of one type. New slots are bumped
+// from the pools of a BumpPointerAllocator, and deleted objects leave their
+// slot on a free list for the next one, so that the short lived objects a
+// parser makes by the thousand cost neither a fastMalloc nor a fastFree each.
+//
+// Each slot starts with a pointer to its arena, which is how delete finds it.
+// When the last object of the arena is deleted, the free list is dropped and
+// the pools are rewound, so that the next burst of objects bumps through the
+// same pages again. Pools past maxRetainedBytes that the last burst did not
+// need go back to the BumpPointerAllocator, which keeps just the first one.
+// The arena must outlive its objects.
+//
+// Classes opt in with WTF_MAKE_ARENA_ALLOCATED and are created with
+// new (arena) Class. Plain new still works, and uses fastMalloc.
+template<typename T> class TypedArena {
+    WTF_MAKE_NONCOPYABLE(TypedArena);
+public:
+    TypedArena()
+        : m_pool(0)
+        , m_firstChunk(0)
+        , m_chunkCurrent(0)
+        , m_chunkEnd(0)
+        , m_chunkIndex(0)
+        , m_poolIndex(0)
+        , m_poolCount(0)
+        , m_poolBytes(0)
+        , m_freeList(0)
+        , m_liveCount(0)
+        , m_allocationCount(0)
+        , m_poolAllocationCount(0)
+    {
+    }
+
+    ~TypedArena()
+    {
+        ASSERT(!m_liveCount);
+    }
+
+    void* allocate(size_t size)
+    {
+        ASSERT_UNUSED(size, size <= sizeof(T));
+        Slot* slot = m_freeList;
+        if (slot)
+            m_freeList = slot->nextFree;
+        else
+            slot = allocateFromChunk();
+        slot->arena = this;
+        ++m_liveCount;
+        ++m_allocationCount;
+        return slot->object();
+    }
+
+    // Objects made with plain new have no arena.
+    static void* allocateWithoutArena(size_t size)
+    {
+        ASSERT(size <= sizeof(T));
+        Slot* slot = static_cast<Slot*>(fastMalloc(slotSize(size)));
+        slot->arena = 0;
+        return slot->object();
+    }
+
+    static void deallocate(void* object)
+    {
+        if (!object)
+            return;
+        Slot* slot = Slot::fromObject(object);
+        if (TypedArena* arena = slot->arena)
+            arena->deallocate(slot);
+        else
+            fastFree(slot);
+    }
+
+    // Live objects, objects ever allocated, and how many pools had to be
+    // allocated from the system for them.
+    size_t liveCount() const { return m_liveCount; }
+    size_t allocationCount() const { return m_allocationCount; }
+    size_t poolAllocationCount() const { return m_poolAllocationCount; }
+
+private:
+    // Pools double in size up to maxPoolSize.
+    static const size_t maxPoolSize = 0x10000;
+    static const size_t maxRetainedBytes = 0x20000;
+
+    struct Slot {
+        union {
+            TypedArena* arena;
+            AllocAlignmentInteger alignment;
+        };
+        // Only used while the slot is free, in place of the object.
+        Slot* nextFree;
+
+        void* object() { return &nextFree; }
+        static Slot* fromObject(void* object) { return reinterpret_cast<Slot*>(static_cast<char*>(object) - OBJECT_OFFSETOF(Slot, nextFree)); }
+    };
+
+    static size_t slotSize(size_t objectSize)
+    {
+        size_t size = OBJECT_OFFSETOF(Slot, nextFree) + std::max(objectSize, sizeof(Slot*));
+        return (size + sizeof(AllocAlignmentInteger) - 1) & ~(sizeof(AllocAlignmentInteger) - 1);
+    }
+
+    static size_t poolSize(size_t capacity)
+    {
+        size_t size = MINIMUM_BUMP_POOL_SIZE;
+        while (size < capacity + sizeof(BumpPointerPool))
+            size <<= 1;
+        return size;
+    }
+
+    // Each chunk fills one pool, so that after a rewind the same chunk sizes
+    // walk the same pools again.
+    size_t chunkSize(size_t index) const
+    {
+        size_t size = MINIMUM_BUMP_POOL_SIZE;
+        for (size_t i = 0; i < index && size < maxPoolSize; ++i)
+            size <<= 1;
+        return std::max(size - sizeof(BumpPointerPool), slotSize(sizeof(T)));
+    }
+
+    Slot* allocateFromChunk()
+    {
+        size_t size = slotSize(sizeof(T));
+        if (m_chunkCurrent + size > m_chunkEnd)
+            allocateChunk();
+        Slot* slot = reinterpret_cast<Slot*>(m_chunkCurrent);
+        m_chunkCurrent += size;
+        return slot;
+    }
+
+    void allocateChunk()
+    {
+        if (!m_pool) {
+            m_pool = m_allocator.startAllocator();
+            if (!m_pool)
+                CRASH();
+            m_poolCount = 1;
+            m_poolBytes = MINIMUM_BUMP_POOL_SIZE;
+            ++m_poolAllocationCount;
+        }
+
+        size_t size = chunkSize(m_chunkIndex++);
+        BumpPointerPool* pool = m_pool->ensureCapacity(size);
+        if (!pool)
+            CRASH();
+        if (pool != m_pool) {
+            // Pools are chained, so a different pool is the next one.
+            if (++m_poolIndex == m_poolCount) {
+                ++m_poolCount;
+                m_poolBytes += poolSize(size);
+                ++m_poolAllocationCount;
+            }
+            m_pool = pool;
+        }
+
+        m_chunkCurrent = static_cast<char*>(m_pool->alloc(size));
+        m_chunkEnd = m_chunkCurrent + size;
+        if (!m_firstChunk)
+            m_firstChunk = m_chunkCurrent;
+    }
+
+    void deallocate(Slot* slot)
+    {
+        ASSERT(m_liveCount);
+        if (--m_liveCount) {
+            slot->nextFree = m_freeList;
+            m_freeList = slot;
+            return;
+        }
+
+        // Nothing is left in the arena: start over from the first chunk. Past
+        // maxRetainedBytes, the pools are only kept if all of them were needed.
+        bool usedAllPools = m_poolIndex + 1 == m_poolCount;
+        m_freeList = 0;
+        m_chunkCurrent = 0;
+        m_chunkEnd = 0;
+        m_chunkIndex = 0;
+        m_poolIndex = 0;
+        if (m_poolBytes <= maxRetainedBytes || usedAllPools) {
+            m_pool = m_pool->dealloc(m_firstChunk);
+            return;
+        }
+        m_allocator.stopAllocator();
+        m_pool = m_allocator.startAllocator();
+        m_poolCount = 1;
+        m_poolBytes = MINIMUM_BUMP_POOL_SIZE;
+    }
+
+    BumpPointerAllocator m_allocator;
+    BumpPointerPool* m_pool;
+    char* m_firstChunk;
+    char* m_chunkCurrent;
+    char* m_chunkEnd;
+    size_t m_chunkIndex;
+    size_t m_poolIndex;
+    size_t m_poolCount;
+    size_t m_poolBytes;
+    Slot* m_freeList;
+    size_t m_liveCount;
+    size_t m_allocationCount;
+    size_t m_poolAllocationCount;
+};
+
+} // namespace WTF
+
+// Routes new (arena) Class and delete of a Class to a TypedArena<Class>.
+#define WTF_MAKE_ARENA_ALLOCATED(className) \
+public: \
+    void* operator new(size_t, void* p) { return p; } \
+    void* operator new(size_t size, ::WTF::TypedArena<className>& arena) { return arena.allocate(size); } \
+    void operator delete(void* p, ::WTF::TypedArena<className>&) { ::WTF::TypedArena<className>::deallocate(p); } \
+    void* operator new(size_t size) { return ::WTF::TypedArena<className>::allocateWithoutArena(size); } \
+    void operator delete(void* p) { ::WTF::TypedArena<className>::deallocate(p); } \
+private: \
+typedef int ThisIsHereToForceASemicolonAfterThisMacro
+
+using WTF::TypedArena;
+
+#endif // TypedArena_h
@@ -35,6 +35,97 @@ using namespace Unicode;
 
 COMPILE_ASSERT(sizeof(AtomicString) == sizeof(String), atomic_string_and_string_must_be_same_size);
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
+// One table for the whole process. It is split into shards by hash, each with its own
+// lock, so that threads atomizing different strings seldom wait for each other.
+class AtomicStringTable {
+public:
+    struct Shard {
+        Mutex lock;
+        HashSet<StringImpl*> table;
+    };
+
+    static AtomicStringTable& shared()
+    {
+        // AtomicString::init() makes its first atoms on the main thread before any other
+        // thread can atomize a string, so this creates the table before it can race.
+        if (UNLIKELY(!s_shared))
+            s_shared = new AtomicStringTable;
+        return *s_shared;
+    }
+
+    Shard& shardForHash(unsigned hash)
+    {
+        // HashSet buckets on the low bits of the hash, so pick the shard from the high ones.
+        // StringHasher never sets the top bit.
+        return m_shards[(hash >> (31 - shardCountLog2)) & (shardCount - 1)];
+    }
+
+private:
+    static const unsigned shardCountLog2 = 4;
+    static const unsigned shardCount = 1 << shardCountLog2;
+
+    static AtomicStringTable* s_shared;
+
+    Shard m_shards[shardCount];
+};
+
+AtomicStringTable* AtomicStringTable::s_shared;
+
+// Hands the hash, computed once to pick a shard, on to the shard's table.
+template<typename T> struct HashedValue {
+    const T& value;
+    unsigned hash;
+};
+
+template<typename T, typename HashTranslator> struct HashedValueTranslator {
+    static unsigned hash(const HashedValue<T>& hashedValue) { return hashedValue.hash; }
+    static bool equal(StringImpl* const& string, const HashedValue<T>& hashedValue) { return HashTranslator::equal(string, hashedValue.value); }
+    static void translate(StringImpl*& location, const HashedValue<T>& hashedValue, unsigned hash) { HashTranslator::translate(location, hashedValue.value, hash); }
+};
+
+template<typename T, typename HashTranslator>
+static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
+{
+    HashedValue<T> hashedValue = { value, HashTranslator::hash(value) };
+    AtomicStringTable::Shard& shard = AtomicStringTable::shared().shardForHash(hashedValue.hash);
+
+    // An atom found in the table is reffed before the lock is released, so that the
+    // thread dropping its last reference can not delete it under us.
+    MutexLocker locker(shard.lock);
+    pair<HashSet<StringImpl*>::iterator, bool> addResult = shard.table.add<HashedValue<T>, HashedValueTranslator<T, HashTranslator> >(hashedValue);
+    return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
+}
+
+static inline PassRefPtr<StringImpl> addStringImplToStringTable(StringImpl* string)
+{
+    ASSERT(string->canBecomeSharedAtom());
+    AtomicStringTable::Shard& shard = AtomicStringTable::shared().shardForHash(string->hash());
+
+    MutexLocker locker(shard.lock);
+    StringImpl* result = *shard.table.add(string).first;
+    if (result == string)
+        string->setIsAtomic(true);
+    return result;
+}
+
+// The 16 bit copy of an 8 bit string is made without a lock, so shared atoms are always 16 bit.
+static inline PassRefPtr<StringImpl> createAtomString(const LChar* characters, unsigned length)
+{
+    UChar* data;
+    RefPtr<StringImpl> string = StringImpl::createUninitialized(length, data);
+    StringImpl::copyChars(data, characters, length);
+    return string.release();
+}
+
+static inline PassRefPtr<StringImpl> createAtomString(const UChar* characters, unsigned length)
+{
+    return StringImpl::create(characters, length);
+}
+
+#else
+
 class AtomicStringTable {
 public:
     static AtomicStringTable* create()
@@ -84,6 +175,18 @@ static inline PassRefPtr<StringImpl> addToStringTable(const T& value)
     return addResult.second ? adoptRef(*addResult.first) : *addResult.first;
 }
 
+static inline PassRefPtr<StringImpl> createAtomString(const LChar* characters, unsigned length)
+{
+    return StringImpl::create(characters, length);
+}
+
+static inline PassRefPtr<StringImpl> createAtomString(const UChar* characters, unsigned length)
+{
+    return StringImpl::create8BitIfPossible(characters, length);
+}
+
+#endif // ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
 struct CStringTranslator {
     static unsigned hash(const char* c)
     {
@@ -93,6 +196,15 @@ struct CStringTranslator {
     static bool equal(StringImpl* r, const char* s)
     {
         int length = r->length();
+        if (r->is8Bit()) {
+            const LChar* d = r->characters8();
+            for (int i = 0; i != length; ++i) {
+                if (d[i] != static_cast<LChar>(s[i]))
+                    return false;
+            }
+            return !s[length];
+        }
+
         const UChar* d = r->characters();
         for (int i = 0; i != length; ++i) {
             unsigned char c = s[i];
@@ -104,7 +216,7 @@ struct CStringTranslator {
 
     static void translate(StringImpl*& location, const char* const& c, unsigned hash)
     {
-        location = StringImpl::create(c).leakRef();
+        location = createAtomString(reinterpret_cast<const LChar*>(c), strlen(c)).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -113,9 +225,9 @@ struct CStringTranslator {
 bool operator==(const AtomicString& a, const char* b)
 { 
     StringImpl* impl = a.impl();
-    if ((!impl || !impl->characters()) && !b)
+    if (!impl && !b)
         return true;
-    if ((!impl || !impl->characters()) || !b)
+    if (!impl || !b)
         return false;
     return CStringTranslator::equal(impl, b); 
 }
@@ -140,6 +252,15 @@ static inline bool equal(StringImpl* string, const UChar* characters, unsigned l
     if (string->length() != length)
         return false;
 
+    if (string->is8Bit()) {
+        const LChar* stringCharacters = string->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            if (stringCharacters[i] != characters[i])
+                return false;
+        }
+        return true;
+    }
+
     // FIXME: perhaps we should have a more abstract macro that indicates when
     // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS) || CPU(SPARC)
@@ -186,7 +307,7 @@ struct UCharBufferTranslator {
 
     static void translate(StringImpl*& location, const UCharBuffer& buf, unsigned hash)
     {
-        location = StringImpl::create(buf.s, buf.length).leakRef();
+        location = createAtomString(buf.s, buf.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -212,7 +333,7 @@ struct HashAndCharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndCharacters& buffer, unsigned hash)
     {
-        location = StringImpl::create(buffer.characters, buffer.length).leakRef();
+        location = createAtomString(buffer.characters, buffer.length).leakRef();
         location->setHash(hash);
         location->setIsAtomic(true);
     }
@@ -236,15 +357,15 @@ struct HashAndUTF8CharactersTranslator {
         if (buffer.utf16Length != string->length())
             return false;
 
-        const UChar* stringCharacters = string->characters();
-
         // If buffer contains only ASCII characters UTF-8 and UTF16 length are the same.
-        if (buffer.utf16Length != buffer.length)
+        if (buffer.utf16Length != buffer.length) {
+            const UChar* stringCharacters = string->characters();
             return equalUTF16WithUTF8(stringCharacters, stringCharacters + string->length(), buffer.characters, buffer.characters + buffer.length);
+        }
 
         for (unsigned i = 0; i < buffer.length; ++i) {
             ASSERT(isASCII(buffer.characters[i]));
-            if (stringCharacters[i] != buffer.characters[i])
+            if ((*string)[i] != static_cast<LChar>(buffer.characters[i]))
                 return false;
         }
 
@@ -253,6 +374,13 @@ struct HashAndUTF8CharactersTranslator {
 
     static void translate(StringImpl*& location, const HashAndUTF8Characters& buffer, unsigned hash)
     {
+        if (buffer.utf16Length == buffer.length) {
+            location = createAtomString(reinterpret_cast<const LChar*>(buffer.characters), buffer.length).leakRef();
+            location->setHash(hash);
+            location->setIsAtomic(true);
+            return;
+        }
+
         UChar* target;
         location = StringImpl::createUninitialized(buffer.utf16Length, target).releaseRef();
 
@@ -313,13 +441,23 @@ PassRefPtr<StringImpl> AtomicString::addSlowCase(StringImpl* r)
     if (!r->length())
         return StringImpl::empty();
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    if (r->canBecomeSharedAtom())
+        return addStringImplToStringTable(r);
+
+    // Other threads could see changes to this string, or to strings it shares a buffer with,
+    // through the atom; atomize a copy of its characters instead.
+    RefPtr<StringImpl> copy = r->is8Bit() ? createAtomString(r->characters8(), r->length()) : createAtomString(r->characters(), r->length());
+    return addStringImplToStringTable(copy.get());
+#else
     StringImpl* result = *stringTable().add(r).first;
     if (result == r)
         r->setIsAtomic(true);
     return result;
+#endif
 }
 
-AtomicStringImpl* AtomicString::find(const UChar* s, unsigned length, unsigned existingHash)
+PassRefPtr<AtomicStringImpl> AtomicString::find(const UChar* s, unsigned length, unsigned existingHash)
 {
     ASSERT(s);
     ASSERT(existingHash);
@@ -328,17 +466,38 @@ AtomicStringImpl* AtomicString::find(const UChar* s, unsigned length, unsigned e
         return static_cast<AtomicStringImpl*>(StringImpl::empty());
 
     HashAndCharacters buffer = { existingHash, s, length }; 
-    HashSet<StringImpl*>::iterator iterator = stringTable().find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
-    if (iterator == stringTable().end())
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    AtomicStringTable::Shard& shard = AtomicStringTable::shared().shardForHash(existingHash);
+    MutexLocker locker(shard.lock);
+    HashSet<StringImpl*>& table = shard.table;
+#else
+    HashSet<StringImpl*>& table = stringTable();
+#endif
+    HashSet<StringImpl*>::iterator iterator = table.find<HashAndCharacters, HashAndCharactersTranslator>(buffer);
+    if (iterator == table.end())
         return 0;
-    return static_cast<AtomicStringImpl*>(*iterator);
+    // Ref the atom before the table is unlocked, another thread may be about to drop
+    // the last reference to it.
+    RefPtr<AtomicStringImpl> atom = static_cast<AtomicStringImpl*>(*iterator);
+    return atom.release();
 }
 
 void AtomicString::remove(StringImpl* r)
 {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    AtomicStringTable::shared().shardForHash(r->existingHash()).table.remove(r);
+#else
     stringTable().remove(r);
+#endif
 }
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+Mutex& AtomicString::tableLock(StringImpl* r)
+{
+    return AtomicStringTable::shared().shardForHash(r->existingHash()).lock;
+}
+#endif
+
 AtomicString AtomicString::lower() const
 {
     // Note: This is a hot function in the Dromaeo benchmark.
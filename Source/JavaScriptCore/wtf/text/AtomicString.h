@@ -35,6 +35,9 @@
 namespace WTF {
 
 struct AtomicStringHash;
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+class Mutex;
+#endif
 
 class AtomicString {
 public:
@@ -53,7 +56,7 @@ public:
     AtomicString(WTF::HashTableDeletedValueType) : m_string(WTF::HashTableDeletedValue) { }
     bool isHashTableDeletedValue() const { return m_string.isHashTableDeletedValue(); }
 
-    static AtomicStringImpl* find(const UChar* s, unsigned length, unsigned existingHash);
+    static PassRefPtr<AtomicStringImpl> find(const UChar* s, unsigned length, unsigned existingHash);
 
     operator const String&() const { return m_string; }
     const String& string() const { return m_string; };
@@ -94,6 +97,11 @@ public:
     bool isEmpty() const { return m_string.isEmpty(); }
 
     static void remove(StringImpl*);
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Guards the shard of the process-wide table that holds the atom. It must be
+    // held when removing the atom, and while dropping its last reference.
+    static Mutex& tableLock(StringImpl*);
+#endif
     
 #if USE(CF)
     AtomicString(CFStringRef s) :  m_string(add(String(s).impl())) { }
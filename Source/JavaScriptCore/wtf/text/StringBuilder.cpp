@@ -62,7 +62,7 @@ void StringBuilder::resize(unsigned newSize)
     // If there is a buffer, we only need to duplicate it if it has more than one ref.
     if (m_buffer) {
         if (!m_buffer->hasOneRef())
-            allocateBuffer(m_buffer->characters(), m_buffer->length());
+            reallocateBuffer(m_buffer->length());
         m_length = newSize;
         m_string = String();
         return;
@@ -81,30 +81,101 @@ void StringBuilder::reserveCapacity(unsigned newCapacity)
     if (m_buffer) {
         // If there is already a buffer, then grow if necessary.
         if (newCapacity > m_buffer->length())
-            allocateBuffer(m_buffer->characters(), newCapacity);
+            reallocateBuffer(newCapacity);
     } else {
         // Grow the string, if necessary.
         if (newCapacity > m_length)
-            allocateBuffer(m_string.characters(), newCapacity);
+            reallocateBuffer(newCapacity);
     }
 }
 
 // Allocate a new buffer, copying in currentCharacters (these may come from either m_string
 // or m_buffer,  neither will be reassigned until the copy has completed).
+void StringBuilder::allocateBuffer(const LChar* currentCharacters, unsigned requiredLength)
+{
+    ASSERT(m_is8Bit);
+    // Copy the existing data into a new buffer, set result to point to the end of the existing data.
+    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters8);
+    memcpy(m_bufferCharacters8, currentCharacters, static_cast<size_t>(m_length) * sizeof(LChar)); // This can't overflow.
+
+    // Update the builder state.
+    m_buffer = buffer.release();
+    m_string = String();
+}
+
 void StringBuilder::allocateBuffer(const UChar* currentCharacters, unsigned requiredLength)
 {
+    ASSERT(!m_is8Bit);
     // Copy the existing data into a new buffer, set result to point to the end of the existing data.
-    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters);
-    memcpy(m_bufferCharacters, currentCharacters, static_cast<size_t>(m_length) * sizeof(UChar)); // This can't overflow.
+    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters16);
+    memcpy(m_bufferCharacters16, currentCharacters, static_cast<size_t>(m_length) * sizeof(UChar)); // This can't overflow.
 
     // Update the builder state.
     m_buffer = buffer.release();
     m_string = String();
 }
 
+// Allocate a new 16 bit buffer, widening the 8 bit currentCharacters into it.
+void StringBuilder::allocateBufferUpconvert(const LChar* currentCharacters, unsigned requiredLength)
+{
+    ASSERT(m_is8Bit);
+    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters16);
+    for (unsigned i = 0; i < m_length; ++i)
+        m_bufferCharacters16[i] = currentCharacters[i];
+
+    m_is8Bit = false;
+    m_buffer = buffer.release();
+    m_string = String();
+}
+
+// Allocate a new buffer of the builder's character width, copying in its current contents.
+void StringBuilder::reallocateBuffer(unsigned requiredLength)
+{
+    if (m_buffer) {
+        if (m_is8Bit)
+            allocateBuffer(m_bufferCharacters8, requiredLength);
+        else
+            allocateBuffer(m_bufferCharacters16, requiredLength);
+        return;
+    }
+
+    ASSERT(m_string.length() == m_length);
+    if (!m_is8Bit) {
+        allocateBuffer(m_string.characters(), requiredLength);
+        return;
+    }
+    if (m_string.is8Bit()) {
+        allocateBuffer(m_string.characters8(), requiredLength);
+        return;
+    }
+
+    // m_string is the empty string, which is 16 bit.
+    const UChar* currentCharacters = m_string.characters();
+    RefPtr<StringImpl> buffer = StringImpl::createUninitialized(requiredLength, m_bufferCharacters8);
+    for (unsigned i = 0; i < m_length; ++i)
+        m_bufferCharacters8[i] = static_cast<LChar>(currentCharacters[i]);
+    m_buffer = buffer.release();
+    m_string = String();
+}
+
+template <>
+ALWAYS_INLINE LChar* StringBuilder::bufferCharacters<LChar>()
+{
+    ASSERT(m_is8Bit);
+    return m_bufferCharacters8;
+}
+
+template <>
+ALWAYS_INLINE UChar* StringBuilder::bufferCharacters<UChar>()
+{
+    ASSERT(!m_is8Bit);
+    return m_bufferCharacters16;
+}
+
 // Make 'length' additional capacity be available in m_buffer, update m_string & m_length,
 // return a pointer to the newly allocated storage.
-UChar* StringBuilder::appendUninitialized(unsigned length)
+template <typename CharType>
+CharType* StringBuilder::appendUninitialized(unsigned length)
 {
     ASSERT(length);
 
@@ -122,17 +193,17 @@ UChar* StringBuilder::appendUninitialized(unsigned length)
             unsigned currentLength = m_length;
             m_string = String();
             m_length = requiredLength;
-            return m_bufferCharacters + currentLength;
+            return bufferCharacters<CharType>() + currentLength;
         }
 
         // We need to realloc the buffer.
-        allocateBuffer(m_buffer->characters(), std::max(requiredLength, m_buffer->length() * 2));
+        reallocateBuffer(std::max(requiredLength, m_buffer->length() * 2));
     } else {
         ASSERT(m_string.length() == m_length);
-        allocateBuffer(m_string.characters(), std::max(requiredLength, requiredLength * 2));
+        reallocateBuffer(std::max(requiredLength, requiredLength * 2));
     }
 
-    UChar* result = m_bufferCharacters + m_length;
+    CharType* result = bufferCharacters<CharType>() + m_length;
     m_length = requiredLength;
     return result;
 }
@@ -143,28 +214,54 @@ void StringBuilder::append(const UChar* characters, unsigned length)
         return;
     ASSERT(characters);
 
-    memcpy(appendUninitialized(length), characters, static_cast<size_t>(length) * 2);
+    if (m_is8Bit) {
+        // Appending 16 bit characters widens the ones held so far.
+        unsigned requiredLength = length + m_length;
+        if (requiredLength < length)
+            CRASH();
+        if (m_buffer)
+            allocateBufferUpconvert(m_bufferCharacters8, std::max(requiredLength, m_buffer->length()));
+        else if (m_string.is8Bit())
+            allocateBufferUpconvert(m_string.characters8(), requiredLength);
+        else {
+            m_is8Bit = false;
+            allocateBuffer(m_string.characters(), requiredLength);
+        }
+    }
+
+    memcpy(appendUninitialized<UChar>(length), characters, static_cast<size_t>(length) * 2);
 }
 
-void StringBuilder::append(const char* characters, unsigned length)
+void StringBuilder::append(const LChar* characters, unsigned length)
 {
     if (!length)
         return;
     ASSERT(characters);
 
-    UChar* dest = appendUninitialized(length);
-    const char* end = characters + length;
+    if (m_is8Bit) {
+        memcpy(appendUninitialized<LChar>(length), characters, static_cast<size_t>(length));
+        return;
+    }
+
+    UChar* dest = appendUninitialized<UChar>(length);
+    const LChar* end = characters + length;
     while (characters < end)
-        *(dest++) = *(const unsigned char*)(characters++);
+        *(dest++) = *(characters++);
 }
 
 void StringBuilder::shrinkToFit()
 {
     // If the buffer is at least 80% full, don't bother copying. Need to tune this heuristic!
     if (m_buffer && m_buffer->length() > (m_length + (m_length >> 2))) {
-        UChar* result;
-        m_string = StringImpl::createUninitialized(m_length, result);
-        memcpy(result, m_buffer->characters(), static_cast<size_t>(m_length) * 2); // This can't overflow.
+        if (m_is8Bit) {
+            LChar* result;
+            m_string = StringImpl::createUninitialized(m_length, result);
+            memcpy(result, m_bufferCharacters8, static_cast<size_t>(m_length)); // This can't overflow.
+        } else {
+            UChar* result;
+            m_string = StringImpl::createUninitialized(m_length, result);
+            memcpy(result, m_bufferCharacters16, static_cast<size_t>(m_length) * 2); // This can't overflow.
+        }
         m_buffer = 0;
     }
 }
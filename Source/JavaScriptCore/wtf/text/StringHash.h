@@ -53,6 +53,9 @@ namespace WTF {
             if (aLength != bLength)
                 return false;
 
+            if (a->is8Bit() || b->is8Bit())
+                return equalWith8Bit(a, b);
+
             // FIXME: perhaps we should have a more abstract macro that indicates when
             // going 4 bytes at a time is unsafe
 #if CPU(ARM) || CPU(SH4) || CPU(MIPS)
@@ -109,6 +112,8 @@ namespace WTF {
 
         static unsigned hash(StringImpl* str)
         {
+            if (str->is8Bit())
+                return StringHasher::computeHash<LChar, foldCase<LChar> >(str->characters8(), str->length());
             return hash(str->characters(), str->length());
         }
 
@@ -126,7 +131,22 @@ namespace WTF {
             unsigned length = a->length();
             if (length != b->length())
                 return false;
-            return WTF::Unicode::umemcasecmp(a->characters(), b->characters(), length) == 0;
+            if (a->is8Bit() || b->is8Bit()) {
+                unsigned i;
+                if (a->is8Bit() && b->is8Bit())
+                    i = StringSIMD::equalIgnoringASCIICasePrefixLength(a->characters8(), b->characters8(), length);
+                else if (a->is8Bit())
+                    i = StringSIMD::equalIgnoringASCIICasePrefixLength(b->characters(), a->characters8(), length);
+                else
+                    i = StringSIMD::equalIgnoringASCIICasePrefixLength(a->characters(), b->characters8(), length);
+                for (; i < length; ++i) {
+                    if (foldCase((*a)[i]) != foldCase((*b)[i]))
+                        return false;
+                }
+                return true;
+            }
+            unsigned prefixLength = StringSIMD::equalIgnoringASCIICasePrefixLength(a->characters(), b->characters(), length);
+            return WTF::Unicode::umemcasecmp(a->characters() + prefixLength, b->characters() + prefixLength, length - prefixLength) == 0;
         }
 
         static unsigned hash(const RefPtr<StringImpl>& key) 
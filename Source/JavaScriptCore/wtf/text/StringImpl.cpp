@@ -29,8 +29,13 @@
 #include "StringBuffer.h"
 #include "StringHash.h"
 #include <wtf/StdLibExtras.h>
+#include <wtf/Threading.h>
 #include <wtf/WTFThreadData.h>
 
+#if DUMP_STRING_STATS
+#include <stdio.h>
+#endif
+
 using namespace std;
 
 namespace WTF {
@@ -39,7 +44,30 @@ using namespace Unicode;
 
 static const unsigned minLengthToShare = 20;
 
-COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 3 * sizeof(void*), StringImpl_should_stay_small);
+COMPILE_ASSERT(sizeof(StringImpl) == 2 * sizeof(int) + 4 * sizeof(void*), StringImpl_should_stay_small);
+
+#if DUMP_STRING_STATS
+unsigned StringStats::numberOf8BitStrings;
+unsigned long long StringStats::numberOf8BitCharacters;
+unsigned StringStats::numberOf16BitStrings;
+unsigned long long StringStats::numberOf16BitCharacters;
+unsigned StringStats::numberOfUpconvertedStrings;
+unsigned long long StringStats::numberOfUpconvertedCharacters;
+
+static StringStats logger;
+
+StringStats::~StringStats()
+{
+    // The characters of the 8 bit strings would have taken twice the bytes as 16 bit strings.
+    unsigned long long bytes = numberOf8BitCharacters + 2 * (numberOf16BitCharacters + numberOfUpconvertedCharacters);
+    unsigned long long bytesWithout8Bit = 2 * (numberOf8BitCharacters + numberOf16BitCharacters);
+    printf("\nWTF::StringImpl statistics\n\n");
+    printf("%u 8 bit strings with %llu characters\n", numberOf8BitStrings, numberOf8BitCharacters);
+    printf("%u 16 bit strings with %llu characters\n", numberOf16BitStrings, numberOf16BitCharacters);
+    printf("%u 8 bit strings widened to 16 bits, with %llu characters\n", numberOfUpconvertedStrings, numberOfUpconvertedCharacters);
+    printf("%llu bytes of characters allocated, %llu if all strings were 16 bit\n", bytes, bytesWithout8Bit);
+}
+#endif
 
 StringImpl::~StringImpl()
 {
@@ -54,9 +82,13 @@ StringImpl::~StringImpl()
     }
 #endif
 
+    if (is8Bit() && m_copyData16)
+        fastFree(m_copyData16);
+
     BufferOwnership ownership = bufferOwnership();
     if (ownership != BufferInternal) {
         if (ownership == BufferOwned) {
+            ASSERT(!is8Bit());
             ASSERT(!m_sharedBuffer);
             ASSERT(m_data);
             fastFree(const_cast<UChar*>(m_data));
@@ -87,9 +119,33 @@ PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, UChar*&
     StringImpl* string = static_cast<StringImpl*>(fastMalloc(size));
 
     data = reinterpret_cast<UChar*>(string + 1);
+#if DUMP_STRING_STATS
+    ++StringStats::numberOf16BitStrings;
+    StringStats::numberOf16BitCharacters += length;
+#endif
     return adoptRef(new (string) StringImpl(length));
 }
 
+PassRefPtr<StringImpl> StringImpl::createUninitialized(unsigned length, LChar*& data)
+{
+    if (!length) {
+        data = 0;
+        return empty();
+    }
+
+    if (length > ((std::numeric_limits<unsigned>::max() - sizeof(StringImpl)) / sizeof(LChar)))
+        CRASH();
+    size_t size = sizeof(StringImpl) + length * sizeof(LChar);
+    StringImpl* string = static_cast<StringImpl*>(fastMalloc(size));
+
+    data = reinterpret_cast<LChar*>(string + 1);
+#if DUMP_STRING_STATS
+    ++StringStats::numberOf8BitStrings;
+    StringStats::numberOf8BitCharacters += length;
+#endif
+    return adoptRef(new (string) StringImpl(length, Force8BitConstructor));
+}
+
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length)
 {
     if (!characters || !length)
@@ -101,17 +157,32 @@ PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned leng
     return string.release();
 }
 
-PassRefPtr<StringImpl> StringImpl::create(const char* characters, unsigned length)
+PassRefPtr<StringImpl> StringImpl::create(const LChar* characters, unsigned length)
 {
     if (!characters || !length)
         return empty();
 
-    UChar* data;
+    LChar* data;
     RefPtr<StringImpl> string = createUninitialized(length, data);
-    for (unsigned i = 0; i != length; ++i) {
-        unsigned char c = characters[i];
-        data[i] = c;
-    }
+    memcpy(data, characters, length * sizeof(LChar));
+    return string.release();
+}
+
+PassRefPtr<StringImpl> StringImpl::create8BitIfPossible(const UChar* characters, unsigned length)
+{
+    if (!characters || !length)
+        return empty();
+
+    UChar ored = 0;
+    for (unsigned i = 0; i < length; ++i)
+        ored |= characters[i];
+    if (ored & ~0xFF)
+        return create(characters, length);
+
+    LChar* data;
+    RefPtr<StringImpl> string = createUninitialized(length, data);
+    for (unsigned i = 0; i < length; ++i)
+        data[i] = static_cast<LChar>(characters[i]);
     return string.release();
 }
 
@@ -122,8 +193,36 @@ PassRefPtr<StringImpl> StringImpl::create(const char* string)
     size_t length = strlen(string);
     if (length > numeric_limits<unsigned>::max())
         CRASH();
-    return create(string, length);
+    return create(reinterpret_cast<const LChar*>(string), length);
+}
+
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+void StringImpl::derefAtomic()
+{
+    ASSERT(isAtomic());
+    ASSERT(!isStatic());
+
+    // Dropping a reference other than the last one does not need the table.
+    while (true) {
+        unsigned oldValue = m_refCountAndFlags;
+        if ((oldValue & s_refCountMask) == s_refCountIncrement)
+            break;
+        if (weakCompareAndSwap(&m_refCountAndFlags, oldValue, oldValue - s_refCountIncrement))
+            return;
+    }
+
+    // Drop the last reference with the table locked, so that no other thread can find the
+    // atom and ref it while it is removed. One that found it before the lock keeps it alive.
+    {
+        MutexLocker locker(AtomicString::tableLock(this));
+        if ((atomicallyUpdateRefCountAndFlags(-s_refCountIncrement) & s_refCountMask) != s_refCountIncrement)
+            return;
+        AtomicString::remove(this);
+        setIsAtomic(false);
+    }
+    delete this;
 }
+#endif
 
 PassRefPtr<StringImpl> StringImpl::create(const UChar* characters, unsigned length, PassRefPtr<SharedUChar> sharedBuffer)
 {
@@ -139,6 +238,14 @@ SharedUChar* StringImpl::sharedBuffer()
     // All static strings are smaller that the minimim length to share.
     ASSERT(!isStatic());
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Atoms can be in use on other threads, so they must not change their buffer.
+    if (isAtomic())
+        return 0;
+#endif
+
+    // 8 bit strings have internal buffers, or are substrings of strings that do, so none
+    // of them are shared.
     BufferOwnership ownership = bufferOwnership();
 
     if (ownership == BufferInternal)
@@ -146,6 +253,7 @@ SharedUChar* StringImpl::sharedBuffer()
     if (ownership == BufferSubstring)
         return m_substringBuffer->sharedBuffer();
     if (ownership == BufferOwned) {
+        ASSERT(!is8Bit());
         ASSERT(!m_sharedBuffer);
         m_sharedBuffer = SharedUChar::create(new SharableUChar(m_data)).leakRef();
         m_refCountAndFlags = (m_refCountAndFlags & ~s_refCountMaskBufferOwnership) | BufferShared;
@@ -161,6 +269,13 @@ bool StringImpl::containsOnlyWhitespace()
     // FIXME: The definition of whitespace here includes a number of characters
     // that are not whitespace from the point of view of RenderText; I wonder if
     // that's a problem in practice.
+    if (is8Bit()) {
+        for (unsigned i = 0; i < m_length; i++)
+            if (!isASCIISpace(m_data8[i]))
+                return false;
+        return true;
+    }
+
     for (unsigned i = 0; i < m_length; i++)
         if (!isASCIISpace(m_data[i]))
             return false;
@@ -177,11 +292,15 @@ PassRefPtr<StringImpl> StringImpl::substring(unsigned start, unsigned length)
             return this;
         length = maxLength;
     }
+    if (is8Bit())
+        return create(m_data8 + start, length);
     return create(m_data + start, length);
 }
 
 UChar32 StringImpl::characterStartingAt(unsigned i)
 {
+    if (is8Bit())
+        return m_data8[i];
     if (U16_IS_SINGLE(m_data[i]))
         return m_data[i];
     if (i + 1 < m_length && U16_IS_LEAD(m_data[i]) && U16_IS_TRAIL(m_data[i + 1]))
@@ -194,6 +313,9 @@ PassRefPtr<StringImpl> StringImpl::lower()
     // Note: This is a hot function in the Dromaeo benchmark, specifically the
     // no-op code path up through the first 'return' statement.
     
+    if (is8Bit())
+        return lower8Bit();
+
     // First scan the string for uppercase and non-ASCII characters:
     UChar ored = 0;
     bool noUpper = true;
@@ -236,11 +358,42 @@ PassRefPtr<StringImpl> StringImpl::lower()
     return newImpl;
 }
 
+PassRefPtr<StringImpl> StringImpl::lower8Bit()
+{
+    ASSERT(is8Bit());
+
+    LChar ored = 0;
+    bool noUpper = true;
+    for (unsigned i = 0; i < m_length; ++i) {
+        if (UNLIKELY(isASCIIUpper(m_data8[i])))
+            noUpper = false;
+        ored |= m_data8[i];
+    }
+
+    if (noUpper && !(ored & ~0x7F))
+        return this;
+
+    LChar* data;
+    RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
+
+    if (!(ored & ~0x7F)) {
+        for (unsigned i = 0; i < m_length; ++i)
+            data[i] = toASCIILower(m_data8[i]);
+        return newImpl.release();
+    }
+
+    // The lower case of every Latin-1 character is also Latin-1.
+    for (unsigned i = 0; i < m_length; ++i)
+        data[i] = static_cast<LChar>(Unicode::toLower(static_cast<UChar>(m_data8[i])));
+    return newImpl.release();
+}
+
 PassRefPtr<StringImpl> StringImpl::upper()
 {
     // This function could be optimized for no-op cases the way lower() is,
     // but in empirical testing, few actual calls to upper() are no-ops, so
     // it wouldn't be worth the extra time for pre-scanning.
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -251,7 +404,7 @@ PassRefPtr<StringImpl> StringImpl::upper()
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIIUpper(c);
     }
@@ -260,11 +413,11 @@ PassRefPtr<StringImpl> StringImpl::upper()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::toUpper(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::toUpper(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl;
     newImpl = createUninitialized(realLength, data);
-    Unicode::toUpper(data, realLength, m_data, m_length, &error);
+    Unicode::toUpper(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -280,12 +433,13 @@ PassRefPtr<StringImpl> StringImpl::secure(UChar character, LastCharacterBehavior
     unsigned lastCharacterIndex = m_length - 1;
     for (unsigned i = 0; i < lastCharacterIndex; ++i)
         data[i] = character;
-    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : m_data[lastCharacterIndex];
+    data[lastCharacterIndex] = (behavior == ObscureLastCharacter) ? character : (*this)[lastCharacterIndex];
     return newImpl.release();
 }
 
 PassRefPtr<StringImpl> StringImpl::foldCase()
 {
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
@@ -296,7 +450,7 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
     // Do a faster loop for the case where all the characters are ASCII.
     UChar ored = 0;
     for (int32_t i = 0; i < length; i++) {
-        UChar c = m_data[i];
+        UChar c = characters[i];
         ored |= c;
         data[i] = toASCIILower(c);
     }
@@ -305,11 +459,11 @@ PassRefPtr<StringImpl> StringImpl::foldCase()
 
     // Do a slower implementation for cases that include non-ASCII characters.
     bool error;
-    int32_t realLength = Unicode::foldCase(data, length, m_data, m_length, &error);
+    int32_t realLength = Unicode::foldCase(data, length, characters, m_length, &error);
     if (!error && realLength == length)
         return newImpl.release();
     newImpl = createUninitialized(realLength, data);
-    Unicode::foldCase(data, realLength, m_data, m_length, &error);
+    Unicode::foldCase(data, realLength, characters, m_length, &error);
     if (error)
         return this;
     return newImpl.release();
@@ -324,7 +478,7 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
     unsigned end = m_length - 1;
     
     // skip white space from start
-    while (start <= end && isSpaceOrNewline(m_data[start]))
+    while (start <= end && isSpaceOrNewline((*this)[start]))
         start++;
     
     // only white space
@@ -332,17 +486,20 @@ PassRefPtr<StringImpl> StringImpl::stripWhiteSpace()
         return empty();
 
     // skip white space from end
-    while (end && isSpaceOrNewline(m_data[end]))
+    while (end && isSpaceOrNewline((*this)[end]))
         end--;
 
     if (!start && end == m_length - 1)
         return this;
+    if (is8Bit())
+        return create(m_data8 + start, end + 1 - start);
     return create(m_data + start, end + 1 - start);
 }
 
 PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr findMatch)
 {
-    const UChar* from = m_data;
+    const UChar* characters = this->characters();
+    const UChar* from = characters;
     const UChar* fromend = from + m_length;
 
     // Assume the common case will not remove any characters
@@ -353,10 +510,10 @@ PassRefPtr<StringImpl> StringImpl::removeCharacters(CharacterMatchFunctionPtr fi
 
     StringBuffer data(m_length);
     UChar* to = data.characters();
-    unsigned outc = from - m_data;
+    unsigned outc = from - characters;
 
     if (outc)
-        memcpy(to, m_data, outc * sizeof(UChar));
+        memcpy(to, characters, outc * sizeof(UChar));
 
     while (true) {
         while (from != fromend && findMatch(*from))
@@ -376,7 +533,7 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 {
     StringBuffer data(m_length);
 
-    const UChar* from = m_data;
+    const UChar* from = characters();
     const UChar* fromend = from + m_length;
     int outc = 0;
     bool changedToSpace = false;
@@ -410,62 +567,62 @@ PassRefPtr<StringImpl> StringImpl::simplifyWhiteSpace()
 
 int StringImpl::toIntStrict(bool* ok, int base)
 {
-    return charactersToIntStrict(m_data, m_length, ok, base);
+    return charactersToIntStrict(characters(), m_length, ok, base);
 }
 
 unsigned StringImpl::toUIntStrict(bool* ok, int base)
 {
-    return charactersToUIntStrict(m_data, m_length, ok, base);
+    return charactersToUIntStrict(characters(), m_length, ok, base);
 }
 
 int64_t StringImpl::toInt64Strict(bool* ok, int base)
 {
-    return charactersToInt64Strict(m_data, m_length, ok, base);
+    return charactersToInt64Strict(characters(), m_length, ok, base);
 }
 
 uint64_t StringImpl::toUInt64Strict(bool* ok, int base)
 {
-    return charactersToUInt64Strict(m_data, m_length, ok, base);
+    return charactersToUInt64Strict(characters(), m_length, ok, base);
 }
 
 intptr_t StringImpl::toIntPtrStrict(bool* ok, int base)
 {
-    return charactersToIntPtrStrict(m_data, m_length, ok, base);
+    return charactersToIntPtrStrict(characters(), m_length, ok, base);
 }
 
 int StringImpl::toInt(bool* ok)
 {
-    return charactersToInt(m_data, m_length, ok);
+    return charactersToInt(characters(), m_length, ok);
 }
 
 unsigned StringImpl::toUInt(bool* ok)
 {
-    return charactersToUInt(m_data, m_length, ok);
+    return charactersToUInt(characters(), m_length, ok);
 }
 
 int64_t StringImpl::toInt64(bool* ok)
 {
-    return charactersToInt64(m_data, m_length, ok);
+    return charactersToInt64(characters(), m_length, ok);
 }
 
 uint64_t StringImpl::toUInt64(bool* ok)
 {
-    return charactersToUInt64(m_data, m_length, ok);
+    return charactersToUInt64(characters(), m_length, ok);
 }
 
 intptr_t StringImpl::toIntPtr(bool* ok)
 {
-    return charactersToIntPtr(m_data, m_length, ok);
+    return charactersToIntPtr(characters(), m_length, ok);
 }
 
 double StringImpl::toDouble(bool* ok, bool* didReadNumber)
 {
-    return charactersToDouble(m_data, m_length, ok, didReadNumber);
+    return charactersToDouble(characters(), m_length, ok, didReadNumber);
 }
 
 float StringImpl::toFloat(bool* ok, bool* didReadNumber)
 {
-    return charactersToFloat(m_data, m_length, ok, didReadNumber);
+    return charactersToFloat(characters(), m_length, ok, didReadNumber);
 }
 
 static bool equal(const UChar* a, const char* b, int length)
@@ -481,6 +638,10 @@ static bool equal(const UChar* a, const char* b, int length)
 
 bool equalIgnoringCase(const UChar* a, const char* b, unsigned length)
 {
+    unsigned prefixLength = StringSIMD::equalIgnoringASCIICasePrefixLength(a, reinterpret_cast<const LChar*>(b), length);
+    a += prefixLength;
+    b += prefixLength;
+    length -= prefixLength;
     while (length--) {
         unsigned char bc = *b++;
         if (foldCase(*a++) != foldCase(bc))
@@ -492,7 +653,8 @@ bool equalIgnoringCase(const UChar* a, const char* b, unsigned length)
 static inline bool equalIgnoringCase(const UChar* a, const UChar* b, int length)
 {
     ASSERT(length >= 0);
-    return umemcasecmp(a, b, length) == 0;
+    unsigned prefixLength = StringSIMD::equalIgnoringASCIICasePrefixLength(a, b, length);
+    return umemcasecmp(a + prefixLength, b + prefixLength, length - prefixLength) == 0;
 }
 
 int codePointCompare(const StringImpl* s1, const StringImpl* s2)
@@ -520,11 +682,23 @@ int codePointCompare(const StringImpl* s1, const StringImpl* s2)
 
 size_t StringImpl::find(UChar c, unsigned start)
 {
+    if (is8Bit()) {
+        if (c & ~0xFF)
+            return notFound;
+        return StringSIMD::find(m_data8, m_length, static_cast<LChar>(c), start);
+    }
     return WTF::find(m_data, m_length, c, start);
 }
 
 size_t StringImpl::find(CharacterMatchFunctionPtr matchFunction, unsigned start)
 {
+    if (is8Bit()) {
+        for (unsigned i = start; i < m_length; ++i) {
+            if (matchFunction(m_data8[i]))
+                return i;
+        }
+        return notFound;
+    }
     return WTF::find(m_data, m_length, matchFunction, start);
 }
 
@@ -542,7 +716,7 @@ size_t StringImpl::find(const char* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::find(characters(), length(), *(const unsigned char*)matchString, index);
+        return find(static_cast<UChar>(*(const unsigned char*)matchString), index);
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -621,7 +795,7 @@ size_t StringImpl::find(StringImpl* matchString, unsigned index)
 
     // Optimization 1: fast case for strings of length 1.
     if (matchLength == 1)
-        return WTF::find(characters(), length(), matchString->characters()[0], index);
+        return find((*matchString)[0], index);
 
     // Check index & matchLength are in range.
     if (index > length())
@@ -689,7 +863,7 @@ size_t StringImpl::findIgnoringCase(StringImpl* matchString, unsigned index)
 
 size_t StringImpl::reverseFind(UChar c, unsigned index)
 {
-    return WTF::reverseFind(m_data, m_length, c, index);
+    return WTF::reverseFind(characters(), m_length, c, index);
 }
 
 size_t StringImpl::reverseFind(StringImpl* matchString, unsigned index)
@@ -775,18 +949,16 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar oldC, UChar newC)
 {
     if (oldC == newC)
         return this;
-    unsigned i;
-    for (i = 0; i != m_length; ++i)
-        if (m_data[i] == oldC)
-            break;
-    if (i == m_length)
+    size_t i = find(oldC);
+    if (i == notFound)
         return this;
 
+    const UChar* characters = this->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(m_length, data);
 
     for (i = 0; i != m_length; ++i) {
-        UChar ch = m_data[i];
+        UChar ch = characters[i];
         if (ch == oldC)
             ch = newC;
         data[i] = ch;
@@ -845,6 +1017,8 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
 
     newSize += replaceSize;
 
+    const UChar* characters = this->characters();
+    const UChar* replacementCharacters = replacement->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(newSize, data);
 
@@ -856,15 +1030,15 @@ PassRefPtr<StringImpl> StringImpl::replace(UChar pattern, StringImpl* replacemen
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacementCharacters, repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + 1;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -903,6 +1077,8 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
 
     newSize += matchCount * repStrLength;
 
+    const UChar* characters = this->characters();
+    const UChar* replacementCharacters = replacement->characters();
     UChar* data;
     RefPtr<StringImpl> newImpl = createUninitialized(newSize, data);
     
@@ -914,15 +1090,15 @@ PassRefPtr<StringImpl> StringImpl::replace(StringImpl* pattern, StringImpl* repl
     
     while ((srcSegmentEnd = find(pattern, srcSegmentStart)) != notFound) {
         srcSegmentLength = srcSegmentEnd - srcSegmentStart;
-        memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+        memcpy(data + dstOffset, characters + srcSegmentStart, srcSegmentLength * sizeof(UChar));
         dstOffset += srcSegmentLength;
-        memcpy(data + dstOffset, replacement->m_data, repStrLength * sizeof(UChar));
+        memcpy(data + dstOffset, replacementCharacters, repStrLength * sizeof(UChar));
         dstOffset += repStrLength;
         srcSegmentStart = srcSegmentEnd + patternLength;
     }
 
     srcSegmentLength = m_length - srcSegmentStart;
-    memcpy(data + dstOffset, m_data + srcSegmentStart, srcSegmentLength * sizeof(UChar));
+    memcpy(data + dstOffset, characters + srcSegmentStart, srcSegmentLength * sizeof(UChar));
 
     ASSERT(dstOffset + srcSegmentLength == newImpl->length());
 
@@ -934,6 +1110,20 @@ bool equal(const StringImpl* a, const StringImpl* b)
     return StringHash::equal(a, b);
 }
 
+bool equalWith8Bit(const StringImpl* a, const StringImpl* b)
+{
+    ASSERT(a->length() == b->length());
+    ASSERT(a->is8Bit() || b->is8Bit());
+
+    unsigned length = a->length();
+    if (a->is8Bit() && b->is8Bit())
+        return !memcmp(a->characters8(), b->characters8(), length);
+
+    if (b->is8Bit())
+        std::swap(a, b);
+    return StringSIMD::equal(a->characters8(), b->characters(), length);
+}
+
 bool equal(const StringImpl* a, const char* b)
 {
     if (!a)
@@ -942,6 +1132,16 @@ bool equal(const StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc || as[i] != bc)
+                return false;
+        }
+        return !b[length];
+    }
+
     const UChar* as = a->characters();
     for (unsigned i = 0; i != length; ++i) {
         unsigned char bc = b[i];
@@ -967,6 +1167,16 @@ bool equalIgnoringCase(StringImpl* a, const char* b)
         return !a;
 
     unsigned length = a->length();
+    if (a->is8Bit()) {
+        const LChar* as = a->characters8();
+        for (unsigned i = 0; i != length; ++i) {
+            LChar bc = b[i];
+            if (!bc || foldCase(as[i]) != foldCase(bc))
+                return false;
+        }
+        return !b[length];
+    }
+
     const UChar* as = a->characters();
 
     // Do a faster loop for the case where all the characters are ASCII.
@@ -1008,7 +1218,7 @@ bool equalIgnoringNullity(StringImpl* a, StringImpl* b)
 WTF::Unicode::Direction StringImpl::defaultWritingDirection(bool* hasStrongDirectionality)
 {
     for (unsigned i = 0; i < m_length; ++i) {
-        WTF::Unicode::Direction charDirection = WTF::Unicode::direction(m_data[i]);
+        WTF::Unicode::Direction charDirection = WTF::Unicode::direction((*this)[i]);
         if (charDirection == WTF::Unicode::LeftToRight) {
             if (hasStrongDirectionality)
                 *hasStrongDirectionality = true;
@@ -1025,6 +1235,23 @@ WTF::Unicode::Direction StringImpl::defaultWritingDirection(bool* hasStrongDirec
     return WTF::Unicode::LeftToRight;
 }
 
+const UChar* StringImpl::getData16SlowCase() const
+{
+    ASSERT(is8Bit());
+    ASSERT(!m_copyData16);
+
+    if (m_length > numeric_limits<unsigned>::max() / sizeof(UChar))
+        CRASH();
+    m_copyData16 = static_cast<UChar*>(fastMalloc(m_length * sizeof(UChar)));
+    for (unsigned i = 0; i < m_length; ++i)
+        m_copyData16[i] = m_data8[i];
+#if DUMP_STRING_STATS
+    ++StringStats::numberOfUpconvertedStrings;
+    StringStats::numberOfUpconvertedCharacters += m_length;
+#endif
+    return m_copyData16;
+}
+
 // This is a hot function because it's used when parsing HTML.
 PassRefPtr<StringImpl> StringImpl::createStrippingNullCharactersSlowCase(const UChar* characters, unsigned length)
 {
@@ -1056,7 +1283,7 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
     if (length >= numeric_limits<unsigned>::max())
         CRASH();
     RefPtr<StringImpl> terminatedString = createUninitialized(length + 1, data);
-    memcpy(data, string.m_data, length * sizeof(UChar));
+    memcpy(data, string.characters(), length * sizeof(UChar));
     data[length] = 0;
     terminatedString->m_length--;
     terminatedString->m_hash = string.m_hash;
@@ -1066,11 +1293,22 @@ PassRefPtr<StringImpl> StringImpl::createWithTerminatingNullCharacter(const Stri
 
 PassRefPtr<StringImpl> StringImpl::threadsafeCopy() const
 {
+    if (is8Bit())
+        return create(m_data8, m_length);
     return create(m_data, m_length);
 }
 
 PassRefPtr<StringImpl> StringImpl::crossThreadString()
 {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Atoms are in the process-wide table and never change, so any thread can use them as they are.
+    if (isAtomic())
+        return this;
+#endif
+
+    if (is8Bit())
+        return threadsafeCopy();
+
     if (SharedUChar* sharedBuffer = this->sharedBuffer())
         return adoptRef(new StringImpl(m_data, m_length, sharedBuffer->crossThreadCopy()));
 
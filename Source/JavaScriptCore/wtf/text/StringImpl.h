@@ -34,6 +34,10 @@
 #include <wtf/text/StringImplBase.h>
 #include <wtf/unicode/Unicode.h>
 
+// Counts the characters of the strings created with 8 and 16 bit buffers, and of the
+// 8 bit strings widened to 16 bits, printing them on exit.
+#define DUMP_STRING_STATS 0
+
 #if USE(CF)
 typedef const struct __CFString * CFStringRef;
 #endif
@@ -62,6 +66,19 @@ typedef OwnFastMallocPtr<const UChar> SharableUChar;
 typedef CrossThreadRefCounted<SharableUChar> SharedUChar;
 typedef bool (*CharacterMatchFunctionPtr)(UChar);
 
+#if DUMP_STRING_STATS
+struct StringStats {
+    ~StringStats();
+    // All of the variables are accessed in ~StringStats when the static struct is destroyed.
+    static unsigned numberOf8BitStrings;
+    static unsigned long long numberOf8BitCharacters;
+    static unsigned numberOf16BitStrings;
+    static unsigned long long numberOf16BitCharacters;
+    static unsigned numberOfUpconvertedStrings;
+    static unsigned long long numberOfUpconvertedCharacters;
+};
+#endif
+
 class StringImpl : public StringImplBase {
     friend struct JSC::IdentifierCStringTranslator;
     friend struct JSC::IdentifierUCharBufferTranslator;
@@ -78,6 +95,7 @@ private:
         : StringImplBase(length, ConstructStaticString)
         , m_data(characters)
         , m_buffer(0)
+        , m_copyData16(0)
         , m_hash(0)
     {
         // Ensure that the hash is computed so that AtomicStringHash can call existingHash()
@@ -91,17 +109,33 @@ private:
         : StringImplBase(length, BufferInternal)
         , m_data(reinterpret_cast<const UChar*>(this + 1))
         , m_buffer(0)
+        , m_copyData16(0)
         , m_hash(0)
     {
         ASSERT(m_data);
         ASSERT(m_length);
     }
 
+    // Create a normal string with internal storage of 8 bit (Latin-1) characters (BufferInternal)
+    enum Force8Bit { Force8BitConstructor };
+    StringImpl(unsigned length, Force8Bit)
+        : StringImplBase(length, BufferInternal)
+        , m_data8(reinterpret_cast<const LChar*>(this + 1))
+        , m_buffer(0)
+        , m_copyData16(0)
+        , m_hash(0)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
+    }
+
     // Create a StringImpl adopting ownership of the provided buffer (BufferOwned)
     StringImpl(const UChar* characters, unsigned length)
         : StringImplBase(length, BufferOwned)
         , m_data(characters)
         , m_buffer(0)
+        , m_copyData16(0)
         , m_hash(0)
     {
         ASSERT(m_data);
@@ -113,6 +147,7 @@ private:
         : StringImplBase(length, BufferSubstring)
         , m_data(characters)
         , m_substringBuffer(base.leakRef())
+        , m_copyData16(0)
         , m_hash(0)
     {
         ASSERT(m_data);
@@ -120,11 +155,26 @@ private:
         ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
     }
 
+    // Used to create new strings that are a substring of an existing 8 bit StringImpl (BufferSubstring)
+    StringImpl(const LChar* characters, unsigned length, PassRefPtr<StringImpl> base)
+        : StringImplBase(length, BufferSubstring)
+        , m_data8(characters)
+        , m_substringBuffer(base.leakRef())
+        , m_copyData16(0)
+        , m_hash(0)
+    {
+        ASSERT(m_data8);
+        ASSERT(m_length);
+        ASSERT(m_substringBuffer->bufferOwnership() != BufferSubstring);
+        m_refCountAndFlags |= s_refCountFlagIs8Bit;
+    }
+
     // Used to construct new strings sharing an existing SharedUChar (BufferShared)
     StringImpl(const UChar* characters, unsigned length, PassRefPtr<SharedUChar> sharedBuffer)
         : StringImplBase(length, BufferShared)
         , m_data(characters)
         , m_sharedBuffer(sharedBuffer.leakRef())
+        , m_copyData16(0)
         , m_hash(0)
     {
         ASSERT(m_data);
@@ -136,7 +186,7 @@ private:
     {
         ASSERT(!isStatic());
         ASSERT(!m_hash);
-        ASSERT(hash == StringHasher::computeHash(m_data, m_length));
+        ASSERT(hash == (is8Bit() ? StringHasher::computeHash(m_data8, m_length) : StringHasher::computeHash(m_data, m_length)));
         m_hash = hash;
     }
 
@@ -144,8 +194,11 @@ public:
     ~StringImpl();
 
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length);
-    static PassRefPtr<StringImpl> create(const char*, unsigned length);
+    static PassRefPtr<StringImpl> create(const LChar*, unsigned length);
+    static PassRefPtr<StringImpl> create(const char* characters, unsigned length) { return create(reinterpret_cast<const LChar*>(characters), length); }
     static PassRefPtr<StringImpl> create(const char*);
+    // Stores the characters in 8 bits if they are all Latin-1.
+    static PassRefPtr<StringImpl> create8BitIfPossible(const UChar*, unsigned length);
     static PassRefPtr<StringImpl> create(const UChar*, unsigned length, PassRefPtr<SharedUChar> sharedBuffer);
     static ALWAYS_INLINE PassRefPtr<StringImpl> create(PassRefPtr<StringImpl> rep, unsigned offset, unsigned length)
     {
@@ -156,10 +209,13 @@ public:
             return empty();
 
         StringImpl* ownerRep = (rep->bufferOwnership() == BufferSubstring) ? rep->m_substringBuffer : rep.get();
+        if (rep->is8Bit())
+            return adoptRef(new StringImpl(rep->m_data8 + offset, length, ownerRep));
         return adoptRef(new StringImpl(rep->m_data + offset, length, ownerRep));
     }
 
     static PassRefPtr<StringImpl> createUninitialized(unsigned length, UChar*& data);
+    static PassRefPtr<StringImpl> createUninitialized(unsigned length, LChar*& data);
     static ALWAYS_INLINE PassRefPtr<StringImpl> tryCreateUninitialized(unsigned length, UChar*& output)
     {
         if (!length) {
@@ -181,6 +237,9 @@ public:
     }
 
     static unsigned dataOffset() { return OBJECT_OFFSETOF(StringImpl, m_data); }
+    static unsigned copyData16Offset() { return OBJECT_OFFSETOF(StringImpl, m_copyData16); }
+    static unsigned flagsOffset() { return OBJECT_OFFSETOF(StringImpl, m_refCountAndFlags); }
+    static unsigned flagIs8Bit() { return s_refCountFlagIs8Bit; }
     static PassRefPtr<StringImpl> createWithTerminatingNullCharacter(const StringImpl&);
     static PassRefPtr<StringImpl> createStrippingNullCharacters(const UChar*, unsigned length);
 
@@ -198,7 +257,20 @@ public:
     static PassRefPtr<StringImpl> adopt(StringBuffer&);
 
     SharedUChar* sharedBuffer();
-    const UChar* characters() const { return m_data; }
+
+    // An 8 bit string holds only Latin-1 characters, one byte each, for its whole life.
+    // Asking it for characters() makes a 16 bit copy, which is kept until the string is
+    // destroyed, so code that can read characters8() instead should.
+    bool is8Bit() const { return m_refCountAndFlags & s_refCountFlagIs8Bit; }
+    const LChar* characters8() const { ASSERT(is8Bit()); return m_data8; }
+    const UChar* characters() const
+    {
+        if (!is8Bit())
+            return m_data;
+        if (m_copyData16)
+            return m_copyData16;
+        return getData16SlowCase();
+    }
 
     size_t cost()
     {
@@ -207,6 +279,13 @@ public:
             return m_substringBuffer->cost();
 
         if (m_refCountAndFlags & s_refCountFlagShouldReportedCost) {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+            if (isAtomic()) {
+                // Only the thread that clears the flag reports the cost.
+                unsigned oldValue = atomicallyUpdateRefCountAndFlags(0, s_refCountFlagShouldReportedCost);
+                return (oldValue & s_refCountFlagShouldReportedCost) ? m_length : 0;
+            }
+#endif
             m_refCountAndFlags &= ~s_refCountFlagShouldReportedCost;
             return m_length;
         }
@@ -235,10 +314,37 @@ public:
             m_refCountAndFlags &= ~s_refCountFlagIsAtomic;
     }
 
-    unsigned hash() const { if (!m_hash) m_hash = StringHasher::computeHash(m_data, m_length); return m_hash; }
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Whether AtomicString can put this string itself in the table, rather than a copy.
+    // Atoms are used from many threads, so they must never change their characters or
+    // buffer, and must not be in a thread's identifier table.
+    bool canBecomeSharedAtom() const
+    {
+        BufferOwnership ownership = bufferOwnership();
+        return (ownership == BufferInternal || ownership == BufferOwned) && !is8Bit() && !isIdentifier();
+    }
+#endif
+
+    unsigned hash() const
+    {
+        if (!m_hash)
+            m_hash = is8Bit() ? StringHasher::computeHash(m_data8, m_length) : StringHasher::computeHash(m_data, m_length);
+        return m_hash;
+    }
     unsigned existingHash() const { ASSERT(m_hash); return m_hash; }
 
-    ALWAYS_INLINE void deref() { m_refCountAndFlags -= s_refCountIncrement; if (!(m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic))) delete this; }
+    ALWAYS_INLINE void deref()
+    {
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+        if (UNLIKELY((m_refCountAndFlags & (s_refCountFlagIsAtomic | s_refCountFlagStatic)) == s_refCountFlagIsAtomic)) {
+            derefAtomic();
+            return;
+        }
+#endif
+        m_refCountAndFlags -= s_refCountIncrement;
+        if (!(m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic)))
+            delete this;
+    }
     ALWAYS_INLINE bool hasOneRef() const { return (m_refCountAndFlags & (s_refCountMask | s_refCountFlagStatic)) == s_refCountIncrement; }
 
     static StringImpl* empty();
@@ -252,6 +358,12 @@ public:
             memcpy(destination, source, numCharacters * sizeof(UChar));
     }
 
+    static void copyChars(UChar* destination, const LChar* source, unsigned numCharacters)
+    {
+        for (unsigned i = 0; i < numCharacters; ++i)
+            destination[i] = source[i];
+    }
+
     // Returns a StringImpl suitable for use on another thread.
     PassRefPtr<StringImpl> crossThreadString();
     // Makes a deep copy. Helpful only if you need to use a String on another thread
@@ -261,7 +373,13 @@ public:
 
     PassRefPtr<StringImpl> substring(unsigned pos, unsigned len = UINT_MAX);
 
-    UChar operator[](unsigned i) { ASSERT(i < m_length); return m_data[i]; }
+    UChar operator[](unsigned i) const
+    {
+        ASSERT(i < m_length);
+        if (is8Bit())
+            return m_data8[i];
+        return m_data[i];
+    }
     UChar32 characterStartingAt(unsigned);
 
     bool containsOnlyWhitespace();
@@ -327,19 +445,33 @@ private:
     static const unsigned s_copyCharsInlineCutOff = 20;
 
     static PassRefPtr<StringImpl> createStrippingNullCharactersSlowCase(const UChar*, unsigned length);
+    const UChar* getData16SlowCase() const;
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    void derefAtomic();
+#endif
+    PassRefPtr<StringImpl> lower8Bit();
     
     BufferOwnership bufferOwnership() const { return static_cast<BufferOwnership>(m_refCountAndFlags & s_refCountMaskBufferOwnership); }
     bool isStatic() const { return m_refCountAndFlags & s_refCountFlagStatic; }
-    const UChar* m_data;
+    union {
+        const UChar* m_data;
+        const LChar* m_data8;
+    };
     union {
         void* m_buffer;
         StringImpl* m_substringBuffer;
         SharedUChar* m_sharedBuffer;
     };
+    // The 16 bit copy of an 8 bit string, made on the first call to characters().
+    // Like m_hash, it is filled in by a const method, so 8 bit strings must not be
+    // read from several threads at once.
+    mutable UChar* m_copyData16;
     mutable unsigned m_hash;
 };
 
 bool equal(const StringImpl*, const StringImpl*);
+// Compares the characters of strings of the same length, at least one of them 8 bit.
+bool equalWith8Bit(const StringImpl*, const StringImpl*);
 bool equal(const StringImpl*, const char*);
 inline bool equal(const char* a, StringImpl* b) { return equal(b, a); }
 
@@ -28,6 +28,10 @@
 
 #include <wtf/unicode/Unicode.h>
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+#include <wtf/Atomics.h>
+#endif
+
 namespace WTF {
 
 class StringImplBase {
@@ -35,7 +39,20 @@ class StringImplBase {
 public:
     bool isStringImpl() { return (m_refCountAndFlags & s_refCountInvalidForStringImpl) != s_refCountInvalidForStringImpl; }
     unsigned length() const { return m_length; }
-    void ref() { m_refCountAndFlags += s_refCountIncrement; }
+    void ref()
+    {
+        // Static strings are never deleted, so their count may wrap around. Any other
+        // string would be deleted while still in use.
+        if (UNLIKELY(m_refCountAndFlags >= s_refCountMask) && !(m_refCountAndFlags & s_refCountFlagStatic))
+            CRASH();
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+        if (UNLIKELY(m_refCountAndFlags & s_refCountFlagIsAtomic)) {
+            atomicallyUpdateRefCountAndFlags(s_refCountIncrement);
+            return;
+        }
+#endif
+        m_refCountAndFlags += s_refCountIncrement;
+    }
 
 protected:
     enum BufferOwnership {
@@ -73,11 +90,13 @@ protected:
         ASSERT(!isStringImpl());
     }
 
-    // The bottom 7 bits hold flags, the top 25 bits hold the ref count.
+    // The bottom 8 bits hold flags, the top 24 bits hold the ref count, which ref()
+    // checks for overflow.
     // When dereferencing StringImpls we check for the ref count AND the
     // static bit both being zero - static strings are never deleted.
-    static const unsigned s_refCountMask = 0xFFFFFF80;
-    static const unsigned s_refCountIncrement = 0x80;
+    static const unsigned s_refCountMask = 0xFFFFFF00;
+    static const unsigned s_refCountIncrement = 0x100;
+    static const unsigned s_refCountFlagIs8Bit = 0x80;
     static const unsigned s_refCountFlagStatic = 0x40;
     static const unsigned s_refCountFlagHasTerminatingNullCharacter = 0x20;
     static const unsigned s_refCountFlagIsAtomic = 0x10;
@@ -89,6 +108,19 @@ protected:
     // Used by "ConstructNonStringImpl" constructor, above.
     static const unsigned s_refCountInvalidForStringImpl = s_refCountFlagStatic | s_refCountFlagShouldReportedCost;
 
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+    // Atoms can be referenced from any thread, so their ref count and flags are only
+    // changed with compare-and-swap. Returns the value from before the update.
+    unsigned atomicallyUpdateRefCountAndFlags(unsigned increment, unsigned flagsToClear = 0)
+    {
+        while (true) {
+            unsigned oldValue = m_refCountAndFlags;
+            if (weakCompareAndSwap(&m_refCountAndFlags, oldValue, (oldValue + increment) & ~flagsToClear))
+                return oldValue;
+        }
+    }
+#endif
+
     unsigned m_refCountAndFlags;
     unsigned m_length;
 };
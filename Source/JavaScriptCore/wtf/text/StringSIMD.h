@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2011 Apple Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY APPLE INC. ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL APPLE INC. OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef StringSIMD_h
+#define StringSIMD_h
+
+#include <stdint.h>
+#include <wtf/ASCIICType.h>
+#include <wtf/NotFound.h>
+#include <wtf/StdLibExtras.h>
+#include <wtf/UnusedParam.h>
+#include <wtf/unicode/Unicode.h>
+
+#if CPU(X86_SSE2)
+#include <emmintrin.h>
+#endif
+
+// The character loops that searching, comparing and decoding strings spend most
+// of their time in. With SSE2 each loop looks at 16 bytes at a time, then finishes
+// the last few characters one at a time; other CPUs run the plain loop. Either
+// way the result is the same, so callers need not care which one ran.
+
+namespace WTF {
+
+namespace StringSIMD {
+
+#if CPU(X86_SSE2)
+
+inline __m128i load(const void* pointer)
+{
+    return _mm_loadu_si128(static_cast<const __m128i*>(pointer));
+}
+
+inline __m128i loadWidened(const UChar* characters)
+{
+    return load(characters);
+}
+
+inline __m128i loadWidened(const LChar* characters)
+{
+    return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(characters)), _mm_setzero_si128());
+}
+
+inline bool isZero(__m128i vector)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(vector, _mm_setzero_si128())) == 0xFFFF;
+}
+
+// Only valid for lanes that hold ASCII characters.
+inline __m128i foldASCIICase(__m128i characters)
+{
+    __m128i isUpper = _mm_and_si128(_mm_cmpgt_epi16(characters, _mm_set1_epi16('A' - 1)), _mm_cmplt_epi16(characters, _mm_set1_epi16('Z' + 1)));
+    return _mm_or_si128(characters, _mm_and_si128(isUpper, _mm_set1_epi16(0x20)));
+}
+
+#endif
+
+// Returns the index of the first matchCharacter at or after index, or notFound.
+inline size_t find(const UChar* characters, unsigned length, UChar matchCharacter, unsigned index = 0)
+{
+#if CPU(X86_SSE2)
+    __m128i match = _mm_set1_epi16(matchCharacter);
+    for (; index < length && length - index >= 8; index += 8) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(load(characters + index), match)))
+            break;
+    }
+#endif
+    for (; index < length; ++index) {
+        if (characters[index] == matchCharacter)
+            return index;
+    }
+    return notFound;
+}
+
+inline size_t find(const LChar* characters, unsigned length, LChar matchCharacter, unsigned index = 0)
+{
+#if CPU(X86_SSE2)
+    __m128i match = _mm_set1_epi8(matchCharacter);
+    for (; index < length && length - index >= 16; index += 16) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(load(characters + index), match)))
+            break;
+    }
+#endif
+    for (; index < length; ++index) {
+        if (characters[index] == matchCharacter)
+            return index;
+    }
+    return notFound;
+}
+
+inline bool isAllASCII(const UChar* characters, size_t length)
+{
+    size_t i = 0;
+    UChar ored = 0;
+#if CPU(X86_SSE2)
+    __m128i oredBlocks = _mm_setzero_si128();
+    for (; length - i >= 8; i += 8)
+        oredBlocks = _mm_or_si128(oredBlocks, load(characters + i));
+    if (!isZero(_mm_and_si128(oredBlocks, _mm_set1_epi16(static_cast<short>(0xFF80)))))
+        return false;
+#endif
+    for (; i < length; ++i)
+        ored |= characters[i];
+    return !(ored & 0xFF80);
+}
+
+inline bool isAllASCII(const LChar* characters, size_t length)
+{
+    size_t i = 0;
+    LChar ored = 0;
+#if CPU(X86_SSE2)
+    __m128i oredBlocks = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16)
+        oredBlocks = _mm_or_si128(oredBlocks, load(characters + i));
+    if (_mm_movemask_epi8(oredBlocks))
+        return false;
+#endif
+    for (; i < length; ++i)
+        ored |= characters[i];
+    return !(ored & 0x80);
+}
+
+// Compares an 8 bit string with a 16 bit one without widening either of them.
+inline bool equal(const LChar* a, const UChar* b, unsigned length)
+{
+    unsigned i = 0;
+#if CPU(X86_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16) {
+        __m128i narrow = load(a + i);
+        __m128i low = _mm_xor_si128(_mm_unpacklo_epi8(narrow, zero), load(b + i));
+        __m128i high = _mm_xor_si128(_mm_unpackhi_epi8(narrow, zero), load(b + i + 8));
+        if (!isZero(_mm_or_si128(low, high)))
+            return false;
+    }
+#endif
+    for (; i < length; ++i) {
+        if (a[i] != b[i])
+            return false;
+    }
+    return true;
+}
+
+// Returns how many leading characters of a and b are known to be equal ignoring
+// case. This stops early at any run of characters that is not all ASCII, and at
+// any difference; the caller carries on from there with full case folding.
+template<typename CharTypeA, typename CharTypeB>
+inline unsigned equalIgnoringASCIICasePrefixLength(const CharTypeA* a, const CharTypeB* b, unsigned length)
+{
+    unsigned i = 0;
+#if CPU(X86_SSE2)
+    const __m128i nonASCII = _mm_set1_epi16(static_cast<short>(0xFF80));
+    for (; length - i >= 8; i += 8) {
+        __m128i blockA = loadWidened(a + i);
+        __m128i blockB = loadWidened(b + i);
+        if (!isZero(_mm_and_si128(_mm_or_si128(blockA, blockB), nonASCII)))
+            break;
+        if (!isZero(_mm_xor_si128(foldASCIICase(blockA), foldASCIICase(blockB))))
+            break;
+    }
+#else
+    UNUSED_PARAM(a);
+    UNUSED_PARAM(b);
+    UNUSED_PARAM(length);
+#endif
+    return i;
+}
+
+// Widens the leading ASCII characters of source into destination, and returns
+// how many there were.
+inline unsigned copyASCIIPrefix(UChar* destination, const LChar* source, unsigned length)
+{
+    unsigned i = 0;
+#if CPU(X86_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; length - i >= 16; i += 16) {
+        __m128i block = load(source + i);
+        if (_mm_movemask_epi8(block))
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_unpacklo_epi8(block, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i + 8), _mm_unpackhi_epi8(block, zero));
+    }
+#else
+    // Read a machine word at a time once the source is aligned to one.
+    typedef uintptr_t MachineWord;
+    const MachineWord nonASCIIMask = static_cast<MachineWord>(0x8080808080808080ULL);
+    for (; i < length && reinterpret_cast<uintptr_t>(source + i) & (sizeof(MachineWord) - 1); ++i) {
+        if (!isASCII(source[i]))
+            return i;
+        destination[i] = source[i];
+    }
+    for (; length - i >= sizeof(MachineWord); i += sizeof(MachineWord)) {
+        if (*reinterpret_cast_ptr<const MachineWord*>(source + i) & nonASCIIMask)
+            break;
+        for (unsigned j = 0; j < sizeof(MachineWord); ++j)
+            destination[i + j] = source[i + j];
+    }
+#endif
+    for (; i < length && isASCII(source[i]); ++i)
+        destination[i] = source[i];
+    return i;
+}
+
+} // namespace StringSIMD
+
+} // namespace WTF
+
+#endif // StringSIMD_h
@@ -645,13 +645,12 @@ CString String::ascii() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
     for (unsigned i = 0; i < length; ++i) {
-        UChar ch = characters[i];
+        UChar ch = (*m_impl)[i];
         characterBuffer[i] = ch && (ch < 0x20 || ch > 0x7f) ? '?' : ch;
     }
 
@@ -664,11 +663,16 @@ CString String::latin1() const
     // preserved, characters outside of this range are converted to '?'.
 
     unsigned length = this->length();
-    const UChar* characters = this->characters();
 
     char* characterBuffer;
     CString result = CString::newUninitialized(length, characterBuffer);
 
+    if (is8Bit()) {
+        memcpy(characterBuffer, characters8(), length);
+        return result;
+    }
+
+    const UChar* characters = this->characters();
     for (unsigned i = 0; i < length; ++i) {
         UChar ch = characters[i];
         characterBuffer[i] = ch > 0xff ? '?' : ch;
@@ -26,6 +26,7 @@
 // on systems without case-sensitive file systems.
 
 #include "StringImpl.h"
+#include "StringSIMD.h"
 
 #ifdef __OBJC__
 #include <objc/objc.h>
@@ -66,6 +67,7 @@ struct StringHash;
 // Declarations of string operations
 
 bool charactersAreAllASCII(const UChar*, size_t);
+bool charactersAreAllASCII(const LChar*, size_t);
 bool charactersAreAllLatin1(const UChar*, size_t);
 int charactersToIntStrict(const UChar*, size_t, bool* ok = 0, int base = 10);
 unsigned charactersToUIntStrict(const UChar*, size_t, bool* ok = 0, int base = 10);
@@ -139,6 +141,14 @@ public:
         return m_impl->characters();
     }
 
+    bool is8Bit() const { return m_impl && m_impl->is8Bit(); }
+    const LChar* characters8() const
+    {
+        if (!m_impl)
+            return 0;
+        return m_impl->characters8();
+    }
+
     CString ascii() const;
     CString latin1() const;
     CString utf8(bool strict = false) const;
@@ -147,7 +157,7 @@ public:
     {
         if (!m_impl || index >= m_impl->length())
             return 0;
-        return m_impl->characters()[index];
+        return (*m_impl)[index];
     }
 
     static String number(short);
@@ -340,8 +350,13 @@ public:
         return WTF::Unicode::LeftToRight;
     }
 
-    bool containsOnlyASCII() const { return charactersAreAllASCII(characters(), length()); }
-    bool containsOnlyLatin1() const { return charactersAreAllLatin1(characters(), length()); }
+    bool containsOnlyASCII() const
+    {
+        if (is8Bit())
+            return charactersAreAllASCII(characters8(), length());
+        return charactersAreAllASCII(characters(), length());
+    }
+    bool containsOnlyLatin1() const { return is8Bit() || charactersAreAllLatin1(characters(), length()); }
 
     // Hash table deleted values, which are only constructed and never copied or destroyed.
     String(WTF::HashTableDeletedValueType) : m_impl(WTF::HashTableDeletedValue) { }
@@ -405,10 +420,12 @@ inline NSString* nsStringNilIfEmpty(const String& str) {  return str.isEmpty() ?
 
 inline bool charactersAreAllASCII(const UChar* characters, size_t length)
 {
-    UChar ored = 0;
-    for (size_t i = 0; i < length; ++i)
-        ored |= characters[i];
-    return !(ored & 0xFF80);
+    return StringSIMD::isAllASCII(characters, length);
+}
+
+inline bool charactersAreAllASCII(const LChar* characters, size_t length)
+{
+    return StringSIMD::isAllASCII(characters, length);
 }
 
 inline bool charactersAreAllLatin1(const UChar* characters, size_t length)
@@ -423,12 +440,7 @@ int codePointCompare(const String&, const String&);
 
 inline size_t find(const UChar* characters, unsigned length, UChar matchCharacter, unsigned index = 0)
 {
-    while (index < length) {
-        if (characters[index] == matchCharacter)
-            return index;
-        ++index;
-    }
-    return notFound;
+    return StringSIMD::find(characters, length, matchCharacter, index);
 }
 
 inline size_t find(const UChar* characters, unsigned length, CharacterMatchFunctionPtr matchFunction, unsigned index = 0)
@@ -1543,6 +1543,53 @@ class YarrGenerator : private MacroAssembler {
         state.setBacktrackLabel(backtrackBegin);
     }
 
+    void generateBackReference(TermGenerationState& state)
+    {
+        const RegisterID matchIndex = regT0;
+        const RegisterID character = regT1;
+        PatternTerm& term = state.term();
+        unsigned subpatternId = term.backReferenceSubpatternId;
+        unsigned indexFrameLocation = term.frameLocation;
+        unsigned matchEndFrameLocation = term.frameLocation + 1;
+
+        ASSERT(term.quantityType == QuantifierFixedCount);
+        ASSERT(term.quantityCount == 1);
+
+        // Saved so that backtracking into the reference can undo its match.
+        storeToFrame(index, indexFrameLocation);
+
+        // A subpattern that has not matched, or matched the empty string, matches
+        // the empty string here.
+        JumpList matchesEmpty;
+        load32(Address(output, (subpatternId << 1) * sizeof(int)), matchIndex);
+        load32(Address(output, ((subpatternId << 1) + 1) * sizeof(int)), character);
+        matchesEmpty.append(branch32(Equal, matchIndex, TrustedImm32(-1)));
+        matchesEmpty.append(branch32(LessThanOrEqual, character, matchIndex));
+        storeToFrame(character, matchEndFrameLocation);
+
+        // The subpattern's match starts at or before the current position, so
+        // matchIndex stays within the input while index does.
+        JumpList failures;
+        Label loop(this);
+        failures.append(atEndOfInput());
+        load16(BaseIndex(input, matchIndex, TimesTwo, 0), character);
+        failures.append(branch16(NotEqual, BaseIndex(input, index, TimesTwo, state.inputOffset() * sizeof(UChar)), character));
+        add32(TrustedImm32(1), matchIndex);
+        add32(TrustedImm32(1), index);
+        branch32(NotEqual, matchIndex, Address(stackPointerRegister, matchEndFrameLocation * sizeof(void*))).linkTo(loop, this);
+        Jump matched = jump();
+
+        Label backtrackBegin(this);
+        failures.link(this);
+        loadFromFrame(indexFrameLocation, index);
+        state.jumpToBacktrack(this);
+
+        matched.link(this);
+        matchesEmpty.link(this);
+
+        state.setBacktrackLabel(backtrackBegin);
+    }
+
     void generateParenthesesDisjunction(PatternTerm& parenthesesTerm, TermGenerationState& state, unsigned alternativeFrameLocation)
     {
         ASSERT((parenthesesTerm.type == PatternTerm::TypeParenthesesSubpattern) || (parenthesesTerm.type == PatternTerm::TypeParentheticalAssertion));
@@ -1897,7 +1944,12 @@ class YarrGenerator : private MacroAssembler {
             break;
 
         case PatternTerm::TypeBackReference:
-            m_shouldFallBack = true;
+            // Case insensitive references need Unicode case folding, and quantified
+            // ones a count of their matches to backtrack over.
+            if (m_pattern.m_ignoreCase || term.quantityType != QuantifierFixedCount || term.quantityCount != 1)
+                m_shouldFallBack = true;
+            else
+                generateBackReference(state);
             break;
 
         case PatternTerm::TypeForwardReference:
@@ -339,6 +339,12 @@ private:
     bool m_isCaseInsensitive;
 };
 
+// Bound the growth of the pattern by unrollQuantifiedParentheses(): the count
+// of a single group, and the terms added by all the copies in the pattern, since
+// nested fixed counts multiply.
+static const unsigned maxUnrolledParenthesesCount = 8;
+static const unsigned maxUnrolledTermCount = 256;
+
 class YarrPatternConstructor {
 public:
     YarrPatternConstructor(YarrPattern& pattern)
@@ -346,6 +352,7 @@ public:
         , m_characterClassConstructor(pattern.m_ignoreCase)
         , m_beginCharHelper(&pattern.m_beginChars, pattern.m_ignoreCase)
         , m_invertParentheticalAssertion(false)
+        , m_unrolledTermBudget(0)
     {
         m_pattern.m_body = new PatternDisjunction();
         m_alternative = m_pattern.m_body->addNewAlternative();
@@ -787,6 +794,90 @@ public:
         }
     }
 
+    // Parentheses quantified to more than once, and the copies that quantifyAtom
+    // makes for the optional part of a {min,max} range, are matched by saving a
+    // frame per iteration, which the JIT does not support. Where it is not needed
+    // we rewrite them into parentheses that are matched once:
+    //   * a fixed count of up to maxUnrolledParenthesesCount is unrolled into that
+    //     many copies, if the parentheses contain no capturing subpatterns. Each
+    //     copy stores the parentheses' own capture, so the last iteration's is kept.
+    //     Inner parentheses are unrolled first, and once the copies made for the
+    //     whole pattern would exceed maxUnrolledTermCount terms, the remaining
+    //     parentheses keep their fixed count.
+    //   * a copy quantified to at most once is matched as an optional once through,
+    //     if there are no captures for it to reset when it does not match.
+    void unrollQuantifiedParentheses(PatternDisjunction* disjunction)
+    {
+        for (unsigned alt = 0; alt < disjunction->m_alternatives.size(); ++alt) {
+            Vector<PatternTerm>& terms = disjunction->m_alternatives[alt]->m_terms;
+            Vector<PatternTerm> unrolledTerms;
+            bool unrolled = false;
+
+            for (unsigned i = 0; i < terms.size(); ++i) {
+                PatternTerm& term = terms[i];
+                if ((term.type != PatternTerm::TypeParenthesesSubpattern) && (term.type != PatternTerm::TypeParentheticalAssertion)) {
+                    unrolledTerms.append(term);
+                    continue;
+                }
+
+                unrollQuantifiedParentheses(term.parentheses.disjunction);
+                if (term.type != PatternTerm::TypeParenthesesSubpattern) {
+                    unrolledTerms.append(term);
+                    continue;
+                }
+
+                bool containsNestedCaptures = term.parentheses.lastSubpatternId >= term.parentheses.subpatternId + (term.capture() ? 1 : 0);
+                if (term.quantityType == QuantifierFixedCount && term.quantityCount > 1 && term.quantityCount <= maxUnrolledParenthesesCount && !containsNestedCaptures
+                    && consumeUnrolledTermBudget((term.quantityCount - 1) * (1 + termCount(term.parentheses.disjunction)))) {
+                    unsigned count = term.quantityCount;
+                    term.quantityCount = 1;
+                    unrolledTerms.append(term);
+                    for (unsigned copy = 1; copy < count; ++copy)
+                        unrolledTerms.append(copyTerm(term));
+                    unrolled = true;
+                    continue;
+                }
+
+                if (term.parentheses.isCopy && term.quantityCount == 1 && !term.capture() && !containsNestedCaptures)
+                    term.parentheses.isCopy = false;
+                unrolledTerms.append(term);
+            }
+
+            if (unrolled)
+                terms.swap(unrolledTerms);
+        }
+    }
+
+    void unrollQuantifiedParentheses()
+    {
+        m_unrolledTermBudget = maxUnrolledTermCount;
+        unrollQuantifiedParentheses(m_pattern.m_body);
+    }
+
+    // Counts the terms of the disjunction, including those of nested parentheses,
+    // stopping once it is known to be over the budget.
+    unsigned termCount(PatternDisjunction* disjunction)
+    {
+        unsigned count = 0;
+        for (unsigned alt = 0; alt < disjunction->m_alternatives.size() && count <= maxUnrolledTermCount; ++alt) {
+            Vector<PatternTerm>& terms = disjunction->m_alternatives[alt]->m_terms;
+            for (unsigned i = 0; i < terms.size() && count <= maxUnrolledTermCount; ++i) {
+                ++count;
+                if ((terms[i].type == PatternTerm::TypeParenthesesSubpattern) || (terms[i].type == PatternTerm::TypeParentheticalAssertion))
+                    count += termCount(terms[i].parentheses.disjunction);
+            }
+        }
+        return count;
+    }
+
+    bool consumeUnrolledTermBudget(unsigned termCount)
+    {
+        if (termCount > m_unrolledTermBudget)
+            return false;
+        m_unrolledTermBudget -= termCount;
+        return true;
+    }
+
     void optimizeBOL()
     {
         // Look for expressions containing beginning of line (^) anchoring and unroll them.
@@ -954,6 +1045,7 @@ private:
     BeginCharHelper m_beginCharHelper;
     bool m_invertCharacterClass;
     bool m_invertParentheticalAssertion;
+    unsigned m_unrolledTermBudget;
 };
 
 const char* YarrPattern::compile(const UString& patternString)
@@ -980,6 +1072,7 @@ const char* YarrPattern::compile(const UString& patternString)
         ASSERT(numSubpatterns == m_numSubpatterns);
     }
 
+    constructor.unrollQuantifiedParentheses();
     constructor.checkForTerminalParentheses();
     constructor.optimizeBOL();
         
@@ -684,6 +684,7 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/android/LayerAndroid.cpp \
 	platform/graphics/android/MediaLayer.cpp \
 	platform/graphics/android/MediaTexture.cpp \
+	platform/graphics/android/OperationQueue.cpp \
 	platform/graphics/android/PaintTileOperation.cpp \
 	platform/graphics/android/PaintedSurface.cpp \
 	platform/graphics/android/PathAndroid.cpp \
@@ -697,11 +698,15 @@ LOCAL_SRC_FILES := $(LOCAL_SRC_FILES) \
 	platform/graphics/android/SharedTexture.cpp \
 	platform/graphics/android/TextureInfo.cpp \
 	platform/graphics/android/TexturesGenerator.cpp \
+	platform/graphics/android/TileBitmapPool.cpp \
+	platform/graphics/android/TileFingerprint.cpp \
 	platform/graphics/android/TilesManager.cpp \
 	platform/graphics/android/TilesProfiler.cpp \
 	platform/graphics/android/TiledPage.cpp \
 	platform/graphics/android/TiledTexture.cpp \
+	platform/graphics/android/TimelineRecorder.cpp \
 	platform/graphics/android/TransferQueue.cpp \
+	platform/graphics/android/TransferRing.cpp \
 	platform/graphics/android/TreeManager.cpp \
 	platform/graphics/android/VerticalTextMap.cpp \
 	platform/graphics/android/VideoLayerAndroid.cpp \
@@ -0,0 +1,4 @@
+#ifndef WebCore_FWD_TypedArena_h
+#define WebCore_FWD_TypedArena_h
+#include <JavaScriptCore/TypedArena.h>
+#endif
@@ -0,0 +1,4 @@
+#ifndef WebCore_FWD_StringSIMD_h
+#define WebCore_FWD_StringSIMD_h
+#include <JavaScriptCore/StringSIMD.h>
+#endif
@@ -2052,7 +2052,6 @@ HEADERS += \
     platform/text/SegmentedString.h \
     platform/text/TextBoundaries.h \
     platform/text/TextCodec.h \
-    platform/text/TextCodecASCIIFastPath.h \
     platform/text/TextCodecLatin1.h \
     platform/text/TextCodecUserDefined.h \
     platform/text/TextCodecUTF16.h \
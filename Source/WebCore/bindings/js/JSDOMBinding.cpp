@@ -242,7 +242,7 @@ JSValue jsStringOrFalse(ExecState* exec, const KURL& url)
     return jsString(exec, url.string());
 }
 
-AtomicStringImpl* findAtomicString(const Identifier& identifier)
+PassRefPtr<AtomicStringImpl> findAtomicString(const Identifier& identifier)
 {
     if (identifier.isNull())
         return 0;
@@ -22,6 +22,7 @@
 #include "ScriptController.h"
 
 #include "ScriptableDocumentParser.h"
+#include "CachedMetadata.h"
 #include "Event.h"
 #include "EventNames.h"
 #include "Frame.h"
@@ -43,6 +44,7 @@
 #include "npruntime_impl.h"
 #include "runtime_root.h"
 #include <debugger/Debugger.h>
+#include <parser/BackgroundParser.h>
 #include <runtime/InitializeThreading.h>
 #include <runtime/JSLock.h>
 #include <wtf/Threading.h>
@@ -115,6 +117,57 @@ JSDOMWindowShell* ScriptController::createWindowShell(DOMWrapperWorld* world)
     return windowShell.get();
 }
 
+// A pseudo-randomly chosen ID used to store and retrieve the functions the
+// parser cached from the CachedScript. If the format changes, this ID should
+// be changed too.
+static const unsigned functionCacheDataTypeID = 0x3A9D52C1;
+
+// Very small scripts are not worth the effort to cache.
+static const int minFunctionCacheSourceLength = 1024;
+
+// Restores the functions the parser cached the last time the script was
+// loaded, or else this time on the background parser thread, so that it can
+// skip them. Returns false if the cached functions are yet to be stored.
+static bool restoreFunctionCache(JSGlobalData* globalData, const ScriptSourceCode& sourceCode)
+{
+    CachedScript* cachedScript = sourceCode.cachedScript();
+    if (!cachedScript)
+        return true;
+    RefPtr<BackgroundParseRequest> backgroundParse = cachedScript->takeBackgroundParse();
+    if (sourceCode.jsSourceCode().length() < minFunctionCacheSourceLength)
+        return true;
+
+    SourceProvider* provider = sourceCode.jsSourceCode().provider();
+    SourceProviderCache* cache = provider->cache();
+    if (!cache->isEmpty())
+        return true;
+
+    unsigned oldCacheSize = cache->byteSize();
+    bool isStored = false;
+    if (CachedMetadata* cachedMetadata = cachedScript->cachedMetadata(functionCacheDataTypeID)) {
+        // Stale data is only replaced with a new response
+        cache->deserialize(globalData, provider, cachedMetadata->data(), cachedMetadata->size());
+        isStored = true;
+    } else if (backgroundParse) {
+        // Not waited for if unfinished, as parsing here takes no longer
+        backgroundParse->restore(globalData, provider);
+    }
+    if (cache->byteSize() != oldCacheSize)
+        provider->notifyCacheSizeChanged(cache->byteSize() - oldCacheSize);
+    return isStored;
+}
+
+static void storeFunctionCache(const ScriptSourceCode& sourceCode)
+{
+    SourceProvider* provider = sourceCode.jsSourceCode().provider();
+    if (provider->cache()->isEmpty())
+        return;
+
+    Vector<char> data;
+    provider->cache()->serialize(provider, data);
+    sourceCode.cachedScript()->setCachedMetadata(functionCacheDataTypeID, data.data(), data.size());
+}
+
 ScriptValue ScriptController::evaluateInWorld(const ScriptSourceCode& sourceCode, DOMWrapperWorld* world)
 {
     const SourceCode& jsSourceCode = sourceCode.jsSourceCode();
@@ -138,10 +191,15 @@ ScriptValue ScriptController::evaluateInWorld(const ScriptSourceCode& sourceCode
 
     InspectorInstrumentationCookie cookie = InspectorInstrumentation::willEvaluateScript(m_frame, sourceURL, sourceCode.startLine());
 
+    bool hasFunctionCache = restoreFunctionCache(&exec->globalData(), sourceCode);
+
     exec->globalData().timeoutChecker.start();
     Completion comp = JSMainThreadExecState::evaluate(exec, exec->dynamicGlobalObject()->globalScopeChain(), jsSourceCode, shell);
     exec->globalData().timeoutChecker.stop();
 
+    if (!hasFunctionCache)
+        storeFunctionCache(sourceCode);
+
     InspectorInstrumentation::didEvaluateScript(cookie);
 
     // Evaluating the JavaScript could cause the frame to be deallocated
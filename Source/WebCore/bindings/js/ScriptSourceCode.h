@@ -31,6 +31,8 @@
 #ifndef ScriptSourceCode_h
 #define ScriptSourceCode_h
 
+#include "CachedResourceHandle.h"
+#include "CachedScript.h"
 #include "CachedScriptSourceProvider.h"
 #include "ScriptSourceProvider.h"
 #include "StringSourceProvider.h"
@@ -52,6 +54,7 @@ public:
     ScriptSourceCode(CachedScript* cs)
         : m_provider(CachedScriptSourceProvider::create(cs))
         , m_code(m_provider)
+        , m_cachedScript(cs)
     {
     }
 
@@ -59,6 +62,8 @@ public:
 
     const JSC::SourceCode& jsSourceCode() const { return m_code; }
 
+    CachedScript* cachedScript() const { return m_cachedScript.get(); }
+
     const String& source() const { return m_provider->source(); }
 
     int startLine() const { return m_code.firstLine(); }
@@ -69,6 +74,8 @@ private:
     RefPtr<ScriptSourceProvider> m_provider;
     
     JSC::SourceCode m_code;
+
+    CachedResourceHandle<CachedScript> m_cachedScript;
     
     KURL m_url;
 
@@ -74,6 +74,7 @@
 #include "WebKitCSSTransformValue.h"
 #include <limits.h>
 #include <wtf/HexNumber.h>
+#include <wtf/MainThread.h>
 #include <wtf/dtoa.h>
 #include <wtf/text/StringBuffer.h>
 
@@ -6226,9 +6227,32 @@ void CSSParser::countLines()
     }
 }
 
+// The floating objects only live until the rule they belong to is made, so they
+// are recycled through arenas shared by all the parsers of the main thread.
+static TypedArena<CSSParserSelector>& selectorArena()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(TypedArena<CSSParserSelector>, arena, ());
+    return arena;
+}
+
+static TypedArena<CSSParserValueList>& valueListArena()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(TypedArena<CSSParserValueList>, arena, ());
+    return arena;
+}
+
+static TypedArena<CSSParserFunction>& functionArena()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(TypedArena<CSSParserFunction>, arena, ());
+    return arena;
+}
+
 CSSParserSelector* CSSParser::createFloatingSelector()
 {
-    CSSParserSelector* selector = new CSSParserSelector;
+    CSSParserSelector* selector = new (selectorArena()) CSSParserSelector;
     m_floatingSelectors.add(selector);
     return selector;
 }
@@ -6260,7 +6284,7 @@ PassOwnPtr<Vector<OwnPtr<CSSParserSelector> > > CSSParser::sinkFloatingSelectorV
 
 CSSParserValueList* CSSParser::createFloatingValueList()
 {
-    CSSParserValueList* list = new CSSParserValueList;
+    CSSParserValueList* list = new (valueListArena()) CSSParserValueList;
     m_floatingValueLists.add(list);
     return list;
 }
@@ -6276,7 +6300,7 @@ CSSParserValueList* CSSParser::sinkFloatingValueList(CSSParserValueList* list)
 
 CSSParserFunction* CSSParser::createFloatingFunction()
 {
-    CSSParserFunction* function = new CSSParserFunction;
+    CSSParserFunction* function = new (functionArena()) CSSParserFunction;
     m_floatingFunctions.add(function);
     return function;
 }
@@ -6481,7 +6505,7 @@ void CSSParser::updateSpecifiersWithElementName(const AtomicString& namespacePre
     if (elementName == starAtom && m_defaultNamespace == starAtom)
         return;
 
-    CSSParserSelector* elementNameSelector = new CSSParserSelector;
+    CSSParserSelector* elementNameSelector = new (selectorArena()) CSSParserSelector;
     elementNameSelector->setTag(tag);
     specifiers->setTagHistory(elementNameSelector);
 }
@@ -22,6 +22,7 @@
 #define CSSParserValues_h
 
 #include "CSSSelector.h"
+#include <wtf/TypedArena.h>
 #include <wtf/text/AtomicString.h>
 
 namespace WebCore {
@@ -62,7 +63,7 @@ struct CSSParserValue {
 };
 
 class CSSParserValueList {
-    WTF_MAKE_FAST_ALLOCATED;
+    WTF_MAKE_ARENA_ALLOCATED(CSSParserValueList);
 public:
     CSSParserValueList()
         : m_current(0)
@@ -89,14 +90,14 @@ private:
 };
 
 struct CSSParserFunction {
-    WTF_MAKE_FAST_ALLOCATED;
+    WTF_MAKE_ARENA_ALLOCATED(CSSParserFunction);
 public:
     CSSParserString name;
     OwnPtr<CSSParserValueList> args;
 };
 
 class CSSParserSelector {
-    WTF_MAKE_FAST_ALLOCATED;
+    WTF_MAKE_ARENA_ALLOCATED(CSSParserSelector);
 public:
     CSSParserSelector();
     ~CSSParserSelector();
@@ -32,6 +32,7 @@
 #include "HTMLNames.h"
 #include "MathMLNames.h"
 #include "SVGNames.h"
+#include <wtf/MainThread.h>
 #include <wtf/PassOwnPtr.h>
 
 namespace WebCore {
@@ -129,6 +130,15 @@ inline bool isSelectScopeMarker(ContainerNode* node)
         && !node->hasTagName(optionTag);
 }
 
+// Records are pushed and popped for every element parsed, so the parsers of
+// the main thread share one arena and reuse the slots of popped records.
+TypedArena<HTMLElementStack::ElementRecord>& recordArena()
+{
+    ASSERT(isMainThread());
+    DEFINE_STATIC_LOCAL(TypedArena<HTMLElementStack::ElementRecord>, arena, ());
+    return arena;
+}
+
 }
 
 HTMLElementStack::ElementRecord::ElementRecord(PassRefPtr<ContainerNode> node, PassOwnPtr<ElementRecord> next)
@@ -342,7 +352,7 @@ void HTMLElementStack::insertAbove(PassRefPtr<Element> element, ElementRecord* r
         if (recordAbove->next() != recordBelow)
             continue;
 
-        recordAbove->setNext(adoptPtr(new ElementRecord(element, recordAbove->releaseNext())));
+        recordAbove->setNext(adoptPtr(new (recordArena()) ElementRecord(element, recordAbove->releaseNext())));
         recordAbove->next()->element()->beginParsingChildren();
         return;
     }
@@ -552,7 +562,7 @@ ContainerNode* HTMLElementStack::rootNode() const
 void HTMLElementStack::pushCommon(PassRefPtr<ContainerNode> node)
 {
     ASSERT(m_rootNode);
-    m_top = adoptPtr(new ElementRecord(node, m_top.release()));
+    m_top = adoptPtr(new (recordArena()) ElementRecord(node, m_top.release()));
     topNode()->beginParsingChildren();
 }
 
@@ -34,6 +34,7 @@
 #include <wtf/OwnPtr.h>
 #include <wtf/PassOwnPtr.h>
 #include <wtf/RefPtr.h>
+#include <wtf/TypedArena.h>
 
 namespace WebCore {
 
@@ -51,7 +52,7 @@ public:
     ~HTMLElementStack();
 
     class ElementRecord {
-        WTF_MAKE_NONCOPYABLE(ElementRecord);
+        WTF_MAKE_NONCOPYABLE(ElementRecord); WTF_MAKE_ARENA_ALLOCATED(ElementRecord);
     public:
         ~ElementRecord(); // Public for ~PassOwnPtr()
     
@@ -35,6 +35,8 @@
 #include <wtf/Vector.h>
 
 #if USE(JSC)  
+#include "Settings.h"
+#include <parser/BackgroundParser.h>
 #include <parser/SourceProvider.h>
 #endif
 
@@ -100,6 +102,10 @@ void CachedScript::data(PassRefPtr<SharedBuffer> data, bool allDataReceived)
 
     m_data = data;
     setEncodedSize(m_data.get() ? m_data->size() : 0);
+#if USE(JSC)
+    if (m_data && Settings::backgroundScriptParsingEnabled())
+        startBackgroundParse();
+#endif
     setLoading(false);
     checkNotify();
 }
@@ -144,6 +150,28 @@ void CachedScript::sourceProviderCacheSizeChanged(int delta)
 {
     setDecodedSize(decodedSize() + delta);
 }
+
+static JSC::BackgroundParser& backgroundParser()
+{
+    DEFINE_STATIC_LOCAL(JSC::BackgroundParser, parser, ());
+    return parser;
+}
+
+void CachedScript::startBackgroundParse()
+{
+    // Very small scripts are not worth the effort to parse in the background.
+    static const unsigned minBackgroundParseLength = 1024;
+
+    const String& source = script();
+    if (source.length() < minBackgroundParseLength)
+        return;
+    m_backgroundParse = backgroundParser().parse(source.characters(), source.length());
+}
+
+PassRefPtr<JSC::BackgroundParseRequest> CachedScript::takeBackgroundParse()
+{
+    return m_backgroundParse.release();
+}
 #endif
 
 } // namespace WebCore
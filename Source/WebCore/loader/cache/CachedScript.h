@@ -31,6 +31,7 @@
 
 #if USE(JSC)
 namespace JSC {
+    class BackgroundParseRequest;
     class SourceProviderCache;
 }
 #endif
@@ -60,9 +61,17 @@ namespace WebCore {
         // Allows JSC to cache additional information about the source.
         JSC::SourceProviderCache* sourceProviderCache() const;
         void sourceProviderCacheSizeChanged(int delta);
+
+        // The background parse of the script, started when it loaded if
+        // Settings::backgroundScriptParsingEnabled(). Its result is only of
+        // use to the first run of the script.
+        PassRefPtr<JSC::BackgroundParseRequest> takeBackgroundParse();
 #endif
     private:
         void decodedDataDeletionTimerFired(Timer<CachedScript>*);
+#if USE(JSC)
+        void startBackgroundParse();
+#endif
         virtual PurgePriority purgePriority() const { return PurgeLast; }
 
         String m_script;
@@ -70,6 +79,7 @@ namespace WebCore {
         Timer<CachedScript> m_decodedDataDeletionTimer;
 #if USE(JSC)        
         mutable OwnPtr<JSC::SourceProviderCache> m_sourceProviderCache;
+        RefPtr<JSC::BackgroundParseRequest> m_backgroundParse;
 #endif
     };
 }
@@ -59,6 +59,10 @@ bool Settings::gShouldPaintNativeControls = true;
 bool Settings::gShouldUseHighResolutionTimers = true;
 #endif
 
+#if USE(JSC)
+bool Settings::gBackgroundScriptParsingEnabled = false;
+#endif
+
 // NOTEs
 //  1) EditingMacBehavior comprises Tiger, Leopard, SnowLeopard and iOS builds, as well QtWebKit and Chromium when built on Mac;
 //  2) EditingWindowsBehavior comprises Win32 and WinCE builds, as well as QtWebKit and Chromium when built on Windows;
@@ -897,6 +901,13 @@ void Settings::setShouldUseHighResolutionTimers(bool shouldUseHighResolutionTime
 }
 #endif
 
+#if USE(JSC)
+void Settings::setBackgroundScriptParsingEnabled(bool backgroundScriptParsingEnabled)
+{
+    gBackgroundScriptParsingEnabled = backgroundScriptParsingEnabled;
+}
+#endif
+
 void Settings::setWebAudioEnabled(bool enabled)
 {
     m_webAudioEnabled = enabled;
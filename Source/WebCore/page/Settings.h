@@ -390,6 +390,13 @@ namespace WebCore {
         static bool shouldUseHighResolutionTimers() { return gShouldUseHighResolutionTimers; }
 #endif
 
+#if USE(JSC)
+        // Syntax checks external scripts on a background thread once they load,
+        // so that parsing them when they run skips their functions' bodies.
+        static void setBackgroundScriptParsingEnabled(bool);
+        static bool backgroundScriptParsingEnabled() { return gBackgroundScriptParsingEnabled; }
+#endif
+
         void setPluginAllowedRunTime(unsigned);
         unsigned pluginAllowedRunTime() const { return m_pluginAllowedRunTime; }
 
@@ -623,6 +630,9 @@ namespace WebCore {
 #endif
 #if PLATFORM(WIN) || (OS(WINDOWS) && PLATFORM(WX))
         static bool gShouldUseHighResolutionTimers;
+#endif
+#if USE(JSC)
+        static bool gBackgroundScriptParsingEnabled;
 #endif
     };
 
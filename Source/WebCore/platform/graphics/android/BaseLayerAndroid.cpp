@@ -33,6 +33,7 @@
 #include "SkCanvas.h"
 #include "TilesManager.h"
 #include <GLES2/gl2.h>
+#include <cutils/atomic.h>
 #include <wtf/CurrentTime.h>
 #endif // USE(ACCELERATED_COMPOSITING)
 
@@ -64,9 +65,18 @@ namespace WebCore {
 
 using namespace android;
 
+#if USE(ACCELERATED_COMPOSITING)
+static int32_t nextContentGeneration()
+{
+    static int32_t lastContentGeneration = 0;
+    return android_atomic_inc(&lastContentGeneration) + 1;
+}
+#endif
+
 BaseLayerAndroid::BaseLayerAndroid()
 #if USE(ACCELERATED_COMPOSITING)
     : m_color(Color::white)
+    , m_contentGeneration(nextContentGeneration())
     , m_scrollState(NotScrolling)
 #endif
 {
@@ -92,6 +102,7 @@ void BaseLayerAndroid::setContent(const PictureSet& src)
     // an atomic refcounting scheme and use atomic operations
     // to swap PictureSets.
     android::Mutex::Autolock lock(m_drawLock);
+    m_contentGeneration = nextContentGeneration();
 #endif
     m_content.set(src);
     // FIXME: We cannot set the size of the base layer because it will screw up
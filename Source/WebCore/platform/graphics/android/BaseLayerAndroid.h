@@ -50,6 +50,8 @@ public:
 #if USE(ACCELERATED_COMPOSITING)
     void setBackgroundColor(Color& color) { m_color = color; }
     Color getBackgroundColor() { return m_color; }
+    // changes with the content drawCanvas() draws, unique across base layers
+    int32_t contentGeneration() { return m_contentGeneration; }
 #endif
     void setContent(const android::PictureSet& src);
     android::PictureSet* content() { return &m_content; }
@@ -80,6 +82,7 @@ private:
 
     android::Mutex m_drawLock;
     Color m_color;
+    int32_t m_contentGeneration;
 #endif
     android::PictureSet m_content;
 
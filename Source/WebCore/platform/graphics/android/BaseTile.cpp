@@ -32,6 +32,7 @@
 #include "RasterRenderer.h"
 #include "TextureInfo.h"
 #include "TilesManager.h"
+#include "TimelineRecorder.h"
 
 #include <cutils/atomic.h>
 
@@ -69,6 +70,11 @@ BaseTile::BaseTile(bool isLayerTile)
     , m_repaintPending(false)
     , m_lastDirtyPicture(0)
     , m_isTexturePainted(false)
+    , m_frontFingerprint(0)
+    , m_backFingerprint(0)
+    , m_hasFrontFingerprint(false)
+    , m_hasBackFingerprint(false)
+    , m_backTextureUnused(false)
     , m_isLayerTile(isLayerTile)
     , m_drawCount(0)
     , m_state(Unpainted)
@@ -139,7 +145,9 @@ void BaseTile::reserveTexture()
              this, texture, m_backTexture, m_frontTexture);
         m_state = Unpainted;
         m_backTexture = texture;
+        m_hasBackFingerprint = false;
     }
+    m_backTextureUnused = false;
 
     if (m_state == UpToDate) {
         XLOG("moving tile %p to unpainted, since it reserved while up to date", this);
@@ -161,10 +169,13 @@ bool BaseTile::removeTexture(BaseTileTexture* texture)
         }
 
         m_frontTexture = 0;
+        m_hasFrontFingerprint = false;
     }
     if (m_backTexture == texture) {
         m_state = Unpainted;
         m_backTexture = 0;
+        m_hasBackFingerprint = false;
+        m_backTextureUnused = false;
     }
 
     // mark dirty regardless of which texture was taken - the back texture may
@@ -365,6 +376,7 @@ void BaseTile::paintBitmap()
               this, m_state, m_frontTexture, m_backTexture);
     }
     m_state = PaintingStarted;
+    m_backTextureUnused = false;
 
     texture->producerAcquireContext();
     TextureInfo* textureInfo = texture->producerLock();
@@ -377,6 +389,20 @@ void BaseTile::paintBitmap()
         return;
     }
 
+    TimelineScope paintScope(TimelineRecorder::TilePaint, x, y);
+
+    // If the tile's content did not change since the front texture was
+    // painted, no need to paint (and transfer) it again
+    uint64_t fingerprint = 0;
+    bool hasFingerprint = painter && painter->fingerprint(x, y, texture->getSize(),
+                                                          scale, &fingerprint);
+    if (hasFingerprint && reuseFrontTexture(texture, fingerprint, dirtyArea)) {
+        texture->producerRelease();
+        TilesManager::instance()->getProfiler()->nextFingerprint(hasFingerprint, true);
+        return;
+    }
+    TilesManager::instance()->getProfiler()->nextFingerprint(hasFingerprint, false);
+
     unsigned int pictureCount = 0;
 
     // swap out the renderer if necessary
@@ -399,9 +425,14 @@ void BaseTile::paintBitmap()
 
     bool fullRepaint = false;
 
+    // A texture of another config (see TilesManager::tileConfig()) gets
+    // reallocated, without the rest of the tile
+    GLenum internalFormat = GLUtils::getInternalFormat(
+        TilesManager::instance()->tileConfig(m_isLayerTile));
     if (m_fullRepaint[m_currentDirtyAreaIndex]
         || textureInfo->m_width != tileWidth
-        || textureInfo->m_height != tileHeight) {
+        || textureInfo->m_height != tileHeight
+        || textureInfo->m_internalFormat != internalFormat) {
         fullRepaint = true;
     }
 
@@ -472,6 +503,8 @@ void BaseTile::paintBitmap()
     texture->producerReleaseAndSwap();
     if (texture == m_backTexture) {
         m_isTexturePainted = true;
+        m_backFingerprint = fingerprint;
+        m_hasBackFingerprint = hasFingerprint;
 
         // set the fullrepaint flags
         m_fullRepaint[m_currentDirtyAreaIndex] = false;
@@ -522,6 +555,9 @@ void BaseTile::discardTextures() {
         m_backTexture->release(this);
         m_backTexture = 0;
     }
+    m_hasFrontFingerprint = false;
+    m_hasBackFingerprint = false;
+    m_backTextureUnused = false;
     for (int i = 0; i < m_maxBufferNumber; i++) {
         m_dirtyArea[i].setEmpty();
         m_fullRepaint[i] = true;
@@ -536,12 +572,21 @@ void BaseTile::discardBackTexture() {
         m_backTexture->release(this);
         m_backTexture = 0;
     }
+    m_hasBackFingerprint = false;
+    m_backTextureUnused = false;
     m_state = Unpainted;
     m_dirty = true;
 }
 
 bool BaseTile::swapTexturesIfNeeded() {
     android::AutoMutex lock(m_atomicSync);
+    if (m_backTextureUnused) {
+        // left by reuseFrontTexture()
+        if (m_backTexture)
+            m_backTexture->release(this);
+        m_backTexture = 0;
+        m_backTextureUnused = false;
+    }
     if (m_state == ReadyToSwap) {
         // discard old texture and swap the new one in its place
         if (m_frontTexture)
@@ -549,6 +594,9 @@ bool BaseTile::swapTexturesIfNeeded() {
 
         m_frontTexture = m_backTexture;
         m_backTexture = 0;
+        m_frontFingerprint = m_backFingerprint;
+        m_hasFrontFingerprint = m_hasBackFingerprint;
+        m_hasBackFingerprint = false;
         m_state = UpToDate;
         XLOG("display texture for %p at %d, %d front is now %p, back is %p",
              this, m_x, m_y, m_frontTexture, m_backTexture);
@@ -558,6 +606,43 @@ bool BaseTile::swapTexturesIfNeeded() {
     return false;
 }
 
+// Called by paintBitmap() instead of painting texture, when fingerprint is the
+// one of the front texture's content
+bool BaseTile::reuseFrontTexture(BaseTileTexture* texture, uint64_t fingerprint,
+                                 const SkRegion& dirtyArea)
+{
+    android::AutoMutex lock(m_atomicSync);
+    if (texture != m_backTexture
+        || !m_frontTexture
+        || m_frontTexture->owner() != this
+        || !m_hasFrontFingerprint
+        || m_frontFingerprint != fingerprint)
+        return false;
+
+    // Marked dirty since we started, the fingerprint may be outdated
+    for (int i = 0; i < m_maxBufferNumber; i++) {
+        SkRegion remaining(m_dirtyArea[i]);
+        remaining.op(dirtyArea, SkRegion::kDifference_Op);
+        if (!remaining.isEmpty())
+            return false;
+    }
+
+    XLOG("tile %p (%d, %d) unchanged, keeping front texture %p",
+         this, m_x, m_y, m_frontTexture);
+
+    // The back texture was not painted, the UI thread lets another tile have
+    // it on the next swap. Its next one will need a full repaint.
+    m_backTextureUnused = true;
+    m_hasBackFingerprint = false;
+    for (int i = 0; i < m_maxBufferNumber; i++) {
+        m_dirtyArea[i].setEmpty();
+        m_fullRepaint[i] = true;
+    }
+    m_dirty = false;
+    m_state = UpToDate;
+    return true;
+}
+
 void BaseTile::backTextureTransfer() {
     android::AutoMutex lock(m_atomicSync);
     if (m_state == PaintingStarted)
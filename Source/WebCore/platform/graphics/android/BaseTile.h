@@ -142,6 +142,8 @@ public:
 
 private:
     void validatePaint();
+    bool reuseFrontTexture(BaseTileTexture* texture, uint64_t fingerprint,
+                           const SkRegion& dirtyArea);
 
     GLWebViewState* m_glWebViewState;
 
@@ -180,6 +182,16 @@ private:
     // flag used to know if we have a texture that was painted at least once
     bool m_isTexturePainted;
 
+    // fingerprints (see TileFingerprint) of the content painted in the
+    // textures, if they could be computed
+    uint64_t m_frontFingerprint;
+    uint64_t m_backFingerprint;
+    bool m_hasFrontFingerprint;
+    bool m_hasBackFingerprint;
+    // set when the front texture was kept instead of painting the back one,
+    // which swapTexturesIfNeeded() then releases
+    bool m_backTextureUnused;
+
     // This mutex serves two purposes. (1) It ensures that certain operations
     // happen atomically and (2) it makes sure those operations are synchronized
     // across all threads and cores.
@@ -55,6 +55,7 @@ namespace WebCore {
 BaseTileTexture::BaseTileTexture(uint32_t w, uint32_t h)
     : DoubleBufferedTexture(eglGetCurrentContext(),
                             TilesManager::instance()->getSharedTextureMode())
+    , m_config(SkBitmap::kARGB_8888_Config)
     , m_owner(0)
     , m_busy(false)
 {
@@ -80,10 +81,16 @@ BaseTileTexture::~BaseTileTexture()
 #endif
 }
 
-void BaseTileTexture::requireGLTexture()
+void BaseTileTexture::requireGLTexture(SkBitmap::Config config)
 {
-    if (!m_ownTextureId)
-        m_ownTextureId = GLUtils::createBaseTileGLTexture(m_size.width(), m_size.height());
+    if (m_ownTextureId && m_config != config)
+        GLUtils::deleteTexture(&m_ownTextureId);
+
+    if (!m_ownTextureId) {
+        m_ownTextureId = GLUtils::createBaseTileGLTexture(m_size.width(), m_size.height(),
+                                                          config);
+        m_config = config;
+    }
 }
 
 void BaseTileTexture::discardGLTexture()
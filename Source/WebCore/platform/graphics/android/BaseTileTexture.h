@@ -104,8 +104,9 @@ public:
 
     // OpenGL ID of backing texture, 0 when not allocated
     GLuint m_ownTextureId;
-    // these are used for dynamically (de)allocating backing graphics memory
-    void requireGLTexture();
+    // these are used for dynamically (de)allocating backing graphics memory,
+    // the texture is reallocated if it does not have the required config
+    void requireGLTexture(SkBitmap::Config config = SkBitmap::kARGB_8888_Config);
     void discardGLTexture();
 
     void setOwnTextureTileInfoFromQueue(const TextureTileInfo* info);
@@ -118,6 +119,7 @@ private:
     TextureTileInfo m_ownTextureTileInfo;
 
     SkSize m_size;
+    // config of m_ownTextureId
     SkBitmap::Config m_config;
 
     // BaseTile owning the texture, only modified by UI thread
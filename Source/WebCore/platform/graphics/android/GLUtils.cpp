@@ -189,7 +189,7 @@ bool GLUtils::isEGLFenceSyncSupported()
 // Textures utilities
 /////////////////////////////////////////////////////////////////////////////////////////
 
-static GLenum getInternalFormat(SkBitmap::Config config)
+GLenum GLUtils::getInternalFormat(SkBitmap::Config config)
 {
     switch (config) {
     case SkBitmap::kA8_Config:
@@ -352,7 +352,7 @@ GLuint GLUtils::createSampleTexture()
     return texture;
 }
 
-GLuint GLUtils::createBaseTileGLTexture(int width, int height)
+GLuint GLUtils::createBaseTileGLTexture(int width, int height, SkBitmap::Config config)
 {
     GLuint texture;
     glGenTextures(1, &texture);
@@ -366,7 +366,9 @@ GLuint GLUtils::createBaseTileGLTexture(int width, int height)
 #endif
     glBindTexture(GL_TEXTURE_2D, texture);
     GLUtils::checkGlError("glBindTexture");
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    int internalformat = getInternalFormat(config);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalformat, width, height, 0,
+                 internalformat, getType(config), pixels);
     GLUtils::checkGlError("glTexImage2D");
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -383,7 +385,9 @@ void GLUtils::paintTextureWithBitmap(const TileRenderInfo* renderInfo,
     const SkSize& requiredSize = renderInfo->tileSize;
     TextureInfo* textureInfo = renderInfo->textureInfo;
     SharedTextureMode mode = textureInfo->getSharedTextureMode();
-    if (requiredSize.equals(textureInfo->m_width, textureInfo->m_height)) {
+    // A bitmap of another config (opaque 565 tiles) needs a new texture
+    if (requiredSize.equals(textureInfo->m_width, textureInfo->m_height)
+        && textureInfo->m_internalFormat == getInternalFormat(bitmap.config())) {
         if (mode == EglImageMode)
             GLUtils::updateTextureWithBitmap(textureInfo->m_textureId, x, y, bitmap);
         else if (mode == SurfaceTextureMode)
@@ -410,7 +414,7 @@ void GLUtils::paintTextureWithBitmap(const TileRenderInfo* renderInfo,
 #endif
         textureInfo->m_width = bitmap.width();
         textureInfo->m_height = bitmap.height();
-        textureInfo->m_internalFormat = GL_RGBA;
+        textureInfo->m_internalFormat = getInternalFormat(bitmap.config());
     }
 }
 
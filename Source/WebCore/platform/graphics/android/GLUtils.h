@@ -70,7 +70,9 @@ public:
     static void deleteTexture(GLuint* texture);
     static GLuint createSampleColorTexture(int r, int g, int b);
     static GLuint createSampleTexture();
-    static GLuint createBaseTileGLTexture(int width, int height);
+    static GLuint createBaseTileGLTexture(int width, int height,
+                                          SkBitmap::Config config = SkBitmap::kARGB_8888_Config);
+    static GLenum getInternalFormat(SkBitmap::Config config);
 
     static void createTextureWithBitmap(GLuint texture, const SkBitmap& bitmap, GLint filter = GL_LINEAR);
     static void updateTextureWithBitmap(GLuint texture, int x, int y, const SkBitmap& bitmap, GLint filter = GL_LINEAR);
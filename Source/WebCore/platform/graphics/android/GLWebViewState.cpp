@@ -37,6 +37,7 @@
 #include "SkPath.h"
 #include "TilesManager.h"
 #include "TilesTracker.h"
+#include "TimelineRecorder.h"
 #include "TreeManager.h"
 #include <wtf/CurrentTime.h>
 
@@ -87,6 +88,7 @@ GLWebViewState::GLWebViewState()
     , m_highEndGfx(false)
     , m_scale(1)
     , m_layersRenderingMode(kAllTextures)
+    , m_useOpaque565Tiles(false)
 {
     m_viewport.setEmpty();
     m_futureViewportTileBounds.setEmpty();
@@ -203,6 +205,15 @@ unsigned int GLWebViewState::paintBaseLayerContent(SkCanvas* canvas)
     return m_currentPictureCounter;
 }
 
+bool GLWebViewState::fingerprintBaseLayerContent(int x, int y, const SkSize& tileSize,
+                                                 float scale, uint64_t* fingerprint)
+{
+    // The layers drawn with the base content change in place
+    if (m_layersRenderingMode == kSingleSurfaceRendering)
+        return false;
+    return m_treeManager.fingerprintBaseTile(x, y, tileSize, scale, fingerprint);
+}
+
 TiledPage* GLWebViewState::sibling(TiledPage* page)
 {
     return (page == m_tiledPageA) ? m_tiledPageB : m_tiledPageA;
@@ -449,6 +460,7 @@ bool GLWebViewState::drawGL(IntRect& rect, SkRect& viewport, IntRect* invalRect,
                             IntRect& clip, float scale,
                             bool* treesSwappedPtr, bool* newTreeHasAnimPtr)
 {
+    TimelineScope frameScope(TimelineRecorder::DrawFrame);
     m_scale = scale;
     TilesManager::instance()->getProfiler()->nextFrame(viewport.fLeft,
                                                        viewport.fTop,
@@ -475,6 +487,14 @@ bool GLWebViewState::drawGL(IntRect& rect, SkRect& viewport, IntRect* invalRect,
 
     resetLayersDirtyArea();
 
+    // Base tiles are painted in another config now, and their textures are
+    // reallocated: repaint them all rather than as they get invalidated
+    bool useOpaque565Tiles = TilesManager::instance()->useOpaque565Tiles();
+    if (useOpaque565Tiles != m_useOpaque565Tiles) {
+        m_useOpaque565Tiles = useOpaque565Tiles;
+        fullInval();
+    }
+
     // when adding or removing layers, use the the paintingBaseLayer's tree so
     // that content that moves to the base layer from a layer is synchronized
 
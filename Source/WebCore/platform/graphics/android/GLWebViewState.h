@@ -176,6 +176,8 @@ public:
     void setFutureViewport(const SkIRect& viewport) { m_futureViewportTileBounds = viewport; }
 
     unsigned int paintBaseLayerContent(SkCanvas* canvas);
+    bool fingerprintBaseLayerContent(int x, int y, const SkSize& tileSize,
+                                     float scale, uint64_t* fingerprint);
     void setBaseLayer(BaseLayerAndroid* layer, const SkRegion& inval, bool showVisualIndicator,
                       bool isPictureAfterFirstLayout);
     void paintExtras();
@@ -290,6 +292,10 @@ private:
 
     LayersRenderingMode m_layersRenderingMode;
     TreeManager m_treeManager;
+
+    // TilesManager::useOpaque565Tiles() when the base tiles were last
+    // invalidated for it
+    bool m_useOpaque565Tiles;
 };
 
 } // namespace WebCore
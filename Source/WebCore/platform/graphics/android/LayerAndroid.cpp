@@ -17,6 +17,7 @@
 #include "SkPaint.h"
 #include "SkPicture.h"
 #include "TilesManager.h"
+#include "TimelineRecorder.h"
 
 #include <wtf/CurrentTime.h>
 #include <math.h>
@@ -1021,6 +1022,7 @@ void LayerAndroid::clearDirtyRegion()
 void LayerAndroid::prepare()
 {
     XLOG("LA %p preparing, m_texture %p", this, m_texture);
+    TimelineScope prepareScope(TimelineRecorder::LayerPrepare, uniqueId());
 
     int count = this->countChildren();
     if (count > 0) {
@@ -1111,6 +1113,7 @@ bool LayerAndroid::drawCanvas(SkCanvas* canvas)
 
 bool LayerAndroid::drawGL()
 {
+    TimelineScope drawScope(TimelineRecorder::LayerDraw, uniqueId());
     FloatRect clippingRect = TilesManager::instance()->shader()->rectInScreenCoord(m_clippingRect);
     TilesManager::instance()->shader()->clip(clippingRect);
     if (!m_visible)
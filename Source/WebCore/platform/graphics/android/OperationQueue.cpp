@@ -0,0 +1,303 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "OperationQueue.h"
+
+namespace WebCore {
+
+OperationQueue::OperationQueue()
+    : m_blockedCount(0)
+    , m_sequence(0)
+    , m_generation(0)
+{
+}
+
+void OperationQueue::append(QueuedOperation* operation)
+{
+    Entry entry;
+    entry.operation = operation;
+    entry.priority = operation->priority();
+    entry.sequence = m_sequence++;
+    insert(entry);
+    indexPage(operation);
+}
+
+void OperationQueue::reprioritize(unsigned long long generation)
+{
+    if (generation == m_generation)
+        return;
+    m_generation = generation;
+
+    for (unsigned i = 0; i < m_heap.size(); i++)
+        m_heap[i].priority = m_heap[i].operation->priority();
+    heapify();
+
+    BlockedMap::iterator end = m_blocked.end();
+    for (BlockedMap::iterator it = m_blocked.begin(); it != end; ++it) {
+        Vector<Entry>& entries = it->second;
+        for (unsigned i = 0; i < entries.size(); i++)
+            entries[i].priority = entries[i].operation->priority();
+    }
+}
+
+QueuedOperation* OperationQueue::popNext(OperationFilter* filter)
+{
+    if (!filter) {
+        if (m_heap.isEmpty())
+            return 0;
+        QueuedOperation* operation = removeAt(0).operation;
+        unindexPage(operation);
+        return operation;
+    }
+
+    // Set aside the operations the filter rejects, and put them back once
+    // we are done -- they keep their sequence, thus their order. Those that
+    // are only blocked stay aside until their blocker is released, so that
+    // the next pops do not go through them again.
+    Vector<Entry> rejected;
+    QueuedOperation* operation = 0;
+    while (!m_heap.isEmpty()) {
+        Entry entry = removeAt(0);
+        if (filter->check(entry.operation)) {
+            operation = entry.operation;
+            unindexPage(operation);
+            break;
+        }
+        if (const void* blocker = filter->blocker(entry.operation))
+            block(blocker, entry);
+        else
+            rejected.append(entry);
+    }
+    for (unsigned i = 0; i < rejected.size(); i++)
+        insert(rejected[i]);
+    return operation;
+}
+
+void OperationQueue::unblock(const void* blocker)
+{
+    BlockedMap::iterator it = m_blocked.find(blocker);
+    if (it == m_blocked.end())
+        return;
+    Vector<Entry>& entries = it->second;
+    if (entries.size() < m_heap.size() / 4) {
+        for (unsigned i = 0; i < entries.size(); i++)
+            insert(entries[i]);
+    } else {
+        // Most of the queue was blocked, rebuilding the heap is cheaper
+        m_heap.append(entries);
+        heapify();
+    }
+    m_blockedCount -= entries.size();
+    m_blocked.remove(it);
+}
+
+void OperationQueue::removeOperationsForFilter(OperationFilter* filter,
+                                               Vector<QueuedOperation*>& removed)
+{
+    TiledPage* page = filter->page();
+    if (page) {
+        // Only look at the operations of that page
+        HashMap<TiledPage*, OperationSet>::iterator it = m_pageOperations.find(page);
+        if (it == m_pageOperations.end())
+            return;
+        Vector<QueuedOperation*> candidates;
+        copyToVector(it->second, candidates);
+        for (unsigned i = 0; i < candidates.size(); i++) {
+            QueuedOperation* operation = candidates[i];
+            if (!filter->check(operation))
+                continue;
+            if (operation->m_queueIndex >= 0)
+                removeAt(operation->m_queueIndex);
+            else
+                removeBlocked(operation);
+            unindexPage(operation);
+            removed.append(operation);
+        }
+        return;
+    }
+
+    // Any operation may match, compact the heap and rebuild it in one pass
+    unsigned kept = 0;
+    for (unsigned i = 0; i < m_heap.size(); i++) {
+        QueuedOperation* operation = m_heap[i].operation;
+        if (filter->check(operation)) {
+            operation->m_queueIndex = -1;
+            unindexPage(operation);
+            removed.append(operation);
+        } else
+            m_heap[kept++] = m_heap[i];
+    }
+    if (kept != m_heap.size()) {
+        m_heap.shrink(kept);
+        heapify();
+    }
+
+    BlockedMap::iterator end = m_blocked.end();
+    Vector<const void*> emptied;
+    for (BlockedMap::iterator it = m_blocked.begin(); it != end; ++it) {
+        Vector<Entry>& entries = it->second;
+        unsigned keptBlocked = 0;
+        for (unsigned i = 0; i < entries.size(); i++) {
+            QueuedOperation* operation = entries[i].operation;
+            if (filter->check(operation)) {
+                operation->m_queueIndex = -1;
+                unindexPage(operation);
+                removed.append(operation);
+            } else
+                entries[keptBlocked++] = entries[i];
+        }
+        m_blockedCount -= entries.size() - keptBlocked;
+        entries.shrink(keptBlocked);
+        if (!keptBlocked)
+            emptied.append(it->first);
+    }
+    for (unsigned i = 0; i < emptied.size(); i++)
+        m_blocked.remove(emptied[i]);
+}
+
+void OperationQueue::insert(const Entry& entry)
+{
+    m_heap.append(entry);
+    entry.operation->m_queueIndex = m_heap.size() - 1;
+    siftUp(m_heap.size() - 1);
+}
+
+OperationQueue::Entry OperationQueue::removeAt(unsigned index)
+{
+    Entry entry = m_heap[index];
+    entry.operation->m_queueIndex = -1;
+
+    Entry last = m_heap.last();
+    m_heap.removeLast();
+    if (index < m_heap.size()) {
+        place(last, index);
+        if (index && lessThan(last, m_heap[(index - 1) / 2]))
+            siftUp(index);
+        else
+            siftDown(index);
+    }
+    return entry;
+}
+
+void OperationQueue::place(const Entry& entry, unsigned index)
+{
+    m_heap[index] = entry;
+    entry.operation->m_queueIndex = index;
+}
+
+void OperationQueue::siftUp(unsigned index)
+{
+    Entry entry = m_heap[index];
+    while (index) {
+        unsigned parent = (index - 1) / 2;
+        if (!lessThan(entry, m_heap[parent]))
+            break;
+        place(m_heap[parent], index);
+        index = parent;
+    }
+    place(entry, index);
+}
+
+void OperationQueue::siftDown(unsigned index)
+{
+    const unsigned size = m_heap.size();
+    Entry entry = m_heap[index];
+    while (true) {
+        unsigned child = 2 * index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && lessThan(m_heap[child + 1], m_heap[child]))
+            child++;
+        if (!lessThan(m_heap[child], entry))
+            break;
+        place(m_heap[child], index);
+        index = child;
+    }
+    place(entry, index);
+}
+
+void OperationQueue::heapify()
+{
+    for (unsigned i = m_heap.size() / 2; i > 0; i--)
+        siftDown(i - 1);
+    // siftDown() only updates the positions of the entries it moves
+    for (unsigned i = 0; i < m_heap.size(); i++)
+        m_heap[i].operation->m_queueIndex = i;
+}
+
+void OperationQueue::block(const void* blocker, const Entry& entry)
+{
+    BlockedMap::iterator it = m_blocked.find(blocker);
+    if (it == m_blocked.end())
+        it = m_blocked.add(blocker, Vector<Entry>()).first;
+    it->second.append(entry);
+    entry.operation->m_queueIndex = -2;
+    m_blockedCount++;
+}
+
+void OperationQueue::removeBlocked(QueuedOperation* operation)
+{
+    BlockedMap::iterator end = m_blocked.end();
+    for (BlockedMap::iterator it = m_blocked.begin(); it != end; ++it) {
+        Vector<Entry>& entries = it->second;
+        for (unsigned i = 0; i < entries.size(); i++) {
+            if (entries[i].operation != operation)
+                continue;
+            entries.remove(i);
+            operation->m_queueIndex = -1;
+            m_blockedCount--;
+            if (entries.isEmpty())
+                m_blocked.remove(it);
+            return;
+        }
+    }
+}
+
+void OperationQueue::indexPage(QueuedOperation* operation)
+{
+    TiledPage* page = operation->page();
+    if (!page)
+        return;
+    HashMap<TiledPage*, OperationSet>::iterator it = m_pageOperations.find(page);
+    if (it == m_pageOperations.end())
+        it = m_pageOperations.add(page, OperationSet()).first;
+    it->second.add(operation);
+}
+
+void OperationQueue::unindexPage(QueuedOperation* operation)
+{
+    TiledPage* page = operation->page();
+    if (!page)
+        return;
+    HashMap<TiledPage*, OperationSet>::iterator it = m_pageOperations.find(page);
+    if (it == m_pageOperations.end())
+        return;
+    it->second.remove(operation);
+    if (it->second.isEmpty())
+        m_pageOperations.remove(it);
+}
+
+} // namespace WebCore
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef OperationQueue_h
+#define OperationQueue_h
+
+#include "QueuedOperation.h"
+#include <wtf/HashMap.h>
+#include <wtf/HashSet.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Indexed binary heap of QueuedOperations, ordered by priority (lower values
+// first) then by order of insertion.
+// QueuedOperation::priority() changes over time, so priorities are cached
+// and only recomputed by reprioritize() when the generation (the GL draw
+// count, as priorities are relative to the last frame) changes, rather than
+// on every pop.
+// Operations are not owned by the queue. The queue is not thread-safe.
+class OperationQueue {
+public:
+    OperationQueue();
+
+    void append(QueuedOperation* operation);
+
+    // Recomputes the priorities of all the operations if generation differs
+    // from the one used for the previous computation.
+    void reprioritize(unsigned long long generation);
+
+    // Removes and returns the first operation accepted by the filter (any
+    // operation if the filter is null), or 0 if there is none. Rejected
+    // operations the filter gives a blocker for are set aside, and not looked
+    // at again until unblock() is called for that blocker.
+    QueuedOperation* popNext(OperationFilter* filter = 0);
+
+    // Puts back the operations set aside for the blocker, in their order.
+    void unblock(const void* blocker);
+
+    // Removes all the operations matching the filter and appends them to
+    // removed, in no particular order.
+    void removeOperationsForFilter(OperationFilter* filter,
+                                   Vector<QueuedOperation*>& removed);
+
+    unsigned size() const { return m_heap.size() + m_blockedCount; }
+    bool isEmpty() const { return !size(); }
+
+private:
+    struct Entry {
+        QueuedOperation* operation;
+        int priority;
+        unsigned sequence;
+    };
+
+    typedef HashSet<QueuedOperation*> OperationSet;
+    typedef HashMap<const void*, Vector<Entry> > BlockedMap;
+
+    static bool lessThan(const Entry& a, const Entry& b)
+    {
+        if (a.priority != b.priority)
+            return a.priority < b.priority;
+        return a.sequence < b.sequence;
+    }
+
+    void insert(const Entry& entry);
+    Entry removeAt(unsigned index);
+    void place(const Entry& entry, unsigned index);
+    void siftUp(unsigned index);
+    void siftDown(unsigned index);
+    void heapify();
+
+    void block(const void* blocker, const Entry& entry);
+    void removeBlocked(QueuedOperation* operation);
+
+    void indexPage(QueuedOperation* operation);
+    void unindexPage(QueuedOperation* operation);
+
+    // each operation keeps its position in m_queueIndex, for removals
+    Vector<Entry> m_heap;
+    // operations of each (non null) page, for page restricted filters
+    HashMap<TiledPage*, OperationSet> m_pageOperations;
+    // operations set aside by popNext(), by blocker
+    BlockedMap m_blocked;
+    unsigned m_blockedCount;
+    unsigned m_sequence;
+    unsigned long long m_generation;
+};
+
+} // namespace WebCore
+
+#endif // OperationQueue_h
@@ -45,6 +45,7 @@ public:
     // returns a rendering priority for m_tile, lower values are processed faster
     virtual int priority();
     TilePainter* painter() { return m_tile->painter(); }
+    BaseTile* tile() { return m_tile; }
     float scale() { return m_tile->scale(); }
 
 private:
@@ -25,6 +25,8 @@
 
 #include "PerformanceMonitor.h"
 
+#include "TimelineRecorder.h"
+
 #include <wtf/text/CString.h>
 
 #include <wtf/CurrentTime.h>
@@ -51,8 +53,12 @@ void PerformanceMonitor::start(const String &tag)
         item = m_tags.get(tag);
     else {
         item = new PerfItem();
+        item->timeline_name = TimelineRecorder::registerName(tag.latin1().data());
         m_tags.set(tag, item);
     }
+    item->timeline_begun = TimelineRecorder::enabled();
+    if (item->timeline_begun)
+        TimelineRecorder::record(item->timeline_name, 'B');
     gettimeofday(&(item->start_time), NULL);
 }
 
@@ -63,6 +69,10 @@ void PerformanceMonitor::stop(const String &tag)
     PerfItem *item = m_tags.get(tag);
     struct timeval end;
     gettimeofday(&end, NULL);
+    if (item->timeline_begun) {
+        TimelineRecorder::record(item->timeline_name, 'E');
+        item->timeline_begun = false;
+    }
     long seconds, useconds;
     seconds  = end.tv_sec  - item->start_time.tv_sec;
     useconds = end.tv_usec - item->start_time.tv_usec;
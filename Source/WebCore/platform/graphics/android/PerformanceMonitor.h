@@ -36,9 +36,12 @@
 namespace WebCore {
 
 struct PerfItem {
-    PerfItem() : average_ms(0), start_time() {}
+    PerfItem() : average_ms(0), start_time(), timeline_name(-1), timeline_begun(false) {}
     float average_ms;
     struct timeval start_time;
+    // the tag's name in the TimelineRecorder
+    int timeline_name;
+    bool timeline_begun;
 };
 
 class PerformanceMonitor {
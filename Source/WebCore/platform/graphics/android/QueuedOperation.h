@@ -35,7 +35,8 @@ public:
     enum OperationType { Undefined, PaintTile, PaintLayer, DeleteTexture };
     QueuedOperation(OperationType type, TiledPage* page)
         : m_type(type)
-        , m_page(page) {}
+        , m_page(page)
+        , m_queueIndex(-1) {}
     virtual ~QueuedOperation() {}
     virtual void run() = 0;
     virtual bool operator==(const QueuedOperation* operation) = 0;
@@ -43,14 +44,24 @@ public:
     OperationType type() const { return m_type; }
     TiledPage* page() const { return m_page; }
 private:
+    friend class OperationQueue;
     OperationType m_type;
     TiledPage* m_page;
+    // position in the OperationQueue heap, -1 if not queued, -2 if set aside
+    // until what blocks it is released
+    int m_queueIndex;
 };
 
 class OperationFilter {
 public:
     virtual ~OperationFilter() {}
     virtual bool check(QueuedOperation* operation) = 0;
+    // if not null, the filter only matches operations of this page
+    virtual TiledPage* page() { return 0; }
+    // if the filter rejects the operation only because something it needs is
+    // busy (e.g. its painter), returns that: popNext() then sets the operation
+    // aside until OperationQueue::unblock() is called with it
+    virtual const void* blocker(QueuedOperation*) { return 0; }
 };
 
 class PageFilter : public OperationFilter {
@@ -62,6 +73,7 @@ public:
             return true;
         return false;
     }
+    virtual TiledPage* page() { return m_page; }
 private:
     TiledPage* m_page;
 };
@@ -76,6 +88,7 @@ public:
             return true;
         return false;
     }
+    virtual TiledPage* page() { return m_page; }
 private:
     TiledPage* m_page;
 };
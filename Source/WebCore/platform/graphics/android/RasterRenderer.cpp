@@ -33,7 +33,9 @@
 #include "SkBitmap.h"
 #include "SkBitmapRef.h"
 #include "SkCanvas.h"
+#include "SkColorPriv.h"
 #include "SkDevice.h"
+#include "SkPaint.h"
 #include "TilesManager.h"
 
 #include <wtf/text/CString.h>
@@ -65,20 +67,13 @@ static const String TAGS[] = {
     TAG_UPDATE_TEXTURE,
 };
 
-SkBitmap* RasterRenderer::g_bitmap = 0;
-
-RasterRenderer::RasterRenderer() : BaseRenderer(BaseRenderer::Raster)
+RasterRenderer::RasterRenderer()
+    : BaseRenderer(BaseRenderer::Raster)
+    , m_bitmap(0)
 {
 #ifdef DEBUG_COUNT
     ClassTracker::instance()->increment("RasterRenderer");
 #endif
-    if (!g_bitmap) {
-        g_bitmap = new SkBitmap();
-        g_bitmap->setConfig(SkBitmap::kARGB_8888_Config,
-                           TilesManager::instance()->tileWidth(),
-                           TilesManager::instance()->tileHeight());
-        g_bitmap->allocPixels();
-    }
 }
 
 RasterRenderer::~RasterRenderer()
@@ -86,6 +81,7 @@ RasterRenderer::~RasterRenderer()
 #ifdef DEBUG_COUNT
     ClassTracker::instance()->decrement("RasterRenderer");
 #endif
+    TilesManager::instance()->bitmapPool()->release(m_bitmap);
 }
 
 void RasterRenderer::setupCanvas(const TileRenderInfo& renderInfo, SkCanvas* canvas)
@@ -93,15 +89,31 @@ void RasterRenderer::setupCanvas(const TileRenderInfo& renderInfo, SkCanvas* can
     if (renderInfo.measurePerf)
         m_perfMon.start(TAG_CREATE_BITMAP);
 
+    // Base tiles are painted over an opaque background, they do not need
+    // an alpha channel
+    TilesManager* tilesManager = TilesManager::instance();
+    SkBitmap::Config config = tilesManager->tileConfig(renderInfo.baseTile->isLayerTile());
+
+    if (m_bitmap && m_bitmap->config() != config) {
+        tilesManager->bitmapPool()->release(m_bitmap);
+        m_bitmap = 0;
+    }
+    if (!m_bitmap) {
+        m_bitmap = tilesManager->bitmapPool()->acquire(tilesManager->tileWidth(),
+                                                       tilesManager->tileHeight(),
+                                                       config);
+    }
+    SkBitmap* bitmap = m_bitmap;
+
     if (renderInfo.baseTile->isLayerTile()) {
-        g_bitmap->setIsOpaque(false);
-        g_bitmap->eraseARGB(0, 0, 0, 0);
+        bitmap->setIsOpaque(false);
+        bitmap->eraseARGB(0, 0, 0, 0);
     } else {
-        g_bitmap->setIsOpaque(true);
-        g_bitmap->eraseARGB(255, 255, 255, 255);
+        bitmap->setIsOpaque(true);
+        bitmap->eraseARGB(255, 255, 255, 255);
     }
 
-    SkDevice* device = new SkDevice(NULL, *g_bitmap, false);
+    SkDevice* device = new SkDevice(NULL, *bitmap, false);
 
     if (renderInfo.measurePerf) {
         m_perfMon.stop(TAG_CREATE_BITMAP);
@@ -116,6 +128,22 @@ void RasterRenderer::setupCanvas(const TileRenderInfo& renderInfo, SkCanvas* can
     canvas->translate(-renderInfo.invalRect->fLeft, -renderInfo.invalRect->fTop);
 }
 
+// True if every pixel of the 8888 bitmap is opaque
+static bool isOpaque(const SkBitmap& bitmap)
+{
+    if (bitmap.config() != SkBitmap::kARGB_8888_Config)
+        return false;
+    SkAutoLockPixels lock(bitmap);
+    for (int y = 0; y < bitmap.height(); y++) {
+        const SkPMColor* row = bitmap.getAddr32(0, y);
+        for (int x = 0; x < bitmap.width(); x++) {
+            if (SkGetPackedA32(row[x]) != 0xFF)
+                return false;
+        }
+    }
+    return true;
+}
+
 void RasterRenderer::renderingComplete(const TileRenderInfo& renderInfo, SkCanvas* canvas)
 {
     if (renderInfo.measurePerf) {
@@ -125,12 +153,40 @@ void RasterRenderer::renderingComplete(const TileRenderInfo& renderInfo, SkCanva
 
     const SkBitmap& bitmap = canvas->getDevice()->accessBitmap(false);
 
-    GLUtils::paintTextureWithBitmap(&renderInfo, bitmap);
+    // Layer tiles covered by opaque content don't need their alpha channel
+    // either. With Surface Textures, tiles are always painted in full.
+    TilesManager* tilesManager = TilesManager::instance();
+    SkBitmap* opaqueBitmap = 0;
+    if (renderInfo.baseTile->isLayerTile() && tilesManager->useOpaque565Tiles()
+        && renderInfo.textureInfo->getSharedTextureMode() == SurfaceTextureMode
+        && isOpaque(bitmap)) {
+        opaqueBitmap = tilesManager->bitmapPool()->acquire(bitmap.width(), bitmap.height(),
+                                                           SkBitmap::kRGB_565_Config);
+        SkCanvas opaqueCanvas(*opaqueBitmap);
+        SkPaint paint;
+        paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+        paint.setDither(true);
+        opaqueCanvas.drawBitmap(bitmap, 0, 0, &paint);
+    }
+
+    uploadBitmap(renderInfo, opaqueBitmap ? *opaqueBitmap : bitmap);
+
+    // The transfer queue copied the pixels, the bitmaps can go back to the
+    // pool. The canvas' device still refers to the pixels, but is not used
+    // any more.
+    tilesManager->bitmapPool()->release(opaqueBitmap);
+    tilesManager->bitmapPool()->release(m_bitmap);
+    m_bitmap = 0;
 
     if (renderInfo.measurePerf)
         m_perfMon.stop(TAG_UPDATE_TEXTURE);
 }
 
+void RasterRenderer::uploadBitmap(const TileRenderInfo& renderInfo, const SkBitmap& bitmap)
+{
+    GLUtils::paintTextureWithBitmap(&renderInfo, bitmap);
+}
+
 const String* RasterRenderer::getPerformanceTags(int& tagCount)
 {
     tagCount = TAG_COUNT;
@@ -50,10 +50,12 @@ protected:
     virtual void setupCanvas(const TileRenderInfo& renderInfo, SkCanvas* canvas);
     virtual void renderingComplete(const TileRenderInfo& renderInfo, SkCanvas* canvas);
     virtual const String* getPerformanceTags(int& tagCount);
+    // hands the painted tile over to its texture
+    virtual void uploadBitmap(const TileRenderInfo& renderInfo, const SkBitmap& bitmap);
 
 private:
-    static SkBitmap* g_bitmap;
-
+    // taken from the TilesManager's bitmap pool for the duration of a paint
+    SkBitmap* m_bitmap;
 };
 
 } // namespace WebCore
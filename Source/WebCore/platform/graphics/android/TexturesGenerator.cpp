@@ -29,6 +29,7 @@
 #if USE(ACCELERATED_COMPOSITING)
 #include "sys/types.h"
 #include "BaseLayerAndroid.h"
+#include "BaseRenderer.h"
 #include "GLUtils.h"
 #include "PaintTileOperation.h"
 #include "TilesManager.h"
@@ -51,13 +52,32 @@
 
 namespace WebCore {
 
+TexturesGenerator::TexturesGenerator(int workerCount)
+    : m_deletingOperations(0)
+{
+    if (workerCount < 1)
+        workerCount = 1;
+    for (int i = 0; i < workerCount; i++) {
+        sp<Worker> worker = new Worker(this, i);
+        m_workers.append(worker);
+        if (!i)
+            worker->run("TexturesGenerator");
+        else {
+            char name[32];
+            snprintf(name, sizeof(name), "TexturesGenerator-%d", i);
+            worker->run(name);
+        }
+    }
+}
+
 void TexturesGenerator::scheduleOperation(QueuedOperation* operation)
 {
     {
         android::Mutex::Autolock lock(mRequestedOperationsLock);
         mRequestedOperations.append(operation);
     }
-    mRequestedOperationsCond.signal();
+    // every worker may not be able to run this operation, wake them all
+    mRequestedOperationsCond.broadcast();
 }
 
 void TexturesGenerator::removeOperationsForPage(TiledPage* page)
@@ -81,128 +101,179 @@ void TexturesGenerator::removeOperationsForFilter(OperationFilter* filter, bool
         return;
 
     android::Mutex::Autolock lock(mRequestedOperationsLock);
-    for (unsigned int i = 0; i < mRequestedOperations.size();) {
-        QueuedOperation* operation = mRequestedOperations[i];
-        if (filter->check(operation)) {
-            mRequestedOperations.remove(i);
-            delete operation;
-        } else {
-            i++;
-        }
-    }
+    Vector<QueuedOperation*> removed;
+    mRequestedOperations.removeOperationsForFilter(filter, removed);
+    for (unsigned int i = 0; i < removed.size(); i++)
+        delete removed[i];
 
-    if (waitForRunning && m_currentOperation) {
-        QueuedOperation* operation = m_currentOperation;
-
-        if (operation && filter->check(operation)) {
-            m_waitForCompletion = true;
-            // The reason we are signaling the transferQueue is :
-            // TransferQueue may be waiting a slot to work on, but now UI
-            // thread is waiting for Tex Gen thread to finish first before the
-            // UI thread can free a slot for the transferQueue.
-            // Therefore, it could be a deadlock.
-            // The solution is use this as a flag to tell Tex Gen thread that
-            // UI thread is waiting now, Tex Gen thread should not wait for the
-            // queue any more.
-            TilesManager::instance()->transferQueue()->interruptTransferQueue(true);
-        }
+    if (waitForRunning && (runningOperationMatches(filter) || m_deletingOperations)) {
+        // The reason we are signaling the transferQueue is :
+        // TransferQueue may be waiting a slot to work on, but now UI
+        // thread is waiting for Tex Gen thread to finish first before the
+        // UI thread can free a slot for the transferQueue.
+        // Therefore, it could be a deadlock.
+        // The solution is use this as a flag to tell Tex Gen threads that
+        // UI thread is waiting now, Tex Gen threads should not wait for the
+        // queue any more.
+        TilesManager::instance()->transferQueue()->interruptTransferQueue(true);
+
+        // At this point, it means that some workers are currently executing
+        // operations that we want to be removed -- we should wait until they
+        // are done, so that when we return our caller can be sure that there
+        // is no more operations in the queue matching the given filter.
+        // Operations that are done may still use what they point to as they
+        // are deleted, and can't be checked against the filter any more:
+        // wait for all of them to be deleted.
+        while (runningOperationMatches(filter) || m_deletingOperations)
+            m_completionCond.wait(mRequestedOperationsLock);
 
-        delete filter;
+        TilesManager::instance()->transferQueue()->interruptTransferQueue(false);
+    }
 
-        // At this point, it means that we are currently executing an operation that
-        // we want to be removed -- we should wait until it is done, so that
-        // when we return our caller can be sure that there is no more operations
-        // in the queue matching the given filter.
-        while (m_waitForCompletion)
-            mRequestedOperationsCond.wait(mRequestedOperationsLock);
-    } else {
-        delete filter;
+    delete filter;
+}
+
+// Must be called from within a lock!
+bool TexturesGenerator::runningOperationMatches(OperationFilter* filter)
+{
+    for (unsigned int i = 0; i < m_runningOperations.size(); i++) {
+        if (filter->check(m_runningOperations[i]))
+            return true;
     }
+    return false;
 }
 
-status_t TexturesGenerator::readyToRun()
+status_t TexturesGenerator::Worker::readyToRun()
 {
-    TilesManager::instance()->markGeneratorAsReady();
-    XLOG("Thread ready to run");
+    m_threadID = gettid();
+    if (isPrimary())
+        TilesManager::instance()->markGeneratorAsReady();
+    XLOG("Thread %d ready to run", m_index);
     return NO_ERROR;
 }
 
+// Takes the priority of the given thread, if it changed since last time
+void TexturesGenerator::Worker::followPriority(int threadID)
+{
+    if (!threadID || !m_threadID)
+        return;
+    int priority = androidGetThreadPriority(threadID);
+    if (priority == m_priority)
+        return;
+    androidSetThreadPriority(m_threadID, priority);
+    m_priority = priority;
+    XLOG("Thread %d now has priority %d", m_index, priority);
+}
+
+bool TexturesGenerator::Worker::threadLoop()
+{
+    m_generator->runNextOperation(this);
+    return true;
+}
+
 // Must be called from within a lock!
-QueuedOperation* TexturesGenerator::popNext()
+bool TexturesGenerator::canRun(Worker* worker, QueuedOperation* operation)
 {
-    // Priority can change between when it was added and now
-    // Hence why the entire queue is rescanned
-    QueuedOperation* current = mRequestedOperations.last();
-    int currentPriority = current->priority();
-    if (currentPriority < 0) {
-        mRequestedOperations.removeLast();
-        return current;
-    }
-    int currentIndex = mRequestedOperations.size() - 1;
-    // Scan from the back to make removing faster (less items to copy)
-    for (int i = mRequestedOperations.size() - 2; i >= 0; i--) {
-        QueuedOperation *next = mRequestedOperations[i];
-        int nextPriority = next->priority();
-        if (nextPriority < 0) {
-            // Found a very high priority item, go ahead and just handle it now
-            mRequestedOperations.remove(i);
-            return next;
-        }
-        // pick items preferrably by priority, or if equal, by order of
-        // insertion (as we add items at the back of the queue)
-        if (nextPriority <= currentPriority) {
-            current = next;
-            currentPriority = nextPriority;
-            currentIndex = i;
-        }
+    if (operation->type() != QueuedOperation::PaintTile)
+        return worker->isPrimary();
+
+    // Ganesh paints through the primary worker's GL context
+    if (!worker->isPrimary() && BaseRenderer::getCurrentRendererType() != BaseRenderer::Raster)
+        return false;
+
+    return !runningBlocker(operation);
+}
+
+// What running the operation needs for itself, if anything
+const void* TexturesGenerator::blockerOf(QueuedOperation* operation)
+{
+    if (operation->type() != QueuedOperation::PaintTile)
+        return 0;
+
+    // A tile is painted by one worker at a time. Tiles sharing a painter
+    // replay the same pictures, which only happens one at a time (see
+    // TilesManager::picturePlaybackLock()): rather than waiting for each
+    // other, workers leave them to one of them, unless the painter asks for
+    // its tiles to be painted concurrently.
+    PaintTileOperation* paintOperation = static_cast<PaintTileOperation*>(operation);
+    TilePainter* painter = paintOperation->painter();
+    if (!painter || painter->paintsConcurrently())
+        return paintOperation->tile();
+    return painter;
+}
+
+// Must be called from within a lock!
+const void* TexturesGenerator::runningBlocker(QueuedOperation* operation)
+{
+    // Leave the operation to the worker already busy with what it needs; the
+    // queue sets it aside until that worker is done
+    const void* blocker = blockerOf(operation);
+    if (!blocker)
+        return 0;
+    for (unsigned int i = 0; i < m_runningOperations.size(); i++) {
+        if (blockerOf(m_runningOperations[i]) == blocker)
+            return blocker;
     }
-    mRequestedOperations.remove(currentIndex);
-    return current;
+    return 0;
 }
 
-bool TexturesGenerator::threadLoop()
+// Must be called from within a lock!
+QueuedOperation* TexturesGenerator::popNext(Worker* worker)
+{
+    // Priority can change between when it was added and now, but only from
+    // one frame to the next: refresh the priorities once per frame
+    mRequestedOperations.reprioritize(TilesManager::instance()->getDrawGLCount());
+
+    // Ganesh paints through the primary worker's GL context, the others have
+    // nothing they can run
+    if (!worker->isPrimary() && BaseRenderer::getCurrentRendererType() != BaseRenderer::Raster)
+        return 0;
+
+    WorkerFilter filter(this, worker);
+    return mRequestedOperations.popNext(&filter);
+}
+
+void TexturesGenerator::runNextOperation(Worker* worker)
 {
-    m_threadID = gettid();
-    // Check if we have any pending operations.
     mRequestedOperationsLock.lock();
-    while (!mRequestedOperations.size())
+    QueuedOperation* operation = popNext(worker);
+    while (!operation) {
         mRequestedOperationsCond.wait(mRequestedOperationsLock);
+        operation = popNext(worker);
+    }
+    m_runningOperations.append(operation);
+    XLOG("worker %p, %d operations in the queue", worker, mRequestedOperations.size());
+    mRequestedOperationsLock.unlock();
 
-    XLOG("threadLoop, got signal");
+    // The WebView only sets the priority of the primary worker (see
+    // threadID()), e.g. lowering it while in the background
+    if (!worker->isPrimary())
+        worker->followPriority(m_workers[0]->m_threadID);
+
+    XLOG("worker %p, painting the request with priority %d", worker, operation->priority());
+    operation->run();
+
+    mRequestedOperationsLock.lock();
+    m_runningOperations.remove(m_runningOperations.find(operation));
+    if (const void* blocker = blockerOf(operation))
+        mRequestedOperations.unblock(blocker);
+    m_deletingOperations++;
+    bool hasPendingOperations = !mRequestedOperations.isEmpty();
     mRequestedOperationsLock.unlock();
 
-    m_currentOperation = 0;
-    bool stop = false;
-    while (!stop) {
-        mRequestedOperationsLock.lock();
-        XLOG("threadLoop, %d operations in the queue", mRequestedOperations.size());
-        if (mRequestedOperations.size())
-            m_currentOperation = popNext();
-        mRequestedOperationsLock.unlock();
-
-        if (m_currentOperation) {
-            XLOG("threadLoop, painting the request with priority %d", m_currentOperation->priority());
-            m_currentOperation->run();
-        }
+    // wake up workers that skipped an operation sharing this one's tile or
+    // painter, now back in the queue
+    if (hasPendingOperations)
+        mRequestedOperationsCond.broadcast();
 
-        QueuedOperation* oldOperation = m_currentOperation;
-        mRequestedOperationsLock.lock();
-        if (m_currentOperation)
-            m_currentOperation = 0;
-        if (!mRequestedOperations.size())
-            stop = true;
-        if (m_waitForCompletion) {
-            m_waitForCompletion = false;
-            TilesManager::instance()->transferQueue()->interruptTransferQueue(false);
-            mRequestedOperationsCond.signal();
-        }
-        mRequestedOperationsLock.unlock();
-        if (oldOperation)
-            delete oldOperation; // delete outside lock
-    }
-    XLOG("threadLoop empty");
+    delete operation; // delete outside lock
 
-    return true;
+    mRequestedOperationsLock.lock();
+    m_deletingOperations--;
+    mRequestedOperationsLock.unlock();
+
+    // wake up anyone waiting in removeOperationsForFilter()
+    m_completionCond.broadcast();
 }
 
 } // namespace WebCore
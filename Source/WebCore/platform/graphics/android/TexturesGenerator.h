@@ -28,10 +28,12 @@
 
 #if USE(ACCELERATED_COMPOSITING)
 
+#include "OperationQueue.h"
 #include "QueuedOperation.h"
 #include "TiledPage.h"
 #include "TilePainter.h"
 #include <utils/threads.h>
+#include <wtf/Vector.h>
 
 namespace WebCore {
 
@@ -40,13 +42,14 @@ using namespace android;
 class BaseLayerAndroid;
 class LayerAndroid;
 
-class TexturesGenerator : public Thread {
+// Pool of background threads painting BaseTiles. All workers drain a single
+// shared queue of QueuedOperations; the first worker (the primary) is the only
+// one allowed to run operations that need its GL context (texture deletion,
+// Ganesh painting), the others only run raster PaintTile operations.
+class TexturesGenerator {
 public:
-    TexturesGenerator() : Thread(false)
-        , m_waitForCompletion(false)
-        , m_currentOperation(0) { }
-    virtual ~TexturesGenerator() { }
-    virtual status_t readyToRun();
+    TexturesGenerator(int workerCount);
+    ~TexturesGenerator() { }
 
     void removeOperationsForPage(TiledPage* page);
     void removePaintOperationsForPage(TiledPage* page, bool waitForRunning);
@@ -54,16 +57,66 @@ public:
     void removeOperationsForFilter(OperationFilter* filter, bool waitForRunning);
 
     void scheduleOperation(QueuedOperation* operation);
-    int m_threadID;
+
+    int workerCount() const { return m_workers.size(); }
+    // thread id of the primary worker, the other workers follow its priority
+    int threadID() const { return m_workers[0]->m_threadID; }
 
 private:
-    QueuedOperation* popNext();
-    virtual bool threadLoop();
-    Vector<QueuedOperation*> mRequestedOperations;
+    class Worker : public Thread {
+    public:
+        Worker(TexturesGenerator* generator, int index)
+            : Thread(false)
+            , m_threadID(0)
+            , m_generator(generator)
+            , m_index(index)
+            , m_priority(ANDROID_PRIORITY_NORMAL) { }
+        virtual status_t readyToRun();
+        bool isPrimary() const { return !m_index; }
+        void followPriority(int threadID);
+        int m_threadID;
+    private:
+        virtual bool threadLoop();
+        TexturesGenerator* m_generator;
+        int m_index;
+        int m_priority;
+    };
+
+    // accepts the operations a given worker can run
+    class WorkerFilter : public OperationFilter {
+    public:
+        WorkerFilter(TexturesGenerator* generator, Worker* worker)
+            : m_generator(generator)
+            , m_worker(worker) { }
+        virtual bool check(QueuedOperation* operation)
+        {
+            return m_generator->canRun(m_worker, operation);
+        }
+        virtual const void* blocker(QueuedOperation* operation)
+        {
+            return m_generator->runningBlocker(operation);
+        }
+    private:
+        TexturesGenerator* m_generator;
+        Worker* m_worker;
+    };
+
+    bool canRun(Worker* worker, QueuedOperation* operation);
+    static const void* blockerOf(QueuedOperation* operation);
+    const void* runningBlocker(QueuedOperation* operation);
+    bool runningOperationMatches(OperationFilter* filter);
+    QueuedOperation* popNext(Worker* worker);
+    void runNextOperation(Worker* worker);
+
+    Vector<sp<Worker> > m_workers;
+    OperationQueue mRequestedOperations;
+    // operations currently being run by a worker, at most one per worker
+    Vector<QueuedOperation*> m_runningOperations;
+    // operations done running, being deleted outside the lock
+    int m_deletingOperations;
     android::Mutex mRequestedOperationsLock;
     android::Condition mRequestedOperationsCond;
-    bool m_waitForCompletion;
-    QueuedOperation* m_currentOperation;
+    android::Condition m_completionCond;
 };
 
 } // namespace WebCore
@@ -0,0 +1,171 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TileBitmapPool.h"
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include <cutils/log.h>
+
+#undef XLOGC
+#define XLOGC(...) android_printLog(ANDROID_LOG_DEBUG, "TileBitmapPool", __VA_ARGS__)
+
+#ifdef DEBUG
+
+#undef XLOG
+#define XLOG(...) android_printLog(ANDROID_LOG_DEBUG, "TileBitmapPool", __VA_ARGS__)
+
+#else
+
+#undef XLOG
+#define XLOG(...)
+
+#endif // DEBUG
+
+namespace WebCore {
+
+TileBitmapPool::TileBitmapPool()
+    : m_budget(0)
+{
+    memset(&m_stats, 0, sizeof(m_stats));
+}
+
+TileBitmapPool::~TileBitmapPool()
+{
+    trim();
+    for (unsigned i = 0; i < m_buckets.size(); i++)
+        delete m_buckets[i];
+}
+
+SkBitmap* TileBitmapPool::acquire(int width, int height, SkBitmap::Config config)
+{
+    android::Mutex::Autolock lock(m_lock);
+
+    Bucket* bucket = bucketFor(width, height, config);
+    if (!bucket->idle.isEmpty()) {
+        SkBitmap* bitmap = bucket->idle.last();
+        bucket->idle.removeLast();
+        m_stats.hits++;
+        m_stats.bytesInUse += bitmap->getSize();
+        return bitmap;
+    }
+
+    SkBitmap* bitmap = new SkBitmap();
+    bitmap->setConfig(config, width, height);
+    freeIdleBitmaps(bitmap->getSize());
+    bitmap->allocPixels();
+    m_stats.misses++;
+    m_stats.bytesResident += bitmap->getSize();
+    m_stats.bytesInUse += bitmap->getSize();
+    if (m_stats.bytesResident > m_budget) {
+        XLOG("over budget: %d bytes resident, budget %d",
+             m_stats.bytesResident, m_budget);
+    }
+    return bitmap;
+}
+
+void TileBitmapPool::release(SkBitmap* bitmap)
+{
+    if (!bitmap)
+        return;
+
+    android::Mutex::Autolock lock(m_lock);
+    m_stats.bytesInUse -= bitmap->getSize();
+    if (m_stats.bytesResident > m_budget) {
+        freeBitmap(bitmap);
+        return;
+    }
+    bucketFor(bitmap->width(), bitmap->height(), bitmap->config())->idle.append(bitmap);
+}
+
+void TileBitmapPool::setBudget(size_t bytes)
+{
+    android::Mutex::Autolock lock(m_lock);
+    XLOGC("budget set to %d bytes (was %d)", bytes, m_budget);
+    m_budget = bytes;
+    freeIdleBitmaps(0);
+}
+
+void TileBitmapPool::trim()
+{
+    android::Mutex::Autolock lock(m_lock);
+    for (unsigned i = 0; i < m_buckets.size(); i++) {
+        Vector<SkBitmap*>& idle = m_buckets[i]->idle;
+        for (unsigned j = 0; j < idle.size(); j++)
+            freeBitmap(idle[j]);
+        idle.clear();
+    }
+}
+
+TileBitmapPool::Stats TileBitmapPool::stats()
+{
+    android::Mutex::Autolock lock(m_lock);
+    return m_stats;
+}
+
+// Must be called with the lock held.
+TileBitmapPool::Bucket* TileBitmapPool::bucketFor(int width, int height,
+                                                  SkBitmap::Config config)
+{
+    // There are only a handful of tile sizes
+    for (unsigned i = 0; i < m_buckets.size(); i++) {
+        Bucket* bucket = m_buckets[i];
+        if (bucket->width == width && bucket->height == height
+            && bucket->config == config)
+            return bucket;
+    }
+    Bucket* bucket = new Bucket();
+    bucket->width = width;
+    bucket->height = height;
+    bucket->config = config;
+    m_buckets.append(bucket);
+    return bucket;
+}
+
+// Frees idle bitmaps until bytesNeeded more bytes fit in the budget, or
+// there is no idle bitmap left. Must be called with the lock held.
+void TileBitmapPool::freeIdleBitmaps(size_t bytesNeeded)
+{
+    for (unsigned i = 0; i < m_buckets.size(); i++) {
+        Vector<SkBitmap*>& idle = m_buckets[i]->idle;
+        while (!idle.isEmpty() && m_stats.bytesResident + bytesNeeded > m_budget) {
+            freeBitmap(idle.last());
+            idle.removeLast();
+            m_stats.evictions++;
+        }
+    }
+}
+
+// Must be called with the lock held.
+void TileBitmapPool::freeBitmap(SkBitmap* bitmap)
+{
+    m_stats.bytesResident -= bitmap->getSize();
+    delete bitmap;
+}
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TileBitmapPool_h
+#define TileBitmapPool_h
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkBitmap.h"
+#include <utils/threads.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// Recycles the bitmaps tiles are painted into, so that painting does not
+// allocate (and the allocator does not have to find) a large block of
+// pixels for every tile.
+// Bitmaps are bucketed by size and config. The pool never refuses a bitmap:
+// over the budget, idle bitmaps of other buckets are freed first, and the
+// bitmaps released while the pool is still over the budget are freed rather
+// than kept. Thread-safe.
+class TileBitmapPool {
+public:
+    struct Stats {
+        unsigned hits;
+        unsigned misses;
+        unsigned evictions;
+        size_t bytesResident; // idle and in use bitmaps
+        size_t bytesInUse;
+    };
+
+    TileBitmapPool();
+    ~TileBitmapPool();
+
+    // Returns a bitmap with allocated pixels, whose content is undefined
+    SkBitmap* acquire(int width, int height, SkBitmap::Config config);
+    void release(SkBitmap* bitmap);
+
+    void setBudget(size_t bytes);
+    // Frees all the idle bitmaps
+    void trim();
+
+    Stats stats();
+
+private:
+    struct Bucket {
+        int width;
+        int height;
+        SkBitmap::Config config;
+        Vector<SkBitmap*> idle;
+    };
+
+    Bucket* bucketFor(int width, int height, SkBitmap::Config config);
+    void freeIdleBitmaps(size_t bytesNeeded);
+    void freeBitmap(SkBitmap* bitmap);
+
+    Vector<Bucket*> m_buckets;
+    size_t m_budget;
+    Stats m_stats;
+    android::Mutex m_lock;
+};
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
+#endif // TileBitmapPool_h
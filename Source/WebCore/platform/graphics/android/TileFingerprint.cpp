@@ -0,0 +1,620 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TileFingerprint.h"
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkRegion.h"
+#include "SkTypeface.h"
+#include "SkXfermode.h"
+#include "TilesManager.h"
+#include <algorithm>
+#include <math.h>
+#include <wtf/Vector.h>
+
+namespace WebCore {
+
+// 64 bit FNV-1a, so that a collision (which would leave a stale tile on
+// screen) is not a practical concern
+static const uint64_t s_fnvOffsetBasis = 0xcbf29ce484222325ULL;
+static const uint64_t s_fnvPrime = 0x100000001b3ULL;
+
+// in content pixels
+static const int s_cellSize = 128;
+// Commands right of or below the content still show in its last tiles
+static const int s_deviceMargin = 1024;
+// The clip is rounded differently at other scales
+static const SkScalar s_clipOutset = SkIntToScalar(8);
+
+enum FingerprintOp {
+    PaintOp = 1,
+    PointsOp,
+    RectOp,
+    PathOp,
+    BitmapOp,
+    SpriteOp,
+    TextOp,
+    PosTextOp,
+    PosTextHOp,
+    TextOnPathOp,
+    SaveLayerOp,
+    RestoreLayerOp,
+    ClipRectOp,
+    ClipPathOp,
+    ClipRegionOp
+};
+
+static void hashBytes(uint64_t* hash, const void* data, size_t length)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; i++) {
+        *hash ^= bytes[i];
+        *hash *= s_fnvPrime;
+    }
+}
+
+template<typename T> static void hashValue(uint64_t* hash, const T& value)
+{
+    hashBytes(hash, &value, sizeof(value));
+}
+
+class FingerprintCanvas : public SkCanvas {
+public:
+    FingerprintCanvas(int width, int height)
+        : m_columns(std::max((width + s_cellSize - 1) / s_cellSize, 1))
+        , m_rows(std::max((height + s_cellSize - 1) / s_cellSize, 1))
+        , m_cells(m_columns * m_rows)
+        , m_command(s_fnvOffsetBasis)
+        , m_commandValid(true)
+        , m_clip(s_fnvOffsetBasis)
+        , m_valid(true)
+    {
+        for (unsigned i = 0; i < m_cells.size(); i++) {
+            m_cells[i].hash = s_fnvOffsetBasis;
+            m_cells[i].valid = true;
+        }
+
+        // The device gives the clip its bounds, its pixels are never used
+        SkBitmap bitmap;
+        bitmap.setConfig(SkBitmap::kARGB_8888_Config, width + s_deviceMargin,
+                         height + s_deviceMargin);
+        setBitmapDevice(bitmap);
+    }
+
+    // Combines the cells covering rect, in content coordinates
+    bool combine(const SkRect& rect, uint64_t* hash) const
+    {
+        if (!m_valid)
+            return false;
+        SkIRect cells = cellsFor(rect);
+        for (int row = cells.fTop; row <= cells.fBottom; row++) {
+            for (int column = cells.fLeft; column <= cells.fRight; column++) {
+                const Cell& cell = m_cells[row * m_columns + column];
+                if (!cell.valid)
+                    return false;
+                hashValue(hash, cell.hash);
+            }
+        }
+        return true;
+    }
+
+    virtual int save(SaveFlags flags)
+    {
+        m_saves.append(SaveRecord(m_clip, flags & kClip_SaveFlag));
+        return SkCanvas::save(flags);
+    }
+
+    virtual int saveLayer(const SkRect* bounds, const SkPaint* paint,
+                          SaveFlags flags)
+    {
+        // Layers are composited back with their paint on restore(), hash
+        // where they start and end in the cells they cover. Only save the
+        // matrix and clip, so that no layer gets allocated.
+        SkRect layerBounds;
+        layerBounds.set(getTotalClip().getBounds());
+        if (bounds) {
+            SkRect deviceBounds;
+            getTotalMatrix().mapRect(&deviceBounds, *bounds);
+            if (!layerBounds.intersect(deviceBounds))
+                layerBounds.setEmpty();
+        }
+        SaveRecord record(m_clip, true);
+        record.isLayer = true;
+        record.layerCells = cellsFor(layerBounds);
+
+        startCommand(SaveLayerOp);
+        add(flags);
+        if (bounds)
+            add(*bounds);
+        if (paint)
+            addPaint(*paint);
+        endCommand(record.layerCells);
+
+        m_saves.append(record);
+        int count = SkCanvas::save(kMatrixClip_SaveFlag);
+        if (bounds)
+            SkCanvas::clipRect(*bounds);
+        return count;
+    }
+
+    virtual void restore()
+    {
+        if (getSaveCount() > 1 && !m_saves.isEmpty()) {
+            SaveRecord record = m_saves.last();
+            m_saves.removeLast();
+            if (record.restoresClip)
+                m_clip = record.clip;
+            if (record.isLayer) {
+                startCommand(RestoreLayerOp);
+                endCommand(record.layerCells);
+            }
+        }
+        SkCanvas::restore();
+    }
+
+    virtual bool clipRect(const SkRect& rect, SkRegion::Op op)
+    {
+        hashValue(&m_clip, ClipRectOp);
+        hashMatrix(&m_clip, getTotalMatrix());
+        hashValue(&m_clip, rect);
+        hashValue(&m_clip, op);
+        return SkCanvas::clipRect(rect, op);
+    }
+
+    virtual bool clipPath(const SkPath& path, SkRegion::Op op)
+    {
+        hashValue(&m_clip, ClipPathOp);
+        hashMatrix(&m_clip, getTotalMatrix());
+        hashPath(&m_clip, path);
+        hashValue(&m_clip, op);
+        return SkCanvas::clipPath(path, op);
+    }
+
+    virtual bool clipRegion(const SkRegion& deviceRegion, SkRegion::Op op)
+    {
+        hashValue(&m_clip, ClipRegionOp);
+        SkRegion::Iterator iter(deviceRegion);
+        while (!iter.done()) {
+            hashValue(&m_clip, iter.rect());
+            iter.next();
+        }
+        hashValue(&m_clip, op);
+        return SkCanvas::clipRegion(deviceRegion, op);
+    }
+
+    virtual void commonDrawBitmap(const SkBitmap& bitmap, const SkIRect* rect,
+                                  const SkMatrix& matrix, const SkPaint& paint)
+    {
+        SkRect bounds;
+        if (rect)
+            bounds.set(*rect);
+        else
+            bounds.iset(0, 0, bitmap.width(), bitmap.height());
+        SkMatrix total = getTotalMatrix();
+        total.preConcat(matrix);
+        if (!begin(BitmapOp, bounds, paint, &total))
+            return;
+        addBitmap(bitmap);
+        if (rect)
+            add(*rect);
+        addMatrix(matrix);
+        end();
+    }
+
+    virtual void drawPaint(const SkPaint& paint)
+    {
+        // Fills the whole clip, whatever the matrix
+        SkRect bounds;
+        bounds.set(getTotalClip().getBounds());
+        SkMatrix identity;
+        identity.reset();
+        if (!begin(PaintOp, bounds, paint, &identity))
+            return;
+        end();
+    }
+
+    virtual void drawPoints(PointMode mode, size_t count, const SkPoint points[],
+                            const SkPaint& paint)
+    {
+        if (!count)
+            return;
+        SkRect bounds;
+        bounds.set(points, count);
+        if (!begin(PointsOp, bounds, paint))
+            return;
+        add(mode);
+        addBytes(points, count * sizeof(SkPoint));
+        end();
+    }
+
+    virtual void drawRect(const SkRect& rect, const SkPaint& paint)
+    {
+        SkRect bounds = rect;
+        bounds.sort();
+        if (!begin(RectOp, bounds, paint))
+            return;
+        add(rect);
+        end();
+    }
+
+    virtual void drawPath(const SkPath& path, const SkPaint& paint)
+    {
+        if (!begin(PathOp, path.getBounds(), paint))
+            return;
+        hashPath(&m_command, path);
+        end();
+    }
+
+    virtual void drawSprite(const SkBitmap& bitmap, int left, int top,
+                            const SkPaint* paint = NULL)
+    {
+        // Sprites ignore the matrix
+        SkRect bounds;
+        bounds.iset(left, top, left + bitmap.width(), top + bitmap.height());
+        SkPaint defaultPaint;
+        SkMatrix identity;
+        identity.reset();
+        if (!begin(SpriteOp, bounds, paint ? *paint : defaultPaint, &identity))
+            return;
+        addBitmap(bitmap);
+        add(left);
+        add(top);
+        end();
+    }
+
+    virtual void drawText(const void* text, size_t byteLength, SkScalar x,
+                          SkScalar y, const SkPaint& paint)
+    {
+        SkScalar width = paint.measureText(text, byteLength);
+        SkRect bounds = SkRect::MakeLTRB(x - width, y, x + width, y);
+        if (!begin(TextOp, textBounds(bounds, paint), paint))
+            return;
+        addBytes(text, byteLength);
+        add(x);
+        add(y);
+        end();
+    }
+
+    virtual void drawPosText(const void* text, size_t byteLength,
+                             const SkPoint pos[], const SkPaint& paint)
+    {
+        int count = paint.countText(text, byteLength);
+        if (!count)
+            return;
+        SkRect bounds;
+        bounds.set(pos, count);
+        if (!begin(PosTextOp, textBounds(bounds, paint), paint))
+            return;
+        addBytes(text, byteLength);
+        addBytes(pos, count * sizeof(SkPoint));
+        end();
+    }
+
+    virtual void drawPosTextH(const void* text, size_t byteLength,
+                              const SkScalar xpos[], SkScalar constY,
+                              const SkPaint& paint)
+    {
+        int count = paint.countText(text, byteLength);
+        if (!count)
+            return;
+        SkRect bounds = SkRect::MakeLTRB(xpos[0], constY, xpos[0], constY);
+        for (int i = 1; i < count; i++) {
+            bounds.fLeft = std::min(bounds.fLeft, xpos[i]);
+            bounds.fRight = std::max(bounds.fRight, xpos[i]);
+        }
+        if (!begin(PosTextHOp, textBounds(bounds, paint), paint))
+            return;
+        addBytes(text, byteLength);
+        addBytes(xpos, count * sizeof(SkScalar));
+        add(constY);
+        end();
+    }
+
+    virtual void drawTextOnPath(const void* text, size_t byteLength,
+                                const SkPath& path, const SkMatrix* matrix,
+                                const SkPaint& paint)
+    {
+        SkRect bounds = path.getBounds();
+        if (matrix)
+            matrix->mapRect(&bounds);
+        if (!begin(TextOnPathOp, textBounds(bounds, paint), paint))
+            return;
+        addBytes(text, byteLength);
+        hashPath(&m_command, path);
+        if (matrix)
+            addMatrix(*matrix);
+        end();
+    }
+
+    // Without bounds, these could touch any tile
+
+    virtual void drawVertices(VertexMode, int, const SkPoint[], const SkPoint[],
+                              const SkColor[], SkXfermode*, const uint16_t[],
+                              int, const SkPaint&)
+    {
+        m_valid = false;
+    }
+
+    virtual void drawData(const void*, size_t)
+    {
+        m_valid = false;
+    }
+
+private:
+    struct Cell {
+        uint64_t hash;
+        bool valid;
+    };
+
+    struct SaveRecord {
+        SaveRecord(uint64_t clip, bool restoresClip)
+            : clip(clip)
+            , restoresClip(restoresClip)
+            , isLayer(false) { }
+        uint64_t clip;
+        bool restoresClip;
+        bool isLayer;
+        // cells the layer is composited into
+        SkIRect layerCells;
+    };
+
+    // Returns false if the command cannot change any pixel. Starts hashing
+    // the command, the state and the paint otherwise, end() then adds it to
+    // the cells it touches.
+    bool begin(FingerprintOp op, const SkRect& bounds, const SkPaint& paint,
+               const SkMatrix* matrix = 0)
+    {
+        if (!m_valid)
+            return false;
+
+        // Outset for strokes, hairlines and antialiasing
+        SkRect deviceBounds = bounds;
+        SkScalar outset = SK_Scalar1;
+        if (paint.getStyle() != SkPaint::kFill_Style)
+            outset += paint.getStrokeWidth() * std::max(paint.getStrokeMiter(), SK_Scalar1);
+        deviceBounds.outset(outset, outset);
+        (matrix ? *matrix : getTotalMatrix()).mapRect(&deviceBounds);
+        deviceBounds.outset(SK_Scalar1, SK_Scalar1);
+
+        SkRect clipBounds;
+        clipBounds.set(getTotalClip().getBounds());
+        clipBounds.outset(s_clipOutset, s_clipOutset);
+        if (!deviceBounds.intersect(clipBounds))
+            return false;
+        m_commandCells = cellsFor(deviceBounds);
+
+        startCommand(op);
+        addMatrix(matrix ? *matrix : getTotalMatrix());
+        add(getDrawFilter());
+        addPaint(paint);
+        return true;
+    }
+
+    void end()
+    {
+        endCommand(m_commandCells);
+    }
+
+    void startCommand(FingerprintOp op)
+    {
+        m_command = s_fnvOffsetBasis;
+        m_commandValid = true;
+        add(op);
+        add(m_clip);
+    }
+
+    void endCommand(const SkIRect& cells)
+    {
+        for (int row = cells.fTop; row <= cells.fBottom; row++) {
+            for (int column = cells.fLeft; column <= cells.fRight; column++) {
+                Cell& cell = m_cells[row * m_columns + column];
+                cell.valid = cell.valid && m_commandValid;
+                hashValue(&cell.hash, m_command);
+            }
+        }
+    }
+
+    // Commands and tiles beyond the content fall in its edge cells
+    SkIRect cellsFor(const SkRect& rect) const
+    {
+        SkIRect cells;
+        cells.fLeft = cellIndex(rect.fLeft, m_columns);
+        cells.fTop = cellIndex(rect.fTop, m_rows);
+        cells.fRight = cellIndex(rect.fRight, m_columns);
+        cells.fBottom = cellIndex(rect.fBottom, m_rows);
+        return cells;
+    }
+
+    static int cellIndex(SkScalar coordinate, int count)
+    {
+        float index = floorf(SkScalarToFloat(coordinate) / s_cellSize);
+        if (!(index >= 0)) // also catches NaN
+            return 0;
+        if (index >= count)
+            return count - 1;
+        return static_cast<int>(index);
+    }
+
+    SkRect textBounds(const SkRect& bounds, const SkPaint& paint)
+    {
+        // Glyphs extend above and below the baseline, and before or after
+        // the origin depending on the alignment; be generous
+        SkScalar margin = paint.getTextSize() * 2;
+        SkRect result = bounds;
+        result.outset(margin, margin);
+        return result;
+    }
+
+    void addBytes(const void* data, size_t length)
+    {
+        hashBytes(&m_command, data, length);
+    }
+
+    template<typename T> void add(const T& value)
+    {
+        hashValue(&m_command, value);
+    }
+
+    void addMatrix(const SkMatrix& matrix)
+    {
+        hashMatrix(&m_command, matrix);
+    }
+
+    static void hashMatrix(uint64_t* hash, const SkMatrix& matrix)
+    {
+        for (int i = 0; i < 9; i++)
+            hashValue(hash, matrix.get(i));
+    }
+
+    void addPaint(const SkPaint& paint)
+    {
+        if (paint.getShader() || paint.getPathEffect() || paint.getMaskFilter()
+            || paint.getColorFilter() || paint.getRasterizer() || paint.getLooper()) {
+            m_commandValid = false;
+            return;
+        }
+        SkXfermode::Mode mode = SkXfermode::kSrcOver_Mode;
+        if (paint.getXfermode() && !SkXfermode::IsMode(paint.getXfermode(), &mode)) {
+            m_commandValid = false;
+            return;
+        }
+        add(mode);
+        add(paint.getColor());
+        add(paint.getFlags());
+        add(paint.getStyle());
+        add(paint.getStrokeWidth());
+        add(paint.getStrokeMiter());
+        add(paint.getStrokeCap());
+        add(paint.getStrokeJoin());
+        add(paint.getTextSize());
+        add(paint.getTextScaleX());
+        add(paint.getTextSkewX());
+        add(paint.getTextAlign());
+        add(paint.getTextEncoding());
+        add(SkTypeface::UniqueID(paint.getTypeface()));
+    }
+
+    void addBitmap(const SkBitmap& bitmap)
+    {
+        // The generation ID changes with the pixels
+        add(bitmap.getGenerationID());
+        add(bitmap.width());
+        add(bitmap.height());
+        add(bitmap.config());
+    }
+
+    static void hashPath(uint64_t* hash, const SkPath& path)
+    {
+        hashValue(hash, path.getFillType());
+        SkPath::Iter iter(path, false);
+        SkPoint points[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(points)) != SkPath::kDone_Verb) {
+            hashValue(hash, verb);
+            switch (verb) {
+            case SkPath::kMove_Verb:
+                hashValue(hash, points[0]);
+                break;
+            case SkPath::kLine_Verb:
+                hashBytes(hash, points, 2 * sizeof(SkPoint));
+                break;
+            case SkPath::kQuad_Verb:
+                hashBytes(hash, points, 3 * sizeof(SkPoint));
+                break;
+            case SkPath::kCubic_Verb:
+                hashBytes(hash, points, 4 * sizeof(SkPoint));
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    int m_columns;
+    int m_rows;
+    Vector<Cell> m_cells;
+    // the command being hashed
+    uint64_t m_command;
+    bool m_commandValid;
+    SkIRect m_commandCells;
+    // the clip operations since the matching save
+    uint64_t m_clip;
+    Vector<SaveRecord> m_saves;
+    // false once a command that can touch any cell could not be hashed
+    bool m_valid;
+};
+
+TileFingerprint::TileFingerprint(int width, int height)
+    : m_canvas(new FingerprintCanvas(width, height))
+{
+}
+
+TileFingerprint::~TileFingerprint()
+{
+    delete m_canvas;
+}
+
+SkCanvas* TileFingerprint::canvas()
+{
+    return m_canvas;
+}
+
+bool TileFingerprint::tile(int x, int y, const SkSize& tileSize, float scale,
+                           uint64_t* fingerprint) const
+{
+    // The visual indicator paints information that changes with every paint
+    if (TilesManager::instance()->getShowVisualIndicator())
+        return false;
+
+    // Same transformation as BaseRenderer::renderTiledContent(). Commands
+    // around the tile can reach one pixel into it, antialiased.
+    float margin = 1 + 1 / scale;
+    SkRect rect = SkRect::MakeLTRB(x * tileSize.width() / scale - margin,
+                                   y * tileSize.height() / scale - margin,
+                                   (x + 1) * tileSize.width() / scale + margin,
+                                   (y + 1) * tileSize.height() / scale + margin);
+
+    uint64_t hash = s_fnvOffsetBasis;
+    hashValue(&hash, x);
+    hashValue(&hash, y);
+    hashValue(&hash, tileSize);
+    hashValue(&hash, scale);
+    hashValue(&hash, TilesManager::instance()->invertedScreen());
+    if (!m_canvas->combine(rect, &hash))
+        return false;
+
+    *fingerprint = hash;
+    return true;
+}
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
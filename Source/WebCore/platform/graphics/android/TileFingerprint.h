@@ -0,0 +1,72 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TileFingerprint_h
+#define TileFingerprint_h
+
+#if USE(ACCELERATED_COMPOSITING)
+
+#include "SkSize.h"
+#include <stdint.h>
+
+class SkCanvas;
+
+namespace WebCore {
+
+class FingerprintCanvas;
+
+// Fingerprints of the drawing commands of some content, so that a tile whose
+// content did not change can be recognized without painting it.
+//
+// The content is replayed once, at scale 1, through a canvas that hashes the
+// commands instead of rasterizing them. Each command is hashed (with the
+// matrix, the clip and the paint) into the cells of 128x128 content pixels it
+// can touch. The fingerprint of a tile then combines the cells it covers,
+// whatever the scale, without replaying the content again.
+//
+// Commands whose result cannot be derived from their arguments (shaders,
+// path effects, filters, custom transfer modes, vertices...) make the cells
+// they touch impossible to fingerprint, rather than risking to consider two
+// different contents equal.
+class TileFingerprint {
+public:
+    TileFingerprint(int width, int height);
+    ~TileFingerprint();
+
+    // The content must be replayed into it before fingerprinting tiles
+    SkCanvas* canvas();
+
+    // Returns false if the content of the tile could not be fingerprinted
+    bool tile(int x, int y, const SkSize& tileSize, float scale,
+              uint64_t* fingerprint) const;
+
+private:
+    FingerprintCanvas* m_canvas;
+};
+
+} // namespace WebCore
+
+#endif // USE(ACCELERATED_COMPOSITING)
+#endif // TileFingerprint_h
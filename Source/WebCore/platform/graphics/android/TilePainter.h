@@ -28,8 +28,10 @@
 
 #include "TransformationMatrix.h"
 #include "SkRefCnt.h"
+#include <stdint.h>
 
 class SkCanvas;
+struct SkSize;
 
 namespace WebCore {
 
@@ -40,6 +42,12 @@ public:
    virtual ~TilePainter() { }
    virtual bool paint(BaseTile* tile, SkCanvas*, unsigned int*) = 0;
    virtual const TransformationMatrix* transform() { return 0; }
+   // true if paint() may be called for several of the painter's tiles at once
+   virtual bool paintsConcurrently() { return false; }
+   // fingerprint (see TileFingerprint) of what paint() draws in the tile at
+   // x, y, false if there is none
+   virtual bool fingerprint(int x, int y, const SkSize& tileSize, float scale,
+                            uint64_t*) { return false; }
 };
 
 class SurfacePainter : public SkRefCnt {
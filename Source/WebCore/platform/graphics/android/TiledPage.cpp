@@ -401,6 +401,18 @@ bool TiledPage::paint(BaseTile* tile, SkCanvas* canvas, unsigned int* pictureUse
     return true;
 }
 
+bool TiledPage::fingerprint(int x, int y, const SkSize& tileSize, float scale,
+                            uint64_t* fingerprint)
+{
+    // Prefetched tiles are painted without antialiasing, don't confuse them
+    // with the others
+    if (!m_glWebViewState || isPrefetchPage())
+        return false;
+
+    return m_glWebViewState->fingerprintBaseLayerContent(x, y, tileSize, scale,
+                                                          fingerprint);
+}
+
 TiledPage* TiledPage::sibling()
 {
     if (!m_glWebViewState)
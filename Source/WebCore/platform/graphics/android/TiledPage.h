@@ -84,6 +84,10 @@ public:
     // TilePainter implementation
     // used by individual tiles to generate the bitmap for their tile
     bool paint(BaseTile*, SkCanvas*, unsigned int*);
+    // the TilesManager serializes the playback of the base content
+    bool paintsConcurrently() { return true; }
+    bool fingerprint(int x, int y, const SkSize& tileSize, float scale,
+                     uint64_t* fingerprint);
 
     // used by individual tiles to get the information about the current picture
     GLWebViewState* glWebViewState() { return m_glWebViewState; }
@@ -33,6 +33,7 @@
 #include "PaintTileOperation.h"
 #include "SkCanvas.h"
 #include "SkPicture.h"
+#include "TileFingerprint.h"
 
 #include <cutils/log.h>
 #include <wtf/CurrentTime.h>
@@ -58,6 +59,8 @@ namespace WebCore {
 TiledTexture::~TiledTexture()
 {
     SkSafeUnref(m_paintingPicture);
+    delete m_fingerprint;
+    SkSafeUnref(m_fingerprintPicture);
 #ifdef DEBUG_COUNT
     ClassTracker::instance()->decrement("TiledTexture");
 #endif
@@ -300,13 +303,42 @@ bool TiledTexture::paint(BaseTile* tile, SkCanvas* canvas, unsigned int* picture
 
     XLOG("TT %p painting tile %d, %d with picture %p", this, tile->x(), tile->y(), picture);
 
+    // the base tiles replay the same picture in single surface mode
+    TilesManager::instance()->picturePlaybackLock()->lock();
     canvas->drawPicture(*picture);
+    TilesManager::instance()->picturePlaybackLock()->unlock();
 
     SkSafeUnref(picture);
 
     return true;
 }
 
+bool TiledTexture::fingerprint(int x, int y, const SkSize& tileSize, float scale,
+                               uint64_t* fingerprint)
+{
+    m_paintingPictureSync.lock();
+    SkPicture* picture = m_paintingPicture;
+    SkSafeRef(picture);
+    m_paintingPictureSync.unlock();
+
+    if (!picture)
+        return false;
+
+    android::Mutex::Autolock lock(m_fingerprintSync);
+    if (picture != m_fingerprintPicture) {
+        delete m_fingerprint;
+        m_fingerprint = new TileFingerprint(picture->width(), picture->height());
+        TilesManager::instance()->picturePlaybackLock()->lock();
+        m_fingerprint->canvas()->drawPicture(*picture);
+        TilesManager::instance()->picturePlaybackLock()->unlock();
+        SkSafeUnref(m_fingerprintPicture);
+        m_fingerprintPicture = picture;
+    } else
+        SkSafeUnref(picture);
+
+    return m_fingerprint->tile(x, y, tileSize, scale, fingerprint);
+}
+
 const TransformationMatrix* TiledTexture::transform()
 {
     if (!m_surface)
@@ -43,10 +43,14 @@ class SkCanvas;
 
 namespace WebCore {
 
+class TileFingerprint;
+
 class TiledTexture : public TilePainter {
 public:
     TiledTexture(SurfacePainter* surface)
         : m_paintingPicture(0)
+        , m_fingerprint(0)
+        , m_fingerprintPicture(0)
         , m_surface(surface)
         , m_prevTileX(0)
         , m_prevTileY(0)
@@ -80,6 +84,8 @@ public:
     // TilePainter methods
     bool paint(BaseTile* tile, SkCanvas*, unsigned int*);
     virtual const TransformationMatrix* transform();
+    bool fingerprint(int x, int y, const SkSize& tileSize, float scale,
+                     uint64_t* fingerprint);
 
     float scale() { return m_scale; }
     bool ready();
@@ -95,6 +101,13 @@ private:
     android::Mutex m_paintingPictureSync;
     SkPicture* m_paintingPicture;
 
+    // fingerprint of m_fingerprintPicture, computed on the texture gen thread
+    // the first time one of its tiles is painted. The picture is reffed, so
+    // that another one can't be mistaken for it.
+    android::Mutex m_fingerprintSync;
+    TileFingerprint* m_fingerprint;
+    SkPicture* m_fingerprintPicture;
+
     SurfacePainter* m_surface;
     Vector<BaseTile*> m_tiles;
 
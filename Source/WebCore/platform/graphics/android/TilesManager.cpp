@@ -37,6 +37,7 @@
 #include <cutils/atomic.h>
 #include <gui/SurfaceTexture.h>
 #include <gui/SurfaceTextureClient.h>
+#include <unistd.h>
 
 
 #include <cutils/log.h>
@@ -77,6 +78,15 @@
 
 #define BYTES_PER_PIXEL 4 // 8888 config
 
+// Upper bound of threads painting tiles concurrently, each of them needs its
+// own TILE_WIDTH*TILE_HEIGHT*BYTES_PER_PIXEL bitmap to paint in.
+#define MAX_TEXTURES_GENERATORS 4
+
+// Tiles only need a bitmap while they are painted or wait in the transfer
+// queue, so the tile bitmap pool keeps one bitmap for this many textures, but
+// at least one per generator and per transfer queue item.
+#define TEXTURES_PER_POOLED_BITMAP 8
+
 #define LAYER_TEXTURES_DESTROY_TIMEOUT 60 // If we do not need layers for 60 seconds, free the textures
 
 namespace WebCore {
@@ -103,6 +113,7 @@ TilesManager::TilesManager()
     , m_invertedScreen(false)
     , m_invertedScreenSwitch(false)
     , m_useMinimalMemory(true)
+    , m_useOpaque565Tiles(false)
     , m_drawGLCount(1)
     , m_lastTimeLayersUsed(0)
     , m_hasLayerTextures(false)
@@ -112,13 +123,24 @@ TilesManager::TilesManager()
     m_availableTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
     m_tilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
     m_availableTilesTextures.reserveCapacity(MAX_TEXTURE_ALLOCATION);
-    m_pixmapsGenerationThread = new TexturesGenerator();
-    m_pixmapsGenerationThread->run("TexturesGenerator");
+    m_bitmapPool.setBudget(bitmapPoolBudget());
+    m_texturesGenerator = new TexturesGenerator(texturesGeneratorCount());
 }
 
 int TilesManager::getTextureManagerThreadID()
 {
-    return m_pixmapsGenerationThread->m_threadID;
+    return m_texturesGenerator->threadID();
+}
+
+int TilesManager::texturesGeneratorCount()
+{
+    // Leave one core to the UI thread
+    int count = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+    if (count < 1)
+        count = 1;
+    if (count > MAX_TEXTURES_GENERATORS)
+        count = MAX_TEXTURES_GENERATORS;
+    return count;
 }
 
 void TilesManager::allocateTiles()
@@ -176,6 +198,7 @@ void TilesManager::deallocateTextures(bool allTextures)
     }
     deallocateTexturesVector(sparedDrawCount, m_textures);
     deallocateTexturesVector(sparedDrawCount, m_tilesTextures);
+    m_bitmapPool.trim();
 }
 
 void TilesManager::deallocateTexturesVector(unsigned long long sparedDrawCount,
@@ -384,9 +407,18 @@ void TilesManager::setMaxTextureCount(int max)
     else
         m_maxTextureCount = MAX_TEXTURE_ALLOCATION;
 
+    m_bitmapPool.setBudget(bitmapPoolBudget());
     allocateTiles();
 }
 
+size_t TilesManager::bitmapPoolBudget()
+{
+    int bitmaps = m_maxTextureCount / TEXTURES_PER_POOLED_BITMAP;
+    if (bitmaps < texturesGeneratorCount() + ST_BUFFER_NUMBER)
+        bitmaps = texturesGeneratorCount() + ST_BUFFER_NUMBER;
+    return bitmaps * TILE_WIDTH * TILE_HEIGHT * BYTES_PER_PIXEL;
+}
+
 void TilesManager::setMaxLayerTextureCount(int max)
 {
     XLOG("setMaxLayerTextureCount: %d (current: %d, total:%d)",
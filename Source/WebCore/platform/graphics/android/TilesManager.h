@@ -35,6 +35,7 @@
 #include "ShaderProgram.h"
 #include "SkBitmapRef.h"
 #include "TexturesGenerator.h"
+#include "TileBitmapPool.h"
 #include "TiledPage.h"
 #include "TilesProfiler.h"
 #include "TilesTracker.h"
@@ -60,22 +61,22 @@ public:
 
     void removeOperationsForFilter(OperationFilter* filter, bool waitForRunning = false)
     {
-        m_pixmapsGenerationThread->removeOperationsForFilter(filter, waitForRunning);
+        m_texturesGenerator->removeOperationsForFilter(filter, waitForRunning);
     }
 
     void removeOperationsForPage(TiledPage* page)
     {
-        m_pixmapsGenerationThread->removeOperationsForPage(page);
+        m_texturesGenerator->removeOperationsForPage(page);
     }
 
     void removePaintOperationsForPage(TiledPage* page, bool waitForCompletion)
     {
-        m_pixmapsGenerationThread->removePaintOperationsForPage(page, waitForCompletion);
+        m_texturesGenerator->removePaintOperationsForPage(page, waitForCompletion);
     }
 
     void scheduleOperation(QueuedOperation* operation)
     {
-        m_pixmapsGenerationThread->scheduleOperation(operation);
+        m_texturesGenerator->scheduleOperation(operation);
     }
 
     void swapLayersTextures(LayerAndroid* newTree, LayerAndroid* oldTree);
@@ -84,6 +85,12 @@ public:
     ShaderProgram* shader() { return &m_shader; }
     TransferQueue* transferQueue() { return &m_queue; }
     VideoLayerManager* videoLayerManager() { return &m_videoLayerManager; }
+    TileBitmapPool* bitmapPool() { return &m_bitmapPool; }
+    // Pictures can't be replayed by two threads at once, and the generator
+    // workers share theirs: in single surface mode base tiles replay the
+    // layers' pictures, and both textures of a DualTiledTexture replay their
+    // layer's. Every playback on the workers holds this lock.
+    android::Mutex* picturePlaybackLock() { return &m_picturePlaybackLock; }
 
     void gatherLayerTextures();
     void gatherTextures();
@@ -184,6 +191,26 @@ public:
         return m_useMinimalMemory;
     }
 
+    // Paint the (opaque) base tiles in 565 bitmaps, uploaded in 565 textures.
+    // Layer tiles found to be opaque once painted are uploaded in 565 too.
+    void setUseOpaque565Tiles(bool useOpaque565Tiles)
+    {
+        m_useOpaque565Tiles = useOpaque565Tiles;
+    }
+
+    bool useOpaque565Tiles()
+    {
+        return m_useOpaque565Tiles;
+    }
+
+    // config tiles are painted in
+    SkBitmap::Config tileConfig(bool isLayerTile)
+    {
+        if (!isLayerTile && m_useOpaque565Tiles)
+            return SkBitmap::kRGB_565_Config;
+        return SkBitmap::kARGB_8888_Config;
+    }
+
     void incDrawGLCount()
     {
         m_drawGLCount++;
@@ -198,7 +225,9 @@ public:
     {
         return m_paintedSurfaces.size();
     }
+    // the primary generator thread, the others follow its priority
     int getTextureManagerThreadID();
+    static int texturesGeneratorCount();
 
 private:
     TilesManager();
@@ -212,6 +241,7 @@ private:
 
     void deallocateTexturesVector(unsigned long long sparedDrawCount,
                                   WTF::Vector<BaseTileTexture*>& textures);
+    size_t bitmapPoolBudget();
 
     Vector<BaseTileTexture*> m_textures;
     Vector<BaseTileTexture*> m_availableTextures;
@@ -232,16 +262,19 @@ private:
     bool m_invertedScreenSwitch;
 
     bool m_useMinimalMemory;
+    bool m_useOpaque565Tiles;
 
-    sp<TexturesGenerator> m_pixmapsGenerationThread;
+    TexturesGenerator* m_texturesGenerator;
 
     android::Mutex m_texturesLock;
     android::Mutex m_generatorLock;
+    android::Mutex m_picturePlaybackLock;
     android::Condition m_generatorReadyCond;
 
     static TilesManager* gInstance;
 
     ShaderProgram m_shader;
+    TileBitmapPool m_bitmapPool;
     TransferQueue m_queue;
 
     VideoLayerManager m_videoLayerManager;
@@ -29,6 +29,7 @@
 #if USE(ACCELERATED_COMPOSITING)
 
 #include "TilesManager.h"
+#include <cutils/atomic.h>
 #include <wtf/CurrentTime.h>
 
 #ifdef DEBUG
@@ -53,7 +54,11 @@
 namespace WebCore {
 TilesProfiler::TilesProfiler()
     : m_enabled(false)
+    , m_fingerprintReuses(0)
+    , m_fingerprintRepaints(0)
+    , m_unfingerprintedPaints(0)
 {
+    memset(&m_bitmapPoolStart, 0, sizeof(m_bitmapPoolStart));
 }
 
 void TilesProfiler::start()
@@ -61,8 +66,12 @@ void TilesProfiler::start()
     m_enabled = true;
     m_goodTiles = 0;
     m_badTiles = 0;
+    m_fingerprintReuses = 0;
+    m_fingerprintRepaints = 0;
+    m_unfingerprintedPaints = 0;
     m_records.clear();
     m_time = currentTimeMS();
+    m_bitmapPoolStart = TilesManager::instance()->bitmapPool()->stats();
     XLOG("initializing tileprofiling");
 }
 
@@ -70,6 +79,10 @@ float TilesProfiler::stop()
 {
     m_enabled = false;
     XLOG("completed tile profiling, observed %d frames", m_records.size());
+    XLOG("tile fingerprints: %d reused, %d repainted, %d not fingerprinted",
+         fingerprintReuses(), fingerprintRepaints(), unfingerprintedPaints());
+    XLOG("tile bitmap pool: %d hits, %d misses, %d bytes resident",
+         bitmapPoolHits(), bitmapPoolMisses(), bitmapPoolBytesResident());
     return (1.0 * m_goodTiles) / (m_goodTiles + m_badTiles);
 }
 
@@ -138,6 +151,34 @@ void TilesProfiler::nextInval(const IntRect& rect, float scale)
          rect.maxX(), rect.maxY(), scale);
 }
 
+void TilesProfiler::nextFingerprint(bool fingerprinted, bool reused)
+{
+    if (!m_enabled)
+        return;
+
+    if (!fingerprinted)
+        android_atomic_inc(&m_unfingerprintedPaints);
+    else if (reused)
+        android_atomic_inc(&m_fingerprintReuses);
+    else
+        android_atomic_inc(&m_fingerprintRepaints);
+}
+
+unsigned TilesProfiler::bitmapPoolHits()
+{
+    return TilesManager::instance()->bitmapPool()->stats().hits - m_bitmapPoolStart.hits;
+}
+
+unsigned TilesProfiler::bitmapPoolMisses()
+{
+    return TilesManager::instance()->bitmapPool()->stats().misses - m_bitmapPoolStart.misses;
+}
+
+size_t TilesProfiler::bitmapPoolBytesResident()
+{
+    return TilesManager::instance()->bitmapPool()->stats().bytesResident;
+}
+
 } // namespace WebCore
 
 #endif // USE(ACCELERATED_COMPOSITING)
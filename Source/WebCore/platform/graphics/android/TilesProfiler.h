@@ -30,6 +30,7 @@
 
 #include "BaseTile.h"
 #include "IntRect.h"
+#include "TileBitmapPool.h"
 #include "Vector.h"
 
 namespace WebCore {
@@ -60,6 +61,9 @@ public:
     void nextFrame(int left, int top, int right, int bottom, float scale);
     void nextTile(BaseTile& tile, float scale, bool inView);
     void nextInval(const IntRect& rect, float scale);
+    // Called from the painting threads for each tile paint, with whether
+    // the tile could be fingerprinted and whether painting was skipped
+    void nextFingerprint(bool fingerprinted, bool reused);
     int numFrames() {
         return m_records.size();
     };
@@ -72,12 +76,26 @@ public:
         return &m_records[frame][tile];
     }
 
+    // Tile fingerprinting results since start()
+    unsigned fingerprintReuses() { return m_fingerprintReuses; }
+    unsigned fingerprintRepaints() { return m_fingerprintRepaints; }
+    unsigned unfingerprintedPaints() { return m_unfingerprintedPaints; }
+
+    // Tile bitmap pool activity since start()
+    unsigned bitmapPoolHits();
+    unsigned bitmapPoolMisses();
+    size_t bitmapPoolBytesResident();
+
 private:
     bool m_enabled;
     unsigned int m_goodTiles;
     unsigned int m_badTiles;
+    volatile int32_t m_fingerprintReuses;
+    volatile int32_t m_fingerprintRepaints;
+    volatile int32_t m_unfingerprintedPaints;
     Vector<Vector<TileProfileRecord> > m_records;
     double m_time;
+    TileBitmapPool::Stats m_bitmapPoolStart;
 };
 
 } // namespace WebCore
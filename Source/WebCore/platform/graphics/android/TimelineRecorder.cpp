@@ -0,0 +1,259 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TimelineRecorder.h"
+
+#include <cutils/atomic.h>
+#include <cutils/log.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/threads.h>
+#include <wtf/Vector.h>
+
+#define XLOGC(...) android_printLog(ANDROID_LOG_DEBUG, "TimelineRecorder", __VA_ARGS__)
+
+// Events kept per thread (24 bytes each), must be a power of two
+#define EVENTS_PER_THREAD 4096
+#define MAX_NAMES 64
+
+namespace WebCore {
+
+struct TimelineThread {
+    TimelineEvent events[EVENTS_PER_THREAD];
+    // Number of events ever recorded, only written by the owning thread
+    volatile int32_t count;
+    pid_t tid;
+    char name[17];
+    // Set when the thread exits, its ring can then be given to a new thread
+    bool exited;
+    TimelineThread* next;
+};
+
+// Labels of the arguments of the builtin names, in Name order
+static const char* s_builtinArgs[TimelineRecorder::BuiltinNameCount][2] = {
+    { 0, 0 },
+    { "layer", 0 },
+    { "layer", 0 },
+    { "x", "y" },
+    { "x", "y" },
+    { 0, 0 },
+    { 0, 0 },
+};
+
+// Guards the names, the list of threads and the clear time
+static android::Mutex s_lock;
+static const char* s_names[MAX_NAMES] = {
+    "DrawFrame",
+    "LayerPrepare",
+    "LayerDraw",
+    "TilePaint",
+    "TileUpload",
+    "RecordContent",
+    "SplitContent",
+};
+static int s_nameCount = TimelineRecorder::BuiltinNameCount;
+// The rings of the threads that exited are kept, so their events can be
+// exported, until new threads reuse them. There are never more rings than
+// threads alive at the same time.
+static TimelineThread* s_threads = 0;
+static int64_t s_clearTimeNs = 0;
+
+static pthread_key_t s_threadKey;
+static pthread_once_t s_threadKeyOnce = PTHREAD_ONCE_INIT;
+
+volatile int32_t TimelineRecorder::s_enabled = 0;
+
+static int64_t currentTimeNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+}
+
+static void releaseThread(void* data)
+{
+    android::Mutex::Autolock lock(s_lock);
+    static_cast<TimelineThread*>(data)->exited = true;
+}
+
+static void createThreadKey()
+{
+    pthread_key_create(&s_threadKey, releaseThread);
+}
+
+static TimelineThread* currentThread()
+{
+    pthread_once(&s_threadKeyOnce, createThreadKey);
+    TimelineThread* thread = static_cast<TimelineThread*>(pthread_getspecific(s_threadKey));
+    if (thread)
+        return thread;
+
+    android::Mutex::Autolock lock(s_lock);
+    for (thread = s_threads; thread; thread = thread->next) {
+        if (thread->exited)
+            break;
+    }
+    if (!thread) {
+        thread = new TimelineThread();
+        thread->next = s_threads;
+        s_threads = thread;
+    }
+    thread->count = 0;
+    thread->tid = gettid();
+    memset(thread->name, 0, sizeof(thread->name));
+    prctl(PR_GET_NAME, thread->name, 0, 0, 0);
+    thread->exited = false;
+    pthread_setspecific(s_threadKey, thread);
+    return thread;
+}
+
+void TimelineRecorder::setEnabled(bool enabled)
+{
+    android_atomic_release_store(enabled ? 1 : 0, &s_enabled);
+}
+
+void TimelineRecorder::clear()
+{
+    android::Mutex::Autolock lock(s_lock);
+    s_clearTimeNs = currentTimeNs();
+}
+
+int TimelineRecorder::registerName(const char* name)
+{
+    android::Mutex::Autolock lock(s_lock);
+    for (int i = 0; i < s_nameCount; i++) {
+        if (!strcmp(s_names[i], name))
+            return i;
+    }
+    if (s_nameCount == MAX_NAMES)
+        return -1;
+    s_names[s_nameCount] = strdup(name);
+    return s_nameCount++;
+}
+
+void TimelineRecorder::record(int name, char phase, int arg0, int arg1)
+{
+    if (name < 0)
+        return;
+
+    TimelineThread* thread = currentThread();
+    uint32_t count = static_cast<uint32_t>(thread->count);
+    TimelineEvent& event = thread->events[count & (EVENTS_PER_THREAD - 1)];
+    event.timestampNs = currentTimeNs();
+    event.args[0] = arg0;
+    event.args[1] = arg1;
+    event.name = name;
+    event.phase = phase;
+
+    // publish the event to exportChromeTrace()
+    android_atomic_release_store(static_cast<int32_t>(count + 1), &thread->count);
+}
+
+void TimelineRecorder::writeJSONString(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for (const char* c = string; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+bool TimelineRecorder::exportChromeTrace(FILE* file)
+{
+    android::Mutex::Autolock lock(s_lock);
+
+    const int pid = getpid();
+    bool first = true;
+    Vector<TimelineEvent> events;
+    fprintf(file, "{\"traceEvents\":[");
+    for (TimelineThread* thread = s_threads; thread; thread = thread->next) {
+        // the threads keep recording while we copy their events
+        uint32_t end = android_atomic_acquire_load(&thread->count);
+        uint32_t begin = end > EVENTS_PER_THREAD ? end - EVENTS_PER_THREAD : 0;
+        events.clear();
+        for (uint32_t i = begin; i != end; i++)
+            events.append(thread->events[i & (EVENTS_PER_THREAD - 1)]);
+
+        // drop the events that may have been overwritten during the copy,
+        // including the one being recorded at the new end
+        uint32_t newEnd = android_atomic_acquire_load(&thread->count);
+        size_t overwritten = 0;
+        if (newEnd + 1 - begin > EVENTS_PER_THREAD)
+            overwritten = newEnd + 1 - begin - EVENTS_PER_THREAD;
+
+        fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"name\":", first ? "" : ",", pid, thread->tid);
+        writeJSONString(file, thread->name);
+        fprintf(file, "}}");
+        first = false;
+
+        for (size_t i = overwritten; i < events.size(); i++) {
+            const TimelineEvent& event = events[i];
+            if (event.timestampNs < s_clearTimeNs)
+                continue;
+            fprintf(file, ",\n{\"name\":");
+            writeJSONString(file, s_names[event.name]);
+            fprintf(file, ",\"cat\":\"webview\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f",
+                    event.phase, pid, thread->tid, event.timestampNs / 1000.0);
+            if (event.phase == 'i')
+                fprintf(file, ",\"s\":\"t\"");
+            if (event.phase != 'E' && event.name < BuiltinNameCount
+                && s_builtinArgs[event.name][0]) {
+                fprintf(file, ",\"args\":{\"%s\":%d", s_builtinArgs[event.name][0],
+                        event.args[0]);
+                if (s_builtinArgs[event.name][1])
+                    fprintf(file, ",\"%s\":%d", s_builtinArgs[event.name][1], event.args[1]);
+                fputc('}', file);
+            }
+            fputc('}', file);
+        }
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    return !ferror(file);
+}
+
+bool TimelineRecorder::exportChromeTrace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        XLOGC("could not open %s to export the timeline", path);
+        return false;
+    }
+    bool success = exportChromeTrace(file);
+    if (fclose(file))
+        success = false;
+    if (!success)
+        XLOGC("could not export the timeline to %s", path);
+    return success;
+}
+
+} // namespace WebCore
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TimelineRecorder_h
+#define TimelineRecorder_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace WebCore {
+
+// A fixed-size timeline event, the phase is the one of the Chrome trace
+// event format: 'B'egin, 'E'nd or 'i'nstant
+struct TimelineEvent {
+    int64_t timestampNs;
+    int32_t args[2];
+    uint16_t name;
+    char phase;
+};
+
+// Records what the WebCore, texture generator and UI threads are doing on a
+// common timeline, to be exported in the Chrome trace event format
+// (chrome://tracing) and profiled offline.
+// Each thread appends to its own ring of events without taking a lock,
+// the oldest events of a thread are overwritten once its ring is full. When
+// the recorder is disabled, recording an event costs a load and a branch.
+class TimelineRecorder {
+public:
+    enum Name {
+        DrawFrame,      // UI thread, drawing the GL WebView
+        LayerPrepare,   // args: layer unique id
+        LayerDraw,      // args: layer unique id
+        TilePaint,      // args: tile x, y
+        TileUpload,     // args: tile x, y
+        RecordContent,  // WebCore thread, recording the base layer picture
+        SplitContent,   // WebCore thread, splitting it in smaller pictures
+        BuiltinNameCount
+    };
+
+    static bool enabled() { return s_enabled; }
+    static void setEnabled(bool enabled);
+    // Drops the events recorded so far
+    static void clear();
+
+    // Returns the name to record events of, or -1 if there are too many.
+    // Registering the same name twice returns the same value.
+    static int registerName(const char* name);
+
+    // Callers check enabled() first, this always records
+    static void record(int name, char phase, int arg0 = 0, int arg1 = 0);
+    static void instant(int name, int arg0 = 0, int arg1 = 0)
+    {
+        if (s_enabled)
+            record(name, 'i', arg0, arg1);
+    }
+
+    // Writes the recorded events as Chrome trace event JSON
+    static bool exportChromeTrace(FILE* file);
+    static bool exportChromeTrace(const char* path);
+    // Writes the string quoted and escaped, control characters are dropped
+    static void writeJSONString(FILE* file, const char* string);
+
+private:
+    static volatile int32_t s_enabled;
+};
+
+// Records the begin and end events of its scope. The end event is recorded
+// even if the recorder got disabled in between, to keep the pairs balanced.
+class TimelineScope {
+public:
+    TimelineScope(int name, int arg0 = 0, int arg1 = 0)
+        : m_name(name)
+        , m_recording(TimelineRecorder::enabled())
+    {
+        if (m_recording)
+            TimelineRecorder::record(name, 'B', arg0, arg1);
+    }
+
+    ~TimelineScope()
+    {
+        if (m_recording)
+            TimelineRecorder::record(m_name, 'E');
+    }
+
+private:
+    int m_name;
+    bool m_recording;
+};
+
+} // namespace WebCore
+
+#endif // TimelineRecorder_h
@@ -30,6 +30,9 @@
 
 #include "BaseTile.h"
 #include "PaintedSurface.h"
+#include "SkCanvas.h"
+#include "SkPaint.h"
+#include "TimelineRecorder.h"
 #include <android/native_window.h>
 #include <gui/SurfaceTexture.h>
 #include <gui/SurfaceTextureClient.h>
@@ -50,8 +53,6 @@
 
 #endif // DEBUG
 
-#define ST_BUFFER_NUMBER 6
-
 // Set this to 1 if we would like to take the new GpuUpload approach which
 // relied on the glCopyTexSubImage2D instead of a glDraw call
 #define GPU_UPLOAD_WITHOUT_DRAW 1
@@ -60,18 +61,14 @@ namespace WebCore {
 
 TransferQueue::TransferQueue()
     : m_eglSurface(EGL_NO_SURFACE)
-    , m_transferQueueIndex(0)
     , m_fboID(0)
     , m_sharedSurfaceTextureId(0)
-    , m_hasGLContext(true)
-    , m_interruptedByRemovingOp(false)
+    , m_transferRing(ST_BUFFER_NUMBER)
     , m_currentDisplay(EGL_NO_DISPLAY)
     , m_currentUploadType(DEFAULT_UPLOAD_TYPE)
 {
     memset(&m_GLStateBeforeBlit, 0, sizeof(m_GLStateBeforeBlit));
 
-    m_emptyItemCount = ST_BUFFER_NUMBER;
-
     m_transferQueue = new TileTransferData[ST_BUFFER_NUMBER];
 }
 
@@ -82,6 +79,8 @@ TransferQueue::~TransferQueue()
     glDeleteTextures(1, &m_sharedSurfaceTextureId);
     m_sharedSurfaceTextureId = 0;
 
+    for (int i = 0; i < ST_BUFFER_NUMBER; i++)
+        TilesManager::instance()->bitmapPool()->release(m_transferQueue[i].bitmap);
     delete[] m_transferQueue;
 }
 
@@ -199,31 +198,15 @@ void TransferQueue::blitTileFromQueue(GLuint fboID, BaseTileTexture* destTex,
 
 void TransferQueue::interruptTransferQueue(bool interrupt)
 {
-    m_transferQueueItemLocks.lock();
-    m_interruptedByRemovingOp = interrupt;
-    if (m_interruptedByRemovingOp)
-        m_transferQueueItemCond.signal();
-    m_transferQueueItemLocks.unlock();
+    m_transferRing.setInterrupted(interrupt);
 }
 
-// This function must be called inside the m_transferQueueItemLocks, for the
-// wait, m_interruptedByRemovingOp and getHasGLContext().
-// Only called by updateQueueWithBitmap() for now.
+// Only called by the producers, with the queue locked.
 bool TransferQueue::readyForUpdate()
 {
-    if (!getHasGLContext())
-        return false;
-    // Don't use a while loop since when the WebView tear down, the emptyCount
-    // will still be 0, and we bailed out b/c of GL context lost.
-    if (!m_emptyItemCount) {
-        if (m_interruptedByRemovingOp)
-            return false;
-        m_transferQueueItemCond.wait(m_transferQueueItemLocks);
-        if (m_interruptedByRemovingOp)
-            return false;
-    }
-
-    if (!getHasGLContext())
+    // Bails out when interrupted, or when the WebView tear down and the UI
+    // thread will not free any item until the next draw.
+    if (!m_transferRing.acquireSlot())
         return false;
 
     // Disable this wait until we figure out why this didn't work on some
@@ -232,7 +215,7 @@ bool TransferQueue::readyForUpdate()
     if (m_currentUploadType == GpuUpload
         && m_currentDisplay != EGL_NO_DISPLAY) {
         // Check the GPU fence
-        EGLSyncKHR syncKHR = m_transferQueue[getNextTransferQueueIndex()].m_syncKHR;
+        EGLSyncKHR syncKHR = m_transferQueue[m_transferRing.writeIndex()].m_syncKHR;
         if (syncKHR != EGL_NO_SYNC_KHR)
             eglClientWaitSyncKHR(m_currentDisplay,
                                  syncKHR,
@@ -245,103 +228,98 @@ bool TransferQueue::readyForUpdate()
     return true;
 }
 
-// Both getHasGLContext and setHasGLContext should be called within the lock.
-bool TransferQueue::getHasGLContext()
-{
-    return m_hasGLContext;
-}
-
-void TransferQueue::setHasGLContext(bool hasContext)
-{
-    m_hasGLContext = hasContext;
-}
-
 // Only called when WebView is destroyed or switching the uploadType.
 void TransferQueue::discardQueue()
 {
-    android::Mutex::Autolock lock(m_transferQueueItemLocks);
-
-    for (int i = 0 ; i < ST_BUFFER_NUMBER; i++)
-        if (m_transferQueue[i].status == pendingBlit)
-            m_transferQueue[i].status = pendingDiscard;
-
-    bool GLContextExisted = getHasGLContext();
     // Unblock the Tex Gen thread first before Tile Page deletion.
-    // Otherwise, there will be a deadlock while removing operations.
-    setHasGLContext(false);
-
-    // Only signal once when GL context lost.
-    if (GLContextExisted)
-        m_transferQueueItemCond.signal();
+    // Otherwise, there will be a deadlock while removing operations. A
+    // producer waiting for a slot holds the producer lock, so this is done
+    // before taking it.
+    m_transferRing.setConsumerAvailable(false);
+
+    // A producer that got its slot before that still publishes its item, and
+    // the item points to a tile about to be deleted. It does so with the
+    // producer lock held, so once we have the lock the item is in the ring,
+    // and gets discarded with the others.
+    android::Mutex::Autolock producerLock(m_transferQueueProducerLock);
+    m_transferRing.discardPendingSlots();
 }
 
 // Call on UI thread to copy from the shared Surface Texture to the BaseTile's texture.
 void TransferQueue::updateDirtyBaseTiles()
 {
-    android::Mutex::Autolock lock(m_transferQueueItemLocks);
-
-    cleanupTransportQueue();
-    if (!getHasGLContext())
-        setHasGLContext(true);
+    m_transferRing.setConsumerAvailable(true);
 
     // Start from the oldest item, we call the updateTexImage to retrive
-    // the texture and blit that into each BaseTile's texture.
-    const int nextItemIndex = getNextTransferQueueIndex();
-    int index = nextItemIndex;
+    // the texture and blit that into each BaseTile's texture. Items queued
+    // while we are at it wait for the next draw call.
     bool usedFboForUpload = false;
     for (int k = 0; k < ST_BUFFER_NUMBER ; k++) {
-        if (m_transferQueue[index].status == pendingBlit) {
-            bool obsoleteBaseTile = checkObsolete(index);
-            // Save the needed info, update the Surf Tex, clean up the item in
-            // the queue. Then either move on to next item or copy the content.
-            BaseTileTexture* destTexture = 0;
-            if (!obsoleteBaseTile)
-                destTexture = m_transferQueue[index].savedBaseTilePtr->backTexture();
-            if (m_transferQueue[index].uploadType == GpuUpload) {
-                status_t result = m_sharedSurfaceTexture->updateTexImage();
-                if (result != OK)
-                    XLOGC("unexpected error: updateTexImage return %d", result);
-            }
-            m_transferQueue[index].savedBaseTilePtr = 0;
-            m_transferQueue[index].status = emptyItem;
-            if (obsoleteBaseTile) {
-                XLOG("Warning: the texture is obsolete for this baseTile");
-                index = (index + 1) % ST_BUFFER_NUMBER;
-                continue;
-            }
+        int index = m_transferRing.oldestSlot();
+        if (index < 0)
+            break;
+        if (m_transferRing.status(index) == pendingDiscard) {
+            discardTransferItem(index);
+            m_transferRing.releaseSlot();
+            continue;
+        }
 
-            // guarantee that we have a texture to blit into
-            destTexture->requireGLTexture();
-
-            if (m_transferQueue[index].uploadType == CpuUpload) {
-                // Here we just need to upload the bitmap content to the GL Texture
-                GLUtils::updateTextureWithBitmap(destTexture->m_ownTextureId, 0, 0,
-                                                 *m_transferQueue[index].bitmap);
-            } else {
-                if (!usedFboForUpload) {
-                    saveGLState();
-                    usedFboForUpload = true;
-                }
-                blitTileFromQueue(m_fboID, destTexture,
-                                  m_sharedSurfaceTextureId,
-                                  m_sharedSurfaceTexture->getCurrentTextureTarget(),
-                                  index);
-            }
+        bool obsoleteBaseTile = checkObsolete(index);
+        // Save the needed info, update the Surf Tex, clean up the item in
+        // the queue. Then either move on to next item or copy the content.
+        BaseTileTexture* destTexture = 0;
+        if (!obsoleteBaseTile)
+            destTexture = m_transferQueue[index].savedBaseTilePtr->backTexture();
+        if (m_transferQueue[index].uploadType == GpuUpload) {
+            status_t result = m_sharedSurfaceTexture->updateTexImage();
+            if (result != OK)
+                XLOGC("unexpected error: updateTexImage return %d", result);
+        }
+        m_transferQueue[index].savedBaseTilePtr = 0;
+        if (obsoleteBaseTile) {
+            XLOG("Warning: the texture is obsolete for this baseTile");
+            m_transferRing.releaseSlot();
+            continue;
+        }
 
-            // After the base tile copied into the GL texture, we need to
-            // update the texture's info such that at draw time, readyFor
-            // will find the latest texture's info
-            // We don't need a map any more, each texture contains its own
-            // texturesTileInfo.
-            destTexture->setOwnTextureTileInfoFromQueue(&m_transferQueue[index].tileInfo);
-
-            XLOG("Blit tile x, y %d %d with dest texture %p to destTexture->m_ownTextureId %d",
-                 m_transferQueue[index].tileInfo.m_x,
-                 m_transferQueue[index].tileInfo.m_y,
-                 destTexture,
-                 destTexture->m_ownTextureId);
+        TimelineScope uploadScope(TimelineRecorder::TileUpload,
+                                  m_transferQueue[index].tileInfo.m_x,
+                                  m_transferQueue[index].tileInfo.m_y);
+
+        // guarantee that we have a texture of the tile's format to upload or
+        // blit into, 16 bit tiles get 16 bit textures
+        destTexture->requireGLTexture(m_transferQueue[index].config);
+
+        if (m_transferQueue[index].uploadType == CpuUpload) {
+            // Here we just need to upload the bitmap content to the GL Texture
+            GLUtils::updateTextureWithBitmap(destTexture->m_ownTextureId, 0, 0,
+                                             *m_transferQueue[index].bitmap);
+        } else {
+            if (!usedFboForUpload) {
+                saveGLState();
+                usedFboForUpload = true;
+            }
+            blitTileFromQueue(m_fboID, destTexture,
+                              m_sharedSurfaceTextureId,
+                              m_sharedSurfaceTexture->getCurrentTextureTarget(),
+                              index);
         }
-        index = (index + 1) % ST_BUFFER_NUMBER;
+
+        // After the base tile copied into the GL texture, we need to
+        // update the texture's info such that at draw time, readyFor
+        // will find the latest texture's info
+        // We don't need a map any more, each texture contains its own
+        // texturesTileInfo.
+        destTexture->setOwnTextureTileInfoFromQueue(&m_transferQueue[index].tileInfo);
+
+        XLOG("Blit tile x, y %d %d with dest texture %p to destTexture->m_ownTextureId %d",
+             m_transferQueue[index].tileInfo.m_x,
+             m_transferQueue[index].tileInfo.m_y,
+             destTexture,
+             destTexture->m_ownTextureId);
+
+        // Only now the item (and its bitmap) can be reused by the producer
+        m_transferRing.releaseSlot();
     }
 
     // Clean up FBO setup. Doing this for both CPU/GPU upload can make the
@@ -352,9 +330,6 @@ void TransferQueue::updateDirtyBaseTiles()
         restoreGLState();
         GLUtils::checkGlError("updateDirtyBaseTiles");
     }
-
-    m_emptyItemCount = ST_BUFFER_NUMBER;
-    m_transferQueueItemCond.signal();
 }
 
 void TransferQueue::updateQueueWithBitmap(const TileRenderInfo* renderInfo,
@@ -372,10 +347,10 @@ void TransferQueue::updateQueueWithBitmap(const TileRenderInfo* renderInfo,
 bool TransferQueue::tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo,
                                           int x, int y, const SkBitmap& bitmap)
 {
-    m_transferQueueItemLocks.lock();
+    android::Mutex::Autolock producerLock(m_transferQueueProducerLock);
+
     bool ready = readyForUpdate();
     TextureUploadType currentUploadType = m_currentUploadType;
-    m_transferQueueItemLocks.unlock();
     if (!ready) {
         XLOG("Quit bitmap update: not ready! for tile x y %d %d",
              renderInfo->x, renderInfo->y);
@@ -397,7 +372,20 @@ bool TransferQueue::tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo,
         int bpp = 4; // Now we only deal with RGBA8888 format.
         int width = TilesManager::instance()->tileWidth();
         int height = TilesManager::instance()->tileHeight();
-        if (!x && !y && bitmap.width() == width && bitmap.height() == height) {
+        if (!x && !y && bitmap.width() == width && bitmap.height() == height
+            && bitmap.config() != SkBitmap::kARGB_8888_Config) {
+            // The shared Surface Texture buffers are 8888, as Ganesh renders
+            // into them. Opaque 565 tiles are expanded into them, and blitted
+            // into 565 textures again.
+            SkBitmap bufferBitmap;
+            bufferBitmap.setConfig(SkBitmap::kARGB_8888_Config, width, height,
+                                   buffer.stride * bpp);
+            bufferBitmap.setPixels(img);
+            SkCanvas bufferCanvas(bufferBitmap);
+            SkPaint paint;
+            paint.setXfermodeMode(SkXfermode::kSrc_Mode);
+            bufferCanvas.drawBitmap(bitmap, 0, 0, &paint);
+        } else if (!x && !y && bitmap.width() == width && bitmap.height() == height) {
             bitmap.lockPixels();
             uint8_t* bitmapOrigin = static_cast<uint8_t*>(bitmap.getPixels());
             if (buffer.stride != bitmap.width())
@@ -419,43 +407,57 @@ bool TransferQueue::tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo,
         ANativeWindow_unlockAndPost(m_ANW.get());
     }
 
-    m_transferQueueItemLocks.lock();
     // b) After update the Surface Texture, now udpate the transfer queue info.
     addItemInTransferQueue(renderInfo, currentUploadType, &bitmap);
 
-    m_transferQueueItemLocks.unlock();
     XLOG("Bitmap updated x, y %d %d, baseTile %p",
          renderInfo->x, renderInfo->y, renderInfo->baseTile);
     return true;
 }
 
 // Note that there should be lock/unlock around this function call.
-// Currently only called by GLUtils::updateSharedSurfaceTextureWithBitmap.
+// Called by tryUpdateQueueWithBitmap() and the GaneshRenderer.
 void TransferQueue::addItemInTransferQueue(const TileRenderInfo* renderInfo,
                                            TextureUploadType type,
                                            const SkBitmap* bitmap)
 {
-    m_transferQueueIndex = (m_transferQueueIndex + 1) % ST_BUFFER_NUMBER;
-
-    int index = m_transferQueueIndex;
+    int index = m_transferRing.writeIndex();
     if (m_transferQueue[index].savedBaseTilePtr
-        || m_transferQueue[index].status != emptyItem) {
+        || m_transferRing.status(index) != emptyItem) {
         XLOG("ERROR update a tile which is dirty already @ index %d", index);
     }
 
     m_transferQueue[index].savedBaseTileTexturePtr = renderInfo->baseTile->backTexture();
     m_transferQueue[index].savedBaseTilePtr = renderInfo->baseTile;
-    m_transferQueue[index].status = pendingBlit;
     m_transferQueue[index].uploadType = type;
+    // Ganesh renders tiles straight into the 8888 Surface Texture
+    m_transferQueue[index].config = bitmap ? bitmap->config() : SkBitmap::kARGB_8888_Config;
     if (type == CpuUpload && bitmap) {
-        // Lazily create the bitmap
-        if (!m_transferQueue[index].bitmap) {
-            m_transferQueue[index].bitmap = new SkBitmap();
-            int w = bitmap->width();
-            int h = bitmap->height();
-            m_transferQueue[index].bitmap->setConfig(bitmap->config(), w, h);
+        // Lazily create the bitmap, and swap it for one of the right
+        // format when 8888 and 565 tiles alternate
+        TileBitmapPool* pool = TilesManager::instance()->bitmapPool();
+        SkBitmap* savedBitmap = m_transferQueue[index].bitmap;
+        if (!savedBitmap
+            || savedBitmap->config() != bitmap->config()
+            || savedBitmap->width() != bitmap->width()
+            || savedBitmap->height() != bitmap->height()) {
+            pool->release(savedBitmap);
+            savedBitmap = pool->acquire(bitmap->width(), bitmap->height(), bitmap->config());
+            m_transferQueue[index].bitmap = savedBitmap;
         }
-        bitmap->copyTo(m_transferQueue[index].bitmap, bitmap->config());
+        // copyTo() would allocate new pixels for every tile, copy into the
+        // ones we already have instead
+        if (savedBitmap->config() == bitmap->config()
+            && savedBitmap->width() == bitmap->width()
+            && savedBitmap->height() == bitmap->height()
+            && savedBitmap->rowBytes() == bitmap->rowBytes()) {
+            bitmap->lockPixels();
+            savedBitmap->lockPixels();
+            memcpy(savedBitmap->getPixels(), bitmap->getPixels(), bitmap->getSize());
+            savedBitmap->unlockPixels();
+            bitmap->unlockPixels();
+        } else
+            bitmap->copyTo(savedBitmap, bitmap->config());
     }
 
     // Now fill the tileInfo.
@@ -468,7 +470,8 @@ void TransferQueue::addItemInTransferQueue(const TileRenderInfo* renderInfo,
 
     textureInfo->m_picture = renderInfo->textureInfo->m_pictureCount;
 
-    m_emptyItemCount--;
+    // Hand the item over to the UI thread
+    m_transferRing.publishSlot();
 }
 
 void TransferQueue::setTextureUploadType(TextureUploadType type)
@@ -476,9 +479,12 @@ void TransferQueue::setTextureUploadType(TextureUploadType type)
     if (m_currentUploadType == type)
         return;
 
-    discardQueue();
-
-    android::Mutex::Autolock lock(m_transferQueueItemLocks);
+    // Same as discardQueue(), but the upload type is switched before the
+    // producer lock is released, so no item is published in between. Each
+    // item remembers its own upload type.
+    m_transferRing.setConsumerAvailable(false);
+    android::Mutex::Autolock producerLock(m_transferQueueProducerLock);
+    m_transferRing.discardPendingSlots();
 #ifdef FORCE_CPU_UPLOAD
     m_currentUploadType = CpuUpload; // force to cpu upload mode for now until gpu upload mode is fixed
 #else
@@ -487,40 +493,31 @@ void TransferQueue::setTextureUploadType(TextureUploadType type)
     XLOGC("Now we set the upload to %s", m_currentUploadType == GpuUpload ? "GpuUpload" : "CpuUpload");
 }
 
-// Note: this need to be called within th lock.
 // Only called by updateDirtyBaseTiles() for now
-void TransferQueue::cleanupTransportQueue()
+void TransferQueue::discardTransferItem(int index)
 {
-    int index = getNextTransferQueueIndex();
-
-    for (int i = 0 ; i < ST_BUFFER_NUMBER; i++) {
-        if (m_transferQueue[index].status == pendingDiscard) {
-            // No matter what the current upload type is, as long as there has
-            // been a Surf Tex enqueue operation, this updateTexImage need to
-            // be called to keep things in sync.
-            if (m_transferQueue[index].uploadType == GpuUpload) {
-                status_t result = m_sharedSurfaceTexture->updateTexImage();
-                if (result != OK)
-                    XLOGC("unexpected error: updateTexImage return %d", result);
-            }
-
-            // since tiles in the queue may be from another webview, remove
-            // their textures so that they will be repainted / retransferred
-            BaseTile* tile = m_transferQueue[index].savedBaseTilePtr;
-            BaseTileTexture* texture = m_transferQueue[index].savedBaseTileTexturePtr;
-            if (tile && texture && texture->owner() == tile) {
-                // since tile destruction removes textures on the UI thread, the
-                // texture->owner ptr guarantees the tile is valid
-                tile->discardBackTexture();
-                XLOG("transfer queue discarded tile %p, removed texture", tile);
-            }
+    // No matter what the current upload type is, as long as there has
+    // been a Surf Tex enqueue operation, this updateTexImage need to
+    // be called to keep things in sync.
+    if (m_transferQueue[index].uploadType == GpuUpload) {
+        status_t result = m_sharedSurfaceTexture->updateTexImage();
+        if (result != OK)
+            XLOGC("unexpected error: updateTexImage return %d", result);
+    }
 
-            m_transferQueue[index].savedBaseTilePtr = 0;
-            m_transferQueue[index].savedBaseTileTexturePtr = 0;
-            m_transferQueue[index].status = emptyItem;
-        }
-        index = (index + 1) % ST_BUFFER_NUMBER;
+    // since tiles in the queue may be from another webview, remove
+    // their textures so that they will be repainted / retransferred
+    BaseTile* tile = m_transferQueue[index].savedBaseTilePtr;
+    BaseTileTexture* texture = m_transferQueue[index].savedBaseTileTexturePtr;
+    if (tile && texture && texture->owner() == tile) {
+        // since tile destruction removes textures on the UI thread, the
+        // texture->owner ptr guarantees the tile is valid
+        tile->discardBackTexture();
+        XLOG("transfer queue discarded tile %p, removed texture", tile);
     }
+
+    m_transferQueue[index].savedBaseTilePtr = 0;
+    m_transferQueue[index].savedBaseTileTexturePtr = 0;
 }
 
 void TransferQueue::saveGLState()
@@ -566,11 +563,6 @@ void TransferQueue::restoreGLState()
 #endif
 }
 
-int TransferQueue::getNextTransferQueueIndex()
-{
-    return (m_transferQueueIndex + 1) % ST_BUFFER_NUMBER;
-}
-
 } // namespace WebCore
 
 #endif // USE(ACCELERATED_COMPOSITING
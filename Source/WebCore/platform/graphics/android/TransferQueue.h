@@ -32,6 +32,7 @@
 #include "BaseTileTexture.h"
 #include "ShaderProgram.h"
 #include "TiledPage.h"
+#include "TransferRing.h"
 
 namespace WebCore {
 
@@ -42,27 +43,13 @@ struct GLState {
     GLfloat clearColor[4];
 };
 
-
-// While in the queue, the BaseTile can be re-used, the updated bitmap
-// can be discarded. In order to track this obsolete base tiles, we save
-// the Tile's Info to make the comparison.
-// At the time of base tile's dtor or webview destroy, we want to discard
-// all the data in the queue. However, we have to do the Surface Texture
-// update in the same GL context as the UI thread. So we mark the status
-// as pendingDiscard, and delay the Surface Texture operation to the next
-// draw call.
-
-enum TransferItemStatus {
-    emptyItem = 0, // S.T. buffer ready for new content
-    pendingBlit = 1, // Ready for bliting into tile's GL Tex.
-    pendingDiscard = 2 // Waiting for the next draw call to discard
-};
-
 enum TextureUploadType {
     CpuUpload = 0,
     GpuUpload = 1
 };
 
+#define ST_BUFFER_NUMBER 6
+
 #ifdef FORCE_CPU_UPLOAD
 #define DEFAULT_UPLOAD_TYPE CpuUpload
 #else
@@ -71,28 +58,23 @@ enum TextureUploadType {
 class TileTransferData {
 public:
     TileTransferData()
-    : status(emptyItem)
-    , savedBaseTilePtr(0)
+    : savedBaseTilePtr(0)
     , savedBaseTileTexturePtr(0)
     , uploadType(DEFAULT_UPLOAD_TYPE)
+    , config(SkBitmap::kARGB_8888_Config)
     , bitmap(0)
     , m_syncKHR(EGL_NO_SYNC_KHR)
     {
     }
 
-    ~TileTransferData()
-    {
-        // Bitmap will be created lazily, need to delete them at dtor.
-        delete bitmap;
-    }
-
-    TransferItemStatus status;
     BaseTile* savedBaseTilePtr;
     BaseTileTexture* savedBaseTileTexturePtr;
     TextureTileInfo tileInfo;
     TextureUploadType uploadType;
+    // config of the tile, and of the texture it is uploaded into
+    SkBitmap::Config config;
     // This is only useful in Cpu upload code path, so it will be dynamically
-    // lazily allocated.
+    // lazily taken from the TilesManager's bitmap pool.
     SkBitmap* bitmap;
 
     // Sync object for GPU fence, this is the only the info passed from UI
@@ -123,20 +105,24 @@ public:
 
     void discardQueue();
 
+    // Fills the next item of the queue and hands it over to the UI thread.
+    // Must be called with the queue locked, after readyForUpdate().
     void addItemInTransferQueue(const TileRenderInfo* info,
                                 TextureUploadType type,
                                 const SkBitmap* bitmap);
-    // Check if the item @ index is ready for update.
-    // The lock will be done when returning true.
+    // Waits for the next item of the queue to be free. Must be called with
+    // the queue locked.
     bool readyForUpdate();
 
     void interruptTransferQueue(bool);
 
-    void lockQueue() { m_transferQueueItemLocks.lock(); }
-    void unlockQueue() { m_transferQueueItemLocks.unlock(); }
+    // Serializes the producers (TexturesGenerator workers); the UI thread
+    // never takes this lock
+    void lockQueue() { m_transferQueueProducerLock.lock(); }
+    void unlockQueue() { m_transferQueueProducerLock.unlock(); }
 
-    // This queue can be accessed from UI and TexGen thread, therefore, we need
-    // a lock to protect its access
+    // This queue can be accessed from UI and TexGen thread: the state of each
+    // item, kept in m_transferRing, tells which thread owns it
     TileTransferData* m_transferQueue;
 
     sp<ANativeWindow> m_ANW;
@@ -148,10 +134,6 @@ private:
     // return true if successfully inserted into queue
     bool tryUpdateQueueWithBitmap(const TileRenderInfo* renderInfo, int x, int y,
                                   const SkBitmap& bitmap);
-    bool getHasGLContext();
-    void setHasGLContext(bool hasContext);
-
-    int getNextTransferQueueIndex();
 
     // Save and restore the GL State while switching from/to FBO.
     void saveGLState();
@@ -161,43 +143,30 @@ private:
     // Check the current transfer queue item is obsolete or not.
     bool checkObsolete(int index);
 
-    // Before each draw call and the blit operation, clean up all the
-    // pendingDiscard items.
-    void cleanupTransportQueue();
+    // Called on the UI thread for the pendingDiscard items.
+    void discardTransferItem(int index);
 
     void blitTileFromQueue(GLuint fboID, BaseTileTexture* destTex,
                            GLuint srcTexId, GLenum srcTexTarget,
                            int index);
 
-    // Note that the m_transferQueueIndex only changed in the TexGen thread
-    // where we are going to move on to update the next item in the queue.
-    int m_transferQueueIndex;
-
     GLuint m_fboID; // The FBO used for copy the SurfTex to each tile
 
     GLuint m_sharedSurfaceTextureId;
 
-    // GLContext can be lost when WebView destroyed.
-    bool m_hasGLContext;
-
     GLState m_GLStateBeforeBlit;
     sp<android::SurfaceTexture> m_sharedSurfaceTexture;
 
-    int m_emptyItemCount;
-
-    bool m_interruptedByRemovingOp;
-
-    // We are using wait/signal to handle our own queue sync.
-    // First of all, if we don't have our own lock, then while WebView is
-    // destroyed, the UI thread will wait for the Tex Gen to get out from
-    // dequeue operation, which will not succeed. B/c at this moment, we
-    // already lost the GL Context.
-    // Now we maintain a counter, which is m_emptyItemCount. When this reach
-    // 0, then we need the Tex Gen thread to wait. UI thread can signal this
-    // wait after calling updateTexImage at the draw call , or after WebView
-    // is destroyed.
-    android::Mutex m_transferQueueItemLocks;
-    android::Condition m_transferQueueItemCond;
+    // Hands the items of m_transferQueue over between the Tex Gen and UI
+    // threads. The UI thread never waits for the Tex Gen threads; those wait
+    // for a free item only while the UI thread still has a GL context (it
+    // can be lost when WebView destroyed) and they are not interrupted.
+    TransferRing m_transferRing;
+
+    // Several TexturesGenerator workers can produce bitmaps at the same time.
+    // The shared Surface Texture buffers must be enqueued in the same order
+    // as the items of m_transferQueue, so producers go through one at a time.
+    android::Mutex m_transferQueueProducerLock;
 
     EGLDisplay m_currentDisplay;
 
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "config.h"
+#include "TransferRing.h"
+
+#include <cutils/atomic.h>
+
+namespace WebCore {
+
+TransferRing::TransferRing(int size)
+    : m_size(size)
+    , m_status(new int32_t[size])
+    , m_writeIndex(0)
+    , m_readIndex(0)
+    , m_consumerAvailable(1)
+    , m_interrupted(0)
+{
+    for (int i = 0; i < size; i++)
+        m_status[i] = emptyItem;
+}
+
+TransferRing::~TransferRing()
+{
+    delete[] m_status;
+}
+
+TransferItemStatus TransferRing::status(int index) const
+{
+    return static_cast<TransferItemStatus>(android_atomic_acquire_load(&m_status[index]));
+}
+
+bool TransferRing::acquireSlot()
+{
+    android::Mutex::Autolock lock(m_wakeLock);
+    while (true) {
+        if (!android_atomic_acquire_load(&m_consumerAvailable))
+            return false;
+        if (status(m_writeIndex) == emptyItem)
+            return true;
+        if (android_atomic_acquire_load(&m_interrupted))
+            return false;
+        m_wakeCond.wait(m_wakeLock);
+    }
+}
+
+void TransferRing::publishSlot()
+{
+    android_atomic_release_store(pendingBlit, &m_status[m_writeIndex]);
+    m_writeIndex = (m_writeIndex + 1) % m_size;
+}
+
+int TransferRing::oldestSlot() const
+{
+    return status(m_readIndex) == emptyItem ? -1 : m_readIndex;
+}
+
+void TransferRing::releaseSlot()
+{
+    android_atomic_release_store(emptyItem, &m_status[m_readIndex]);
+    m_readIndex = (m_readIndex + 1) % m_size;
+    wakeProducer();
+}
+
+void TransferRing::discardPendingSlots()
+{
+    for (int i = 0; i < m_size; i++) {
+        if (status(i) == pendingBlit)
+            android_atomic_release_store(pendingDiscard, &m_status[i]);
+    }
+}
+
+void TransferRing::setConsumerAvailable(bool available)
+{
+    android_atomic_release_store(available, &m_consumerAvailable);
+    if (!available)
+        wakeProducer();
+}
+
+void TransferRing::setInterrupted(bool interrupted)
+{
+    android_atomic_release_store(interrupted, &m_interrupted);
+    if (interrupted)
+        wakeProducer();
+}
+
+// The producer checks the slot states and flags with m_wakeLock held before
+// waiting, so taking it here guarantees the wake up is not missed
+void TransferRing::wakeProducer()
+{
+    android::Mutex::Autolock lock(m_wakeLock);
+    m_wakeCond.broadcast();
+}
+
+} // namespace WebCore
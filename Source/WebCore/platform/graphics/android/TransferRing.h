@@ -0,0 +1,110 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TransferRing_h
+#define TransferRing_h
+
+#include <utils/threads.h>
+
+namespace WebCore {
+
+// While in the queue, the BaseTile can be re-used, the updated bitmap
+// can be discarded. In order to track this obsolete base tiles, we save
+// the Tile's Info to make the comparison.
+// At the time of base tile's dtor or webview destroy, we want to discard
+// all the data in the queue. However, we have to do the Surface Texture
+// update in the same GL context as the UI thread. So we mark the status
+// as pendingDiscard, and delay the Surface Texture operation to the next
+// draw call.
+
+enum TransferItemStatus {
+    emptyItem = 0, // S.T. buffer ready for new content
+    pendingBlit = 1, // Ready for bliting into tile's GL Tex.
+    pendingDiscard = 2 // Waiting for the next draw call to discard
+};
+
+// Bounded single-producer/single-consumer ring of slot states, used by the
+// TransferQueue to hand tiles from the texture generator (producer) over to
+// the UI thread (consumer). The slot contents live with the caller, indexed
+// like the ring.
+//
+// Slots are filled and emptied in order, so the non-empty slots always form
+// a run starting at the consumer's index. Only the producer moves a slot out
+// of emptyItem, and only the consumer changes a non-empty slot, so slot
+// states are plain atomic stores: a release store publishes the contents
+// written before it, and the acquire load on the other side sees them.
+//
+// The consumer never waits. When the ring is full the producer waits for
+// the consumer to free a slot, unless it was interrupted or the consumer
+// went away (the GL context was lost); the lock below is only held to check
+// those conditions and to wake the producer up, never while a slot is used.
+// Several producers must be serialized by the caller.
+class TransferRing {
+public:
+    TransferRing(int size);
+    ~TransferRing();
+
+    int size() const { return m_size; }
+    TransferItemStatus status(int index) const;
+
+    // Producer side
+    // Waits until the slot at writeIndex() is empty. Returns false, without
+    // waiting, if the consumer is unavailable or the ring interrupted.
+    bool acquireSlot();
+    int writeIndex() const { return m_writeIndex; }
+    // Marks the slot at writeIndex() pendingBlit and moves on to the next one
+    void publishSlot();
+
+    // Consumer side
+    // Returns the index of the oldest non-empty slot, or -1 if there is none
+    int oldestSlot() const;
+    // Empties the oldest slot, once the consumer is done with its contents
+    void releaseSlot();
+    // Marks all the pendingBlit slots pendingDiscard
+    void discardPendingSlots();
+
+    // While unavailable, acquireSlot() fails. Set by the consumer.
+    void setConsumerAvailable(bool available);
+    // While interrupted, acquireSlot() fails instead of waiting. Set when
+    // something the consumer thread waits for needs the producer to finish.
+    void setInterrupted(bool interrupted);
+
+private:
+    void wakeProducer();
+
+    int m_size;
+    volatile int32_t* m_status;
+    int m_writeIndex; // only used by the producer
+    int m_readIndex; // only used by the consumer
+    volatile int32_t m_consumerAvailable;
+    volatile int32_t m_interrupted;
+
+    android::Mutex m_wakeLock;
+    android::Condition m_wakeCond;
+};
+
+} // namespace WebCore
+
+#endif // TransferRing_h
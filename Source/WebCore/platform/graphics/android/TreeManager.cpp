@@ -29,6 +29,7 @@
 #include "Layer.h"
 #include "BaseLayerAndroid.h"
 #include "ScrollableLayerAndroid.h"
+#include "TileFingerprint.h"
 #include "TilesManager.h"
 
 #include <cutils/log.h>
@@ -56,6 +57,8 @@ TreeManager::TreeManager()
     : m_drawingTree(0)
     , m_paintingTree(0)
     , m_queuedTree(0)
+    , m_fingerprint(0)
+    , m_fingerprintGeneration(0)
     , m_fastSwapMode(false)
 {
 }
@@ -63,6 +66,7 @@ TreeManager::TreeManager()
 TreeManager::~TreeManager()
 {
     clearTrees();
+    delete m_fingerprint;
 }
 
 // the painting tree has finished painting:
@@ -281,8 +285,7 @@ int TreeManager::getTotalPaintedSurfaceCount()
     return TilesManager::instance()->getPaintedSurfaceCount();
 }
 
-// draw for base tile - called on TextureGeneration thread
-void TreeManager::drawCanvas(SkCanvas* canvas, bool drawLayers)
+BaseLayerAndroid* TreeManager::refPaintingTree()
 {
     BaseLayerAndroid* paintingTree = 0;
     m_paintSwapLock.lock();
@@ -292,11 +295,20 @@ void TreeManager::drawCanvas(SkCanvas* canvas, bool drawLayers)
         paintingTree = static_cast<BaseLayerAndroid*>(m_drawingTree);
     SkSafeRef(paintingTree);
     m_paintSwapLock.unlock();
+    return paintingTree;
+}
 
+// draw for base tile - called on TextureGeneration thread
+void TreeManager::drawCanvas(SkCanvas* canvas, bool drawLayers)
+{
+    BaseLayerAndroid* paintingTree = refPaintingTree();
     if (!paintingTree)
         return;
 
-
+    // Pictures can't be replayed by two threads at once, and every base tile
+    // replays the same ones, as well as the layers' in single surface mode
+    android::Mutex* playbackLock = TilesManager::instance()->picturePlaybackLock();
+    playbackLock->lock();
     paintingTree->drawCanvas(canvas);
 
     if (drawLayers && paintingTree->countChildren()) {
@@ -304,8 +316,36 @@ void TreeManager::drawCanvas(SkCanvas* canvas, bool drawLayers)
         Layer* layers = paintingTree->getChild(0);
         static_cast<LayerAndroid*>(layers)->drawCanvas(canvas);
     }
+    playbackLock->unlock();
+
+    SkSafeUnref(paintingTree);
+}
+
+// fingerprint of a base tile, without the layers - called on
+// TextureGeneration thread. The base content is fingerprinted once, the
+// first time one of its tiles is painted.
+bool TreeManager::fingerprintBaseTile(int x, int y, const SkSize& tileSize,
+                                      float scale, uint64_t* fingerprint)
+{
+    BaseLayerAndroid* paintingTree = refPaintingTree();
+    if (!paintingTree)
+        return false;
+
+    android::Mutex* playbackLock = TilesManager::instance()->picturePlaybackLock();
+    playbackLock->lock();
+    int32_t generation = paintingTree->contentGeneration();
+    if (!m_fingerprint || m_fingerprintGeneration != generation) {
+        delete m_fingerprint;
+        m_fingerprint = new TileFingerprint(paintingTree->content()->width(),
+                                            paintingTree->content()->height());
+        paintingTree->drawCanvas(m_fingerprint->canvas());
+        m_fingerprintGeneration = generation;
+    }
+    bool hasFingerprint = m_fingerprint->tile(x, y, tileSize, scale, fingerprint);
+    playbackLock->unlock();
 
     SkSafeUnref(paintingTree);
+    return hasFingerprint;
 }
 
 int TreeManager::baseContentWidth()
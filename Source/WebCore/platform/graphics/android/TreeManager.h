@@ -33,11 +33,14 @@
 class Layer;
 class SkRect;
 class SkCanvas;
+struct SkSize;
 
 namespace WebCore {
 
+class BaseLayerAndroid;
 class IntRect;
 class TexturesResult;
+class TileFingerprint;
 
 class TEST_EXPORT TreeManager {
 public:
@@ -55,6 +58,8 @@ public:
                 TexturesResult* texturesResultPtr);
 
     void drawCanvas(SkCanvas* canvas, bool drawLayers);
+    bool fingerprintBaseTile(int x, int y, const SkSize& tileSize, float scale,
+                             uint64_t* fingerprint);
 
     // used in debugging (to avoid exporting TilesManager symbols)
     static int getTotalPaintedSurfaceCount();
@@ -67,6 +72,7 @@ private:
 
     void swap();
     void clearTrees();
+    BaseLayerAndroid* refPaintingTree();
 
     android::Mutex m_paintSwapLock;
 
@@ -74,6 +80,11 @@ private:
     Layer* m_paintingTree;
     Layer* m_queuedTree;
 
+    // fingerprint of the base content, protected by the TilesManager's
+    // picture playback lock
+    TileFingerprint* m_fingerprint;
+    int32_t m_fingerprintGeneration;
+
     bool m_fastSwapMode;
     PerformanceMonitor m_perf;
 };
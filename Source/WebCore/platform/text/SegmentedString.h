@@ -240,21 +240,45 @@ private:
     void advanceSubstring();
     const UChar* current() const { return m_currentChar; }
 
-    static bool equalsLiterally(const UChar* str1, const UChar* str2, size_t count) { return !memcmp(str1, str2, count * sizeof(UChar)); }
-    static bool equalsIgnoringCase(const UChar* str1, const UChar* str2, size_t count) { return !WTF::Unicode::umemcasecmp(str1, str2, count); }
+    // The strings looked ahead for are mostly literals, held in 8 bits.
+    static bool equalsLiterally(const String& string, const UChar* characters, size_t count)
+    {
+        if (string.is8Bit()) {
+            const LChar* stringCharacters = string.characters8();
+            for (size_t i = 0; i < count; ++i) {
+                if (stringCharacters[i] != characters[i])
+                    return false;
+            }
+            return true;
+        }
+        return !memcmp(string.characters(), characters, count * sizeof(UChar));
+    }
+
+    static bool equalsIgnoringCase(const String& string, const UChar* characters, size_t count)
+    {
+        if (string.is8Bit()) {
+            const LChar* stringCharacters = string.characters8();
+            for (size_t i = 0; i < count; ++i) {
+                if (WTF::Unicode::foldCase(stringCharacters[i]) != WTF::Unicode::foldCase(characters[i]))
+                    return false;
+            }
+            return true;
+        }
+        return !WTF::Unicode::umemcasecmp(string.characters(), characters, count);
+    }
 
-    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
+    template<bool equals(const String& string, const UChar* characters, size_t count)>
     inline LookAheadResult lookAheadInline(const String& string)
     {
         if (!m_pushedChar1 && string.length() <= static_cast<unsigned>(m_currentString.m_length)) {
-            if (equals(string.characters(), m_currentString.m_current, string.length()))
+            if (equals(string, m_currentString.m_current, string.length()))
                 return DidMatch;
             return DidNotMatch;
         }
         return lookAheadSlowCase<equals>(string);
     }
 
-    template<bool equals(const UChar* str1, const UChar* str2, size_t count)>
+    template<bool equals(const String& string, const UChar* characters, size_t count)>
     LookAheadResult lookAheadSlowCase(const String& string)
     {
         unsigned count = string.length();
@@ -264,7 +288,7 @@ private:
         String consumedString = String::createUninitialized(count, consumedCharacters);
         advance(count, consumedCharacters);
         LookAheadResult result = DidNotMatch;
-        if (equals(string.characters(), consumedCharacters, count))
+        if (equals(string, consumedCharacters, count))
             result = DidMatch;
         prepend(SegmentedString(consumedString));
         return result;
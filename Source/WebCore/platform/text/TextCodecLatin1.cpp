@@ -27,9 +27,9 @@
 #include "TextCodecLatin1.h"
 
 #include "PlatformString.h"
-#include "TextCodecASCIIFastPath.h"
 #include <wtf/text/CString.h>
 #include <wtf/text/StringBuffer.h>
+#include <wtf/text/StringSIMD.h>
 #include <wtf/PassOwnPtr.h>
 
 namespace WebCore {
@@ -123,35 +123,17 @@ String TextCodecLatin1::decode(const char* bytes, size_t length, bool, bool, boo
 
     const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
     const uint8_t* end = reinterpret_cast<const uint8_t*>(bytes + length);
-    const uint8_t* alignedEnd = alignToMachineWord(end);
     UChar* destination = characters;
 
     while (source < end) {
         if (isASCII(*source)) {
             // Fast path for ASCII. Most Latin-1 text will be ASCII.
-            if (isAlignedToMachineWord(source)) {
-                while (source < alignedEnd) {
-                    MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
-
-                    if (!isAllASCII(chunk))
-                        goto useLookupTable;
-
-                    copyASCIIMachineWord(destination, source);
-                    source += sizeof(MachineWord);
-                    destination += sizeof(MachineWord);
-                }
-
-                if (source == end)
-                    break;
-            }
-            *destination = *source;
-        } else {
-useLookupTable:
-            *destination = table[*source];
+            unsigned asciiLength = WTF::StringSIMD::copyASCIIPrefix(destination, source, end - source);
+            source += asciiLength;
+            destination += asciiLength;
+            continue;
         }
-
-        ++source;
-        ++destination;
+        *destination++ = table[*source++];
     }
 
     return result;
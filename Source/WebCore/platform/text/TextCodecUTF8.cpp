@@ -26,9 +26,9 @@
 #include "config.h"
 #include "TextCodecUTF8.h"
 
-#include "TextCodecASCIIFastPath.h"
 #include <wtf/text/CString.h>
 #include <wtf/text/StringBuffer.h>
+#include <wtf/text/StringSIMD.h>
 #include <wtf/unicode/CharacterNames.h>
 
 using namespace WTF::Unicode;
@@ -222,7 +222,6 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
 
     const uint8_t* source = reinterpret_cast<const uint8_t*>(bytes);
     const uint8_t* end = source + length;
-    const uint8_t* alignedEnd = alignToMachineWord(end);
     UChar* destination = buffer.characters();
 
     do {
@@ -242,21 +241,9 @@ String TextCodecUTF8::decode(const char* bytes, size_t length, bool flush, bool
         while (source < end) {
             if (isASCII(*source)) {
                 // Fast path for ASCII. Most UTF-8 text will be ASCII.
-                if (isAlignedToMachineWord(source)) {
-                    while (source < alignedEnd) {
-                        MachineWord chunk = *reinterpret_cast_ptr<const MachineWord*>(source);
-                        if (!isAllASCII(chunk))
-                            break;
-                        copyASCIIMachineWord(destination, source);
-                        source += sizeof(MachineWord);
-                        destination += sizeof(MachineWord);
-                    }
-                    if (source == end)
-                        break;
-                    if (!isASCII(*source))
-                        continue;
-                }
-                *destination++ = *source++;
+                unsigned asciiLength = WTF::StringSIMD::copyASCIIPrefix(destination, source, end - source);
+                source += asciiLength;
+                destination += asciiLength;
                 continue;
             }
             int count = nonASCIISequenceLength(*source);
@@ -57,8 +57,15 @@ LOCAL_SRC_FILES += \
 	android/RenderSkinRadio.cpp \
 	android/TimeCounter.cpp \
 	\
+	android/benchmark/AtomicStringStress.cpp \
 	android/benchmark/Intercept.cpp \
+	android/benchmark/MallocStatistics.cpp \
 	android/benchmark/MyJavaVM.cpp \
+	android/benchmark/Opaque565TileCheck.cpp \
+	android/benchmark/OperationQueueBenchmark.cpp \
+	android/benchmark/PictureSetBenchmark.cpp \
+	android/benchmark/TileBenchmark.cpp \
+	android/benchmark/TransferRingStress.cpp \
 	\
 	android/icu/unicode/ucnv.cpp \
 	\
@@ -0,0 +1,217 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/RefPtr.h>
+#include <wtf/Threading.h>
+#include <wtf/Vector.h>
+#include <wtf/text/AtomicString.h>
+#include <wtf/text/WTFString.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+namespace android {
+
+#if ENABLE(SHARED_ATOMIC_STRING_TABLE)
+
+// Hammers the shared AtomicString table: threads make atoms out of a small
+// set of names, trade them through shared slots, look them up with
+// AtomicString::find() and drop them, so that the last reference to an atom
+// is often dropped on one thread while another finds or adds it again.
+//
+// The same characters must always give the same atom, and once every atom
+// is dropped none of the names may be left in the table.
+
+static const int s_threadCount = 4;
+static const int s_nameCount = 64;
+static const int s_slotCount = 16;
+static const int s_stepsPerThread = 400000;
+
+class AtomicStringStress {
+public:
+    AtomicStringStress()
+        : m_failures(0)
+    {
+        for (int i = 0; i < s_slotCount; i++)
+            m_slots[i] = 0;
+    }
+
+    ~AtomicStringStress()
+    {
+        for (int i = 0; i < s_slotCount; i++)
+            delete m_slots[i];
+    }
+
+    static String name(int i)
+    {
+        char buffer[32];
+        snprintf(buffer, sizeof(buffer), "stress-atom-%d", i);
+        return String(buffer);
+    }
+
+    static PassRefPtr<AtomicStringImpl> find(const String& text)
+    {
+        return AtomicString::find(text.characters(), text.length(), text.impl()->hash());
+    }
+
+    void run(unsigned seed)
+    {
+        Vector<String> names;
+        for (int i = 0; i < s_nameCount; i++)
+            names.append(name(i));
+
+        for (int i = 0; i < s_stepsPerThread; i++) {
+            const String& text = names[rand_r(&seed) % s_nameCount];
+            switch (rand_r(&seed) % 4) {
+            case 0: {
+                AtomicString atom(text);
+                if (atom.string() != text)
+                    fail("an atom has the wrong characters");
+                if (find(text) != atom.impl())
+                    fail("find() returned another atom");
+                break;
+            }
+            case 1: {
+                // Usually finds nothing, or an atom being dropped on another thread
+                RefPtr<AtomicStringImpl> found = find(text);
+                if (found && String(found.get()) != text)
+                    fail("find() returned an atom with the wrong characters");
+                break;
+            }
+            case 2: {
+                // Hand the atom over to another thread, and drop the one it left
+                AtomicString* atom = new AtomicString(text);
+                AtomicString* old;
+                {
+                    MutexLocker locker(m_slotLock);
+                    int slot = rand_r(&seed) % s_slotCount;
+                    old = m_slots[slot];
+                    m_slots[slot] = atom;
+                }
+                if (old) {
+                    AtomicString again(old->string());
+                    if (again.impl() != old->impl())
+                        fail("the same characters gave two atoms");
+                    delete old;
+                }
+                break;
+            }
+            case 3: {
+                // A string that is not an atom must give the same atom
+                AtomicString atom(text.crossThreadString());
+                AtomicString other(text);
+                if (atom.impl() != other.impl())
+                    fail("the same characters gave two atoms");
+                break;
+            }
+            }
+        }
+    }
+
+    int leftoverAtoms()
+    {
+        int leftover = 0;
+        for (int i = 0; i < s_nameCount; i++) {
+            if (find(name(i)))
+                leftover++;
+        }
+        return leftover;
+    }
+
+    int failures() { return m_failures; }
+
+private:
+    void fail(const char* what)
+    {
+        MutexLocker locker(m_slotLock);
+        if (!m_failures++)
+            printf("%s\n", what);
+    }
+
+    Mutex m_slotLock;
+    AtomicString* m_slots[s_slotCount];
+    int m_failures;
+};
+
+struct StressThread {
+    AtomicStringStress* stress;
+    unsigned seed;
+};
+
+static void* stressThread(void* data)
+{
+    StressThread* thread = static_cast<StressThread*>(data);
+    thread->stress->run(thread->seed);
+    return 0;
+}
+
+static void runStress()
+{
+    double start = currentTime();
+    int leftover;
+    int failures;
+    {
+        AtomicStringStress stress;
+        StressThread threads[s_threadCount];
+        ThreadIdentifier identifiers[s_threadCount];
+        for (int i = 0; i < s_threadCount; i++) {
+            threads[i].stress = &stress;
+            threads[i].seed = rand();
+            identifiers[i] = createThread(stressThread, &threads[i], "AtomicStringStress");
+        }
+        for (int i = 0; i < s_threadCount; i++)
+            waitForThreadCompletion(identifiers[i], 0);
+        failures = stress.failures();
+    }
+    leftover = AtomicStringStress().leftoverAtoms();
+    double elapsed = currentTime() - start;
+
+    printf("%d threads x %d steps in %.2f ms: %d failures, %d atoms left in the table\n",
+           s_threadCount, s_stepsPerThread, elapsed * 1000, failures, leftover);
+    if (failures || leftover)
+        printf("FAILED\n");
+}
+
+EXPORT void stressAtomicStrings(int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+        runStress();
+}
+
+#else
+
+EXPORT void stressAtomicStrings(int)
+{
+    printf("Atoms are per thread, build with ENABLE_SHARED_ATOMIC_STRING_TABLE=1\n");
+}
+
+#endif
+
+} // namespace android
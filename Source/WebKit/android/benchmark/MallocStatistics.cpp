@@ -0,0 +1,148 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include <algorithm>
+#include <dlfcn.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+#include <utils/Log.h>
+#include <wtf/FastMalloc.h>
+#include <wtf/Vector.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+namespace android {
+
+// Enough for the 67 size classes TCMalloc uses
+static const size_t s_maxSizeClasses = 128;
+static const size_t s_maxSites = 1024;
+// Sites printed, the most sampled first
+static const size_t s_sitesToDump = 100;
+
+static bool moreSamples(const WTF::FastMallocAllocationSite& a, const WTF::FastMallocAllocationSite& b)
+{
+    return a.samples > b.samples;
+}
+
+// Tunes FastMalloc before a run: samples allocation sites every sampleInterval
+// bytes (0 for none), and sets how eagerly free pages go back to the system.
+EXPORT void configureMalloc(int sampleInterval, float scavengeAggressiveness)
+{
+    if (WTF::fastMallocUsesSystemMalloc()) {
+        if (sampleInterval > 0 || scavengeAggressiveness != 1)
+            LOGE("FastMalloc uses the system malloc, -s and -a have no effect");
+        return;
+    }
+    WTF::setFastMallocScavengeAggressiveness(scavengeAggressiveness);
+    WTF::setFastMallocSampleInterval(sampleInterval > 0 ? sampleInterval : 0);
+}
+
+// The system malloc only has the totals of mallinfo()
+static void dumpSystemMallocStatistics(FILE* file)
+{
+    struct mallinfo info = mallinfo();
+    fprintf(file, "{\n  \"allocator\": \"system\",\n"
+            "  \"unavailable\": \"FastMalloc uses the system malloc, so there are no size classes, page heap or allocation sites\",\n");
+    fprintf(file, "  \"arenaBytes\": %zu,\n  \"mmappedBytes\": %zu,\n  \"inUseBytes\": %zu,\n  \"freeBytes\": %zu,\n"
+            "  \"releasableBytes\": %zu\n}\n",
+            static_cast<size_t>(info.arena), static_cast<size_t>(info.hblkhd), static_cast<size_t>(info.uordblks),
+            static_cast<size_t>(info.fordblks), static_cast<size_t>(info.keepcost));
+}
+
+static void dumpFastMallocStatistics(FILE* file)
+{
+    WTF::FastMallocStatistics totals = WTF::fastMallocStatistics();
+    fprintf(file, "{\n  \"allocator\": \"fastMalloc\",\n  \"reservedBytes\": %zu,\n  \"committedBytes\": %zu,\n  \"freeListBytes\": %zu,\n",
+            totals.reservedVMBytes, totals.committedVMBytes, totals.freeListBytes);
+
+    WTF::FastMallocPageHeapStatistics pageHeap = WTF::fastMallocPageHeapStatistics();
+    fprintf(file, "  \"pageHeap\": { \"systemBytes\": %zu, \"freeCommittedBytes\": %zu, \"returnedBytes\": %zu,"
+            " \"freeSpans\": %zu, \"largestFreeSpanBytes\": %zu },\n",
+            pageHeap.systemBytes, pageHeap.freeCommittedBytes, pageHeap.returnedBytes,
+            pageHeap.freeSpanCount, pageHeap.largestFreeSpanBytes);
+
+    WTF::FastMallocSizeClassStatistics sizeClasses[s_maxSizeClasses];
+    size_t sizeClassCount = WTF::fastMallocSizeClassStatistics(sizeClasses, s_maxSizeClasses);
+    fprintf(file, "  \"sizeClasses\": [");
+    bool first = true;
+    for (size_t i = 0; i < sizeClassCount; ++i) {
+        const WTF::FastMallocSizeClassStatistics& sizeClass = sizeClasses[i];
+        if (!sizeClass.spanCount && !sizeClass.sampledBytes)
+            continue;
+        fprintf(file, "%s\n    { \"objectSize\": %zu, \"spans\": %zu, \"spanBytes\": %zu, \"freeBytes\": %zu,"
+                " \"unusableBytes\": %zu, \"sampledBytes\": %zu }",
+                first ? "" : ",", sizeClass.objectSize, sizeClass.spanCount, sizeClass.spanBytes,
+                sizeClass.freeBytes, sizeClass.unusableBytes, sizeClass.sampledBytes);
+        first = false;
+    }
+    fprintf(file, "\n  ],\n");
+
+    Vector<WTF::FastMallocAllocationSite> sites(s_maxSites);
+    sites.shrink(WTF::fastMallocAllocationSites(sites.data(), s_maxSites));
+    std::sort(sites.begin(), sites.end(), moreSamples);
+    if (sites.size() > s_sitesToDump)
+        sites.shrink(s_sitesToDump);
+
+    fprintf(file, "  \"sampleInterval\": %zu,\n  \"sites\": [", WTF::fastMallocSampleInterval());
+    for (size_t i = 0; i < sites.size(); ++i) {
+        fprintf(file, "%s\n    { \"samples\": %zu, \"stack\": [", i ? "," : "", sites[i].samples);
+        for (unsigned j = 0; j < sites[i].stackDepth; ++j) {
+            Dl_info info;
+            void* address = sites[i].stack[j];
+            if (dladdr(address, &info) && info.dli_sname) {
+                fprintf(file, "%s\"%s+%zu\"", j ? ", " : "", info.dli_sname,
+                        static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_saddr)));
+            } else
+                fprintf(file, "%s\"%p\"", j ? ", " : "", address);
+        }
+        fprintf(file, "] }");
+    }
+    fprintf(file, "\n  ]\n}\n");
+}
+
+// Writes the occupancy of each size class, the free pages of the page heap
+// and the sampled allocation sites as JSON to fileName ("-" for stdout).
+// With the system malloc, only the totals it keeps are written.
+EXPORT bool dumpMallocStatistics(const char* fileName)
+{
+    FILE* file = strcmp(fileName, "-") ? fopen(fileName, "w") : stdout;
+    if (!file)
+        return false;
+
+    if (WTF::fastMallocUsesSystemMalloc())
+        dumpSystemMallocStatistics(file);
+    else
+        dumpFastMallocStatistics(file);
+
+    if (file != stdout)
+        fclose(file);
+    return true;
+}
+
+} // namespace android
@@ -0,0 +1,150 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkColorPriv.h"
+#include "SkPaint.h"
+#include "SkPicture.h"
+#include "TilesManager.h"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <wtf/CurrentTime.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+using namespace WebCore;
+
+namespace android {
+
+// Paints the tiles of a synthetic page the way RasterRenderer paints base
+// tiles, once in 8888 bitmaps and once in the 565 bitmaps used for opaque
+// tiles, and checks that the 565 tiles only differ from the 8888 ones by
+// the loss of precision of 565 (plus Skia's dithering).
+
+static const int s_pageHeight = 4096;
+// 5 and 6 bit channels, one step each for rounding and dithering
+static const int s_maxChannelError = 16;
+
+static SkPicture* recordPage(int width, int height)
+{
+    SkPicture* picture = new SkPicture();
+    SkCanvas* canvas = picture->beginRecording(width, height);
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    for (int y = 0; y < height; y += 64) {
+        // translucent blocks, antialiased circles and text, over the white
+        // background the tiles are erased with
+        paint.setColor(SkColorSetARGB(0x20 + (y % 0xc0), y % 256, 0x80, 255 - y % 256));
+        canvas->drawRect(SkRect::MakeLTRB(y % width, y, width, y + 48), paint);
+        paint.setColor(SkColorSetARGB(0xff, 0x10, y % 256, 0x40));
+        canvas->drawCircle(width / 2, y + 32, 20 + y % 12, paint);
+        paint.setTextSize(12 + y % 20);
+        canvas->drawText("The quick brown fox", 19, 8, y + 40, paint);
+    }
+    picture->endRecording();
+    return picture;
+}
+
+static void paintTile(SkPicture* page, SkBitmap* bitmap, int x, int y)
+{
+    bitmap->setIsOpaque(true);
+    bitmap->eraseARGB(255, 255, 255, 255);
+    SkCanvas canvas(*bitmap);
+    canvas.translate(-x, -y);
+    canvas.drawPicture(*page);
+}
+
+// Returns the largest difference between the channels of the two bitmaps,
+// and counts the pixels over s_maxChannelError
+static int compareTiles(const SkBitmap& reference, const SkBitmap& tile, int* badPixels)
+{
+    int maxError = 0;
+    SkAutoLockPixels lockReference(reference);
+    SkAutoLockPixels lockTile(tile);
+    for (int y = 0; y < reference.height(); y++) {
+        for (int x = 0; x < reference.width(); x++) {
+            SkPMColor expected = *reference.getAddr32(x, y);
+            uint16_t actual = *tile.getAddr16(x, y);
+            int error = abs((int)SkGetPackedR32(expected) - (int)SkPacked16ToR32(actual));
+            error = std::max(error, abs((int)SkGetPackedG32(expected) - (int)SkPacked16ToG32(actual)));
+            error = std::max(error, abs((int)SkGetPackedB32(expected) - (int)SkPacked16ToB32(actual)));
+            if (error > s_maxChannelError)
+                (*badPixels)++;
+            maxError = std::max(maxError, error);
+        }
+    }
+    return maxError;
+}
+
+EXPORT void checkOpaque565Tiles(int width, int iterations)
+{
+    SkBitmap reference;
+    reference.setConfig(SkBitmap::kARGB_8888_Config,
+                        TilesManager::tileWidth(), TilesManager::tileHeight());
+    reference.allocPixels();
+    SkBitmap tile;
+    tile.setConfig(SkBitmap::kRGB_565_Config,
+                   TilesManager::tileWidth(), TilesManager::tileHeight());
+    tile.allocPixels();
+
+    SkPicture* page = recordPage(width, s_pageHeight);
+    double referenceTime = 0;
+    double tileTime = 0;
+    int tiles = 0;
+    int maxError = 0;
+    int badPixels = 0;
+    for (int i = 0; i < iterations; i++) {
+        for (int y = 0; y < s_pageHeight; y += tile.height()) {
+            for (int x = 0; x < width; x += tile.width()) {
+                double start = currentTimeMS();
+                paintTile(page, &reference, x, y);
+                referenceTime += currentTimeMS() - start;
+                start = currentTimeMS();
+                paintTile(page, &tile, x, y);
+                tileTime += currentTimeMS() - start;
+                maxError = std::max(maxError, compareTiles(reference, tile, &badPixels));
+                tiles++;
+            }
+        }
+    }
+    page->unref();
+
+    printf("%d tiles of %dx%d\n", tiles, tile.width(), tile.height());
+    printf("8888: %.1f us per tile, %u bytes\n",
+           referenceTime * 1000 / tiles, reference.getSize());
+    printf("565: %.1f us per tile, %u bytes\n",
+           tileTime * 1000 / tiles, tile.getSize());
+    printf("max channel error %d, %d pixels over %d\n",
+           maxError, badPixels, s_maxChannelError);
+    if (badPixels)
+        printf("FAILED\n");
+}
+
+} // namespace android
@@ -0,0 +1,338 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include "OperationQueue.h"
+#include "QueuedOperation.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <utils/Log.h>
+#include <wtf/CurrentTime.h>
+#include <wtf/Vector.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+using namespace WebCore;
+
+namespace android {
+
+// Replays a trace of tile paint queue operations against OperationQueue and
+// against the linear rescan the TexturesGenerator used to do, and checks
+// that both hand out operations in the same order.
+//
+// A trace is a text file with one event per line:
+//   f <scrolling> <goingDown>   starts a new GL frame
+//   s <page> <x> <y>            schedules a paint of tile (x, y), page 0
+//                               standing for layer tiles
+//   p                           pops the next operation
+//   r <page>                    removes the operations of a page
+//   b <page>                    a worker starts painting with the page's
+//                               painter: pops skip the page's operations
+//   e <page>                    that worker is done with the painter
+// Lines starting with '#' are ignored.
+
+struct TraceEvent {
+    char type;
+    int page;
+    int x;
+    int y;
+};
+
+static const int s_maxPages = 16;
+
+struct TraceState {
+    unsigned long long drawCount;
+    bool scrolling;
+    bool goingDown;
+    bool busyPages[s_maxPages];
+};
+
+static TraceState s_state;
+
+// Fake pages, only used as keys
+static TiledPage* tracePage(int page)
+{
+    return page ? reinterpret_cast<TiledPage*>(page * 16) : 0;
+}
+
+// Mimics PaintTileOperation::priority()
+class TraceOperation : public QueuedOperation {
+public:
+    TraceOperation(const TraceEvent& event, int id)
+        : QueuedOperation(QueuedOperation::PaintTile, tracePage(event.page))
+        , m_id(id)
+        , m_pageId(event.page)
+        , m_x(event.x)
+        , m_y(event.y)
+        , m_drawCount(s_state.drawCount) {}
+    virtual void run() {}
+    int id() const { return m_id; }
+    int pageId() const { return m_pageId; }
+    virtual bool operator==(const QueuedOperation* operation) { return operation == this; }
+    virtual int priority()
+    {
+        int priority = 200000;
+        // even pages stand for prefetch pages
+        if (m_pageId && !(m_pageId % 2))
+            priority = s_state.scrolling ? 0 : 400000;
+        unsigned long long drawDelta = s_state.drawCount - m_drawCount;
+        priority += 100000 * (int)std::min(drawDelta, (unsigned long long)1000);
+        if (m_pageId) {
+            priority += m_x;
+            if (s_state.goingDown)
+                priority += 100000 - (1 + m_y) * 1000;
+            else
+                priority += m_y * 1000;
+        }
+        return priority;
+    }
+private:
+    int m_id;
+    int m_pageId;
+    int m_x;
+    int m_y;
+    unsigned long long m_drawCount;
+};
+
+// Mimics the TexturesGenerator's WorkerFilter: the operations of a page
+// whose painter is busy are blocked by it
+class BusyPageFilter : public OperationFilter {
+public:
+    virtual bool check(QueuedOperation* operation) { return !blocker(operation); }
+    virtual const void* blocker(QueuedOperation* operation)
+    {
+        int page = static_cast<TraceOperation*>(operation)->pageId();
+        return page < s_maxPages && s_state.busyPages[page] ? tracePage(page) : 0;
+    }
+};
+
+// The queue as it used to be: priorities rescanned on each pop
+class LinearQueue {
+public:
+    void append(QueuedOperation* operation) { m_operations.append(operation); }
+    void reprioritize(unsigned long long) { }
+    QueuedOperation* popNext(OperationFilter* filter)
+    {
+        QueuedOperation* current = 0;
+        int currentPriority = 0;
+        int currentIndex = -1;
+        for (int i = m_operations.size() - 1; i >= 0; i--) {
+            if (!filter->check(m_operations[i]))
+                continue;
+            int nextPriority = m_operations[i]->priority();
+            if (!current || nextPriority <= currentPriority) {
+                current = m_operations[i];
+                currentPriority = nextPriority;
+                currentIndex = i;
+            }
+        }
+        if (current)
+            m_operations.remove(currentIndex);
+        return current;
+    }
+    void unblock(const void*) { }
+    void removeOperationsForFilter(OperationFilter* filter, Vector<QueuedOperation*>& removed)
+    {
+        for (unsigned i = 0; i < m_operations.size();) {
+            if (filter->check(m_operations[i])) {
+                removed.append(m_operations[i]);
+                m_operations.remove(i);
+            } else
+                i++;
+        }
+    }
+private:
+    Vector<QueuedOperation*> m_operations;
+};
+
+static bool loadTrace(const char* fileName, Vector<TraceEvent>& events)
+{
+    FILE* file = fopen(fileName, "r");
+    if (!file)
+        return false;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        TraceEvent event;
+        memset(&event, 0, sizeof(event));
+        event.type = line[0];
+        switch (event.type) {
+        case 'f':
+            sscanf(line + 1, "%d %d", &event.x, &event.y);
+            break;
+        case 's':
+            sscanf(line + 1, "%d %d %d", &event.page, &event.x, &event.y);
+            break;
+        case 'r':
+            sscanf(line + 1, "%d", &event.page);
+            break;
+        case 'b':
+        case 'e':
+            // layer tiles have no page to stand for their painter
+            sscanf(line + 1, "%d", &event.page);
+            if (event.page < 1 || event.page >= s_maxPages)
+                continue;
+            break;
+        case 'p':
+            break;
+        default:
+            continue;
+        }
+        events.append(event);
+    }
+    fclose(file);
+    return true;
+}
+
+// Flinging down a long page: every frame the viewport moves by a row of
+// tiles, the row entering the page and the prefetch page gets scheduled, and
+// the generator keeps up with only part of them. For the first half of each
+// frame, another worker is busy with the painter the pages share, leaving
+// only layer tiles to pop. Zooming every
+// 100 frames drops all the operations of the page.
+static void synthesizeTrace(Vector<TraceEvent>& events)
+{
+    const int frames = 2000;
+    const int columns = 5;
+    const int rows = 8;
+    for (int frame = 0; frame < frames; frame++) {
+        TraceEvent event = { 'f', 0, 1, 1 };
+        events.append(event);
+        for (int page = 1; page <= 2; page++) {
+            for (int y = frame ? frame + rows - 1 : 0; y < frame + rows; y++) {
+                for (int x = 0; x < columns; x++) {
+                    TraceEvent schedule = { 's', page, x, y };
+                    events.append(schedule);
+                }
+            }
+        }
+        for (int x = 0; x < columns; x++) {
+            TraceEvent schedule = { 's', 0, x, frame % rows };
+            events.append(schedule);
+        }
+        for (int page = 1; page <= 2; page++) {
+            TraceEvent busy = { 'b', page, 0, 0 };
+            events.append(busy);
+        }
+        for (int i = 0; i < 2 * columns; i++) {
+            for (int page = 1; page <= 2 && i == columns; page++) {
+                TraceEvent done = { 'e', page, 0, 0 };
+                events.append(done);
+            }
+            TraceEvent pop = { 'p', 0, 0, 0 };
+            events.append(pop);
+        }
+        if (frame % 100 == 99) {
+            TraceEvent remove = { 'r', 1, 0, 0 };
+            events.append(remove);
+        }
+    }
+}
+
+template<typename Queue>
+static double replay(const Vector<TraceEvent>& events, Queue& queue, Vector<int>& order)
+{
+    memset(&s_state, 0, sizeof(s_state));
+    Vector<QueuedOperation*> operations;
+    BusyPageFilter busyFilter;
+    double start = currentTimeMS();
+    for (unsigned i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        switch (event.type) {
+        case 'f':
+            s_state.drawCount++;
+            s_state.scrolling = event.x;
+            s_state.goingDown = event.y;
+            break;
+        case 's': {
+            QueuedOperation* operation = new TraceOperation(event, operations.size());
+            operations.append(operation);
+            queue.append(operation);
+            break;
+        }
+        case 'p': {
+            queue.reprioritize(s_state.drawCount);
+            QueuedOperation* operation = queue.popNext(&busyFilter);
+            order.append(operation ? static_cast<TraceOperation*>(operation)->id() : -1);
+            break;
+        }
+        case 'r': {
+            PageFilter filter(tracePage(event.page));
+            Vector<QueuedOperation*> removed;
+            queue.removeOperationsForFilter(&filter, removed);
+            break;
+        }
+        case 'b':
+            s_state.busyPages[event.page] = true;
+            break;
+        case 'e':
+            s_state.busyPages[event.page] = false;
+            queue.unblock(tracePage(event.page));
+            break;
+        }
+    }
+    double time = currentTimeMS() - start;
+    deleteAllValues(operations);
+    return time;
+}
+
+EXPORT void benchmarkOperationQueue(const char* traceFile, int iterations)
+{
+    Vector<TraceEvent> events;
+    if (!strcmp(traceFile, "synthetic"))
+        synthesizeTrace(events);
+    else if (!loadTrace(traceFile, events)) {
+        LOGE("Could not read trace %s", traceFile);
+        return;
+    }
+
+    double linearTime = 0;
+    double heapTime = 0;
+    Vector<int> linearOrder;
+    Vector<int> heapOrder;
+    for (int i = 0; i < iterations; i++) {
+        LinearQueue linearQueue;
+        OperationQueue heapQueue;
+        linearOrder.clear();
+        heapOrder.clear();
+        linearTime += replay(events, linearQueue, linearOrder);
+        heapTime += replay(events, heapQueue, heapOrder);
+    }
+
+    unsigned mismatches = 0;
+    for (unsigned i = 0; i < linearOrder.size() && i < heapOrder.size(); i++) {
+        if (linearOrder[i] != heapOrder[i])
+            mismatches++;
+    }
+
+    printf("%u events, %d iterations\n", events.size(), iterations);
+    printf("linear rescan: %.2f ms\n", linearTime / iterations);
+    printf("heap:          %.2f ms\n", heapTime / iterations);
+    printf("pop order mismatches: %u / %u\n", mismatches, linearOrder.size());
+}
+
+} // namespace android
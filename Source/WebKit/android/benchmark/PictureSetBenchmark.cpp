@@ -0,0 +1,127 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include "PictureSet.h"
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkPicture.h"
+#include "SkRegion.h"
+#include "TilesManager.h"
+#include <stdio.h>
+#include <wtf/CurrentTime.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+using namespace WebCore;
+
+namespace android {
+
+// Paints the tiles of synthetic long documents out of a PictureSet, to check
+// that the cost of a tile depends on the pictures it intersects and not on
+// the length of the document.
+//
+// Each document is a base picture covering the whole page, plus as many
+// invalidated paragraphs spread down the page as the set keeps before it
+// collapses them into the base. Pictures only fill their bounds, so that
+// the time measured is the PictureSet's own work for each tile.
+
+static const int s_documentHeights[] = { 5000, 20000, 80000 };
+static const int s_paragraphHeight = 100;
+static const int s_paragraphCount = 31;
+
+static SkPicture* recordPicture(const SkIRect& bounds)
+{
+    SkPicture* picture = new SkPicture();
+    SkCanvas* canvas = picture->beginRecording(bounds.width(), bounds.height());
+    canvas->drawColor(0xff000000 | (bounds.fTop * 2654435761u >> 8));
+    picture->endRecording();
+    return picture;
+}
+
+static void buildDocument(PictureSet* set, int width, int height)
+{
+    SkIRect bounds;
+    bounds.set(0, 0, width, height);
+    SkPicture* base = recordPicture(bounds);
+    PictureSet document(base);
+    base->unref();
+    int spacing = height / s_paragraphCount;
+    for (int i = 0; i < s_paragraphCount; i++) {
+        bounds.set(0, i * spacing + spacing / 2,
+                   width, i * spacing + spacing / 2 + s_paragraphHeight);
+        document.add(SkRegion(bounds), 0, 0, false);
+    }
+    // Record the invalidated pictures, as WebViewCore::rebuildPictureSet() does
+    for (size_t i = 0; i < document.size(); i++) {
+        if (!document.upToDate(i))
+            document.setPicture(i, recordPicture(document.bounds(i)));
+    }
+    set->set(document);
+}
+
+// Returns the time taken to paint every tile of the document, in ms
+static double paintTiles(PictureSet* set, SkBitmap* bitmap, int* tiles)
+{
+    int tileWidth = bitmap->width();
+    int tileHeight = bitmap->height();
+    double start = currentTimeMS();
+    for (int y = 0; y < set->height(); y += tileHeight) {
+        for (int x = 0; x < set->width(); x += tileWidth) {
+            SkCanvas canvas(*bitmap);
+            canvas.translate(-x, -y);
+            canvas.clipRect(SkRect::MakeLTRB(x, y, x + tileWidth, y + tileHeight));
+            set->draw(&canvas);
+            (*tiles)++;
+        }
+    }
+    return currentTimeMS() - start;
+}
+
+EXPORT void benchmarkPictureSet(int width, int iterations)
+{
+    SkBitmap bitmap;
+    bitmap.setConfig(SkBitmap::kARGB_8888_Config,
+                     TilesManager::tileWidth(), TilesManager::tileHeight());
+    bitmap.allocPixels();
+
+    printf("%d iterations, tiles of %dx%d\n", iterations,
+           bitmap.width(), bitmap.height());
+    for (size_t i = 0; i < sizeof(s_documentHeights) / sizeof(int); i++) {
+        PictureSet set;
+        buildDocument(&set, width, s_documentHeights[i]);
+        double time = 0;
+        int tiles = 0;
+        for (int j = 0; j < iterations; j++)
+            time += paintTiles(&set, &bitmap, &tiles);
+        printf("%dx%d, %u pictures: %.2f ms, %.1f us per tile\n",
+               width, s_documentHeights[i], set.size(), time / iterations,
+               tiles ? time * 1000 / tiles : 0);
+    }
+}
+
+} // namespace android
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+#include "TileBenchmark.h"
+
+#include "BaseLayerAndroid.h"
+#include "BaseTile.h"
+#include "RasterRenderer.h"
+#include "SkCanvas.h"
+#include "TextureInfo.h"
+#include "TilePainter.h"
+#include "TilesManager.h"
+#include "TimelineRecorder.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <wtf/CurrentTime.h>
+
+using namespace WebCore;
+
+namespace android {
+
+static const float s_zoomScales[] = { 2.0f, 0.5f, 1.0f };
+
+// Renders the tiles like the base tiles' RasterRenderer, but keeps them
+// instead of handing them over to the transfer queue
+class BenchmarkRenderer : public RasterRenderer {
+protected:
+    virtual void uploadBitmap(const TileRenderInfo&, const SkBitmap&) { }
+};
+
+// Paints the base content like a TiledPage, without the layers
+class ContentPainter : public TilePainter {
+public:
+    ContentPainter(BaseLayerAndroid* content) : m_content(content) { }
+    virtual bool paint(BaseTile*, SkCanvas* canvas, unsigned int* pictureUsed)
+    {
+        m_content->drawCanvas(canvas);
+        *pictureUsed = 0;
+        return true;
+    }
+private:
+    BaseLayerAndroid* m_content;
+};
+
+TileBenchmark::TileBenchmark(int viewportWidth, int viewportHeight)
+    : m_viewportWidth(viewportWidth)
+    , m_viewportHeight(viewportHeight)
+    , m_renderer(new BenchmarkRenderer())
+    , m_tile(new BaseTile())
+    , m_textureInfo(new TextureInfo(TilesManager::instance()->getSharedTextureMode()))
+    , m_paintedScale(0)
+{
+}
+
+TileBenchmark::~TileBenchmark()
+{
+    delete m_textureInfo;
+    delete m_tile;
+    delete m_renderer;
+}
+
+void TileBenchmark::run(BaseLayerAndroid* content, int contentWidth, int contentHeight,
+                        TileBenchmarkResult* result)
+{
+    m_painted.clear();
+    m_paintedScale = 0;
+
+    // fling down by quarter of viewports
+    int scrollY = 0;
+    int step = std::max(m_viewportHeight / 4, 1);
+    while (true) {
+        paintTiles(content, contentWidth, contentHeight, scrollY, 1.0f, result);
+        if (scrollY + m_viewportHeight >= contentHeight)
+            break;
+        scrollY += step;
+    }
+
+    // then zoom around the bottom of the page
+    for (unsigned i = 0; i < sizeof(s_zoomScales) / sizeof(s_zoomScales[0]); i++)
+        paintTiles(content, contentWidth, contentHeight, scrollY, s_zoomScales[i], result);
+}
+
+void TileBenchmark::paintTiles(BaseLayerAndroid* content, int contentWidth, int contentHeight,
+                               int scrollY, float scale, TileBenchmarkResult* result)
+{
+    const float tileWidth = TilesManager::tileWidth();
+    const float tileHeight = TilesManager::tileHeight();
+    const int columns = ceilf(contentWidth * scale / tileWidth);
+    const int rows = ceilf(contentHeight * scale / tileHeight);
+
+    // like swapping TiledPages, a new scale discards every tile
+    if (scale != m_paintedScale) {
+        m_painted.clear();
+        m_painted.fill(false, columns * rows);
+        m_paintedScale = scale;
+    }
+
+    const int firstRow = scrollY * scale / tileHeight;
+    const int lastRow = std::min(static_cast<int>(ceilf((scrollY * scale + m_viewportHeight) / tileHeight)),
+                                 rows);
+    const int lastColumn = std::min(static_cast<int>(ceilf(m_viewportWidth / tileWidth)), columns);
+
+    // What BaseTile::paintBitmap() hands the renderer for a full repaint
+    ContentPainter painter(content);
+    SkIRect rect;
+    rect.set(0, 0, tileWidth, tileHeight);
+    TileRenderInfo renderInfo;
+    renderInfo.scale = scale;
+    renderInfo.invalRect = &rect;
+    renderInfo.tileSize.set(tileWidth, tileHeight);
+    renderInfo.tilePainter = &painter;
+    renderInfo.baseTile = m_tile;
+    renderInfo.textureInfo = m_textureInfo;
+    renderInfo.measurePerf = false;
+
+    for (int y = firstRow; y < lastRow; y++) {
+        for (int x = 0; x < lastColumn; x++) {
+            if (m_painted[y * columns + x])
+                continue;
+            m_painted[y * columns + x] = true;
+
+            TimelineScope paintScope(TimelineRecorder::TilePaint, x, y);
+            double start = currentTimeMS();
+            renderInfo.x = x;
+            renderInfo.y = y;
+            m_renderer->renderTiledContent(renderInfo);
+            result->time += currentTimeMS() - start;
+            result->tiles++;
+        }
+    }
+}
+
+int peakMemoryKB()
+{
+    FILE* file = fopen("/proc/self/status", "r");
+    if (!file)
+        return -1;
+    int peak = -1;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        if (!strncmp(line, "VmHWM:", 6)) {
+            sscanf(line + 6, "%d", &peak);
+            break;
+        }
+    }
+    fclose(file);
+    return peak;
+}
+
+} // namespace android
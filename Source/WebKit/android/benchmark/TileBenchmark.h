@@ -0,0 +1,78 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TileBenchmark_h
+#define TileBenchmark_h
+
+#include <wtf/Vector.h>
+
+namespace WebCore {
+class BaseLayerAndroid;
+class BaseTile;
+class TextureInfo;
+}
+
+namespace android {
+
+struct TileBenchmarkResult {
+    TileBenchmarkResult() : tiles(0), time(0) {}
+    int tiles;
+    double time; // in ms
+};
+
+class BenchmarkRenderer;
+
+// Rasterizes the tiles a TiledPage would need while scrolling recorded
+// content from top to bottom, then zooming in and out, with the
+// RasterRenderer of the base tiles. The tiles are not uploaded.
+class TileBenchmark {
+public:
+    TileBenchmark(int viewportWidth, int viewportHeight);
+    ~TileBenchmark();
+
+    void run(WebCore::BaseLayerAndroid* content, int contentWidth, int contentHeight,
+             TileBenchmarkResult* result);
+
+private:
+    void paintTiles(WebCore::BaseLayerAndroid* content, int contentWidth, int contentHeight,
+                    int scrollY, float scale, TileBenchmarkResult* result);
+
+    int m_viewportWidth;
+    int m_viewportHeight;
+    BenchmarkRenderer* m_renderer;
+    // the base tile and texture the tiles are rendered for
+    WebCore::BaseTile* m_tile;
+    WebCore::TextureInfo* m_textureInfo;
+    // tiles already painted at m_paintedScale, indexed by y * columns + x
+    WTF::Vector<bool> m_painted;
+    float m_paintedScale;
+};
+
+// Peak resident memory of the process, in KB, or -1 if unknown
+int peakMemoryKB();
+
+} // namespace android
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2012, The Android Open Source Project
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "webcore_test"
+#include "config.h"
+
+#include "TransferRing.h"
+#include <cutils/atomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <utils/threads.h>
+#include <wtf/CurrentTime.h>
+
+#define EXPORT __attribute__((visibility("default")))
+
+using namespace WebCore;
+
+namespace android {
+
+// Hammers the TransferRing the way the TransferQueue uses it, without GL:
+// producer threads serialized by a lock publish sequence numbers, while the
+// consumer drains the ring, and every now and then discards it, goes away
+// as when the GL context is lost, or interrupts the producers.
+//
+// The consumer must see the sequence numbers in increasing order, and every
+// item published must eventually be either consumed or discarded.
+
+static const int s_ringSize = 10; // ST_BUFFER_NUMBER
+static const int s_producerCount = 2;
+static const int s_itemsPerIteration = 100000;
+// Copied into the slot, as the producer copies the tile's bitmap
+static const int s_tileBytes = 16 * 1024;
+
+class RingStress {
+public:
+    RingStress(int items)
+        : m_ring(s_ringSize)
+        , m_items(items)
+        , m_sequence(0)
+        , m_producersDone(0)
+        , m_published(0)
+        , m_rejected(0)
+        , m_blitted(0)
+        , m_discarded(0)
+        , m_outOfOrder(0)
+        , m_publishedAfterDiscard(0)
+        , m_lastSeen(0)
+    {
+        memset(m_payload, 0, sizeof(m_payload));
+        memset(m_bitmap, 0, sizeof(m_bitmap));
+    }
+
+    // Mirrors TransferQueue::tryUpdateQueueWithBitmap()
+    bool produce()
+    {
+        Mutex::Autolock lock(m_producerLock);
+        if (m_sequence >= m_items)
+            return false;
+        if (!m_ring.acquireSlot()) {
+            m_rejected++;
+            return true;
+        }
+        memcpy(m_tile, m_bitmap, s_tileBytes);
+        // Sometimes the copy is slow, or the producer is preempted
+        if (!(rand() % 16))
+            usleep(rand() % 50);
+        m_payload[m_ring.writeIndex()] = ++m_sequence;
+        m_ring.publishSlot();
+        m_published++;
+        return true;
+    }
+
+    // Mirrors TransferQueue::updateDirtyBaseTiles()
+    void consume()
+    {
+        m_ring.setConsumerAvailable(true);
+        for (int k = 0; k < s_ringSize; k++) {
+            int index = m_ring.oldestSlot();
+            if (index < 0)
+                break;
+            int sequence = m_payload[index];
+            if (sequence <= m_lastSeen)
+                m_outOfOrder++;
+            m_lastSeen = sequence;
+            if (m_ring.status(index) == pendingDiscard)
+                m_discarded++;
+            else
+                m_blitted++;
+            m_payload[index] = 0;
+            m_ring.releaseSlot();
+        }
+    }
+
+    void disturb()
+    {
+        switch (rand() % 64) {
+        case 0:
+            // TransferQueue::discardQueue()
+            m_ring.setConsumerAvailable(false);
+            {
+                Mutex::Autolock lock(m_producerLock);
+                m_ring.discardPendingSlots();
+            }
+            // The tiles are deleted now. Until the consumer comes back,
+            // nothing may be published that still points to them.
+            usleep(20);
+            for (int i = 0; i < s_ringSize; i++) {
+                if (m_ring.status(i) == pendingBlit)
+                    m_publishedAfterDiscard++;
+            }
+            break;
+        case 1:
+            m_ring.setInterrupted(true);
+            usleep(10);
+            m_ring.setInterrupted(false);
+            break;
+        default:
+            break;
+        }
+    }
+
+    TransferRing m_ring;
+    Mutex m_producerLock;
+    int m_payload[s_ringSize];
+    char m_bitmap[s_tileBytes];
+    char m_tile[s_tileBytes];
+    int m_items;
+    int m_sequence;
+    volatile int32_t m_producersDone;
+    int m_published;
+    int m_rejected;
+    int m_blitted;
+    int m_discarded;
+    int m_outOfOrder;
+    int m_publishedAfterDiscard;
+    int m_lastSeen;
+};
+
+class ProducerThread : public Thread {
+public:
+    ProducerThread(RingStress* stress) : Thread(false), m_stress(stress) {}
+private:
+    virtual bool threadLoop()
+    {
+        if (m_stress->produce())
+            return true;
+        android_atomic_inc(&m_stress->m_producersDone);
+        return false;
+    }
+    RingStress* m_stress;
+};
+
+static void runStress(int items)
+{
+    RingStress stress(items);
+    sp<ProducerThread> producers[s_producerCount];
+    for (int i = 0; i < s_producerCount; i++) {
+        producers[i] = new ProducerThread(&stress);
+        producers[i]->run("TransferRingProducer");
+    }
+
+    // The main thread plays the UI thread
+    double start = currentTime();
+    int draws = 0;
+    while (android_atomic_acquire_load(&stress.m_producersDone) < s_producerCount) {
+        // Let the producers fill the ring between two draws
+        usleep(rand() % 100);
+        stress.consume();
+        // Right after a draw, when the producers are busy filling slots
+        stress.disturb();
+        draws++;
+    }
+    for (int i = 0; i < s_producerCount; i++)
+        producers[i]->join();
+    stress.consume();
+    double elapsed = currentTime() - start;
+
+    int lost = stress.m_published - stress.m_blitted - stress.m_discarded;
+    printf("%d items, %d draws in %.2f ms: %d published, %d rejected, "
+           "%d blitted, %d discarded, %d lost, %d out of order, "
+           "%d published after a discard\n",
+           items, draws, elapsed * 1000, stress.m_published, stress.m_rejected,
+           stress.m_blitted, stress.m_discarded, lost, stress.m_outOfOrder,
+           stress.m_publishedAfterDiscard);
+    if (lost || stress.m_outOfOrder || stress.m_publishedAfterDiscard)
+        printf("FAILED\n");
+}
+
+EXPORT void stressTransferRing(int iterations)
+{
+    for (int i = 0; i < iterations; i++)
+        runStress(s_itemsPerIteration);
+}
+
+} // namespace android
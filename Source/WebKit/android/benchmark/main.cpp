@@ -32,14 +32,34 @@
 
 namespace android {
 extern void benchmark(const char*, int, int ,int);
+extern void benchmarkOperationQueue(const char*, int);
+extern void benchmarkPictureSet(int, int);
+extern void benchmarkTiles(const char**, int, int, int, const char*);
+extern void checkOpaque565Tiles(int, int);
+extern void stressTransferRing(int);
+extern void stressAtomicStrings(int);
+extern void startTimeline();
+extern bool exportTimeline(const char*);
+extern void configureMalloc(int, float);
+extern bool dumpMallocStatistics(const char*);
 }
 
 int main(int argc, char** argv) {
     int width = 800;
     int height = 600;
     int reloadCount = 0;
+    const char* queueTrace = 0;
+    const char* jsonFile = 0;
+    const char* traceFile = 0;
+    const char* mallocFile = 0;
+    int mallocSampleInterval = 0;
+    float scavengeAggressiveness = 1;
+    bool pictureSet = false;
+    bool transferRing = false;
+    bool atomicStrings = false;
+    bool opaque565Tiles = false;
     while (true) {
-        int c = getopt(argc, argv, "d:r:");
+        int c = getopt(argc, argv, "d:r:q:j:o:m:s:a:ptuc");
         if (c == -1)
             break;
         else if (c == 'd') {
@@ -54,12 +74,75 @@ int main(int argc, char** argv) {
             if (reloadCount < 0)
                 reloadCount = 0;
             LOGD("Reloading %d times", reloadCount);
+        } else if (c == 'q') {
+            queueTrace = optarg;
+        } else if (c == 'j') {
+            jsonFile = optarg;
+        } else if (c == 'o') {
+            traceFile = optarg;
+        } else if (c == 'm') {
+            mallocFile = optarg;
+        } else if (c == 's') {
+            mallocSampleInterval = atoi(optarg);
+        } else if (c == 'a') {
+            scavengeAggressiveness = atof(optarg);
+        } else if (c == 'p') {
+            pictureSet = true;
+        } else if (c == 't') {
+            transferRing = true;
+        } else if (c == 'u') {
+            atomicStrings = true;
+        } else if (c == 'c') {
+            opaque565Tiles = true;
         }
     }
-    if (optind >= argc) {
+    if (!queueTrace && !pictureSet && !transferRing && !atomicStrings && !opaque565Tiles && optind >= argc) {
         LOGE("Please supply a file to read\n");
         return 1;
     }
 
-    android::benchmark(argv[optind], reloadCount, width, height);
+    // Sample the allocation sites every -s bytes, and scale how eagerly
+    // free pages are given back to the system by -a
+    android::configureMalloc(mallocSampleInterval, scavengeAggressiveness);
+
+    if (traceFile) {
+        // Record the timeline of the run, to be loaded in chrome://tracing
+        android::startTimeline();
+    }
+
+    if (queueTrace) {
+        // Replay a tile paint queue trace (or "synthetic") instead of
+        // loading a page
+        android::benchmarkOperationQueue(queueTrace, reloadCount ? reloadCount : 10);
+    } else if (pictureSet) {
+        // Paint the tiles of synthetic long documents out of a PictureSet
+        android::benchmarkPictureSet(width, reloadCount ? reloadCount : 10);
+    } else if (transferRing) {
+        // Hand items over through the tile transfer ring from several
+        // threads, discarding and interrupting it along the way
+        android::stressTransferRing(reloadCount ? reloadCount : 10);
+    } else if (atomicStrings) {
+        // Make, find and drop atoms from several threads at once through
+        // the shared AtomicString table
+        android::stressAtomicStrings(reloadCount ? reloadCount : 10);
+    } else if (opaque565Tiles) {
+        // Compare the opaque 565 tiles with the 8888 ones
+        android::checkOpaque565Tiles(width, reloadCount ? reloadCount : 1);
+    } else if (jsonFile) {
+        // Time every phase of each page given, up to the rasterization of
+        // its tiles, and write the results as JSON ("-" for stdout)
+        android::benchmarkTiles(const_cast<const char**>(argv + optind), argc - optind,
+                                width, height, jsonFile);
+    } else
+        android::benchmark(argv[optind], reloadCount, width, height);
+
+    if (traceFile && !android::exportTimeline(traceFile)) {
+        LOGE("Could not write the timeline to %s", traceFile);
+        return 1;
+    }
+    if (mallocFile && !android::dumpMallocStatistics(mallocFile)) {
+        LOGE("Could not write the malloc statistics to %s", mallocFile);
+        return 1;
+    }
+    return 0;
 }
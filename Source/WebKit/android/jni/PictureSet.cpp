@@ -38,6 +38,8 @@
 #include "SkStream.h"
 #include "TimeCounter.h"
 
+#include <algorithm>
+
 #define MAX_DRAW_TIME 100
 #define MIN_SPLITTABLE 400
 #define MAX_ADDITIONAL_AREA 0.65
@@ -47,6 +49,8 @@
 #define MAX_BUCKET_COUNT_X 16
 #define MAX_BUCKET_COUNT_Y 64
 
+#define INDEX_CELL_SIZE 512
+
 #include <wtf/CurrentTime.h>
 
 #include <cutils/log.h>
@@ -85,6 +89,8 @@ PictureSet::PictureSet() :
 #ifdef FAST_PICTURESET
     mBucketSizeX(BUCKET_SIZE), mBucketSizeY(BUCKET_SIZE),
     mBucketCountX(0), mBucketCountY(0),
+#else
+    mIndexCountX(0), mIndexCountY(0),
 #endif
     mHeight(0), mWidth(0)
 {
@@ -96,6 +102,8 @@ PictureSet::PictureSet(SkPicture* picture) :
 #ifdef FAST_PICTURESET
     mBucketSizeX(BUCKET_SIZE), mBucketSizeY(BUCKET_SIZE),
     mBucketCountX(0), mBucketCountY(0),
+#else
+    mIndexCountX(0), mIndexCountY(0),
 #endif
     mHeight(0), mWidth(0)
 {
@@ -139,6 +147,7 @@ PictureSet::PictureSet(SkPicture* picture) :
     pictureAndBounds.mElapsed = 0;
     pictureAndBounds.mWroteElapsed = false;
     mPictures.append(pictureAndBounds);
+    buildIndex();
 #endif // FAST_PICTURESET
 }
 
@@ -607,6 +616,8 @@ void PictureSet::add(const SkRegion& area, SkPicture* picture,
             drawn.op(working->mArea, SkRegion::kUnion_Op);
         }
     }
+
+    buildIndex();
 }
 #endif // FAST_PICTURESET
 
@@ -663,6 +674,8 @@ void PictureSet::setDimensions(int width, int height, SkRegion* inval)
     mBucketSizeY = bucketSizeY;
     mBucketCountX = bucketCountX;
     mBucketCountY = bucketCountY;
+#else
+    buildIndex();
 #endif
 }
 
@@ -691,6 +704,10 @@ void PictureSet::clear()
     mPictures.clear();
 #endif // FAST_PICTURESET
     mWidth = mHeight = 0;
+#ifdef FAST_PICTURESET
+#else
+    buildIndex();
+#endif
 }
 
 bool PictureSet::draw(SkCanvas* canvas)
@@ -737,16 +754,20 @@ bool PictureSet::draw(SkCanvas* canvas)
 #else
 
     validate(__FUNCTION__);
-    Pictures* first = mPictures.begin();
-    Pictures* last = mPictures.end();
-    Pictures* working;
     SkRect bounds;
     if (canvas->getClipBounds(&bounds) == false)
         return false;
     SkIRect irect;
     bounds.roundOut(&irect);
-    for (working = last; working != first; ) {
-        --working;
+    // Only the pictures intersecting the clip can draw anything; the others
+    // are left alone (including their draw times)
+    WTF::Vector<size_t> list;
+    gatherPicturesForArea(list, irect);
+    size_t first = 0;
+    size_t last = list.size();
+    Pictures* working;
+    for (size_t index = last; index != first; ) {
+        working = &mPictures[list[--index]];
         if (working->mArea.contains(irect)) {
 #if PICTURE_SET_DEBUG
             const SkIRect& b = working->mArea.getBounds();
@@ -754,20 +775,21 @@ bool PictureSet::draw(SkCanvas* canvas)
                 " irect={%d,%d,%d,%d}", b.fLeft, b.fTop, b.fRight, b.fBottom,
                 irect.fLeft, irect.fTop, irect.fRight, irect.fBottom);
 #endif
-            first = working;
+            first = index;
             break;
         }
     }
-    DBG_SET_LOGD("%p first=%d last=%d", this, first - mPictures.begin(),
-        last - mPictures.begin());
+    DBG_SET_LOGD("%p first=%d last=%d (%d pictures)", this, first, last,
+        mPictures.size());
     uint32_t maxElapsed = 0;
-    for (working = first; working != last; working++) {
+    for (size_t index = first; index != last; index++) {
+        working = &mPictures[list[index]];
         const SkRegion& area = working->mArea;
         if (area.quickReject(irect)) {
 #if PICTURE_SET_DEBUG
             const SkIRect& b = area.getBounds();
             DBG_SET_LOGD("[%d] %p quickReject working->mArea={%d,%d,%d,%d}"
-                " irect={%d,%d,%d,%d}", working - first, working,
+                " irect={%d,%d,%d,%d}", list[index], working,
                 b.fLeft, b.fTop, b.fRight, b.fBottom,
                 irect.fLeft, irect.fTop, irect.fRight, irect.fBottom);
 #endif
@@ -813,7 +835,7 @@ bool PictureSet::draw(SkCanvas* canvas)
         }
 #endif
         DBG_SET_LOGD("[%d] %p working->mArea={%d,%d,%d,%d} elapsed=%d base=%s",
-            working - first, working,
+            list[index], working,
             area.getBounds().fLeft, area.getBounds().fTop,
             area.getBounds().fRight, area.getBounds().fBottom,
             working->mElapsed, working->mBase ? "true" : "false");
@@ -1007,6 +1029,7 @@ void PictureSet::set(const PictureSet& src)
     const Pictures* last = src.mPictures.end();
     for (const Pictures* working = src.mPictures.begin(); working != last; working++)
         add(working);
+    buildIndex();
  //   dump(__FUNCTION__);
     validate(__FUNCTION__);
     DBG_SET_LOG("end");
@@ -1016,6 +1039,77 @@ void PictureSet::set(const PictureSet& src)
 #ifdef FAST_PICTURESET
 #else
 
+void PictureSet::buildIndex()
+{
+    mIndexCountX = std::max(1, (mWidth + INDEX_CELL_SIZE - 1) / INDEX_CELL_SIZE);
+    mIndexCountY = std::max(1, (mHeight + INDEX_CELL_SIZE - 1) / INDEX_CELL_SIZE);
+    mIndexCells.fill(0, mIndexCountX * mIndexCountY + 1);
+    int left, top, right, bottom;
+    // count the pictures of each cell, then turn the counts into offsets
+    for (size_t i = 0; i < mPictures.size(); i++) {
+        if (!indexCells(mPictures[i].mArea.getBounds(), &left, &top, &right, &bottom))
+            continue;
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++)
+                mIndexCells[y * mIndexCountX + x + 1]++;
+        }
+    }
+    for (size_t cell = 1; cell < mIndexCells.size(); cell++)
+        mIndexCells[cell] += mIndexCells[cell - 1];
+    WTF::Vector<unsigned> next(mIndexCells);
+    mIndexPictures.resize(mIndexCells.last());
+    for (size_t i = 0; i < mPictures.size(); i++) {
+        if (!indexCells(mPictures[i].mArea.getBounds(), &left, &top, &right, &bottom))
+            continue;
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++)
+                mIndexPictures[next[y * mIndexCountX + x]++] = i;
+        }
+    }
+    DBG_SET_LOGD("%p %d pictures in %dx%d cells, %d entries", this,
+        mPictures.size(), mIndexCountX, mIndexCountY, mIndexPictures.size());
+}
+
+// Returns the range of cells covered by rect, clamped to the grid (content
+// may extend past mWidth/mHeight), or false if rect is empty. There is no
+// grid before the set is first changed.
+bool PictureSet::indexCells(const SkIRect& rect, int* left, int* top,
+    int* right, int* bottom) const
+{
+    if (rect.isEmpty() || !mIndexCountX)
+        return false;
+    *left = std::min(std::max(rect.fLeft / INDEX_CELL_SIZE, 0), mIndexCountX - 1);
+    *top = std::min(std::max(rect.fTop / INDEX_CELL_SIZE, 0), mIndexCountY - 1);
+    *right = std::min(std::max((rect.fRight - 1) / INDEX_CELL_SIZE, 0), mIndexCountX - 1);
+    *bottom = std::min(std::max((rect.fBottom - 1) / INDEX_CELL_SIZE, 0), mIndexCountY - 1);
+    return true;
+}
+
+// Collects the indices of the pictures whose bounds intersect rect, in
+// drawing order. Only reads the index, which the mutators keep up to date.
+void PictureSet::gatherPicturesForArea(WTF::Vector<size_t>& list,
+    const SkIRect& rect) const
+{
+    int left, top, right, bottom;
+    if (!indexCells(rect, &left, &top, &right, &bottom))
+        return;
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            int cell = y * mIndexCountX + x;
+            for (unsigned i = mIndexCells[cell]; i < mIndexCells[cell + 1]; i++) {
+                unsigned picture = mIndexPictures[i];
+                if (SkIRect::Intersects(mPictures[picture].mArea.getBounds(), rect))
+                    list.append(picture);
+            }
+        }
+    }
+    // a single cell is already sorted, and lists each picture once
+    if (left == right && top == bottom)
+        return;
+    std::sort(list.begin(), list.end());
+    list.shrink(std::unique(list.begin(), list.end()) - list.begin());
+}
+
 bool PictureSet::reuseSubdivided(const SkRegion& inval)
 {
     validate(__FUNCTION__);
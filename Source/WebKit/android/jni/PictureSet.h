@@ -89,6 +89,8 @@ namespace android {
         // Update mWidth/mHeight, and adds any additional inval region
         void setDimensions(int width, int height, SkRegion* inval = 0);
         void clear();
+        // Records the time each picture took to draw (see split()), so
+        // the same set must not be drawn by two threads at once
         bool draw(SkCanvas* );
         static PictureSet* GetNativePictureSet(JNIEnv* env, jobject jpic);
         int height() const { return mHeight; }
@@ -133,7 +135,20 @@ namespace android {
             bool mEmpty : 8; // true if the picture only draws white
         };
         void add(const Pictures* temp);
+        void buildIndex();
+        bool indexCells(const SkIRect& rect, int* left, int* top,
+            int* right, int* bottom) const;
+        void gatherPicturesForArea(WTF::Vector<size_t>& list,
+            const SkIRect& rect) const;
         WTF::Vector<Pictures> mPictures;
+        // Uniform grid over the bounds of mPictures, rebuilt by every method
+        // changing the pictures' areas. Cell i lists the pictures it
+        // intersects, in drawing order, in
+        // mIndexPictures[mIndexCells[i]..mIndexCells[i+1]).
+        WTF::Vector<unsigned> mIndexCells;
+        WTF::Vector<unsigned> mIndexPictures;
+        int mIndexCountX;
+        int mIndexCountY;
 #endif
         float mBaseArea;
         float mAdditionalArea;
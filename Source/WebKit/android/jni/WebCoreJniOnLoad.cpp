@@ -28,11 +28,13 @@
 #include "config.h"
 
 #include "BackForwardList.h"
+#include "BaseLayerAndroid.h"
 #include "ChromeClientAndroid.h"
 #include "ContextMenuClientAndroid.h"
 #include "CookieClient.h"
 #include "DeviceMotionClientAndroid.h"
 #include "DeviceOrientationClientAndroid.h"
+#include "Document.h"
 #include "DragClientAndroid.h"
 #include "EditorClientAndroid.h"
 #include "FocusController.h"
@@ -47,6 +49,7 @@
 #include "JavaSharedClient.h"
 #include "Page.h"
 #include "PlatformGraphicsContext.h"
+#include "RenderView.h"
 #include "ResourceRequest.h"
 #include "ScriptController.h"
 #include "SecurityOrigin.h"
@@ -57,6 +60,7 @@
 #include "SkCanvas.h"
 #include "SkImageEncoder.h"
 #include "SubstituteData.h"
+#include "TimelineRecorder.h"
 #include "TimerClient.h"
 #include "TextEncoding.h"
 #include "WebCoreViewBridge.h"
@@ -64,10 +68,14 @@
 #include "WebViewCore.h"
 #include "benchmark/Intercept.h"
 #include "benchmark/MyJavaVM.h"
+#include "benchmark/TileBenchmark.h"
 
 #include <JNIUtility.h>
 #include <jni.h>
+#include <stdio.h>
+#include <string.h>
 #include <utils/Log.h>
+#include <wtf/CurrentTime.h>
 
 #define EXPORT __attribute__((visibility("default")))
 
@@ -187,7 +195,12 @@ static void historyItemChanged(HistoryItem* i) {
 
 namespace android {
 
-EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+static MyJavaSharedClient* initializeBenchmark()
+{
+    static MyJavaSharedClient* client = 0;
+    if (client)
+        return client;
+
     ScriptController::initializeThreading();
 
     // Setting this allows data: urls to load from a local file.
@@ -200,10 +213,20 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     notifyHistoryItemChanged = historyItemChanged;
 
     // Implement the shared timer callback
-    MyJavaSharedClient client;
-    JavaSharedClient::SetTimerClient(&client);
-    JavaSharedClient::SetCookieClient(&client);
+    client = new MyJavaSharedClient;
+    JavaSharedClient::SetTimerClient(client);
+    JavaSharedClient::SetCookieClient(client);
+    return client;
+}
+
+struct BenchmarkPage {
+    WebCore::Page* page;
+    RefPtr<Frame> frame;
+    WebViewCore* webViewCore;
+};
 
+static void createBenchmarkPage(BenchmarkPage* benchmarkPage, int width, int height)
+{
     // Create the page with all the various clients
     ChromeClientAndroid* chrome = new ChromeClientAndroid;
     EditorClientAndroid* editor = new EditorClientAndroid;
@@ -277,23 +300,49 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     s->setUseWideViewport(false);
 #endif
 
+    benchmarkPage->page = page;
+    benchmarkPage->frame = frame;
+    benchmarkPage->webViewCore = webViewCore;
+}
+
+static void destroyBenchmarkPage(BenchmarkPage* benchmarkPage)
+{
+    // Tear down the world.
+    benchmarkPage->frame->loader()->detachFromParent();
+    benchmarkPage->frame = 0;
+    delete benchmarkPage->page;
+    benchmarkPage->page = 0;
+}
+
+// Layout the page and service the timers until there is nothing left to do
+static void runUntilIdle(Frame* frame, MyJavaSharedClient* client)
+{
+    frame->view()->layout();
+    while (client->m_hasTimer) {
+        client->m_func();
+        JavaSharedClient::ServiceFunctionPtrQueue();
+    }
+    JavaSharedClient::ServiceFunctionPtrQueue();
+
+    // Layout more if needed.
+    while (frame->view()->needsLayout())
+        frame->view()->layout();
+    JavaSharedClient::ServiceFunctionPtrQueue();
+}
+
+EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
+    MyJavaSharedClient* client = initializeBenchmark();
+
+    BenchmarkPage benchmarkPage;
+    createBenchmarkPage(&benchmarkPage, width, height);
+    Frame* frame = benchmarkPage.frame.get();
+
     // Finally, load the actual data
     ResourceRequest req(url);
     frame->loader()->load(req, false);
 
     do {
-        // Layout the page and service the timer
-        frame->view()->layout();
-        while (client.m_hasTimer) {
-            client.m_func();
-            JavaSharedClient::ServiceFunctionPtrQueue();
-        }
-        JavaSharedClient::ServiceFunctionPtrQueue();
-
-        // Layout more if needed.
-        while (frame->view()->needsLayout())
-            frame->view()->layout();
-        JavaSharedClient::ServiceFunctionPtrQueue();
+        runUntilIdle(frame, client);
 
         if (reloadCount)
             frame->loader()->reload(true);
@@ -313,9 +362,95 @@ EXPORT void benchmark(const char* url, int reloadCount, int width, int height) {
     enc->encodeFile("/sdcard/webcore_test.png", bmp, 100);
     delete enc;
 
-    // Tear down the world.
-    frame->loader()->detachFromParent();
-    delete page;
+    destroyBenchmarkPage(&benchmarkPage);
+}
+
+// Loads each page of the corpus, then measures the time spent recomputing
+// its style and layout, recording its content the way WebViewCore does for
+// the UI thread, and rasterizing the tiles of a scroll and zoom trace over
+// it in software. The results are written as JSON to jsonFile ("-" for the
+// standard output).
+EXPORT void benchmarkTiles(const char** urls, int urlCount, int width, int height,
+                           const char* jsonFile)
+{
+    MyJavaSharedClient* client = initializeBenchmark();
+
+    FILE* file = strcmp(jsonFile, "-") ? fopen(jsonFile, "w") : stdout;
+    if (!file) {
+        LOGE("Could not open %s", jsonFile);
+        return;
+    }
+
+    fprintf(file, "{\n  \"viewport\": { \"width\": %d, \"height\": %d },\n", width, height);
+    fprintf(file, "  \"pages\": [");
+    TileBenchmark tileBenchmark(width, height);
+    for (int i = 0; i < urlCount; i++) {
+        BenchmarkPage benchmarkPage;
+        createBenchmarkPage(&benchmarkPage, width, height);
+        Frame* frame = benchmarkPage.frame.get();
+
+        // parsing is interleaved with loading, and the style and layout it
+        // triggers: the parse phase covers all of them
+        double start = currentTimeMS();
+        frame->loader()->load(ResourceRequest(urls[i]), false);
+        runUntilIdle(frame, client);
+        double parseTime = currentTimeMS() - start;
+
+        start = currentTimeMS();
+        frame->document()->recalcStyle(Node::Force);
+        double styleTime = currentTimeMS() - start;
+
+        start = currentTimeMS();
+        frame->contentRenderer()->setNeedsLayoutAndPrefWidthsRecalc();
+        frame->view()->forceLayout();
+        double layoutTime = currentTimeMS() - start;
+
+        start = currentTimeMS();
+        SkRegion region;
+        SkIPoint contentSize;
+        contentSize.set(0, 0);
+        benchmarkPage.webViewCore->contentInvalidateAll();
+        BaseLayerAndroid* baseLayer = benchmarkPage.webViewCore->recordContent(&region, &contentSize);
+        double recordTime = currentTimeMS() - start;
+
+        TileBenchmarkResult raster;
+        if (baseLayer) {
+            tileBenchmark.run(baseLayer, contentSize.fX, contentSize.fY, &raster);
+            SkSafeUnref(baseLayer);
+        } else
+            LOGE("Could not record %s, its content is reported empty", urls[i]);
+
+        fprintf(file, "%s\n    {\n      \"url\": ", i ? "," : "");
+        TimelineRecorder::writeJSONString(file, urls[i]);
+        fprintf(file, ",\n      \"content\": { \"width\": %d, \"height\": %d },\n",
+                contentSize.fX, contentSize.fY);
+        fprintf(file, "      \"timings\": { \"parse\": %.2f, \"style\": %.2f, \"layout\": %.2f,"
+                " \"record\": %.2f, \"raster\": %.2f },\n",
+                parseTime, styleTime, layoutTime, recordTime, raster.time);
+        fprintf(file, "      \"tiles\": %d,\n      \"peakMemoryKB\": %d\n    }",
+                raster.tiles, peakMemoryKB());
+
+        destroyBenchmarkPage(&benchmarkPage);
+    }
+    fprintf(file, "\n  ],\n  \"peakMemoryKB\": %d\n}\n", peakMemoryKB());
+
+    if (file != stdout)
+        fclose(file);
+}
+
+// Records the timeline of whatever runs until exportTimeline()
+EXPORT void startTimeline()
+{
+    TimelineRecorder::clear();
+    TimelineRecorder::setEnabled(true);
+}
+
+// Writes the timeline recorded since startTimeline() as Chrome trace event
+// JSON, to be loaded in chrome://tracing
+EXPORT bool exportTimeline(const char* traceFile)
+{
+    TimelineRecorder::setEnabled(false);
+    return TimelineRecorder::exportChromeTrace(traceFile);
 }
 
 }  // namespace android
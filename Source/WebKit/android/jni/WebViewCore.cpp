@@ -115,6 +115,7 @@
 #include "SkPicture.h"
 #include "SkUtils.h"
 #include "Text.h"
+#include "TimelineRecorder.h"
 #include "TypingCommand.h"
 #include "WebCache.h"
 #include "WebCoreFrameBridge.h"
@@ -946,6 +947,7 @@ BaseLayerAndroid* WebViewCore::createBaseLayer(SkRegion* region)
 BaseLayerAndroid* WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
 {
     DBG_SET_LOG("start");
+    TimelineScope recordScope(TimelineRecorder::RecordContent);
     // If there is a pending style recalculation, just return.
     if (m_mainFrame->document()->isPendingStyleRecalc()) {
         DBG_SET_LOGD("recordContent: pending style recalc, ignoring.");
@@ -977,6 +979,7 @@ BaseLayerAndroid* WebViewCore::recordContent(SkRegion* region, SkIPoint* point)
 
 void WebViewCore::splitContent(PictureSet* content)
 {
+    TimelineScope splitScope(TimelineRecorder::SplitContent);
 #ifdef FAST_PICTURESET
 #else
     bool layoutSucceeded = layoutIfNeededRecursive(m_mainFrame);
@@ -1445,6 +1448,11 @@ void WebViewCore::dumpRenderTree(bool useFile)
 
 void WebViewCore::dumpNavTree()
 {
+    const CacheBuilder::BuildStats& stats = cacheBuilder().totalBuildStats();
+    LOGD("nav cache: %d builds (%d full), built %d frames (%d nodes),"
+        " reused %d frames (%d nodes), %d ms", stats.mBuilds,
+        stats.mFullRebuilds, stats.mBuiltFrames, stats.mBuiltNodes,
+        stats.mReusedFrames, stats.mReusedNodes, stats.mElapsed);
 #if DUMP_NAV_CACHE
     cacheBuilder().mDebug.print();
 #endif
@@ -1634,6 +1642,13 @@ void WebViewCore::updateFrameCache()
     }
 #endif
     builder.buildCache(m_temp);
+#if DEBUG_NAV_UI
+    const CacheBuilder::BuildStats& stats = builder.lastBuildStats();
+    DBG_NAV_LOGD("built %d frames (%d nodes), reused %d frames (%d nodes)"
+        " in %dms%s", stats.mBuiltFrames, stats.mBuiltNodes,
+        stats.mReusedFrames, stats.mReusedNodes, stats.mElapsed,
+        stats.mFullRebuilds ? " (full)" : "");
+#endif
     m_tempPict = new SkPicture();
     recordPicture(m_tempPict);
     m_temp->setPicture(m_tempPict);
@@ -60,6 +60,7 @@
 #include "SkCanvas.h"
 #include "SkPoint.h"
 #include "Text.h"
+#include "TimeCounter.h"
 #include "WebCoreFrameBridge.h"
 #include "WebCoreViewBridge.h"
 #include "Widget.h"
@@ -786,11 +787,19 @@ void CacheBuilder::Debug::wideString(const String& str) {
 CacheBuilder::CacheBuilder()
 {
     mAllowableTypes = ALL_CACHEDNODE_BITS;
+    mSnapshot.mCachedFrame = NULL;
+    bzero(&mLastBuildStats, sizeof(mLastBuildStats));
+    bzero(&mTotalBuildStats, sizeof(mTotalBuildStats));
 #ifdef DUMP_NAV_CACHE_USING_PRINTF
     gNavCacheLogFile = NULL;
 #endif
 }
 
+CacheBuilder::~CacheBuilder()
+{
+    delete mSnapshot.mCachedFrame;
+}
+
 void CacheBuilder::adjustForColumns(const ClipColumnTracker& track, 
     CachedNode* node, IntRect* bounds, RenderBlock* renderer)
 {
@@ -881,10 +890,59 @@ bool CacheBuilder::AnyIsClick(Node* node)
 void CacheBuilder::buildCache(CachedRoot* root)
 {
     Frame* frame = FrameAnd(this);
+    uint32_t startTime = getThreadMsec();
     mPictureSetDisabled = false;
-    BuildFrame(frame, frame, root, (CachedFrame*) root);
+    bzero(&mLastBuildStats, sizeof(mLastBuildStats));
+    mLastBuildStats.mBuilds = 1;
+    // If the main frame was resized, its layout changed as a whole: rebuild
+    // every frame rather than trust their snapshots
+    IntSize contentsSize = frame->view() ? frame->view()->contentsSize() : IntSize();
+    if (contentsSize != mContentsSize) {
+        mLastBuildStats.mFullRebuilds = 1;
+        mContentsSize = contentsSize;
+    }
+    BuildOrReuseFrame(frame, frame, root, (CachedFrame*) root);
     root->finishInit(); // set up frame parent pointers, child pointers
     setData((CachedFrame*) root);
+    mLastBuildStats.mBuiltNodes = NodeCount(root) - mLastBuildStats.mReusedNodes;
+    mLastBuildStats.mElapsed = getThreadMsec() - startTime;
+    mTotalBuildStats.mBuiltFrames += mLastBuildStats.mBuiltFrames;
+    mTotalBuildStats.mReusedFrames += mLastBuildStats.mReusedFrames;
+    mTotalBuildStats.mBuiltNodes += mLastBuildStats.mBuiltNodes;
+    mTotalBuildStats.mReusedNodes += mLastBuildStats.mReusedNodes;
+    mTotalBuildStats.mBuilds += mLastBuildStats.mBuilds;
+    mTotalBuildStats.mFullRebuilds += mLastBuildStats.mFullRebuilds;
+    mTotalBuildStats.mElapsed += mLastBuildStats.mElapsed;
+}
+
+// Copies in the nodes of the frame from its snapshot if its document did not
+// change, else walks its DOM. Either way its child frames are then built or
+// reused on their own, so that a change in one frame only costs that frame.
+void CacheBuilder::BuildOrReuseFrame(Frame* root, Frame* frame,
+    CachedRoot* cachedRoot, CachedFrame* cachedFrame)
+{
+    CacheBuilder* builder = Builder(frame);
+    if (!mLastBuildStats.mFullRebuilds
+            && builder->snapshotIsValid(mAllowableTypes)) {
+        int indexInParent = cachedFrame->indexInParent();
+        *cachedFrame = *builder->mSnapshot.mCachedFrame;
+        cachedFrame->setRoot(cachedRoot);
+        cachedFrame->setIndexInParent(indexInParent);
+        mLastBuildStats.mReusedFrames++;
+        mLastBuildStats.mReusedNodes += cachedFrame->size();
+        for (size_t index = 0; index < cachedFrame->childCount(); index++) {
+            CachedFrame* childPtr = cachedFrame->firstChild() + index;
+            Frame* child = (Frame*) childPtr->framePointer();
+            // the snapshot holds the children as they were when it was taken
+            CachedFrame cachedChild;
+            cachedChild.init(cachedRoot, childPtr->indexInParent(), child);
+            *childPtr = cachedChild;
+            BuildOrReuseFrame(root, child, cachedRoot, childPtr);
+        }
+        return;
+    }
+    BuildFrame(root, frame, cachedRoot, cachedFrame);
+    builder->saveSnapshot(cachedFrame, mAllowableTypes);
 }
 
 static Node* ParentWithChildren(Node* node)
@@ -998,6 +1056,7 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
     bzero(tabIndexTracker.data(), sizeof(TabIndexTracker));
     WTF::Vector<CachedColor> colorTracker(1);
     InitColor(colorTracker.data());
+    mLastBuildStats.mBuiltFrames++;
 #if DUMP_NAV_CACHE
     char* frameNamePtr = cachedFrame->mDebug.mFrameName;
     Builder(frame)->mDebug.frameName(frameNamePtr, frameNamePtr + 
@@ -1088,7 +1147,7 @@ void CacheBuilder::BuildFrame(Frame* root, Frame* frame,
 #endif
             cachedFrame->add(cachedNode);
             CachedFrame* childPtr = cachedFrame->lastChild();
-            BuildFrame(root, child, cachedRoot, childPtr);
+            BuildOrReuseFrame(root, child, cachedRoot, childPtr);
             continue;
         }
         int tabIndex = node->tabIndex();
@@ -2869,6 +2928,81 @@ bool CacheBuilder::IsMailboxChar(UChar ch)
     return (body[ch >> 5] & 1 << (ch & 0x1f)) != 0;
 }
 
+int CacheBuilder::NodeCount(CachedFrame* cachedFrame)
+{
+    int count = cachedFrame->size();
+    for (size_t index = 0; index < cachedFrame->childCount(); index++)
+        count += NodeCount(cachedFrame->firstChild() + index);
+    return count;
+}
+
+// Called on the builder of a frame once its cache is built
+void CacheBuilder::saveSnapshot(CachedFrame* cachedFrame,
+    CachedNodeBits allowableTypes)
+{
+    Frame* frame = FrameAnd(this);
+    delete mSnapshot.mCachedFrame;
+    mSnapshot.mCachedFrame = NULL;
+    // the focus is recorded in the frame and the CachedRoot as it is built,
+    // and must not come back once it moves elsewhere
+    if (frame->document()->focusedNode())
+        return;
+#if USE(ACCELERATED_COMPOSITING)
+    // cached layers point into the current layer tree; don't keep them. The
+    // main frame is drawn in the base layer, even if it uses compositing.
+    if (cachedFrame->layerCount() || (frame->tree()->parent()
+            && frame->contentRenderer()
+            && frame->contentRenderer()->usesCompositing()))
+        return;
+#endif
+    mSnapshot.mCachedFrame = new CachedFrame(*cachedFrame);
+    mSnapshot.mDomTreeVersion = frame->document()->domTreeVersion();
+    mSnapshot.mStyleVersion = frame->document()->styleVersion();
+    mSnapshot.mLayoutCount = frame->view() ? frame->view()->layoutCount() : 0;
+    int x, y;
+    GetGlobalOffset(frame, &x, &y);
+    mSnapshot.mGlobalOffset = IntPoint(x, y);
+    mSnapshot.mScrollPosition = frame->view() ? frame->view()->scrollPosition()
+        : IntPoint();
+    mSnapshot.mAllowableTypes = allowableTypes;
+}
+
+// True if the nodes of this frame's snapshot can be used as is; those of its
+// children are checked on their own. Frames holding the focus are always
+// rebuilt, as building them also records the focus in the CachedRoot.
+bool CacheBuilder::snapshotIsValid(CachedNodeBits allowableTypes) const
+{
+    if (!mSnapshot.mCachedFrame)
+        return false;
+    Frame* frame = FrameAnd(this);
+    Document* doc = frame->document();
+    FrameView* view = frame->view();
+    if (!doc || !view || view->needsLayout() || doc->focusedNode())
+        return false;
+    if (mSnapshot.mAllowableTypes != allowableTypes
+            || mSnapshot.mDomTreeVersion != doc->domTreeVersion()
+            || mSnapshot.mStyleVersion != doc->styleVersion()
+            || mSnapshot.mLayoutCount != view->layoutCount()
+            || mSnapshot.mScrollPosition != view->scrollPosition())
+        return false;
+    int x, y;
+    GetGlobalOffset(frame, &x, &y);
+    if (mSnapshot.mGlobalOffset != IntPoint(x, y))
+        return false;
+    // the frames the snapshot holds must still be there to be built; they
+    // are only compared, as they may be gone
+    for (size_t index = 0; index < mSnapshot.mCachedFrame->childCount(); index++) {
+        void* framePointer =
+            (mSnapshot.mCachedFrame->firstChild() + index)->framePointer();
+        Frame* child = frame->tree()->firstChild();
+        while (child && child != framePointer)
+            child = child->tree()->nextSibling();
+        if (!child || !child->document())
+            return false;
+    }
+    return true;
+}
+
 bool CacheBuilder::setData(CachedFrame* cachedFrame) 
 {
     Frame* frame = FrameAnd(this);
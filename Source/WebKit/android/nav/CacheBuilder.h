@@ -79,9 +79,22 @@ public:
         FOUND_PARTIAL,
         FOUND_COMPLETE
     };
+    // Counters of the work done by buildCache()
+    struct BuildStats {
+        int mBuiltFrames;
+        int mReusedFrames;
+        int mBuiltNodes;
+        int mReusedNodes;
+        int mBuilds;
+        int mFullRebuilds; // main frame resized, no frame reused
+        uint32_t mElapsed; // thread time, in ms
+    };
     CacheBuilder();
+    ~CacheBuilder();
     void allowAllTextDetection() { mAllowableTypes = ALL_CACHEDNODE_BITS; }
     void buildCache(CachedRoot* root);
+    const BuildStats& lastBuildStats() const { return mLastBuildStats; }
+    const BuildStats& totalBuildStats() const { return mTotalBuildStats; }
     static bool ConstructPartRects(Node* node, const IntRect& bounds, 
         IntRect* focusBounds, int x, int y, WTF::Vector<IntRect>* result,
         int* imageCountPtr);
@@ -213,6 +226,18 @@ private:
         int mCachedNodeIndex;
         bool mSomeParentTakesFocus;
     };
+    // The cache last built for a frame, with what it was built from. A frame
+    // whose document, layout and position did not change since then reuses
+    // its nodes instead of walking its DOM again.
+    struct FrameSnapshot {
+        CachedFrame* mCachedFrame;
+        uint64_t mDomTreeVersion;
+        unsigned mStyleVersion;
+        int mLayoutCount;
+        IntPoint mGlobalOffset;
+        IntPoint mScrollPosition;
+        CachedNodeBits mAllowableTypes;
+    };
     void adjustForColumns(const ClipColumnTracker& track, 
         CachedNode* node, IntRect* bounds, RenderBlock*);
     static bool AddPartRect(IntRect& bounds, int x, int y,
@@ -222,6 +247,8 @@ private:
     static bool NodeHasEventListeners(Node* node, AtomicString* eventTypes, int length);
     void BuildFrame(Frame* root, Frame* frame,
         CachedRoot* cachedRoot, CachedFrame* cachedFrame);
+    void BuildOrReuseFrame(Frame* root, Frame* frame,
+        CachedRoot* cachedRoot, CachedFrame* cachedFrame);
     bool CleanUpContainedNodes(CachedRoot* cachedRoot, CachedFrame* cachedFrame,
         const FocusTracker* last, int lastChildIndex);
     static bool ConstructTextRect(Text* textNode,
@@ -247,8 +274,11 @@ private:
         String* exported) const; //returns true if it is focusable
     static bool IsMailboxChar(UChar ch);
     static bool IsRealNode(Frame* , Node* );
+    static int NodeCount(CachedFrame* );
     int overlap(int left, int right); // returns distance scale factor as 16.16 scalar
+    void saveSnapshot(CachedFrame* , CachedNodeBits allowableTypes);
     bool setData(CachedFrame* );
+    bool snapshotIsValid(CachedNodeBits allowableTypes) const;
 #if USE(ACCELERATED_COMPOSITING)
     void TrackLayer(WTF::Vector<LayerTracker>& layerTracker,
         RenderObject* nodeRenderer, Node* lastChild, int offsetX, int offsetY);
@@ -257,6 +287,10 @@ private:
     Node* trySegment(Direction direction, int mainStart, int mainEnd);
     CachedNodeBits mAllowableTypes;
     bool mPictureSetDisabled;
+    FrameSnapshot mSnapshot;
+    IntSize mContentsSize; // of the main frame, at the last build
+    BuildStats mLastBuildStats;
+    BuildStats mTotalBuildStats;
 #if DUMP_NAV_CACHE
 public:
     class Debug {
@@ -943,6 +943,13 @@ void CachedFrame::init(const CachedRoot* root, int childFrameIndex,
     mIndexInParent = childFrameIndex;
 }
 
+void CachedFrame::setRoot(const CachedRoot* root)
+{
+    mRoot = root;
+    for (CachedFrame* child = mCachedFrames.begin(); child != mCachedFrames.end(); child++)
+        child->setRoot(root);
+}
+
 #if USE(ACCELERATED_COMPOSITING)
 const CachedLayer* CachedFrame::layer(const CachedNode* node) const
 {
@@ -146,6 +146,7 @@ public:
     void setFocusIndex(int index) { mFocusIndex = index; }
     void setIndexInParent(int index) { mIndexInParent = index; }
     void setLocalViewBounds(const WebCore::IntRect& bounds) { mLocalViewBounds = bounds; }
+    void setRoot(const CachedRoot* root); // of this frame and its children
     int size() { return mCachedNodes.size(); }
     const CachedInput* textInput(const CachedNode* node) const {
         return node->isTextInput() ? &mCachedTextInputs[node->textInputIndex()]
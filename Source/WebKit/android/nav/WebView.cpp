@@ -57,6 +57,7 @@
 #include "TimeCounter.h"
 #endif
 #include "TilesManager.h"
+#include "TimelineRecorder.h"
 #include "WebCoreJni.h"
 #include "WebRequestContext.h"
 #include "WebViewCore.h"
@@ -2606,6 +2607,20 @@ static bool nativeSetProperty(JNIEnv *env, jobject obj, jstring jkey, jstring jv
         TilesManager::instance()->setUseMinimalMemory(value == "true");
         return true;
     }
+    else if (key == "use_opaque_565_tiles") {
+        TilesManager::instance()->setUseOpaque565Tiles(value == "true");
+        return true;
+    }
+    else if (key == "timeline") {
+        if (value == "true")
+            TimelineRecorder::clear();
+        TimelineRecorder::setEnabled(value == "true");
+        return true;
+    }
+    else if (key == "timeline_export") {
+        // the value is the path of the Chrome trace event JSON file
+        return TimelineRecorder::exportChromeTrace(value.utf8().data());
+    }
     return false;
 }
 